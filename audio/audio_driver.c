@@ -28,6 +28,12 @@
 #define AUDIO_BUFFER_FREE_SAMPLES_COUNT (8 * 1024)
 #endif
 
+/* Frames pushed through the whole audio pipeline at a time.
+ * Small enough for every stage to stay in L1. */
+#ifndef AUDIO_BLOCK_FRAMES
+#define AUDIO_BLOCK_FRAMES 256
+#endif
+
 typedef struct audio_driver_input_data
 {
    float *data;
@@ -426,7 +432,9 @@ void init_audio(void)
 
    if (!rarch_resampler_realloc(&driver->resampler_data,
             &driver->resampler,
-         settings->audio.resampler, audio_data.orig_src_ratio))
+         settings->audio.resampler,
+         (enum resampler_quality)settings->audio.resampler_quality,
+         audio_data.orig_src_ratio))
    {
       RARCH_ERR("Failed to initialize resampler \"%s\".\n",
             settings->audio.resampler);
@@ -581,6 +589,84 @@ void audio_driver_set_nonblocking_state(bool enable)
       audio_data.block_chunk_size;
 }
 
+/**
+ * audio_driver_process_block:
+ * @in                   : s16 input samples, or NULL if the block
+ *                         has already been converted to float.
+ * @in_float             : float buffer holding the block.
+ * @frames               : amount of frames in the block.
+ * @out                  : float output of the resampler.
+ * @out_s16              : s16 output, or NULL if the audio driver
+ *                         takes float samples.
+ * @ratio                : resampling ratio.
+ *
+ * Runs one block through every stage of the audio pipeline,
+ * so it stays in cache from conversion to resampling.
+ *
+ * Returns: amount of frames written to @out.
+ **/
+static size_t audio_driver_process_block(const int16_t *in,
+      float *in_float, size_t frames, float *out, int16_t *out_s16,
+      double ratio)
+{
+   static struct retro_perf_counter audio_convert_s16 = {0};
+   static struct retro_perf_counter audio_convert_float = {0};
+   static struct retro_perf_counter audio_dsp         = {0};
+   static struct retro_perf_counter resampler_proc    = {0};
+   struct resampler_data src_data              = {0};
+   struct rarch_dsp_data dsp_data              = {0};
+   driver_t  *driver                           = driver_get_ptr();
+
+   if (in)
+   {
+      rarch_perf_init(&audio_convert_s16, "audio_convert_s16");
+      retro_perf_start(&audio_convert_s16);
+      audio_convert_s16_to_float(in_float, in, frames << 1,
+            audio_data.volume_gain);
+      retro_perf_stop(&audio_convert_s16);
+   }
+
+   src_data.data_in               = in_float;
+   src_data.input_frames          = frames;
+
+   dsp_data.input                 = in_float;
+   dsp_data.input_frames          = frames;
+
+   if (audio_data.dsp)
+   {
+      rarch_perf_init(&audio_dsp, "audio_dsp");
+      retro_perf_start(&audio_dsp);
+      rarch_dsp_filter_process(audio_data.dsp, &dsp_data);
+      retro_perf_stop(&audio_dsp);
+
+      if (dsp_data.output)
+      {
+         src_data.data_in      = dsp_data.output;
+         src_data.input_frames = dsp_data.output_frames;
+      }
+   }
+
+   src_data.data_out = out;
+   src_data.ratio    = ratio;
+
+   rarch_perf_init(&resampler_proc, "resampler_proc");
+   retro_perf_start(&resampler_proc);
+   rarch_resampler_process(driver->resampler,
+         driver->resampler_data, &src_data);
+   retro_perf_stop(&resampler_proc);
+
+   if (out_s16)
+   {
+      rarch_perf_init(&audio_convert_float, "audio_convert_float");
+      retro_perf_start(&audio_convert_float);
+      audio_convert_float_to_s16(out_s16, out,
+            src_data.output_frames << 1);
+      retro_perf_stop(&audio_convert_float);
+   }
+
+   return src_data.output_frames;
+}
+
 /**
  * audio_driver_flush:
  * @data                 : pointer to audio buffer.
@@ -589,20 +675,20 @@ void audio_driver_set_nonblocking_state(bool enable)
  * Writes audio samples to audio driver. Will first
  * perform DSP processing (if enabled) and resampling.
  *
+ * Samples are pushed through the pipeline in blocks of
+ * AUDIO_BLOCK_FRAMES frames instead of running each stage
+ * over the whole buffer.
+ *
  * Returns: true (1) if audio samples were written to the audio
  * driver, false (0) in case of an error.
  **/
 bool audio_driver_flush(const int16_t *data, size_t samples)
 {
    bool is_slowmotion, is_paused;
-   static struct retro_perf_counter audio_convert_s16 = {0};
-   static struct retro_perf_counter audio_convert_float = {0};
-   static struct retro_perf_counter audio_dsp         = {0};
-   static struct retro_perf_counter resampler_proc    = {0};
-   struct resampler_data src_data              = {0};
-   struct rarch_dsp_data dsp_data              = {0};
+   double ratio;
+   size_t frames, in_frames, out_frames      = 0;
+   bool converted                              = false;
    const void *output_data                     = NULL;
-   unsigned output_frames                      = 0;
    size_t   output_size                        = sizeof(float);
    driver_t  *driver                           = driver_get_ptr();
    const audio_driver_t *audio                 = driver ? 
@@ -626,66 +712,52 @@ bool audio_driver_flush(const int16_t *data, size_t samples)
    if (!driver->audio_active || !audio_data.data)
       return false;
 
-   rarch_perf_init(&audio_convert_s16, "audio_convert_s16");
-   retro_perf_start(&audio_convert_s16);
-   audio_convert_s16_to_float(audio_data.data, data, samples,
-         audio_data.volume_gain);
-   retro_perf_stop(&audio_convert_s16);
-
-   src_data.data_in               = audio_data.data;
-   src_data.input_frames          = samples >> 1;
-
-   dsp_data.input                 = audio_data.data;
-   dsp_data.input_frames          = samples >> 1;
-
-   if (audio_data.dsp)
-   {
-      rarch_perf_init(&audio_dsp, "audio_dsp");
-      retro_perf_start(&audio_dsp);
-      rarch_dsp_filter_process(audio_data.dsp, &dsp_data);
-      retro_perf_stop(&audio_dsp);
-
-      if (dsp_data.output)
-      {
-         src_data.data_in      = dsp_data.output;
-         src_data.input_frames = dsp_data.output_frames;
-      }
-   }
-
-   src_data.data_out = audio_data.outsamples;
-
    if (audio_data.rate_control)
       audio_driver_readjust_input_rate();
 
-   src_data.ratio = audio_data.src_ratio;
+   ratio = audio_data.src_ratio;
 
    rarch_main_ctl(RARCH_MAIN_CTL_IS_SLOWMOTION, &is_slowmotion);
 
    if (is_slowmotion)
-      src_data.ratio *= settings->slowmotion_ratio;
+      ratio *= settings->slowmotion_ratio;
 
-   rarch_perf_init(&resampler_proc, "resampler_proc");
-   retro_perf_start(&resampler_proc);
-   rarch_resampler_process(driver->resampler,
-         driver->resampler_data, &src_data);
-   retro_perf_stop(&resampler_proc);
+   /* audio_driver_sample() stages its samples in conv_outsamples,
+    * convert them up front before the s16 output overwrites them. */
+   if (!audio_data.use_float && data == audio_data.conv_outsamples)
+   {
+      audio_convert_s16_to_float(audio_data.data, data, samples,
+            audio_data.volume_gain);
+      converted = true;
+   }
 
-   output_data   = audio_data.outsamples;
-   output_frames = src_data.output_frames;
+   in_frames = samples >> 1;
 
-   if (!audio_data.use_float)
+   for (frames = 0; frames < in_frames; frames += AUDIO_BLOCK_FRAMES)
    {
-      rarch_perf_init(&audio_convert_float, "audio_convert_float");
-      retro_perf_start(&audio_convert_float);
-      audio_convert_float_to_s16(audio_data.conv_outsamples,
-            (const float*)output_data, output_frames * 2);
-      retro_perf_stop(&audio_convert_float);
+      size_t block = in_frames - frames;
+
+      if (block > AUDIO_BLOCK_FRAMES)
+         block = AUDIO_BLOCK_FRAMES;
+
+      out_frames += audio_driver_process_block(
+            converted ? NULL : data + (frames << 1),
+            audio_data.data + (frames << 1), block,
+            audio_data.outsamples + (out_frames << 1),
+            audio_data.use_float ?
+            NULL : audio_data.conv_outsamples + (out_frames << 1),
+            ratio);
+   }
+
+   output_data = audio_data.outsamples;
 
+   if (!audio_data.use_float)
+   {
       output_data = audio_data.conv_outsamples;
       output_size = sizeof(int16_t);
    }
 
-   if (audio->write(driver->audio_data, output_data, output_frames * output_size * 2) < 0)
+   if (audio->write(driver->audio_data, output_data, out_frames * output_size * 2) < 0)
    {
       driver->audio_active = false;
       return false;
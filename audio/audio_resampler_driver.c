@@ -181,6 +181,7 @@ static resampler_simd_mask_t resampler_get_cpu_features(void)
  * resampler_append_plugs:
  * @re                         : Resampler handle
  * @backend                    : Resampler backend that is about to be set.
+ * @quality                    : Quality level hint.
  * @bw_ratio                   : Bandwidth ratio.
  *
  * Initializes resampler driver based on queried CPU features.
@@ -189,11 +190,12 @@ static resampler_simd_mask_t resampler_get_cpu_features(void)
  **/
 static bool resampler_append_plugs(void **re,
       const rarch_resampler_t **backend,
+      enum resampler_quality quality,
       double bw_ratio)
 {
    resampler_simd_mask_t mask = resampler_get_cpu_features();
 
-   *re = (*backend)->init(&resampler_config, bw_ratio, mask);
+   *re = (*backend)->init(&resampler_config, bw_ratio, quality, mask);
 
    if (!*re)
       return false;
@@ -205,6 +207,7 @@ static bool resampler_append_plugs(void **re,
  * @re                         : Resampler handle
  * @backend                    : Resampler backend that is about to be set.
  * @ident                      : Identifier name for resampler we want.
+ * @quality                    : Quality level hint.
  * @bw_ratio                   : Bandwidth ratio.
  *
  * Reallocates resampler. Will free previous handle before 
@@ -213,7 +216,7 @@ static bool resampler_append_plugs(void **re,
  * Returns: true (1) if successful, otherwise false (0).
  **/
 bool rarch_resampler_realloc(void **re, const rarch_resampler_t **backend,
-      const char *ident, double bw_ratio)
+      const char *ident, enum resampler_quality quality, double bw_ratio)
 {
    if (*re && *backend)
       (*backend)->free(*re);
@@ -221,7 +224,7 @@ bool rarch_resampler_realloc(void **re, const rarch_resampler_t **backend,
    *re      = NULL;
    *backend = find_resampler_driver(ident);
 
-   if (!resampler_append_plugs(re, backend, bw_ratio))
+   if (!resampler_append_plugs(re, backend, quality, bw_ratio))
       goto error;
 
    return true;
@@ -19,6 +19,20 @@
 
 #if defined(__SSE2__)
 #include <emmintrin.h>
+
+#if defined(__AVX2__) || (defined(__GNUC__) && !defined(__clang__) && \
+      (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+/* GCC can build the AVX2 kernels for a generic target,
+ * they are only used if the CPU reports AVX2 at runtime. */
+#define HAVE_AUDIO_CONVERT_AVX2
+#include <immintrin.h>
+#ifdef __AVX2__
+#define AUDIO_CONVERT_AVX2_TARGET
+#else
+#define AUDIO_CONVERT_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
 #elif defined(__ALTIVEC__)
 #include <altivec.h>
 #endif
@@ -138,6 +152,84 @@ void audio_convert_float_to_s16_SSE2(int16_t *out,
 
    audio_convert_float_to_s16_C(out, in, samples - i);
 }
+
+#ifdef HAVE_AUDIO_CONVERT_AVX2
+/**
+ * audio_convert_s16_to_float_AVX2:
+ * @out               : output buffer
+ * @in                : input buffer
+ * @samples           : size of samples to be converted
+ * @gain              : gain applied to the audio volume
+ *
+ * Converts audio samples from signed integer 16-bit
+ * to floating point.
+ *
+ * AVX2 implementation callback function.
+ **/
+static AUDIO_CONVERT_AVX2_TARGET void audio_convert_s16_to_float_AVX2(
+      float *out, const int16_t *in, size_t samples, float gain)
+{
+   size_t i;
+   __m256 factor = _mm256_set1_ps(gain / 0x8000);
+
+   for (i = 0; i + 16 <= samples; i += 16, in += 16, out += 16)
+   {
+      __m256i input    = _mm256_loadu_si256((const __m256i *)in);
+      __m256i regs_l   = _mm256_cvtepi16_epi32(
+            _mm256_castsi256_si128(input));
+      __m256i regs_r   = _mm256_cvtepi16_epi32(
+            _mm256_extracti128_si256(input, 1));
+      __m256 output_l  = _mm256_mul_ps(_mm256_cvtepi32_ps(regs_l), factor);
+      __m256 output_r  = _mm256_mul_ps(_mm256_cvtepi32_ps(regs_r), factor);
+
+      _mm256_storeu_ps(out + 0, output_l);
+      _mm256_storeu_ps(out + 8, output_r);
+   }
+
+   audio_convert_s16_to_float_SSE2(out, in, samples - i, gain);
+}
+
+/**
+ * audio_convert_float_to_s16_AVX2:
+ * @out               : output buffer
+ * @in                : input buffer
+ * @samples           : size of samples to be converted
+ *
+ * Converts audio samples from floating point 
+ * to signed integer 16-bit.
+ *
+ * AVX2 implementation callback function.
+ **/
+static AUDIO_CONVERT_AVX2_TARGET void audio_convert_float_to_s16_AVX2(
+      int16_t *out, const float *in, size_t samples)
+{
+   size_t i;
+   __m256 factor = _mm256_set1_ps((float)0x8000);
+
+   for (i = 0; i + 16 <= samples; i += 16, in += 16, out += 16)
+   {
+      __m256 input_l = _mm256_loadu_ps(in + 0);
+      __m256 input_r = _mm256_loadu_ps(in + 8);
+      __m256i ints_l = _mm256_cvtps_epi32(_mm256_mul_ps(input_l, factor));
+      __m256i ints_r = _mm256_cvtps_epi32(_mm256_mul_ps(input_r, factor));
+      /* Packing works per 128-bit lane, put the quadwords back in order. */
+      __m256i packed = _mm256_permute4x64_epi64(
+            _mm256_packs_epi32(ints_l, ints_r), 0xd8);
+
+      _mm256_storeu_si256((__m256i *)out, packed);
+   }
+
+   audio_convert_float_to_s16_SSE2(out, in, samples - i);
+}
+#endif
+
+void (*audio_convert_s16_to_float_x86)(float *out,
+      const int16_t *in, size_t samples, float gain) =
+   audio_convert_s16_to_float_SSE2;
+
+void (*audio_convert_float_to_s16_x86)(int16_t *out,
+      const float *in, size_t samples) =
+   audio_convert_float_to_s16_SSE2;
 #elif defined(__ALTIVEC__)
 /**
  * audio_convert_s16_to_float_altivec:
@@ -426,6 +518,18 @@ void audio_convert_init_simd(void)
    unsigned cpu = audio_convert_get_cpu_features();
 
    (void)cpu;
+#if defined(__SSE2__) && defined(HAVE_AUDIO_CONVERT_AVX2)
+   {
+      /* RETRO_SIMD_AVX is only reported once the OS is known to save
+       * YMM state; a frontend's CPUID-only AVX2 bit is not enough. */
+      bool avx2 = (cpu & RETRO_SIMD_AVX) && (cpu & RETRO_SIMD_AVX2);
+
+      audio_convert_s16_to_float_x86 = avx2 ?
+         audio_convert_s16_to_float_AVX2 : audio_convert_s16_to_float_SSE2;
+      audio_convert_float_to_s16_x86 = avx2 ?
+         audio_convert_float_to_s16_AVX2 : audio_convert_float_to_s16_SSE2;
+   }
+#endif
 #if defined(__ARM_NEON__) && !defined(VITA)
    audio_convert_s16_to_float_arm = (cpu & RETRO_SIMD_NEON) ?
       audio_convert_s16_to_float_neon : audio_convert_s16_to_float_C;
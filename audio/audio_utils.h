@@ -28,8 +28,15 @@ extern "C" {
 #endif
 
 #if defined(__SSE2__)
-#define audio_convert_s16_to_float audio_convert_s16_to_float_SSE2
-#define audio_convert_float_to_s16 audio_convert_float_to_s16_SSE2
+#define audio_convert_s16_to_float audio_convert_s16_to_float_x86
+#define audio_convert_float_to_s16 audio_convert_float_to_s16_x86
+
+/* Set up by audio_convert_init_simd(), default to SSE2. */
+extern void (*audio_convert_s16_to_float_x86)(float *out,
+      const int16_t *in, size_t samples, float gain);
+
+extern void (*audio_convert_float_to_s16_x86)(int16_t *out,
+      const float *in, size_t samples);
 
 /**
  * audio_convert_s16_to_float_SSE2:
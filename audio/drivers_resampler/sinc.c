@@ -38,67 +38,72 @@
  * HIGHEST: 140 dB
  */
 
-/* TODO, make all this more configurable. */
+/* Quality used when the frontend doesn't care. */
 #if defined(SINC_LOWEST_QUALITY)
-#define SINC_WINDOW_LANCZOS
-#define CUTOFF 0.98
-#define PHASE_BITS 12
-#define SINC_COEFF_LERP 0
-#define SUBPHASE_BITS 10
-#define SIDELOBES 2
-#define ENABLE_AVX 0
+#define SINC_DEFAULT_QUALITY RESAMPLER_QUALITY_LOWEST
 #elif defined(SINC_LOWER_QUALITY)
-#define SINC_WINDOW_LANCZOS
-#define CUTOFF 0.98
-#define PHASE_BITS 12
-#define SUBPHASE_BITS 10
-#define SINC_COEFF_LERP 0
-#define SIDELOBES 4
-#define ENABLE_AVX 0
+#define SINC_DEFAULT_QUALITY RESAMPLER_QUALITY_LOWER
 #elif defined(SINC_HIGHER_QUALITY)
-#define SINC_WINDOW_KAISER
-#define SINC_WINDOW_KAISER_BETA 10.5
-#define CUTOFF 0.90
-#define PHASE_BITS 10
-#define SUBPHASE_BITS 14
-#define SINC_COEFF_LERP 1
-#define SIDELOBES 32
-#define ENABLE_AVX 1
+#define SINC_DEFAULT_QUALITY RESAMPLER_QUALITY_HIGHER
 #elif defined(SINC_HIGHEST_QUALITY)
-#define SINC_WINDOW_KAISER
-#define SINC_WINDOW_KAISER_BETA 14.5
-#define CUTOFF 0.962
-#define PHASE_BITS 10
-#define SUBPHASE_BITS 14
-#define SINC_COEFF_LERP 1
-#define SIDELOBES 128
-#define ENABLE_AVX 1
+#define SINC_DEFAULT_QUALITY RESAMPLER_QUALITY_HIGHEST
 #else
-#define SINC_WINDOW_KAISER
-#define SINC_WINDOW_KAISER_BETA 5.5
-#define CUTOFF 0.825
-#define PHASE_BITS 8
-#define SUBPHASE_BITS 16
-#define SINC_COEFF_LERP 1
-#define SIDELOBES 8
-#define ENABLE_AVX 0
+#define SINC_DEFAULT_QUALITY RESAMPLER_QUALITY_NORMAL
 #endif
 
-/* For the little amount of taps we're using,
- * SSE1 is faster than AVX for some reason.
- * AVX code is kept here though as by increasing number
- * of sinc taps, the AVX code is clearly faster than SSE1.
- */
-
-#if defined(__AVX__) && ENABLE_AVX
+#if defined(__AVX__) || ((defined(__x86_64__) || defined(__i386__)) && \
+      defined(__GNUC__) && !defined(__clang__) && \
+      (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+/* GCC can build the AVX path for a generic target,
+ * it is only used if the CPU reports AVX at runtime. */
+#define HAVE_SINC_AVX
 #include <immintrin.h>
+#ifdef __AVX__
+#define SINC_AVX_TARGET
+#else
+#define SINC_AVX_TARGET __attribute__((target("avx")))
+#endif
+
+/* Below this many taps the wider horizontal sum at the end of
+ * every output frame costs more than the 8-wide loop saves. */
+#define SINC_AVX_MIN_TAPS 32
+
+/* Same for FMA, which is used if the CPU reports it as well. */
+#if defined(__AVX__) && defined(__FMA__)
+#define HAVE_SINC_FMA
+#define SINC_FMA_TARGET
+#elif defined(__GNUC__)
+#define HAVE_SINC_FMA
+#define SINC_FMA_TARGET __attribute__((target("avx,fma")))
+#endif
 #endif
 
-#define PHASES (1 << (PHASE_BITS + SUBPHASE_BITS))
+enum sinc_window
+{
+   SINC_WINDOW_LANCZOS = 0,
+   SINC_WINDOW_KAISER
+};
+
+struct sinc_params
+{
+   enum sinc_window window;
+   double kaiser_beta;
+   double cutoff;
+   unsigned phase_bits;
+   unsigned subphase_bits;
+   unsigned sidelobes;
+   bool coeff_lerp;
+};
 
-#define TAPS (SIDELOBES * 2)
-#define SUBPHASE_MASK ((1 << SUBPHASE_BITS) - 1)
-#define SUBPHASE_MOD (1.0f / (1 << SUBPHASE_BITS))
+/* Indexed by enum resampler_quality, starting at
+ * RESAMPLER_QUALITY_LOWEST. */
+static const struct sinc_params sinc_quality_params[] = {
+   { SINC_WINDOW_LANCZOS, 0.0,  0.98,  12, 10, 2,   false },
+   { SINC_WINDOW_LANCZOS, 0.0,  0.98,  12, 10, 4,   false },
+   { SINC_WINDOW_KAISER,  5.5,  0.825, 8,  16, 8,   true  },
+   { SINC_WINDOW_KAISER,  10.5, 0.90,  10, 14, 32,  true  },
+   { SINC_WINDOW_KAISER,  14.5, 0.962, 10, 14, 128, true  },
+};
 
 typedef struct rarch_sinc_resampler
 {
@@ -111,25 +116,38 @@ typedef struct rarch_sinc_resampler
    unsigned ptr;
    uint32_t time;
 
+   unsigned phase_bits;
+   unsigned subphase_bits;
+   uint32_t subphase_mask;
+   float subphase_mod;
+
+   /* Picked in resampler_sinc_new() from quality and CPU features. */
+   void (*process)(struct rarch_sinc_resampler *re,
+         struct resampler_data *data);
+
    /* A buffer for phase_table, buffer_l and buffer_r 
     * are created in a single calloc().
     * Ensure that we get as good cache locality as we can hope for. */
    float *main_buffer;
 } rarch_sinc_resampler_t;
 
-#if defined(SINC_WINDOW_LANCZOS)
-#define window_function(idx)  (lanzcos_window_function(idx))
-#elif defined(SINC_WINDOW_KAISER)
-#define window_function(idx)  (kaiser_window_function(idx, SINC_WINDOW_KAISER_BETA))
-#else
-#error "No SINC window function defined."
-#endif
+typedef void (*sinc_kernel_t)(const rarch_sinc_resampler_t *resamp,
+      uint32_t time, float *out_buffer, bool lerp);
 
-static void init_sinc_table(rarch_sinc_resampler_t *resamp, double cutoff,
-      float *phase_table, int phases, int taps, bool calculate_delta)
+static double window_function(const struct sinc_params *params,
+      double idx)
+{
+   if (params->window == SINC_WINDOW_LANCZOS)
+      return lanzcos_window_function(idx);
+   return kaiser_window_function(idx, params->kaiser_beta);
+}
+
+static void init_sinc_table(const struct sinc_params *params,
+      double cutoff, float *phase_table, int phases, int taps,
+      bool calculate_delta)
 {
    int i, j;
-   double    window_mod = window_function(0.0); /* Need to normalize w(0) to 1.0. */
+   double    window_mod = window_function(params, 0.0); /* Need to normalize w(0) to 1.0. */
    int           stride = calculate_delta ? 2 : 1;
    double     sidelobes = taps / 2.0;
 
@@ -145,7 +163,7 @@ static void init_sinc_table(rarch_sinc_resampler_t *resamp, double cutoff,
          sinc_phase = sidelobes * window_phase;
 
          val = cutoff * sinc(M_PI * sinc_phase * cutoff) * 
-            window_function(window_phase) / window_mod;
+            window_function(params, window_phase) / window_mod;
          phase_table[i * stride * taps + j] = val;
       }
    }
@@ -176,40 +194,34 @@ static void init_sinc_table(rarch_sinc_resampler_t *resamp, double cutoff,
          sinc_phase = sidelobes * window_phase;
 
          val = cutoff * sinc(M_PI * sinc_phase * cutoff) * 
-            window_function(window_phase) / window_mod;
+            window_function(params, window_phase) / window_mod;
          delta = (val - phase_table[phase * stride * taps + j]);
          phase_table[(phase * stride + 1) * taps + j] = delta;
       }
    }
 }
 
-#if !(defined(__AVX__) && ENABLE_AVX) && !defined(__SSE__)
-static INLINE void process_sinc_C(rarch_sinc_resampler_t *resamp,
-      float *out_buffer)
+static INLINE void process_sinc_C(const rarch_sinc_resampler_t *resamp,
+      uint32_t time, float *out_buffer, bool lerp)
 {
-   unsigned i;
+   size_t i;
    float sum_l              = 0.0f;
    float sum_r              = 0.0f;
    const float *buffer_l    = resamp->buffer_l + resamp->ptr;
    const float *buffer_r    = resamp->buffer_r + resamp->ptr;
-   unsigned taps            = resamp->taps;
-   unsigned phase           = resamp->time >> SUBPHASE_BITS;
-#if SINC_COEFF_LERP
-   const float *phase_table = resamp->phase_table + phase * taps * 2;
+   size_t taps              = resamp->taps;
+   size_t phase             = time >> resamp->subphase_bits;
+   const float *phase_table = resamp->phase_table + 
+      phase * taps * (lerp ? 2 : 1);
    const float *delta_table = phase_table + taps;
    float delta              = (float)
-      (resamp->time & SUBPHASE_MASK) * SUBPHASE_MOD;
-#else
-   const float *phase_table = resamp->phase_table + phase * taps;
-#endif
+      (time & resamp->subphase_mask) * resamp->subphase_mod;
 
    for (i = 0; i < taps; i++)
    {
-#if SINC_COEFF_LERP
-      float sinc_val = phase_table[i] + delta_table[i] * delta;
-#else
       float sinc_val = phase_table[i];
-#endif
+      if (lerp)
+         sinc_val   += delta_table[i] * delta;
       sum_l         += buffer_l[i] * sinc_val;
       sum_r         += buffer_r[i] * sinc_val;
    }
@@ -217,65 +229,12 @@ static INLINE void process_sinc_C(rarch_sinc_resampler_t *resamp,
    out_buffer[0] = sum_l;
    out_buffer[1] = sum_r;
 }
-#endif
 
-#if defined(__AVX__) && ENABLE_AVX
-#define process_sinc_func process_sinc
-static void process_sinc(rarch_sinc_resampler_t *resamp, float *out_buffer)
+#if defined(__SSE__)
+static INLINE void process_sinc_SSE(const rarch_sinc_resampler_t *resamp,
+      uint32_t time, float *out_buffer, bool lerp)
 {
-   unsigned i;
-   __m256 sum_l             = _mm256_setzero_ps();
-   __m256 sum_r             = _mm256_setzero_ps();
-
-   const float *buffer_l    = resamp->buffer_l + resamp->ptr;
-   const float *buffer_r    = resamp->buffer_r + resamp->ptr;
-
-   unsigned taps            = resamp->taps;
-   unsigned phase           = resamp->time >> SUBPHASE_BITS;
-#if SINC_COEFF_LERP
-   const float *phase_table = resamp->phase_table + phase * taps * 2;
-   const float *delta_table = phase_table + taps;
-   __m256 delta             = _mm256_set1_ps((float)
-         (resamp->time & SUBPHASE_MASK) * SUBPHASE_MOD);
-#else
-   const float *phase_table = resamp->phase_table + phase * taps;
-#endif
-
-   for (i = 0; i < taps; i += 8)
-   {
-      __m256 buf_l  = _mm256_loadu_ps(buffer_l + i);
-      __m256 buf_r  = _mm256_loadu_ps(buffer_r + i);
-
-#if SINC_COEFF_LERP
-      __m256 deltas = _mm256_load_ps(delta_table + i);
-      __m256 sinc   = _mm256_add_ps(_mm256_load_ps(phase_table + i),
-            _mm256_mul_ps(deltas, delta));
-#else
-      __m256 sinc   = _mm256_load_ps(phase_table + i);
-#endif
-      sum_l         = _mm256_add_ps(sum_l, _mm256_mul_ps(buf_l, sinc));
-      sum_r         = _mm256_add_ps(sum_r, _mm256_mul_ps(buf_r, sinc));
-   }
-
-   /* hadd on AVX is weird, and acts on low-lanes 
-    * and high-lanes separately. */
-   __m256 res_l = _mm256_hadd_ps(sum_l, sum_l);
-   __m256 res_r = _mm256_hadd_ps(sum_r, sum_r);
-   res_l        = _mm256_hadd_ps(res_l, res_l);
-   res_r        = _mm256_hadd_ps(res_r, res_r);
-   res_l        = _mm256_add_ps(_mm256_permute2f128_ps(res_l, res_l, 1), res_l);
-   res_r        = _mm256_add_ps(_mm256_permute2f128_ps(res_r, res_r, 1), res_r);
-
-   /* This is optimized to mov %xmmN, [mem].
-    * There doesn't seem to be any _mm256_store_ss intrinsic. */
-   _mm_store_ss(out_buffer + 0, _mm256_extractf128_ps(res_l, 0));
-   _mm_store_ss(out_buffer + 1, _mm256_extractf128_ps(res_r, 0));
-}
-#elif defined(__SSE__)
-#define process_sinc_func process_sinc
-static void process_sinc(rarch_sinc_resampler_t *resamp, float *out_buffer)
-{
-   unsigned i;
+   size_t i;
    __m128 sum;
    __m128 sum_l             = _mm_setzero_ps();
    __m128 sum_r             = _mm_setzero_ps();
@@ -283,29 +242,24 @@ static void process_sinc(rarch_sinc_resampler_t *resamp, float *out_buffer)
    const float *buffer_l    = resamp->buffer_l + resamp->ptr;
    const float *buffer_r    = resamp->buffer_r + resamp->ptr;
 
-   unsigned taps            = resamp->taps;
-   unsigned phase           = resamp->time >> SUBPHASE_BITS;
-#if SINC_COEFF_LERP
-   const float *phase_table = resamp->phase_table + phase * taps * 2;
+   size_t taps              = resamp->taps;
+   size_t phase             = time >> resamp->subphase_bits;
+   const float *phase_table = resamp->phase_table + 
+      phase * taps * (lerp ? 2 : 1);
    const float *delta_table = phase_table + taps;
    __m128 delta             = _mm_set1_ps((float)
-         (resamp->time & SUBPHASE_MASK) * SUBPHASE_MOD);
-#else
-   const float *phase_table = resamp->phase_table + phase * taps;
-#endif
+         (time & resamp->subphase_mask) * resamp->subphase_mod);
 
    for (i = 0; i < taps; i += 4)
    {
       __m128 buf_l = _mm_loadu_ps(buffer_l + i);
       __m128 buf_r = _mm_loadu_ps(buffer_r + i);
-
-#if SINC_COEFF_LERP
-      __m128 deltas = _mm_load_ps(delta_table + i);
-      __m128 _sinc  = _mm_add_ps(_mm_load_ps(phase_table + i),
-            _mm_mul_ps(deltas, delta));
-#else
       __m128 _sinc = _mm_load_ps(phase_table + i);
-#endif
+
+      if (lerp)
+         _sinc     = _mm_add_ps(_sinc,
+               _mm_mul_ps(_mm_load_ps(delta_table + i), delta));
+
       sum_l        = _mm_add_ps(sum_l, _mm_mul_ps(buf_l, _sinc));
       sum_r        = _mm_add_ps(sum_r, _mm_mul_ps(buf_r, _sinc));
    }
@@ -335,99 +289,281 @@ static void process_sinc(rarch_sinc_resampler_t *resamp, float *out_buffer)
    /* movehl { X, R, X, L } == { X, R, X, R } */
    _mm_store_ss(out_buffer + 1, _mm_movehl_ps(sum, sum));
 }
-#elif defined(__ARM_NEON__) && !defined(VITA)
+#endif
+
+#ifdef HAVE_SINC_AVX
+static INLINE SINC_AVX_TARGET void sinc_store_AVX(
+      __m256 sum_l, __m256 sum_r, float *out_buffer)
+{
+   __m128 res;
+   /* hadd on AVX is weird, and acts on low-lanes 
+    * and high-lanes separately.
+    * sum   = { r67, r45, l67, l45 | r23, r01, l23, l01 }
+    * sum   = {   R,   L,   R,   L |   R,   L,   R,   L } */
+   __m256 sum = _mm256_hadd_ps(sum_l, sum_r);
+   sum   = _mm256_hadd_ps(sum, sum);
+   res   = _mm_add_ps(_mm256_castps256_ps128(sum),
+         _mm256_extractf128_ps(sum, 1));
+
+   /* Stores { R, L }. */
+   _mm_storel_pi((__m64*)out_buffer, res);
+}
+
+static INLINE SINC_AVX_TARGET void process_sinc_AVX(
+      const rarch_sinc_resampler_t *resamp, uint32_t time,
+      float *out_buffer, bool lerp)
+{
+   size_t i;
+   __m256 sum_l             = _mm256_setzero_ps();
+   __m256 sum_r             = _mm256_setzero_ps();
+
+   const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+   const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+
+   size_t taps              = resamp->taps;
+   size_t phase             = time >> resamp->subphase_bits;
+   const float *phase_table = resamp->phase_table + 
+      phase * taps * (lerp ? 2 : 1);
+   const float *delta_table = phase_table + taps;
+   __m256 delta             = _mm256_set1_ps((float)
+         (time & resamp->subphase_mask) * resamp->subphase_mod);
+
+   for (i = 0; i < taps; i += 8)
+   {
+      __m256 buf_l  = _mm256_loadu_ps(buffer_l + i);
+      __m256 buf_r  = _mm256_loadu_ps(buffer_r + i);
+      __m256 sinc   = _mm256_load_ps(phase_table + i);
+
+      if (lerp)
+         sinc       = _mm256_add_ps(sinc,
+               _mm256_mul_ps(_mm256_load_ps(delta_table + i), delta));
+      sum_l         = _mm256_add_ps(sum_l, _mm256_mul_ps(buf_l, sinc));
+      sum_r         = _mm256_add_ps(sum_r, _mm256_mul_ps(buf_r, sinc));
+   }
 
-#if SINC_COEFF_LERP
-#error "NEON asm does not support SINC lerp."
+   sinc_store_AVX(sum_l, sum_r, out_buffer);
+}
 #endif
 
-/* Need to make this function pointer as Android doesn't 
- * have built-in targets for NEON and plain ARMv7a.
- */
-static void (*process_sinc_func)(rarch_sinc_resampler_t *resamp,
-      float *out_buffer);
+#ifdef HAVE_SINC_FMA
+static INLINE SINC_FMA_TARGET void process_sinc_FMA(
+      const rarch_sinc_resampler_t *resamp, uint32_t time,
+      float *out_buffer, bool lerp)
+{
+   size_t i;
+   __m256 sum_l             = _mm256_setzero_ps();
+   __m256 sum_r             = _mm256_setzero_ps();
+
+   const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+   const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+
+   size_t taps              = resamp->taps;
+   size_t phase             = time >> resamp->subphase_bits;
+   const float *phase_table = resamp->phase_table + 
+      phase * taps * (lerp ? 2 : 1);
+   const float *delta_table = phase_table + taps;
+   __m256 delta             = _mm256_set1_ps((float)
+         (time & resamp->subphase_mask) * resamp->subphase_mod);
+
+   for (i = 0; i < taps; i += 8)
+   {
+      __m256 buf_l  = _mm256_loadu_ps(buffer_l + i);
+      __m256 buf_r  = _mm256_loadu_ps(buffer_r + i);
+      __m256 sinc   = _mm256_load_ps(phase_table + i);
+
+      if (lerp)
+         sinc       = _mm256_fmadd_ps(_mm256_load_ps(delta_table + i),
+               delta, sinc);
+      sum_l         = _mm256_fmadd_ps(buf_l, sinc, sum_l);
+      sum_r         = _mm256_fmadd_ps(buf_r, sinc, sum_r);
+   }
+
+   sinc_store_AVX(sum_l, sum_r, out_buffer);
+}
+#endif
 
+#if defined(__ARM_NEON__) && !defined(VITA)
 /* Assumes that taps >= 8, and that taps is a multiple of 8. */
 void process_sinc_neon_asm(float *out, const float *left, 
       const float *right, const float *coeff, unsigned taps);
 
-static void process_sinc_neon(rarch_sinc_resampler_t *resamp,
-      float *out_buffer)
+/* Does not support coefficient interpolation. */
+static INLINE void process_sinc_neon(const rarch_sinc_resampler_t *resamp,
+      uint32_t time, float *out_buffer, bool lerp)
 {
    const float *buffer_l    = resamp->buffer_l + resamp->ptr;
    const float *buffer_r    = resamp->buffer_r + resamp->ptr;
 
-   unsigned phase           = resamp->time >> SUBPHASE_BITS;
+   unsigned phase           = time >> resamp->subphase_bits;
    unsigned taps            = resamp->taps;
    const float *phase_table = resamp->phase_table + phase * taps;
 
+   (void)lerp;
+
    process_sinc_neon_asm(out_buffer, buffer_l, buffer_r, phase_table, taps);
 }
-#else /* Plain ol' C99 */
-#define process_sinc_func process_sinc_C
 #endif
 
-static void resampler_sinc_process(void *re_, struct resampler_data *data)
+/**
+ * resampler_sinc_process_block:
+ * @re                : Resampler handle.
+ * @data              : Input and output buffers.
+ * @kernel            : Filter kernel, inlined into the caller.
+ * @lerp              : Interpolate between filter phases.
+ *
+ * Pushes input frames into the history buffer, and between two
+ * pushes computes the whole run of output frames due in one loop.
+ * Every caller passes a constant @kernel and @lerp, so each gets its
+ * own copy of the loop with the kernel inlined instead of an
+ * indirect call per output frame.
+ **/
+static INLINE void resampler_sinc_process_block(rarch_sinc_resampler_t *re,
+      struct resampler_data *data, sinc_kernel_t kernel, bool lerp)
 {
-   rarch_sinc_resampler_t *re = (rarch_sinc_resampler_t*)re_;
-
-   uint32_t ratio        = PHASES / data->ratio;
+   uint32_t phases       = 1 << (re->phase_bits + re->subphase_bits);
+   uint32_t ratio        = phases / data->ratio;
    const float *input    = data->data_in;
    float *output         = data->data_out;
    size_t frames         = data->input_frames;
    size_t out_frames     = 0;
+   unsigned taps         = re->taps;
+   uint32_t time         = re->time;
 
    while (frames)
    {
-      while (frames && re->time >= PHASES)
+      while (frames && time >= phases)
       {
          /* Push in reverse to make filter more obvious. */
          if (!re->ptr)
-            re->ptr = re->taps;
+            re->ptr = taps;
          re->ptr--;
 
-         re->buffer_l[re->ptr + re->taps] = re->buffer_l[re->ptr] = *input++;
-         re->buffer_r[re->ptr + re->taps] = re->buffer_r[re->ptr] = *input++;
+         re->buffer_l[re->ptr + taps] = re->buffer_l[re->ptr] = *input++;
+         re->buffer_r[re->ptr + taps] = re->buffer_r[re->ptr] = *input++;
 
-         re->time -= PHASES;
+         time -= phases;
          frames--;
       }
 
-      while (re->time < PHASES)
+      while (time < phases)
       {
-         process_sinc_func(re, output);
+         kernel(re, time, output, lerp);
          output += 2;
          out_frames++;
-         re->time += ratio;
+         time += ratio;
       }
    }
 
+   re->time            = time;
    data->output_frames = out_frames;
 }
 
+static void resampler_sinc_process_C(rarch_sinc_resampler_t *re,
+      struct resampler_data *data)
+{
+   resampler_sinc_process_block(re, data, process_sinc_C, false);
+}
+
+static void resampler_sinc_process_C_lerp(rarch_sinc_resampler_t *re,
+      struct resampler_data *data)
+{
+   resampler_sinc_process_block(re, data, process_sinc_C, true);
+}
+
+#if defined(__SSE__)
+static void resampler_sinc_process_SSE(rarch_sinc_resampler_t *re,
+      struct resampler_data *data)
+{
+   resampler_sinc_process_block(re, data, process_sinc_SSE, false);
+}
+
+static void resampler_sinc_process_SSE_lerp(rarch_sinc_resampler_t *re,
+      struct resampler_data *data)
+{
+   resampler_sinc_process_block(re, data, process_sinc_SSE, true);
+}
+#endif
+
+#ifdef HAVE_SINC_AVX
+static SINC_AVX_TARGET void resampler_sinc_process_AVX(
+      rarch_sinc_resampler_t *re, struct resampler_data *data)
+{
+   resampler_sinc_process_block(re, data, process_sinc_AVX, false);
+}
+
+static SINC_AVX_TARGET void resampler_sinc_process_AVX_lerp(
+      rarch_sinc_resampler_t *re, struct resampler_data *data)
+{
+   resampler_sinc_process_block(re, data, process_sinc_AVX, true);
+}
+#endif
+
+#ifdef HAVE_SINC_FMA
+static SINC_FMA_TARGET void resampler_sinc_process_FMA(
+      rarch_sinc_resampler_t *re, struct resampler_data *data)
+{
+   resampler_sinc_process_block(re, data, process_sinc_FMA, false);
+}
+
+static SINC_FMA_TARGET void resampler_sinc_process_FMA_lerp(
+      rarch_sinc_resampler_t *re, struct resampler_data *data)
+{
+   resampler_sinc_process_block(re, data, process_sinc_FMA, true);
+}
+#endif
+
+#if defined(__ARM_NEON__) && !defined(VITA)
+static void resampler_sinc_process_neon(rarch_sinc_resampler_t *re,
+      struct resampler_data *data)
+{
+   resampler_sinc_process_block(re, data, process_sinc_neon, false);
+}
+#endif
+
+static void resampler_sinc_process(void *re_, struct resampler_data *data)
+{
+   rarch_sinc_resampler_t *re = (rarch_sinc_resampler_t*)re_;
+   re->process(re, data);
+}
+
 static void resampler_sinc_free(void *re)
 {
    rarch_sinc_resampler_t *resampler = (rarch_sinc_resampler_t*)re;
-   if (resampler)
+   if (resampler && resampler->main_buffer)
       memalign_free(resampler->main_buffer);
    free(resampler);
 }
 
 static void *resampler_sinc_new(const struct resampler_config *config,
-      double bandwidth_mod, resampler_simd_mask_t mask)
+      double bandwidth_mod, enum resampler_quality quality,
+      resampler_simd_mask_t mask)
 {
    size_t phase_elems, elems;
    double cutoff;
-   rarch_sinc_resampler_t *re = (rarch_sinc_resampler_t*)
+   unsigned simd_taps               = 4;
+   const struct sinc_params *params = NULL;
+   rarch_sinc_resampler_t *re       = (rarch_sinc_resampler_t*)
       calloc(1, sizeof(*re));
 
    if (!re)
       return NULL;
 
    (void)config;
+   (void)mask;
+
+   if (quality < RESAMPLER_QUALITY_LOWEST ||
+         quality > RESAMPLER_QUALITY_HIGHEST)
+      quality = SINC_DEFAULT_QUALITY;
+
+   params            = &sinc_quality_params[
+      quality - RESAMPLER_QUALITY_LOWEST];
 
-   re->taps = TAPS;
-   cutoff   = CUTOFF;
+   re->phase_bits    = params->phase_bits;
+   re->subphase_bits = params->subphase_bits;
+   re->subphase_mask = (1 << params->subphase_bits) - 1;
+   re->subphase_mod  = 1.0f / (1 << params->subphase_bits);
+   re->taps          = params->sidelobes * 2;
+   cutoff            = params->cutoff;
 
    /* Downsampling, must lower cutoff, and extend number of 
     * taps accordingly to keep same stopband attenuation. */
@@ -437,34 +573,54 @@ static void *resampler_sinc_new(const struct resampler_config *config,
       re->taps = (unsigned)ceil(re->taps / bandwidth_mod);
    }
 
-   /* Be SIMD-friendly. */
-#if (defined(__AVX__) && ENABLE_AVX) || (defined(__ARM_NEON__)&& !defined(VITA))
-   re->taps = (re->taps + 7) & ~7;
-#else
-   re->taps = (re->taps + 3) & ~3;
-#endif
+   re->process       = params->coeff_lerp ?
+      resampler_sinc_process_C_lerp : resampler_sinc_process_C;
 
-   phase_elems = (1 << PHASE_BITS) * re->taps;
-#if SINC_COEFF_LERP
-   phase_elems *= 2;
+#if defined(__SSE__)
+   re->process       = params->coeff_lerp ?
+      resampler_sinc_process_SSE_lerp : resampler_sinc_process_SSE;
 #endif
+#ifdef HAVE_SINC_AVX
+   if ((mask & RESAMPLER_SIMD_AVX) && re->taps >= SINC_AVX_MIN_TAPS)
+   {
+      re->process    = params->coeff_lerp ?
+         resampler_sinc_process_AVX_lerp : resampler_sinc_process_AVX;
+#ifdef HAVE_SINC_FMA
+      if (mask & RESAMPLER_SIMD_FMA)
+         re->process = params->coeff_lerp ?
+            resampler_sinc_process_FMA_lerp : resampler_sinc_process_FMA;
+#endif
+      simd_taps      = 8;
+   }
+#endif
+#if defined(__ARM_NEON__) && !defined(VITA)
+   if ((mask & RESAMPLER_SIMD_NEON) && !params->coeff_lerp)
+   {
+      re->process    = resampler_sinc_process_neon;
+      simd_taps      = 8;
+   }
+#endif
+
+   /* Be SIMD-friendly. */
+   re->taps = (re->taps + simd_taps - 1) & ~(simd_taps - 1);
+
+   phase_elems = (1 << params->phase_bits) * re->taps;
+   if (params->coeff_lerp)
+      phase_elems *= 2;
    elems = phase_elems + 4 * re->taps;
 
    re->main_buffer = (float*)memalign_alloc(128, sizeof(float) * elems);
    if (!re->main_buffer)
       goto error;
 
+   memset(re->main_buffer, 0, sizeof(float) * elems);
+
    re->phase_table = re->main_buffer;
    re->buffer_l = re->main_buffer + phase_elems;
    re->buffer_r = re->buffer_l + 2 * re->taps;
 
-   init_sinc_table(re, cutoff, re->phase_table,
-         1 << PHASE_BITS, re->taps, SINC_COEFF_LERP);
-
-#if defined(__ARM_NEON__) && !defined(VITA)
-   process_sinc_func = mask & RESAMPLER_SIMD_NEON 
-      ? process_sinc_neon : process_sinc_C;
-#endif
+   init_sinc_table(params, cutoff, re->phase_table,
+         1 << params->phase_bits, re->taps, params->coeff_lerp);
 
    return re;
 
@@ -0,0 +1,266 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Replays raw S16NE/stereo from stdin through the stages of
+ * audio_driver_flush(): s16 to float conversion, an optional DSP
+ * filter chain, the resampler and float to s16 conversion.
+ * The recording is cut into one batch per video frame, like a core
+ * would push it, and each batch is processed in blocks of
+ * AUDIO_BLOCK_FRAMES frames like audio_driver_process_block() does.
+ * Reports nanoseconds per input sample for every stage. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "../audio_resampler_driver.h"
+#include "../audio_dsp_filter.h"
+#include "../audio_utils.h"
+
+#ifndef RESAMPLER_IDENT
+#define RESAMPLER_IDENT "sinc"
+#endif
+
+/* Keep in sync with audio_driver.c. */
+#ifndef AUDIO_BLOCK_FRAMES
+#define AUDIO_BLOCK_FRAMES 256
+#endif
+
+/* Replays the recording until at least this much time was spent. */
+#define BENCH_MIN_NSEC 1000000000LL
+
+#define BENCH_FPS 60.0
+
+enum
+{
+   STAGE_CONVERT_S16 = 0,
+   STAGE_DSP,
+   STAGE_RESAMPLER,
+   STAGE_CONVERT_FLOAT,
+   STAGE_LAST
+};
+
+static const char *stage_names[STAGE_LAST] = {
+   "audio_convert_s16",
+   "audio_dsp",
+   "resampler_proc",
+   "audio_convert_float",
+};
+
+static int64_t bench_time_nsec(void)
+{
+   struct timespec tv;
+   clock_gettime(CLOCK_MONOTONIC, &tv);
+   return (int64_t)tv.tv_sec * 1000000000 + tv.tv_nsec;
+}
+
+static int16_t *read_recording(size_t *frames)
+{
+   size_t size     = 0;
+   size_t capacity = 1 << 20;
+   int16_t *data   = (int16_t*)malloc(capacity * 2 * sizeof(int16_t));
+
+   while (data)
+   {
+      int16_t *new_data;
+      size_t read = fread(data + size * 2, 2 * sizeof(int16_t),
+            capacity - size, stdin);
+
+      size += read;
+      if (size < capacity)
+         break;
+
+      capacity *= 2;
+      new_data  = (int16_t*)realloc(data, capacity * 2 * sizeof(int16_t));
+      if (!new_data)
+         free(data);
+      data = new_data;
+   }
+
+   *frames = size;
+   return data;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i;
+   double in_rate, out_rate, ratio, batch_frames;
+   size_t rec_frames;
+   int64_t stage_time[STAGE_LAST] = {0};
+   int64_t total_time             = 0;
+   uint64_t samples               = 0;
+   unsigned passes                = 0;
+   const rarch_resampler_t *resampler = NULL;
+   void *re                       = NULL;
+   rarch_dsp_filter_t *dsp        = NULL;
+   int16_t *recording             = NULL;
+   float *in_float                = NULL;
+   float *out_float               = NULL;
+   int16_t *out_s16               = NULL;
+   int ret                        = 1;
+
+   if (argc < 3 || argc > 4)
+   {
+      fprintf(stderr, "Usage: %s <in-rate> <out-rate> [dsp config] (max ratio: 8.0)\n", argv[0]);
+      return 1;
+   }
+
+   in_rate  = strtod(argv[1], NULL);
+   out_rate = strtod(argv[2], NULL);
+   ratio    = out_rate / in_rate;
+
+   if (in_rate <= 0.0 || ratio >= 7.99)
+   {
+      fprintf(stderr, "Invalid rates.\n");
+      return 1;
+   }
+
+   audio_convert_init_simd();
+
+   if (!rarch_resampler_realloc(&re, &resampler, RESAMPLER_IDENT,
+            RESAMPLER_QUALITY_DONTCARE, ratio))
+   {
+      fprintf(stderr, "Failed to allocate resampler ...\n");
+      return 1;
+   }
+
+   if (argc == 4)
+   {
+      dsp = rarch_dsp_filter_new(argv[3], in_rate);
+      if (!dsp)
+      {
+         fprintf(stderr, "Failed to load DSP config %s.\n", argv[3]);
+         goto end;
+      }
+   }
+
+   recording    = read_recording(&rec_frames);
+   batch_frames = in_rate / BENCH_FPS;
+   if (!recording || rec_frames < batch_frames)
+   {
+      fprintf(stderr, "Recording on stdin is shorter than one batch.\n");
+      goto end;
+   }
+
+   /* Room for a DSP chain that changes the amount of frames. */
+   in_float  = (float*)malloc(AUDIO_BLOCK_FRAMES * 2 * sizeof(float));
+   out_float = (float*)malloc(AUDIO_BLOCK_FRAMES * 2 * 16 * sizeof(float));
+   out_s16   = (int16_t*)malloc(AUDIO_BLOCK_FRAMES * 2 * 16 * sizeof(int16_t));
+   if (!in_float || !out_float || !out_s16)
+      goto end;
+
+   do
+   {
+      double batch_end = 0.0;
+      size_t batch_start;
+
+      for (batch_start = 0; batch_start < rec_frames; )
+      {
+         size_t frames, in_frames;
+
+         batch_end += batch_frames;
+         in_frames  = (size_t)batch_end - batch_start;
+         if (in_frames > rec_frames - batch_start)
+            in_frames = rec_frames - batch_start;
+
+         for (frames = 0; frames < in_frames; frames += AUDIO_BLOCK_FRAMES)
+         {
+            int64_t start, end;
+            struct resampler_data src_data = {0};
+            struct rarch_dsp_data dsp_data = {0};
+            size_t block                   = in_frames - frames;
+
+            if (block > AUDIO_BLOCK_FRAMES)
+               block = AUDIO_BLOCK_FRAMES;
+
+            start = bench_time_nsec();
+            audio_convert_s16_to_float(in_float,
+                  recording + ((batch_start + frames) << 1),
+                  block << 1, 1.0f);
+            end = bench_time_nsec();
+            stage_time[STAGE_CONVERT_S16] += end - start;
+
+            src_data.data_in      = in_float;
+            src_data.input_frames = block;
+
+            if (dsp)
+            {
+               dsp_data.input        = in_float;
+               dsp_data.input_frames = block;
+
+               start = end;
+               rarch_dsp_filter_process(dsp, &dsp_data);
+               end   = bench_time_nsec();
+               stage_time[STAGE_DSP] += end - start;
+
+               if (dsp_data.output)
+               {
+                  src_data.data_in      = dsp_data.output;
+                  src_data.input_frames = dsp_data.output_frames;
+               }
+            }
+
+            src_data.data_out = out_float;
+            src_data.ratio    = ratio;
+
+            start = end;
+            rarch_resampler_process(resampler, re, &src_data);
+            end   = bench_time_nsec();
+            stage_time[STAGE_RESAMPLER] += end - start;
+
+            start = end;
+            audio_convert_float_to_s16(out_s16, out_float,
+                  src_data.output_frames << 1);
+            end   = bench_time_nsec();
+            stage_time[STAGE_CONVERT_FLOAT] += end - start;
+         }
+
+         batch_start += in_frames;
+      }
+
+      samples += rec_frames << 1;
+      passes++;
+
+      total_time = 0;
+      for (i = 0; i < STAGE_LAST; i++)
+         total_time += stage_time[i];
+   } while (total_time < BENCH_MIN_NSEC);
+
+   printf("%u passes over %u frames, %.0f frames per batch, %s resampler.\n",
+         passes, (unsigned)rec_frames, batch_frames, RESAMPLER_IDENT);
+   printf("%-20s  %10s\n", "stage", "ns/sample");
+   for (i = 0; i < STAGE_LAST; i++)
+   {
+      if (i == STAGE_DSP && !dsp)
+         continue;
+      printf("%-20s  %10.3f\n", stage_names[i],
+            (double)stage_time[i] / samples);
+   }
+   printf("%-20s  %10.3f\n", "total", (double)total_time / samples);
+
+   ret = 0;
+
+end:
+   free(recording);
+   free(in_float);
+   free(out_float);
+   free(out_s16);
+   if (dsp)
+      rarch_dsp_filter_free(dsp);
+   rarch_resampler_freep(&resampler, &re);
+   return ret;
+}
@@ -0,0 +1,33 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Frontend symbols the audio code and libretro-common refer
+ * to under RARCH_INTERNAL, for the standalone test programs. */
+
+#include <stdlib.h>
+
+#include "../../runloop.h"
+
+static global_t g_global;
+
+global_t *global_get_ptr(void)
+{
+   return &g_global;
+}
+
+bool rarch_main_verbosity(void)
+{
+   return getenv("AUDIO_TEST_VERBOSE") != NULL;
+}
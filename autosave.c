@@ -16,14 +16,25 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#define HAVE_AUTOSAVE_PWRITE
+#endif
+
 #include <boolean.h>
 
 #include <rthreads/rthreads.h>
 
 #include "general.h"
 
+/* SRAM is compared and written back in blocks of this size. */
+#define AUTOSAVE_BLOCK_SIZE 4096
+
 struct autosave
 {
    volatile bool quit;
@@ -33,11 +44,16 @@ struct autosave
    scond_t *cond;
    sthread_t *thread;
 
-   void *buffer;
+   /* What was last written to disk. */
+   uint8_t *buffer;
+   /* Copy of retro_buffer taken under the lock. */
+   uint8_t *snapshot;
    const void *retro_buffer;
    const char *path;
    size_t bufsize;
    unsigned interval;
+   /* Whether the whole file needs rewriting. */
+   bool full_write;
 };
 
 /**
@@ -62,6 +78,166 @@ static void autosave_unlock(autosave_t *handle)
    slock_unlock(handle->lock);
 }
 
+/**
+ * autosave_block_dirty:
+ * @save            : pointer to autosave object
+ * @offset          : start of the block
+ *
+ * Returns: size of the block at @offset if it differs from
+ * what was last written, otherwise 0.
+ **/
+static size_t autosave_block_dirty(const autosave_t *save, size_t offset)
+{
+   size_t len = save->bufsize - offset;
+
+   if (len > AUTOSAVE_BLOCK_SIZE)
+      len = AUTOSAVE_BLOCK_SIZE;
+
+   if (memcmp(save->buffer + offset, save->snapshot + offset, len) == 0)
+      return 0;
+   return len;
+}
+
+/**
+ * autosave_find_dirty:
+ * @save            : pointer to autosave object
+ * @offset          : offset to start looking from, updated
+ *                    to the start of the run.
+ *
+ * Finds the next run of consecutive dirty blocks.
+ *
+ * Returns: size of the run, or 0 if there are no dirty blocks
+ * left.
+ **/
+static size_t autosave_find_dirty(const autosave_t *save, size_t *offset)
+{
+   size_t len;
+   size_t run = 0;
+
+   while (*offset < save->bufsize && !autosave_block_dirty(save, *offset))
+      *offset += AUTOSAVE_BLOCK_SIZE;
+
+   while (*offset + run < save->bufsize
+         && (len = autosave_block_dirty(save, *offset + run)))
+      run += len;
+
+   return run;
+}
+
+#ifdef HAVE_AUTOSAVE_PWRITE
+static bool autosave_pwrite(int fd, const uint8_t *data,
+      size_t size, size_t offset)
+{
+   while (size)
+   {
+      ssize_t ret = pwrite(fd, data, size, offset);
+
+      if (ret <= 0)
+         return false;
+
+      data   += ret;
+      size   -= ret;
+      offset += ret;
+   }
+
+   return true;
+}
+
+/**
+ * autosave_write:
+ * @save            : pointer to autosave object
+ * @offset          : start of the first dirty run
+ *
+ * Writes every dirty run of the snapshot in place, or the whole
+ * snapshot if the file doesn't match the buffer size.
+ *
+ * Returns: true if successful, otherwise false.
+ **/
+static bool autosave_write(autosave_t *save, size_t offset)
+{
+   struct stat st;
+   bool failed = false;
+   int fd      = open(save->path, O_WRONLY | O_CREAT, 0644);
+
+   if (fd < 0)
+      return false;
+
+   if (!save->full_write && (fstat(fd, &st) != 0
+            || (size_t)st.st_size != save->bufsize))
+      save->full_write = true;
+
+   if (save->full_write)
+   {
+      failed |= !autosave_pwrite(fd, save->snapshot, save->bufsize, 0);
+      failed |= ftruncate(fd, save->bufsize) != 0;
+   }
+   else
+   {
+      size_t run;
+
+      while (!failed && (run = autosave_find_dirty(save, &offset)))
+      {
+         failed |= !autosave_pwrite(fd, save->snapshot + offset,
+               run, offset);
+         offset += run;
+      }
+   }
+
+   failed |= close(fd) != 0;
+
+   return !failed;
+}
+#else
+static bool autosave_write(autosave_t *save, size_t offset)
+{
+   bool failed = false;
+   FILE *file  = NULL;
+
+   if (!save->full_write)
+      file = fopen(save->path, "r+b");
+
+   if (file)
+   {
+      long size;
+
+      failed |= fseek(file, 0, SEEK_END) != 0;
+      size    = ftell(file);
+      if (failed || size < 0 || (size_t)size != save->bufsize)
+      {
+         fclose(file);
+         file   = NULL;
+         failed = false;
+      }
+   }
+
+   if (!file)
+   {
+      save->full_write = true;
+      file             = fopen(save->path, "wb");
+      if (!file)
+         return false;
+      failed          |= fwrite(save->snapshot, 1, save->bufsize, file)
+         != save->bufsize;
+   }
+   else
+   {
+      size_t run;
+
+      while (!failed && (run = autosave_find_dirty(save, &offset)))
+      {
+         failed |= fseek(file, (long)offset, SEEK_SET) != 0;
+         failed |= fwrite(save->snapshot + offset, 1, run, file) != run;
+         offset += run;
+      }
+   }
+
+   failed |= fflush(file) != 0;
+   failed |= fclose(file) != 0;
+
+   return !failed;
+}
+#endif
+
 /**
  * autosave_thread:
  * @data            : pointer to autosave object
@@ -75,41 +251,38 @@ static void autosave_thread(void *data)
 
    while (!save->quit)
    {
-      bool differ;
+      size_t offset = 0;
 
+      /* Only the copy happens under the lock, so the main loop
+       * never waits on the comparison or the disk. */
       autosave_lock(save);
-      differ = memcmp(save->buffer, save->retro_buffer,
-            save->bufsize) != 0;
-      if (differ)
-         memcpy(save->buffer, save->retro_buffer, save->bufsize);
+      memcpy(save->snapshot, save->retro_buffer, save->bufsize);
       autosave_unlock(save);
 
-      if (differ)
+      if (autosave_find_dirty(save, &offset))
       {
-         /* Should probably deal with this more elegantly. */
-         FILE *file = fopen(save->path, "wb");
+         uint8_t *tmp = NULL;
+
+         /* Avoid spamming down stderr ... */
+         if (first_log)
+         {
+            RARCH_LOG("Autosaving SRAM to \"%s\", will continue to check every %u seconds ...\n",
+                  save->path, save->interval);
+            first_log = false;
+         }
+         else
+            RARCH_LOG("SRAM changed ... autosaving ...\n");
 
-         if (file)
+         if (autosave_write(save, offset))
          {
-            bool failed = false;
-
-            /* Avoid spamming down stderr ... */
-            if (first_log)
-            {
-               RARCH_LOG("Autosaving SRAM to \"%s\", will continue to check every %u seconds ...\n",
-                     save->path, save->interval);
-               first_log = false;
-            }
-            else
-               RARCH_LOG("SRAM changed ... autosaving ...\n");
-
-            failed |= fwrite(save->buffer, 1, save->bufsize, file)
-               != save->bufsize;
-            failed |= fflush(file) != 0;
-            failed |= fclose(file) != 0;
-            if (failed)
-               RARCH_WARN("Failed to autosave SRAM. Disk might be full.\n");
+            /* The file now matches the snapshot. */
+            tmp              = save->buffer;
+            save->buffer     = save->snapshot;
+            save->snapshot   = tmp;
+            save->full_write = false;
          }
+         else
+            RARCH_WARN("Failed to autosave SRAM. Disk might be full.\n");
       }
 
       slock_lock(save->cond_lock);
@@ -144,11 +317,17 @@ autosave_t *autosave_new(const char *path, const void *data, size_t size,
    handle->bufsize      = size;
    handle->interval     = interval;
    handle->path         = path;
-   handle->buffer       = malloc(size);
+   handle->buffer       = (uint8_t*)malloc(size);
+   handle->snapshot     = (uint8_t*)malloc(size);
    handle->retro_buffer = data;
+   /* The file on disk may be shorter or stale, so the first
+    * autosave rewrites all of it. */
+   handle->full_write   = true;
 
-   if (!handle->buffer)
+   if (!handle->buffer || !handle->snapshot)
    {
+      free(handle->buffer);
+      free(handle->snapshot);
       free(handle);
       return NULL;
    }
@@ -185,6 +364,7 @@ void autosave_free(autosave_t *handle)
    scond_free(handle->cond);
 
    free(handle->buffer);
+   free(handle->snapshot);
    free(handle);
 }
 
@@ -21,6 +21,7 @@
 #include "performance.h"
 #include "dynamic.h"
 #include "content.h"
+#include "save_writer.h"
 #include "screenshot.h"
 #include "msg_hash.h"
 #include "retroarch.h"
@@ -537,6 +538,10 @@ static void event_deinit_core(bool reinit)
    pretro_unload_game();
    pretro_deinit();
 
+   /* Let queued savestates, SRAM and screenshots reach the disk. */
+   save_writer_deinit();
+   screenshot_writer_deinit();
+
    if (reinit)
       event_command(EVENT_CMD_DRIVERS_DEINIT);
 
@@ -778,9 +783,9 @@ static bool event_save_auto_state(void)
    fill_pathname_noext(savestate_name_auto, global->name.savestate,
          ".auto", sizeof(savestate_name_auto));
 
-   ret = save_state(savestate_name_auto);
+   ret = save_state(savestate_name_auto, NULL);
    RARCH_LOG("Auto save state to \"%s\" %s.\n", savestate_name_auto, ret ?
-         "succeeded" : "failed");
+         "queued" : "failed");
 
    return true;
 }
@@ -905,26 +910,28 @@ static bool event_save_core_config(void)
  * @s               : Message.
  * @len             : Size of @s.
  *
- * Saves a state with path being @path.
+ * Saves a state with path being @path. The slot message
+ * is shown by the save writer once the state is on disk,
+ * so @s is only filled in on failure.
  **/
 static void event_save_state(const char *path,
       char *s, size_t len)
 {
-   settings_t *settings = config_get_ptr();
-
-   if (!save_state(path))
-   {
-      snprintf(s, len, "%s \"%s\".",
-            msg_hash_to_str(MSG_FAILED_TO_SAVE_STATE_TO),
-            path);
-      return;
-   }
+   char msg[PATH_MAX_LENGTH] = {0};
+   settings_t *settings      = config_get_ptr();
 
    if (settings->state_slot < 0)
-      snprintf(s, len, "%s #-1 (auto).", msg_hash_to_str(MSG_SAVED_STATE_TO_SLOT));
+      snprintf(msg, sizeof(msg), "%s #-1 (auto).",
+            msg_hash_to_str(MSG_SAVED_STATE_TO_SLOT));
    else
-      snprintf(s, len, "%s #%d.", msg_hash_to_str(MSG_SAVED_STATE_TO_SLOT),
+      snprintf(msg, sizeof(msg), "%s #%d.",
+            msg_hash_to_str(MSG_SAVED_STATE_TO_SLOT),
             settings->state_slot);
+
+   if (!save_state(path, msg))
+      snprintf(s, len, "%s \"%s\".",
+            msg_hash_to_str(MSG_FAILED_TO_SAVE_STATE_TO),
+            path);
 }
 
 /**
@@ -985,6 +992,9 @@ static void event_main_state(unsigned cmd)
    else
       strlcpy(msg, msg_hash_to_str(MSG_CORE_DOES_NOT_SUPPORT_SAVESTATES), sizeof(msg));
 
+   if (!*msg)
+      return;
+
    rarch_main_msg_queue_push(msg, 2, 180, true);
    RARCH_LOG("%s\n", msg);
 }
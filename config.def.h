@@ -637,6 +637,11 @@ static const float max_timing_skew = 0.05;
 /* Default audio volume in dB. (0.0 dB == unity gain). */
 static const float audio_volume = 0.0;
 
+/* Quality of the resampler, for resamplers which support it.
+ * 0 uses the build default, 1 (lowest) to 5 (highest) pick
+ * a quality level. */
+static const unsigned audio_resampler_quality = RESAMPLER_QUALITY_DONTCARE;
+
 /* MISC */
 
 /* Enables displaying the current frames per second. */
@@ -653,6 +658,13 @@ static const unsigned rewind_buffer_size = 20 << 20; /* 20MiB */
 /* How many frames to rewind at a time. */
 static const unsigned rewind_granularity = 1;
 
+/* Store a full savestate in the rewind buffer every N frames,
+ * and compress deltas further. 0 disables keyframes. */
+static const unsigned rewind_keyframe_interval = 0;
+
+/* With keyframes, rewinding speeds up the longer it is held. */
+static const bool rewind_acceleration = false;
+
 /* Pause gameplay when gameplay loses focus. */
 static const bool pause_nonactive = false;
 
@@ -681,6 +693,10 @@ static const bool savestate_auto_index = false;
 static const bool savestate_auto_save = false;
 static const bool savestate_auto_load = false;
 
+/* Deflate savestates before writing them to disk.
+ * Compressed states are inflated transparently when loaded. */
+static const bool savestate_compression = false;
+
 /* Slowmotion ratio. */
 static const float slowmotion_ratio = 3.0;
 
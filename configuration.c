@@ -542,12 +542,15 @@ static void config_set_defaults(void)
    settings->audio.rate_control_delta          = rate_control_delta;
    settings->audio.max_timing_skew             = max_timing_skew;
    settings->audio.volume                      = audio_volume;
+   settings->audio.resampler_quality           = audio_resampler_quality;
 
    audio_driver_set_volume_gain(db_to_gain(settings->audio.volume));
 
    settings->rewind_enable                     = rewind_enable;
    settings->rewind_buffer_size                = rewind_buffer_size;
    settings->rewind_granularity                = rewind_granularity;
+   settings->rewind_keyframe_interval          = rewind_keyframe_interval;
+   settings->rewind_acceleration               = rewind_acceleration;
    settings->slowmotion_ratio                  = slowmotion_ratio;
    settings->fastforward_ratio                 = fastforward_ratio;
    settings->pause_nonactive                   = pause_nonactive;
@@ -557,6 +560,7 @@ static void config_set_defaults(void)
    settings->savestate_auto_index              = savestate_auto_index;
    settings->savestate_auto_save               = savestate_auto_save;
    settings->savestate_auto_load               = savestate_auto_load;
+   settings->savestate_compression             = savestate_compression;
    settings->network_cmd_enable                = network_cmd_enable;
    settings->network_cmd_port                  = network_cmd_port;
    settings->stdin_cmd_enable                  = stdin_cmd_enable;
@@ -1455,6 +1459,7 @@ static bool config_load_file(const char *path, bool set_defaults)
    CONFIG_GET_FLOAT_BASE(conf, settings, audio.max_timing_skew, "audio_max_timing_skew");
    CONFIG_GET_FLOAT_BASE(conf, settings, audio.volume, "audio_volume");
    CONFIG_GET_STRING_BASE(conf, settings, audio.resampler, "audio_resampler");
+   CONFIG_GET_INT_BASE(conf, settings, audio.resampler_quality, "audio_resampler_quality");
    audio_driver_set_volume_gain(db_to_gain(settings->audio.volume));
 
    CONFIG_GET_STRING_BASE(conf, settings, camera.device, "camera_device");
@@ -1593,6 +1598,8 @@ static bool config_load_file(const char *path, bool set_defaults)
    }
 
    CONFIG_GET_INT_BASE(conf, settings, rewind_granularity, "rewind_granularity");
+   CONFIG_GET_INT_BASE(conf, settings, rewind_keyframe_interval, "rewind_keyframe_interval");
+   CONFIG_GET_BOOL_BASE(conf, settings, rewind_acceleration, "rewind_acceleration");
    CONFIG_GET_FLOAT_BASE(conf, settings, slowmotion_ratio, "slowmotion_ratio");
    if (settings->slowmotion_ratio < 1.0f)
       settings->slowmotion_ratio = 1.0f;
@@ -1616,6 +1623,7 @@ static bool config_load_file(const char *path, bool set_defaults)
    CONFIG_GET_BOOL_BASE(conf, settings, savestate_auto_index, "savestate_auto_index");
    CONFIG_GET_BOOL_BASE(conf, settings, savestate_auto_save, "savestate_auto_save");
    CONFIG_GET_BOOL_BASE(conf, settings, savestate_auto_load, "savestate_auto_load");
+   CONFIG_GET_BOOL_BASE(conf, settings, savestate_compression, "savestate_compression");
 
    CONFIG_GET_BOOL_BASE(conf, settings, network_cmd_enable, "network_cmd_enable");
    CONFIG_GET_INT_BASE(conf, settings, network_cmd_port, "network_cmd_port");
@@ -2461,6 +2469,10 @@ bool config_save_file(const char *path)
    config_set_bool(conf,  "audio_sync",    settings->audio.sync);
    config_set_int(conf,   "audio_block_frames", settings->audio.block_frames);
    config_set_int(conf,   "rewind_granularity", settings->rewind_granularity);
+   config_set_int(conf,   "rewind_keyframe_interval",
+         settings->rewind_keyframe_interval);
+   config_set_bool(conf,  "rewind_acceleration",
+         settings->rewind_acceleration);
    config_set_path(conf,  "video_shader", settings->video.shader_path);
    config_set_bool(conf,  "video_shader_enable",
          settings->video.shader_enable);
@@ -2577,6 +2589,8 @@ bool config_save_file(const char *path)
    config_set_path(conf, "resampler_directory",
          settings->resampler_directory);
    config_set_string(conf, "audio_resampler", settings->audio.resampler);
+   config_set_int(conf, "audio_resampler_quality",
+         settings->audio.resampler_quality);
    config_set_path(conf, "savefile_directory",
          *global->dir.savefile ? global->dir.savefile : "default");
    config_set_path(conf, "savestate_directory",
@@ -2701,6 +2715,8 @@ bool config_save_file(const char *path)
          settings->savestate_auto_save);
    config_set_bool(conf, "savestate_auto_load",
          settings->savestate_auto_load);
+   config_set_bool(conf, "savestate_compression",
+         settings->savestate_compression);
    config_set_bool(conf, "history_list_enable",
          settings->history_list_enable);
 
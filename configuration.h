@@ -199,6 +199,7 @@ typedef struct settings
       float max_timing_skew;
       float volume; /* dB scale. */
       char resampler[32];
+      unsigned resampler_quality;
    } audio;
 
    struct
@@ -314,6 +315,8 @@ typedef struct settings
    bool rewind_enable;
    size_t rewind_buffer_size;
    unsigned rewind_granularity;
+   unsigned rewind_keyframe_interval;
+   bool rewind_acceleration;
 
    float slowmotion_ratio;
    float fastforward_ratio;
@@ -325,6 +328,7 @@ typedef struct settings
    bool savestate_auto_index;
    bool savestate_auto_save;
    bool savestate_auto_load;
+   bool savestate_compression;
 
    bool network_cmd_enable;
    unsigned network_cmd_port;
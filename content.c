@@ -16,7 +16,6 @@
 #include <stdlib.h>
 #include <boolean.h>
 #include <string.h>
-#include <time.h>
 
 #ifdef _WIN32
 #ifdef _XBOX
@@ -43,94 +42,154 @@
 #include "dynamic.h"
 #include "movie.h"
 #include "patch.h"
+#include "save_writer.h"
 #include "system.h"
 
+#ifdef HAVE_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Content at least this large is mapped instead of copied into
+ * memory, unless it needs patching. */
+#define CONTENT_MMAP_MIN_SIZE (4 * 1024 * 1024)
+
+/* Maps the file copy-on-write, so cores can still write to the
+ * buffer as they could to the one read_file() hands out. read_file()
+ * also NUL terminates; the tail of the last page past EOF reads as
+ * zero, so only files that end on a page boundary need the fallback. */
+static void *content_file_map(const char *path, size_t *size)
+{
+   struct stat st;
+   void *data = NULL;
+   long page  = sysconf(_SC_PAGESIZE);
+   int fd     = open(path, O_RDONLY);
+
+   if (fd < 0)
+      return NULL;
+
+   if (page > 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode)
+         && st.st_size >= CONTENT_MMAP_MIN_SIZE
+         && (uint64_t)st.st_size < (size_t)-1
+         && (st.st_size % page) != 0)
+   {
+      data = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE, fd, 0);
+
+      if (data == MAP_FAILED)
+         data = NULL;
+      else
+         *size = (size_t)st.st_size;
+   }
+
+   close(fd);
+   return data;
+}
+#endif
+
+/**
+ * content_file_free:
+ * @data         : buffer of the content file.
+ * @mapped       : size of the mapping if @data was mapped, otherwise 0.
+ *
+ * Frees a buffer returned by read_content_file().
+ **/
+static void content_file_free(const void *data, size_t mapped)
+{
+#ifdef HAVE_MMAP
+   if (mapped)
+   {
+      munmap((void*)data, mapped);
+      return;
+   }
+#endif
+   free((void*)data);
+}
+
 /**
  * read_content_file:
- * @path         : buffer of the content file.
- * @buf          : size   of the content file.
+ * @i            : index of the content file.
+ * @path         : path of the content file.
+ * @buf          : buffer of the content file.
  * @length       : size of the content file that has been read from.
+ * @mapped       : set to the size of the mapping if @buf is mapped
+ *                 to the file, otherwise 0.
  *
  * Read the content file. If read into memory, also performs soft patching
  * (see patch_content function) in case soft patching has not been
  * blocked by the enduser.
  *
+ * The CRC32 of the first content file is worked out while reading
+ * it, large files that don't need patching are mapped instead of
+ * copied. Free @buf with content_file_free().
+ *
  * Returns: true if successful, false on error.
  **/
 static bool read_content_file(unsigned i, const char *path, void **buf,
-      ssize_t *length)
+      ssize_t *length, size_t *mapped)
 {
+   uint32_t crc     = 0;
    uint8_t *ret_buf = NULL;
    global_t *global = global_get_ptr();
+   bool patch       = (i == 0) && patch_content_pending();
+
+   *mapped = 0;
 
    RARCH_LOG("%s: %s.\n",
          msg_hash_to_str(MSG_LOADING_CONTENT_FILE), path);
-   if (!read_file(path, (void**) &ret_buf, length))
-      return false;
+
+#ifdef HAVE_MMAP
+   if (!patch && !path_contains_compressed_file(path)
+         && (ret_buf = (uint8_t*)content_file_map(path, mapped)))
+   {
+      *length = *mapped;
+#ifdef HAVE_ZLIB
+      if (i == 0)
+         crc = zlib_crc32_calculate(ret_buf, *length);
+#endif
+   }
+#endif
+
+   if (!ret_buf)
+   {
+      if (i == 0)
+      {
+         if (!read_file_crc32(path, (void**)&ret_buf, length, &crc))
+            return false;
+      }
+      else if (!read_file(path, (void**)&ret_buf, length))
+         return false;
+   }
 
    if (*length < 0)
       return false;
 
+   *buf = ret_buf;
+
    if (i != 0)
       return true;
 
    /* Attempt to apply a patch. */
-   if (!global->patch.block_patch)
+   if (patch)
+   {
       patch_content(&ret_buf, length);
+      *buf = ret_buf;
+#ifdef HAVE_ZLIB
+      crc  = zlib_crc32_calculate(ret_buf, *length);
+#endif
+   }
    
 #ifdef HAVE_ZLIB
-   global->content_crc = zlib_crc32_calculate(ret_buf, *length);
+   global->content_crc = crc;
 
    RARCH_LOG("CRC32: 0x%x .\n", (unsigned)global->content_crc);
 #endif
-   *buf = ret_buf;
 
    return true;
 }
 
-/**
- * dump_to_file_desperate:
- * @data         : pointer to data buffer.
- * @size         : size of @data.
- * @type         : type of file to be saved.
- *
- * Attempt to save valuable RAM data somewhere.
- **/
-static void dump_to_file_desperate(const void *data,
-      size_t size, unsigned type)
-{
-   time_t time_;
-   char path[PATH_MAX_LENGTH]    = {0};
-   char timebuf[PATH_MAX_LENGTH] = {0};
-#if defined(_WIN32) && !defined(_XBOX)
-   const char *base = getenv("APPDATA");
-#elif defined(__CELLOS_LV2__) || defined(_XBOX)
-   const char *base = NULL;
-#else
-   const char *base = getenv("HOME");
-#endif
-
-   if (!base)
-      goto error;
-
-   snprintf(path, sizeof(path), "%s/RetroArch-recovery-%u", base, type);
-
-   time(&time_);
-
-   strftime(timebuf, sizeof(timebuf), "%Y-%m-%d-%H-%M-%S", localtime(&time_));
-   strlcat(path, timebuf, sizeof(path));
-
-   if (retro_write_file(path, data, size))
-      RARCH_WARN("Succeeded in saving RAM data to \"%s\".\n", path);
-   else
-      goto error;
-
-   return;
-
-error:
-   RARCH_WARN("Failed ... Cannot recover save file.\n");
-}
-
 struct sram_block
 {
    unsigned type;
@@ -141,16 +200,20 @@ struct sram_block
 /**
  * save_state:
  * @path      : path of saved state that shall be written to.
+ * @msg       : message to show once the state is on disk, or NULL.
  *
- * Save a state from memory to disk.
+ * Save a state from memory to disk. The state is serialized
+ * right away and written out by the save writer.
  *
  * Returns: true if successful, false otherwise.
  **/
-bool save_state(const char *path)
+bool save_state(const char *path, const char *msg)
 {
-   bool ret    = false;
-   void *data  = NULL;
-   size_t size = pretro_serialize_size();
+   bool ret             = false;
+   void *data           = NULL;
+   unsigned flags       = SAVE_WRITER_STATE;
+   size_t size          = pretro_serialize_size();
+   settings_t *settings = config_get_ptr();
 
    RARCH_LOG("%s: \"%s\".\n",
          msg_hash_to_str(MSG_SAVING_STATE),
@@ -170,17 +233,19 @@ bool save_state(const char *path)
          msg_hash_to_str(MSG_BYTES));
    ret = pretro_serialize(data, size);
 
-   if (ret)
-      ret = retro_write_file(path, data, size);
-
    if (!ret)
+   {
       RARCH_ERR("%s \"%s\".\n", 
             msg_hash_to_str(MSG_FAILED_TO_SAVE_STATE_TO),
             path);
+      free(data);
+      return false;
+   }
 
-   free(data);
+   if (settings->savestate_compression)
+      flags |= SAVE_WRITER_COMPRESS;
 
-   return ret;
+   return save_writer_push(path, data, size, flags, 0, msg);
 }
 
 /**
@@ -200,12 +265,20 @@ bool load_state(const char *path)
    struct sram_block *blocks = NULL;
    settings_t *settings      = config_get_ptr();
    global_t *global          = global_get_ptr();
-   bool ret                  = read_file(path, &buf, &size);
+   bool ret                  = false;
 
    RARCH_LOG("%s: \"%s\".\n",
          msg_hash_to_str(MSG_LOADING_STATE),
          path);
 
+   /* The state might still be on its way to the disk. */
+   save_writer_flush();
+
+   ret = read_file(path, &buf, &size);
+
+   if (ret && size >= 0)
+      ret = save_writer_decompress(&buf, &size);
+
    if (!ret || size < 0)
    {
       RARCH_ERR("%s \"%s\".\n",
@@ -291,6 +364,8 @@ void load_ram_file(const char *path, int type)
    if (size == 0 || !data)
       return;
 
+   save_writer_flush();
+
    ret = read_file(path, &buf, &rc);
 
    if (!ret)
@@ -319,13 +394,15 @@ void load_ram_file(const char *path, int type)
  * @path             : path of RAM state that shall be written to.
  * @type             : type of memory
  *
- * Save a RAM state from memory to disk.
+ * Save a RAM state from memory to disk. A copy of the RAM
+ * is written out by the save writer.
  *
  * In case the file could not be written to, a fallback function
  * 'dump_to_file_desperate' will be called.
  */
 void save_ram_file(const char *path, int type)
 {
+   void *copy  = NULL;
    size_t size = pretro_get_memory_size(type);
    void *data  = pretro_get_memory_data(type);
 
@@ -334,34 +411,28 @@ void save_ram_file(const char *path, int type)
    if (size == 0)
       return;
 
-   if (!retro_write_file(path, data, size))
+   copy = malloc(size);
+
+   if (copy)
    {
-      RARCH_ERR("%s.\n",
-            msg_hash_to_str(MSG_FAILED_TO_SAVE_SRAM));
-      RARCH_WARN("Attempting to recover ...\n");
-      dump_to_file_desperate(data, size, type);
-      return;
+      memcpy(copy, data, size);
+      save_writer_push(path, copy, size, SAVE_WRITER_SRAM, type, NULL);
    }
-
-   RARCH_LOG("%s \"%s\".\n",
-         msg_hash_to_str(MSG_SAVED_SUCCESSFULLY_TO),
-         path);
+   else
+      save_writer_push(path, data, size,
+            SAVE_WRITER_SRAM | SAVE_WRITER_SYNC, type, NULL);
 }
 
 static bool load_content_dont_need_fullpath(
-      struct retro_game_info *info, unsigned i, const char *path)
+      struct retro_game_info *info, unsigned i, const char *path,
+      size_t *mapped)
 {
    ssize_t len;
    /* Load the content into memory. */
 
    /* First content file is significant, attempt to do patching,
     * CRC checking, etc. */
-   bool ret = false;
-
-   if (i == 0)
-      ret = read_content_file(i, path, (void**)&info->data, &len);
-   else
-      ret = read_file(path, (void**)&info->data, &len);
+   bool ret = read_content_file(i, path, (void**)&info->data, &len, mapped);
 
    if (!ret || len < 0)
    {
@@ -465,9 +536,12 @@ static bool load_content(const struct retro_subsystem_info *special,
    struct string_list* additional_path_allocs = string_list_new();
    struct retro_game_info *info = (struct retro_game_info*)
       calloc(content->size, sizeof(*info));
+   size_t *mapped = (size_t*)calloc(content->size, sizeof(*mapped));
 
-   if (!info)
+   if (!info || !mapped)
    {
+      free(info);
+      free(mapped);
       string_list_free(additional_path_allocs);
       return false;
    }
@@ -493,7 +567,8 @@ static bool load_content(const struct retro_subsystem_info *special,
 
       if (!need_fullpath && *path)
       {
-         if (!load_content_dont_need_fullpath(&info[i], i, path))
+         if (!load_content_dont_need_fullpath(&info[i], i, path,
+                  &mapped[i]))
             goto end;
       }
       else
@@ -517,11 +592,12 @@ static bool load_content(const struct retro_subsystem_info *special,
 
 end:
    for (i = 0; i < content->size; i++)
-      free((void*)info[i].data);
+      content_file_free(info[i].data, mapped[i]);
 
    string_list_free(additional_path_allocs);
    if (info)
       free(info);
+   free(mapped);
    return ret;
 }
 
@@ -42,12 +42,14 @@ bool load_state(const char *path);
 /**
  * save_state:
  * @path      : path of saved state that shall be written to.
+ * @msg       : message to show once the state is on disk, or NULL.
  *
- * Save a state from memory to disk.
+ * Save a state from memory to disk. The state is serialized
+ * right away and written out by the save writer.
  *
  * Returns: true if successful, false otherwise.
  **/
-bool save_state(const char *path);
+bool save_state(const char *path, const char *msg);
 
 /**
  * load_ram_file:
@@ -63,7 +65,8 @@ void load_ram_file(const char *path, int type);
  * @path             : path of RAM state that shall be written to.
  * @type             : type of memory
  *
- * Save a RAM state from memory to disk.
+ * Save a RAM state from memory to disk. A copy of the RAM
+ * is written out by the save writer.
  *
  * In case the file could not be written to, a fallback function
  * 'dump_to_file_desperate' will be called.
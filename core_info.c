@@ -15,17 +15,45 @@
  *  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdio.h>
+
 #include <file/file_path.h>
 #include <file/file_extract.h>
+#include <retro_file.h>
+#include <retro_stat.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "general.h"
 #include "dir_list_special.h"
+#include "performance.h"
 #include "config.def.h"
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
+/* Parsed .info files are cached in this file, next to the config
+ * file. Records are keyed by .info path, mtime and size. The cache
+ * is only read back on the machine that wrote it, so numbers are
+ * stored in native byte order. */
+#define CORE_INFO_CACHE_FILE    "core_info.cache"
+#define CORE_INFO_CACHE_MAGIC   "RAINFO"
+#define CORE_INFO_CACHE_VERSION 1
+#define CORE_INFO_CACHE_NULL    0xffffffffu
+
+#define CORE_INFO_MAX_THREADS   8
+
+typedef struct core_info_source
+{
+   char *info_path;
+   int64_t mtime;
+   int32_t size;
+   bool stale;
+} core_info_source_t;
+
 static void core_info_list_resolve_all_extensions(
       core_info_list_t *core_info_list)
 {
@@ -58,52 +86,613 @@ static void core_info_list_resolve_all_extensions(
    }
 }
 
-static void core_info_list_resolve_all_firmware(
-      core_info_list_t *core_info_list)
+/* Frees everything in @info except its path. */
+static void core_info_free_fields(core_info_t *info)
 {
    size_t i;
-   unsigned c;
+   char *path = info->path;
+
+   free(info->core_name);
+   free(info->systemname);
+   free(info->system_manufacturer);
+   free(info->display_name);
+   free(info->supported_extensions);
+   free(info->authors);
+   free(info->permissions);
+   free(info->licenses);
+   free(info->categories);
+   free(info->databases);
+   free(info->notes);
+   if (info->supported_extensions_list)
+      string_list_free(info->supported_extensions_list);
+   string_list_free(info->authors_list);
+   string_list_free(info->note_list);
+   string_list_free(info->permissions_list);
+   string_list_free(info->licenses_list);
+   string_list_free(info->categories_list);
+   string_list_free(info->databases_list);
 
-   if (!core_info_list)
-      return;
-
-   for (i = 0; i < core_info_list->count; i++)
+   for (i = 0; i < info->firmware_count; i++)
    {
-      unsigned count    = 0;
-      core_info_t *info = (core_info_t*)&core_info_list->list[i];
+      free(info->firmware[i].path);
+      free(info->firmware[i].desc);
+   }
+   free(info->firmware);
 
-      if (!info || !info->data)
-         continue;
+   memset(info, 0, sizeof(*info));
+   info->path = path;
+}
 
-      if (!config_get_uint(info->data, "firmware_count", &count))
-         continue;
+static void core_info_split_lists(core_info_t *info)
+{
+   if (info->supported_extensions)
+      info->supported_extensions_list =
+         string_split(info->supported_extensions, "|");
+   if (info->authors)
+      info->authors_list     = string_split(info->authors, "|");
+   if (info->permissions)
+      info->permissions_list = string_split(info->permissions, "|");
+   if (info->licenses)
+      info->licenses_list    = string_split(info->licenses, "|");
+   if (info->categories)
+      info->categories_list  = string_split(info->categories, "|");
+   if (info->databases)
+      info->databases_list   = string_split(info->databases, "|");
+   if (info->notes)
+      info->note_list        = string_split(info->notes, "|");
+}
 
+/**
+ * core_info_parse_file:
+ * @info                : Core info to fill in.
+ * @info_path           : Path to the .info file of the core.
+ *
+ * Reads the fields of @info from @info_path. Does not touch
+ * anything outside of @info, so several cores can be parsed
+ * on different threads at once.
+ *
+ * Returns: true (1) if @info_path could be read, otherwise false (0).
+ **/
+static bool core_info_parse_file(core_info_t *info, const char *info_path)
+{
+   unsigned c;
+   unsigned count      = 0;
+   config_file_t *conf = config_file_new(info_path);
+
+   if (!conf)
+      return false;
+
+   config_get_string(conf, "display_name",   &info->display_name);
+   config_get_string(conf, "corename",       &info->core_name);
+   config_get_string(conf, "systemname",     &info->systemname);
+   config_get_string(conf, "manufacturer",   &info->system_manufacturer);
+   config_get_string(conf, "supported_extensions",
+         &info->supported_extensions);
+   config_get_string(conf, "authors",        &info->authors);
+   config_get_string(conf, "permissions",    &info->permissions);
+   config_get_string(conf, "license",        &info->licenses);
+   config_get_string(conf, "categories",     &info->categories);
+   config_get_string(conf, "database",       &info->databases);
+   config_get_string(conf, "notes",          &info->notes);
+   config_get_bool(conf, "supports_no_game", &info->supports_no_game);
+
+   if (config_get_uint(conf, "firmware_count", &count) && count)
+   {
       info->firmware = (core_info_firmware_t*)
          calloc(count, sizeof(*info->firmware));
 
-      if (!info->firmware)
-         continue;
+      if (info->firmware)
+      {
+         info->firmware_count = count;
+
+         for (c = 0; c < count; c++)
+         {
+            char path_key[64] = {0};
+            char desc_key[64] = {0};
+            char opt_key[64]  = {0};
+
+            snprintf(path_key, sizeof(path_key), "firmware%u_path", c);
+            snprintf(desc_key, sizeof(desc_key), "firmware%u_desc", c);
+            snprintf(opt_key, sizeof(opt_key), "firmware%u_opt", c);
+
+            config_get_string(conf, path_key, &info->firmware[c].path);
+            config_get_string(conf, desc_key, &info->firmware[c].desc);
+            config_get_bool(conf, opt_key, &info->firmware[c].optional);
+         }
+      }
+   }
+
+   config_file_free(conf);
+   info->has_info = true;
+   return true;
+}
+
+#ifdef HAVE_THREADS
+typedef struct core_info_parse_job
+{
+   core_info_t *list;
+   const core_info_source_t *sources;
+   const size_t *stale;
+   size_t num_stale;
+   size_t next;
+   slock_t *lock;
+} core_info_parse_job_t;
+
+static void core_info_parse_thread(void *data)
+{
+   core_info_parse_job_t *job = (core_info_parse_job_t*)data;
+
+   for (;;)
+   {
+      size_t i;
+
+      slock_lock(job->lock);
+      i = job->next++;
+      slock_unlock(job->lock);
+
+      if (i >= job->num_stale)
+         break;
+
+      core_info_parse_file(&job->list[job->stale[i]],
+            job->sources[job->stale[i]].info_path);
+   }
+}
+#endif
+
+/**
+ * core_info_parse_stale:
+ * @list                : Core info list.
+ * @sources             : .info file of every core in @list.
+ * @stale               : Indices of the cores that need parsing.
+ * @num_stale           : Number of entries in @stale.
+ *
+ * Parses the .info files of the given cores, spread over
+ * a few threads if there are enough of them.
+ **/
+static void core_info_parse_stale(core_info_t *list,
+      const core_info_source_t *sources,
+      const size_t *stale, size_t num_stale)
+{
+   size_t i;
+#ifdef HAVE_THREADS
+   sthread_t *threads[CORE_INFO_MAX_THREADS];
+   core_info_parse_job_t job;
+   unsigned num_threads = retro_get_cpu_cores();
+
+   if (num_threads > CORE_INFO_MAX_THREADS)
+      num_threads = CORE_INFO_MAX_THREADS;
+   if (num_threads > num_stale / 4)
+      num_threads = num_stale / 4;
+
+   if (num_threads > 1)
+   {
+      unsigned t, started = 0;
+
+      job.list      = list;
+      job.sources   = sources;
+      job.stale     = stale;
+      job.num_stale = num_stale;
+      job.next      = 0;
+      job.lock      = slock_new();
+
+      if (job.lock)
+      {
+         for (t = 0; t < num_threads; t++)
+         {
+            threads[started] = sthread_create(core_info_parse_thread, &job);
+            if (threads[started])
+               started++;
+         }
+
+         /* Also do some of the work here, and all of it
+          * if no thread could be started. */
+         core_info_parse_thread(&job);
+
+         for (t = 0; t < started; t++)
+            sthread_join(threads[t]);
+         slock_free(job.lock);
+         return;
+      }
+   }
+#endif
+
+   for (i = 0; i < num_stale; i++)
+      core_info_parse_file(&list[stale[i]], sources[stale[i]].info_path);
+}
+
+static bool core_info_cache_path(char *s, size_t len)
+{
+   global_t *global = global_get_ptr();
+
+   if (!global || !*global->path.config)
+      return false;
+
+   fill_pathname_resolve_relative(s, global->path.config,
+         CORE_INFO_CACHE_FILE, len);
+   return true;
+}
+
+typedef struct core_info_cache_reader
+{
+   const uint8_t *data;
+   size_t len;
+   size_t pos;
+   bool error;
+} core_info_cache_reader_t;
+
+static const uint8_t *core_info_cache_read(core_info_cache_reader_t *r,
+      size_t len)
+{
+   const uint8_t *ptr = r->data + r->pos;
+
+   if (r->error || len > r->len - r->pos)
+   {
+      r->error = true;
+      return NULL;
+   }
+
+   r->pos += len;
+   return ptr;
+}
+
+static uint32_t core_info_cache_read_u32(core_info_cache_reader_t *r)
+{
+   uint32_t val        = 0;
+   const uint8_t *ptr  = core_info_cache_read(r, sizeof(val));
+   if (ptr)
+      memcpy(&val, ptr, sizeof(val));
+   return val;
+}
+
+static int64_t core_info_cache_read_s64(core_info_cache_reader_t *r)
+{
+   int64_t val         = 0;
+   const uint8_t *ptr  = core_info_cache_read(r, sizeof(val));
+   if (ptr)
+      memcpy(&val, ptr, sizeof(val));
+   return val;
+}
+
+/* Returns a pointer into the cache, the string is
+ * not terminated. Sets *len to CORE_INFO_CACHE_NULL
+ * for a NULL string. */
+static const char *core_info_cache_read_string(
+      core_info_cache_reader_t *r, uint32_t *len)
+{
+   *len = core_info_cache_read_u32(r);
+   if (*len == CORE_INFO_CACHE_NULL)
+      return NULL;
+   return (const char*)core_info_cache_read(r, *len);
+}
+
+static char *core_info_cache_dup_string(core_info_cache_reader_t *r)
+{
+   uint32_t len;
+   char *str       = NULL;
+   const char *ptr = core_info_cache_read_string(r, &len);
+
+   if (!ptr)
+      return NULL;
+
+   if ((str = (char*)malloc(len + 1)))
+   {
+      memcpy(str, ptr, len);
+      str[len] = '\0';
+   }
+   return str;
+}
+
+/**
+ * core_info_cache_read_record:
+ * @r                   : Cache reader, at the start of a record.
+ * @info                : Core info to fill in, or NULL to skip
+ *                        the record.
+ *
+ * Reads the parsed fields of one core.
+ *
+ * Returns: true (1) if successful, otherwise false (0).
+ **/
+static bool core_info_cache_read_record(core_info_cache_reader_t *r,
+      core_info_t *info)
+{
+   unsigned c;
+   core_info_t tmp;
+   uint32_t firmware_count;
+
+   if (!info)
+   {
+      memset(&tmp, 0, sizeof(tmp));
+      info = &tmp;
+   }
+
+   info->display_name         = core_info_cache_dup_string(r);
+   info->core_name            = core_info_cache_dup_string(r);
+   info->systemname           = core_info_cache_dup_string(r);
+   info->system_manufacturer  = core_info_cache_dup_string(r);
+   info->supported_extensions = core_info_cache_dup_string(r);
+   info->authors              = core_info_cache_dup_string(r);
+   info->permissions          = core_info_cache_dup_string(r);
+   info->licenses             = core_info_cache_dup_string(r);
+   info->categories           = core_info_cache_dup_string(r);
+   info->databases            = core_info_cache_dup_string(r);
+   info->notes                = core_info_cache_dup_string(r);
+   info->supports_no_game     = core_info_cache_read_u32(r) != 0;
+   firmware_count             = core_info_cache_read_u32(r);
+
+   if (!r->error && firmware_count)
+   {
+      if (firmware_count > (r->len - r->pos) / 12)
+         r->error = true;
+      else
+      {
+         info->firmware = (core_info_firmware_t*)
+            calloc(firmware_count, sizeof(*info->firmware));
+         if (info->firmware)
+            info->firmware_count = firmware_count;
+         else
+            r->error = true;
+      }
+   }
+
+   for (c = 0; c < info->firmware_count; c++)
+   {
+      info->firmware[c].path     = core_info_cache_dup_string(r);
+      info->firmware[c].desc     = core_info_cache_dup_string(r);
+      info->firmware[c].optional = core_info_cache_read_u32(r) != 0;
+   }
+
+   info->has_info = true;
+
+   if (info == &tmp)
+      core_info_free_fields(&tmp);
+
+   return !r->error;
+}
+
+/**
+ * core_info_cache_load:
+ * @list                : Core info list.
+ * @sources             : .info file of every core in @list.
+ *
+ * Fills in every core in @list whose .info file has an up-to-date
+ * record in the cache, and marks the others in @sources as stale.
+ *
+ * Returns: true (1) if every record in the cache was used,
+ * otherwise false (0).
+ **/
+static bool core_info_cache_load(core_info_list_t *list,
+      core_info_source_t *sources)
+{
+   uint32_t i, count;
+   core_info_cache_reader_t r;
+   char path[PATH_MAX_LENGTH] = {0};
+   void *buf                  = NULL;
+   ssize_t len                = 0;
+   size_t used                = 0;
+   size_t next                = 0;
+   bool valid                 = false;
+
+   if (!core_info_cache_path(path, sizeof(path)))
+      return false;
+   if (!path_file_exists(path) || retro_read_file(path, &buf, &len) != 1)
+      return false;
+
+   r.data  = (const uint8_t*)buf;
+   r.len   = len;
+   r.pos   = 0;
+   r.error = false;
+
+   if (len < (ssize_t)sizeof(CORE_INFO_CACHE_MAGIC)
+         || memcmp(buf, CORE_INFO_CACHE_MAGIC, sizeof(CORE_INFO_CACHE_MAGIC)))
+      goto end;
+   r.pos = sizeof(CORE_INFO_CACHE_MAGIC);
 
-      for (c = 0; c < count; c++)
+   if (core_info_cache_read_u32(&r) != CORE_INFO_CACHE_VERSION)
+      goto end;
+
+   count = core_info_cache_read_u32(&r);
+
+   for (i = 0; i < count && !r.error; i++)
+   {
+      size_t j;
+      uint32_t path_len;
+      const char *info_path = core_info_cache_read_string(&r, &path_len);
+      int64_t mtime         = core_info_cache_read_s64(&r);
+      int64_t size          = core_info_cache_read_s64(&r);
+      core_info_t *match    = NULL;
+
+      if (!info_path)
+         break;
+
+      /* Records are stored in core list order, so the
+       * matching core is nearly always the next one. */
+      for (j = 0; j < list->count && !match; j++)
       {
-         char path_key[64] = {0};
-         char desc_key[64] = {0};
-         char opt_key[64]  = {0};
+         core_info_source_t *src = &sources[(next + j) % list->count];
+
+         if (src->stale && src->info_path && src->mtime == mtime
+               && src->size == size
+               && strlen(src->info_path) == path_len
+               && !memcmp(src->info_path, info_path, path_len))
+         {
+            match      = &list->list[(next + j) % list->count];
+            src->stale = false;
+            next       = (next + j + 1) % list->count;
+         }
+      }
 
-         snprintf(path_key, sizeof(path_key), "firmware%u_path", c);
-         snprintf(desc_key, sizeof(desc_key), "firmware%u_desc", c);
-         snprintf(opt_key, sizeof(opt_key), "firmware%u_opt", c);
+      if (!core_info_cache_read_record(&r, match))
+      {
+         if (match)
+         {
+            /* Truncated record, parse the file again. */
+            sources[match - list->list].stale = true;
+            core_info_free_fields(match);
+         }
+         break;
+      }
+
+      if (match)
+         used++;
+   }
+
+   valid = !r.error && i == count && used == count;
+
+end:
+   free(buf);
+   return valid;
+}
 
-         config_get_string(info->data, path_key, &info->firmware[c].path);
-         config_get_string(info->data, desc_key, &info->firmware[c].desc);
-         config_get_bool(info->data, opt_key , &info->firmware[c].optional);
+static void core_info_cache_write_bytes(uint8_t **buf, size_t *len,
+      size_t *cap, const void *data, size_t size)
+{
+   if (!*buf)
+      return;
+
+   if (*len + size > *cap)
+   {
+      uint8_t *tmp = NULL;
+      size_t new_cap = *cap * 2;
+
+      while (*len + size > new_cap)
+         new_cap *= 2;
+
+      if (!(tmp = (uint8_t*)realloc(*buf, new_cap)))
+      {
+         free(*buf);
+         *buf = NULL;
+         return;
       }
+
+      *buf = tmp;
+      *cap = new_cap;
    }
+
+   memcpy(*buf + *len, data, size);
+   *len += size;
+}
+
+static void core_info_cache_write_u32(uint8_t **buf, size_t *len,
+      size_t *cap, uint32_t val)
+{
+   core_info_cache_write_bytes(buf, len, cap, &val, sizeof(val));
+}
+
+static void core_info_cache_write_s64(uint8_t **buf, size_t *len,
+      size_t *cap, int64_t val)
+{
+   core_info_cache_write_bytes(buf, len, cap, &val, sizeof(val));
+}
+
+static void core_info_cache_write_string(uint8_t **buf, size_t *len,
+      size_t *cap, const char *str)
+{
+   if (!str)
+   {
+      core_info_cache_write_u32(buf, len, cap, CORE_INFO_CACHE_NULL);
+      return;
+   }
+
+   core_info_cache_write_u32(buf, len, cap, (uint32_t)strlen(str));
+   core_info_cache_write_bytes(buf, len, cap, str, strlen(str));
+}
+
+/**
+ * core_info_cache_save:
+ * @list                : Core info list.
+ * @sources             : .info file of every core in @list.
+ *
+ * Writes every core in @list that has a .info file to the cache.
+ * The cache is written to a temporary file first and renamed
+ * over the old one, so it is never seen half-written.
+ **/
+static void core_info_cache_save(const core_info_list_t *list,
+      const core_info_source_t *sources)
+{
+   size_t i;
+   unsigned c;
+   char path[PATH_MAX_LENGTH]     = {0};
+   char tmp_path[PATH_MAX_LENGTH] = {0};
+   uint32_t count                 = 0;
+   size_t len                     = 0;
+   size_t cap                     = 4096;
+   uint8_t *buf                   = (uint8_t*)malloc(cap);
+
+   if (!buf)
+      return;
+
+   if (!core_info_cache_path(path, sizeof(path)))
+      goto end;
+
+   for (i = 0; i < list->count; i++)
+      if (list->list[i].has_info && sources[i].info_path)
+         count++;
+
+   core_info_cache_write_bytes(&buf, &len, &cap,
+         CORE_INFO_CACHE_MAGIC, sizeof(CORE_INFO_CACHE_MAGIC));
+   core_info_cache_write_u32(&buf, &len, &cap, CORE_INFO_CACHE_VERSION);
+   core_info_cache_write_u32(&buf, &len, &cap, count);
+
+   for (i = 0; i < list->count; i++)
+   {
+      const core_info_t *info = &list->list[i];
+
+      if (!info->has_info || !sources[i].info_path)
+         continue;
+
+      core_info_cache_write_string(&buf, &len, &cap, sources[i].info_path);
+      core_info_cache_write_s64(&buf, &len, &cap, sources[i].mtime);
+      core_info_cache_write_s64(&buf, &len, &cap, sources[i].size);
+
+      core_info_cache_write_string(&buf, &len, &cap, info->display_name);
+      core_info_cache_write_string(&buf, &len, &cap, info->core_name);
+      core_info_cache_write_string(&buf, &len, &cap, info->systemname);
+      core_info_cache_write_string(&buf, &len, &cap,
+            info->system_manufacturer);
+      core_info_cache_write_string(&buf, &len, &cap,
+            info->supported_extensions);
+      core_info_cache_write_string(&buf, &len, &cap, info->authors);
+      core_info_cache_write_string(&buf, &len, &cap, info->permissions);
+      core_info_cache_write_string(&buf, &len, &cap, info->licenses);
+      core_info_cache_write_string(&buf, &len, &cap, info->categories);
+      core_info_cache_write_string(&buf, &len, &cap, info->databases);
+      core_info_cache_write_string(&buf, &len, &cap, info->notes);
+      core_info_cache_write_u32(&buf, &len, &cap, info->supports_no_game);
+      core_info_cache_write_u32(&buf, &len, &cap,
+            (uint32_t)info->firmware_count);
+
+      for (c = 0; c < info->firmware_count; c++)
+      {
+         core_info_cache_write_string(&buf, &len, &cap,
+               info->firmware[c].path);
+         core_info_cache_write_string(&buf, &len, &cap,
+               info->firmware[c].desc);
+         core_info_cache_write_u32(&buf, &len, &cap,
+               info->firmware[c].optional);
+      }
+   }
+
+   if (!buf)
+      return;
+
+   snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+   if (!retro_write_file(tmp_path, buf, len))
+      goto end;
+
+   /* rename() does not replace an existing file everywhere. */
+   remove(path);
+   if (rename(tmp_path, path) != 0)
+      remove(tmp_path);
+
+end:
+   free(buf);
 }
 
 void core_info_get_name(const char *path, char *s, size_t len)
 {
    size_t i;
+   config_file_t *conf    = NULL;
    core_info_t *core_info = NULL;
    core_info_list_t *core_info_list = NULL;
    settings_t *settings = config_get_ptr();
@@ -152,13 +741,16 @@ void core_info_get_name(const char *path, char *s, size_t len)
             settings->libretro_info_path : settings->libretro_directory,
             info_path_base, sizeof(info_path));
 
-      core_info[i].data = config_file_new(info_path);
+      conf = config_file_new(info_path);
 
-      if (core_info[i].data)
-         config_get_string(core_info[i].data, "corename",
-               &core_info[i].core_name);
+      if (conf)
+      {
+         config_get_string(conf, "corename", &core_info[i].core_name);
+         config_file_free(conf);
+      }
 
-      strlcpy(s, core_info[i].core_name, len);
+      if (core_info[i].core_name)
+         strlcpy(s, core_info[i].core_name, len);
    }
 
 error:
@@ -168,13 +760,27 @@ error:
    core_info_list_free(core_info_list);
 }
 
+/**
+ * core_info_list_new:
+ *
+ * Builds the info list of every core in the cores directory.
+ * Cores whose .info file has not changed since the last call
+ * are read from the core info cache, the rest are parsed again
+ * and the cache is updated.
+ *
+ * Returns: core info list, or NULL on error.
+ **/
 core_info_list_t *core_info_list_new(void)
 {
    size_t i;
-   core_info_t *core_info = NULL;
+   size_t num_stale                 = 0;
+   size_t *stale                    = NULL;
+   core_info_source_t *sources      = NULL;
+   core_info_t *core_info           = NULL;
    core_info_list_t *core_info_list = NULL;
-   settings_t *settings = config_get_ptr();
-   struct string_list *contents = dir_list_new_special(NULL, DIR_LIST_CORES);
+   settings_t *settings             = config_get_ptr();
+   struct string_list *contents     = dir_list_new_special(NULL, DIR_LIST_CORES);
+   bool cache_valid                 = false;
 
    if (!contents)
       return NULL;
@@ -184,8 +790,13 @@ core_info_list_t *core_info_list_new(void)
       goto error;
 
    core_info = (core_info_t*)calloc(contents->size, sizeof(*core_info));
-   if (!core_info)
+   sources   = (core_info_source_t*)calloc(contents->size, sizeof(*sources));
+   stale     = (size_t*)calloc(contents->size + 1, sizeof(*stale));
+   if (!core_info || !sources || !stale)
+   {
+      free(core_info);
       goto error;
+   }
 
    core_info_list->list = core_info;
    core_info_list->count = contents->size;
@@ -215,77 +826,50 @@ core_info_list_t *core_info_list_new(void)
             settings->libretro_info_path : settings->libretro_directory,
             info_path_base, sizeof(info_path));
 
-      core_info[i].data = config_file_new(info_path);
+      /* Cores without a .info file have nothing to parse. */
+      sources[i].mtime = path_get_mtime(info_path);
+      if (sources[i].mtime < 0)
+         continue;
 
-      if (core_info[i].data)
-      {
-         unsigned count = 0;
-         config_get_string(core_info[i].data, "display_name",
-               &core_info[i].display_name);
-         config_get_string(core_info[i].data, "corename",
-               &core_info[i].core_name);
-         config_get_string(core_info[i].data, "systemname",
-               &core_info[i].systemname);
-         config_get_string(core_info[i].data, "manufacturer",
-               &core_info[i].system_manufacturer);
-         config_get_uint(core_info[i].data, "firmware_count", &count);
-         core_info[i].firmware_count = count;
-         if (config_get_string(core_info[i].data, "supported_extensions",
-                  &core_info[i].supported_extensions) &&
-               core_info[i].supported_extensions)
-            core_info[i].supported_extensions_list =
-               string_split(core_info[i].supported_extensions, "|");
-
-         if (config_get_string(core_info[i].data, "authors",
-                  &core_info[i].authors) &&
-               core_info[i].authors)
-            core_info[i].authors_list =
-               string_split(core_info[i].authors, "|");
-
-         if (config_get_string(core_info[i].data, "permissions",
-                  &core_info[i].permissions) &&
-               core_info[i].permissions)
-            core_info[i].permissions_list =
-               string_split(core_info[i].permissions, "|");
-
-         if (config_get_string(core_info[i].data, "license",
-                  &core_info[i].licenses) &&
-               core_info[i].licenses)
-            core_info[i].licenses_list =
-               string_split(core_info[i].licenses, "|");
-
-         if (config_get_string(core_info[i].data, "categories",
-                  &core_info[i].categories) &&
-               core_info[i].categories)
-            core_info[i].categories_list =
-               string_split(core_info[i].categories, "|");
-
-         if (config_get_string(core_info[i].data, "database",
-                  &core_info[i].databases) &&
-               core_info[i].databases)
-            core_info[i].databases_list =
-               string_split(core_info[i].databases, "|");
-
-         if (config_get_string(core_info[i].data, "notes",
-                  &core_info[i].notes) &&
-               core_info[i].notes)
-            core_info[i].note_list = string_split(core_info[i].notes, "|");
-
-         config_get_bool(core_info[i].data, "supports_no_game",
-               &core_info[i].supports_no_game);
-      }
+      sources[i].info_path = strdup(info_path);
+      sources[i].size      = path_get_size(info_path);
+      sources[i].stale     = true;
+   }
+
+   cache_valid = core_info_cache_load(core_info_list, sources);
+
+   for (i = 0; i < core_info_list->count; i++)
+      if (sources[i].stale)
+         stale[num_stale++] = i;
 
-      if (!core_info[i].display_name)
+   core_info_parse_stale(core_info, sources, stale, num_stale);
+
+   if (num_stale || !cache_valid)
+      core_info_cache_save(core_info_list, sources);
+
+   for (i = 0; i < core_info_list->count; i++)
+   {
+      core_info_split_lists(&core_info[i]);
+
+      if (!core_info[i].display_name && core_info[i].path)
          core_info[i].display_name = strdup(path_basename(core_info[i].path));
    }
 
    core_info_list_resolve_all_extensions(core_info_list);
-   core_info_list_resolve_all_firmware(core_info_list);
 
+   for (i = 0; i < contents->size; i++)
+      free(sources[i].info_path);
+   free(sources);
+   free(stale);
    dir_list_free(contents);
    return core_info_list;
 
 error:
+   if (sources)
+      for (i = 0; i < contents->size; i++)
+         free(sources[i].info_path);
+   free(sources);
+   free(stale);
    if (contents)
       dir_list_free(contents);
    core_info_list_free(core_info_list);
@@ -294,7 +878,7 @@ error:
 
 void core_info_list_free(core_info_list_t *core_info_list)
 {
-   size_t i, j;
+   size_t i;
 
    if (!core_info_list)
       return;
@@ -306,34 +890,8 @@ void core_info_list_free(core_info_list_t *core_info_list)
       if (!info)
          continue;
 
+      core_info_free_fields(info);
       free(info->path);
-      free(info->core_name);
-      free(info->systemname);
-      free(info->system_manufacturer);
-      free(info->display_name);
-      free(info->supported_extensions);
-      free(info->authors);
-      free(info->permissions);
-      free(info->licenses);
-      free(info->categories);
-      free(info->databases);
-      free(info->notes);
-      if (info->supported_extensions_list)
-         string_list_free(info->supported_extensions_list);
-      string_list_free(info->authors_list);
-      string_list_free(info->note_list);
-      string_list_free(info->permissions_list);
-      string_list_free(info->licenses_list);
-      string_list_free(info->categories_list);
-      string_list_free(info->databases_list);
-      config_file_free(info->data);
-
-      for (j = 0; j < info->firmware_count; j++)
-      {
-         free(info->firmware[j].path);
-         free(info->firmware[j].desc);
-      }
-      free(info->firmware);
    }
 
    free(core_info_list->all_ext);
@@ -349,7 +907,7 @@ size_t core_info_list_num_info_files(core_info_list_t *core_info_list)
       return 0;
 
    for (i = 0; i < core_info_list->count; i++)
-      num += !!core_info_list->list[i].data;
+      num += core_info_list->list[i].has_info;
 
    return num;
 }
@@ -38,7 +38,6 @@ typedef struct
 typedef struct
 {
    char *path;
-   config_file_t *data;
    char *display_name;
    char *core_name;
    char *system_manufacturer;
@@ -61,6 +60,8 @@ typedef struct
    core_info_firmware_t *firmware;
    size_t firmware_count;
    bool supports_no_game;
+   /* Set if the .info file of this core was found. */
+   bool has_info;
    void *userdata;
 } core_info_t;
 
@@ -18,8 +18,11 @@
 #include <stdint.h>
 
 #include <file/file_extract.h>
+#include <file/file_path.h>
 #include <retro_endianness.h>
 
+#include "libretro-db/libretrodb_columns.h"
+
 #include "dir_list_special.h"
 #include "database_info.h"
 #include "msg_hash.h"
@@ -219,34 +222,43 @@ char *bin_to_hex_alloc(const uint8_t *data, size_t len)
 }
 
 
-static int database_cursor_iterate(libretrodb_cursor_t *cur,
-      database_info_t *db_info)
+static bool database_info_field_wanted(const struct rmsgpack_dom_value *key,
+      const char **fields)
+{
+   if (!fields)
+      return true;
+
+   for (; *fields; fields++)
+      if (!strcmp(*fields, key->val.string.buff))
+         return true;
+
+   return false;
+}
+
+static int database_info_parse_item(const struct rmsgpack_dom_value *item,
+      database_info_t *db_info, const char **fields)
 {
    unsigned i;
-   struct rmsgpack_dom_value item;
    const char* str                = NULL;
 
-   if (libretrodb_cursor_read_item(cur, &item) != 0)
-      return -1;
-
-   if (item.type != RDT_MAP)
-   {
-      rmsgpack_dom_value_free(&item);
+   if (item->type != RDT_MAP)
       return 1;
-   }
 
    db_info->analog_supported       = -1;
    db_info->rumble_supported       = -1;
 
-   for (i = 0; i < item.val.map.len; i++)
+   for (i = 0; i < item->val.map.len; i++)
    {
       uint32_t                 value = 0;
-      struct rmsgpack_dom_value *key = &item.val.map.items[i].key;
-      struct rmsgpack_dom_value *val = &item.val.map.items[i].value;
+      struct rmsgpack_dom_value *key = &item->val.map.items[i].key;
+      struct rmsgpack_dom_value *val = &item->val.map.items[i].value;
 
       if (!key || !val)
          continue;
 
+      if (!database_info_field_wanted(key, fields))
+         continue;
+
       str   = key->val.string.buff;
       value = msg_hash_calculate(str);
 
@@ -325,7 +337,12 @@ static int database_cursor_iterate(libretrodb_cursor_t *cur,
             db_info->size = val->val.uint_;
             break;
          case DB_CURSOR_CHECKSUM_CRC32:
-            db_info->crc32 = swap_if_little32(*(uint32_t*)val->val.binary.buff);
+            {
+               uint32_t crc32 = 0;
+               memcpy(&crc32, val->val.binary.buff,
+                     min(val->val.binary.len, sizeof(crc32)));
+               db_info->crc32 = swap_if_little32(crc32);
+            }
             break;
          case DB_CURSOR_CHECKSUM_SHA1:
             db_info->sha1 = bin_to_hex_alloc((uint8_t*)val->val.binary.buff, val->val.binary.len);
@@ -339,13 +356,23 @@ static int database_cursor_iterate(libretrodb_cursor_t *cur,
       }
    }
 
-   rmsgpack_dom_value_free(&item);
-
    return 0;
 }
 
+static int database_cursor_iterate(libretrodb_cursor_t *cur,
+      database_info_t *db_info, const char **fields)
+{
+   struct rmsgpack_dom_value item;
+
+   if (libretrodb_cursor_read_item(cur, &item) != 0)
+      return -1;
+
+   return database_info_parse_item(&item, db_info, fields);
+}
+
 static int database_cursor_open(libretrodb_t *db,
-      libretrodb_cursor_t *cur, const char *path, const char *query)
+      libretrodb_cursor_t *cur, const char *path, const char *query,
+      libretrodb_query_t **out_q)
 {
    const char *error     = NULL;
    libretrodb_query_t *q = NULL;
@@ -362,7 +389,9 @@ static int database_cursor_open(libretrodb_t *db,
    if ((libretrodb_cursor_open(db, cur, q)) != 0)
       goto error;
 
-   if (q)
+   if (out_q)
+      *out_q = q;
+   else if (q)
       libretrodb_query_free(q);
 
    return 0;
@@ -446,12 +475,123 @@ void database_info_free(database_info_handle_t *db)
    string_list_free(db->list);
 }
 
+static void database_info_free_entry(database_info_t *info);
+
+static bool database_info_list_append(database_info_list_t *list,
+      unsigned *cap, database_info_t *db_info)
+{
+   if (list->count == *cap)
+   {
+      unsigned new_cap         = *cap ? *cap * 2 : 64;
+      database_info_t *new_ptr = (database_info_t*)
+         realloc(list->list, new_cap * sizeof(database_info_t));
+
+      if (!new_ptr)
+      {
+         database_info_free_entry(db_info);
+         return false;
+      }
+
+      list->list = new_ptr;
+      *cap       = new_cap;
+   }
+
+   memcpy(&list->list[list->count++], db_info, sizeof(*db_info));
+   return true;
+}
+
+/**
+ * database_info_list_read_columns:
+ * @list                : List to add the matching entries to.
+ * @db                  : Handle to database.
+ * @rdb_path            : Path to database.
+ * @q                   : Query to match, or NULL for all entries.
+ * @fields              : Fields to read, or NULL for all of them.
+ *
+ * Reads the entries from the columnar sidecar of @rdb_path, if
+ * there is an up to date one, so that only the columns of @fields
+ * are loaded instead of decoding every entry whole. A query still
+ * needs every column to be matched against.
+ *
+ * Returns: 0 if successful, -1 if the database has to be read
+ * through a cursor instead (@list is left empty), -2 if out of memory.
+ **/
+static int database_info_list_read_columns(database_info_list_t *list,
+      libretrodb_t *db, const char *rdb_path, libretrodb_query_t *q,
+      const char **fields)
+{
+   uint64_t row;
+   char columns_path[PATH_MAX_LENGTH];
+   int ret                    = 0;
+   unsigned cap               = 0;
+   libretrodb_columns_t *cols = NULL;
+
+   snprintf(columns_path, sizeof(columns_path), "%s%s",
+         rdb_path, LIBRETRODB_COLUMNS_EXTENSION);
+
+   if (!path_file_exists(columns_path))
+      return -1;
+
+   cols = libretrodb_columns_open(db, columns_path,
+         q ? NULL : (const char * const*)fields);
+
+   if (!cols)
+      return -1;
+
+   for (row = 0; row < libretrodb_columns_count(cols); row++)
+   {
+      database_info_t db_info = {0};
+      struct rmsgpack_dom_value item;
+
+      if (libretrodb_columns_read_row(cols, row, &item) != 0)
+      {
+         /* Don't hand back a truncated list, start over
+          * through the cursor instead. */
+         unsigned i;
+
+         for (i = 0; i < list->count; i++)
+            database_info_free_entry(&list->list[i]);
+         free(list->list);
+         list->list  = NULL;
+         list->count = 0;
+         ret         = -1;
+         break;
+      }
+      if (q && !libretrodb_query_filter(q, &item))
+         continue;
+      if (database_info_parse_item(&item, &db_info, fields) != 0)
+         continue;
+      if (!database_info_list_append(list, &cap, &db_info))
+      {
+         ret = -2;
+         break;
+      }
+   }
+
+   libretrodb_columns_close(cols);
+   return ret;
+}
+
+/**
+ * database_info_list_new:
+ * @rdb_path            : Path to database.
+ * @query               : Query to match, or NULL for all entries.
+ * @fields              : NULL-terminated list of the fields to fill
+ *                        in, or NULL for all of them.
+ *
+ * Reads the entries of @rdb_path matching @query. Fields not in
+ * @fields are left unset, which saves copying strings nobody
+ * looks at when browsing large databases.
+ *
+ * Returns: list of entries, or NULL on failure.
+ **/
 database_info_list_t *database_info_list_new(
-      const char *rdb_path, const char *query)
+      const char *rdb_path, const char *query, const char **fields)
 {
    int ret                                  = 0;
-   unsigned k                               = 0;
-   database_info_t *database_info           = NULL;
+   unsigned cap                             = 0;
+   uint64_t count                           = 0;
+   libretrodb_query_t *q                    = NULL;
    database_info_list_t *database_info_list = NULL;
    libretrodb_t *db                         = libretrodb_new();
    libretrodb_cursor_t *cur                 = libretrodb_cursor_new();
@@ -459,7 +599,7 @@ database_info_list_t *database_info_list_new(
    if (!db || !cur)
       goto end;
 
-   if ((database_cursor_open(db, cur, rdb_path, query) != 0))
+   if ((database_cursor_open(db, cur, rdb_path, query, &q) != 0))
       goto end;
 
    database_info_list = (database_info_list_t*)
@@ -468,42 +608,43 @@ database_info_list_t *database_info_list_new(
    if (!database_info_list)
       goto end;
 
-   while (ret != -1)
+   /* Index lookups only read a handful of entries, the sidecar
+    * would not be any faster. */
+   if (!libretrodb_cursor_get_plan(cur, &count))
    {
-      database_info_t db_info = {0};
-      ret = database_cursor_iterate(cur, &db_info);
+      ret = database_info_list_read_columns(database_info_list,
+            db, rdb_path, q, fields);
 
-      if (ret == 0)
+      if (ret == -2)
       {
-         database_info_t *db_ptr  = NULL;
-         database_info_t *new_ptr = (database_info_t*)
-            realloc(database_info, (k+1) * sizeof(database_info_t));
-
-         if (!new_ptr)
-         {
-            database_info_list_free(database_info_list);
-            database_info_list = NULL;
-            goto end;
-         }
-
-         database_info = new_ptr;
-         db_ptr        = &database_info[k];
+         database_info_list_free(database_info_list);
+         database_info_list = NULL;
+      }
+      if (ret != -1)
+         goto end;
 
-         if (!db_ptr)
-            continue;
+      ret = 0;
+   }
 
-         memcpy(db_ptr, &db_info, sizeof(*db_ptr));
+   while (ret != -1)
+   {
+      database_info_t db_info = {0};
+      ret = database_cursor_iterate(cur, &db_info, fields);
 
-         k++;
+      if (ret == 0 && !database_info_list_append(
+               database_info_list, &cap, &db_info))
+      {
+         database_info_list_free(database_info_list);
+         database_info_list = NULL;
+         goto end;
       }
    } 
 
-   database_info_list->list  = database_info;
-   database_info_list->count = k;
-
 end:
    database_cursor_close(db, cur);
 
+   if (q)
+      libretrodb_query_free(q);
    if (db)
       libretrodb_free(db);
    if (cur)
@@ -512,6 +653,46 @@ end:
    return database_info_list;
 }
 
+static void database_info_free_entry(database_info_t *info)
+{
+   if (info->name)
+      free(info->name);
+   if (info->rom_name)
+      free(info->rom_name);
+   if (info->serial)
+      free(info->serial);
+   if (info->description)
+      free(info->description);
+   if (info->publisher)
+      free(info->publisher);
+   if (info->developer)
+      string_list_free(info->developer);
+   info->developer = NULL;
+   if (info->origin)
+      free(info->origin);
+   if (info->franchise)
+      free(info->franchise);
+   if (info->edge_magazine_review)
+      free(info->edge_magazine_review);
+
+   if (info->cero_rating)
+      free(info->cero_rating);
+   if (info->pegi_rating)
+      free(info->pegi_rating);
+   if (info->enhancement_hw)
+      free(info->enhancement_hw);
+   if (info->elspa_rating)
+      free(info->elspa_rating);
+   if (info->esrb_rating)
+      free(info->esrb_rating);
+   if (info->bbfc_rating)
+      free(info->bbfc_rating);
+   if (info->sha1)
+      free(info->sha1);
+   if (info->md5)
+      free(info->md5);
+}
+
 void database_info_list_free(database_info_list_t *database_info_list)
 {
    size_t i;
@@ -520,50 +701,467 @@ void database_info_list_free(database_info_list_t *database_info_list)
       return;
 
    for (i = 0; i < database_info_list->count; i++)
+      database_info_free_entry(&database_info_list->list[i]);
+
+   free(database_info_list->list);
+   free(database_info_list);
+}
+
+typedef struct database_info_index_slot
+{
+   /* Offset of the entry in its database. Entries never start
+    * at offset 0, so 0 marks an empty slot. */
+   uint64_t offset;
+   uint32_t key;
+   uint32_t db;
+} database_info_index_slot_t;
+
+typedef struct database_info_index_table
+{
+   database_info_index_slot_t *slots;
+   /* Offsets into the string heap, parallel to slots.
+    * Only used by tables keyed by string hashes. */
+   uint32_t *strings;
+   size_t size;
+   size_t count;
+} database_info_index_table_t;
+
+struct database_info_index
+{
+   char **paths;
+   libretrodb_t **dbs;
+   unsigned num_dbs;
+
+   database_info_index_table_t crc;
+   database_info_index_table_t serial;
+
+   char *heap;
+   size_t heap_size;
+   size_t heap_cap;
+};
+
+static bool database_info_index_table_insert(
+      database_info_index_table_t *table, uint32_t key,
+      uint32_t db, uint64_t offset, bool has_string, uint32_t string);
+
+static bool database_info_index_table_grow(database_info_index_table_t *table,
+      bool has_strings)
+{
+   size_t i;
+   database_info_index_table_t old = *table;
+   size_t new_size                 = old.size ? old.size * 2 : 1024;
+
+   table->slots   = (database_info_index_slot_t*)
+      calloc(new_size, sizeof(*table->slots));
+   table->strings = has_strings ?
+      (uint32_t*)calloc(new_size, sizeof(*table->strings)) : NULL;
+   table->size    = new_size;
+   table->count   = 0;
+
+   if (!table->slots || (has_strings && !table->strings))
    {
-      database_info_t *info = &database_info_list->list[i];
+      free(table->slots);
+      free(table->strings);
+      *table = old;
+      return false;
+   }
 
-      if (!info)
+   for (i = 0; i < old.size; i++)
+   {
+      if (!old.slots[i].offset)
          continue;
 
-      if (info->name)
-         free(info->name);
-      if (info->rom_name)
-         free(info->rom_name);
-      if (info->serial)
-         free(info->serial);
-      if (info->description)
-         free(info->description);
-      if (info->publisher)
-         free(info->publisher);
-      if (info->developer)
-         string_list_free(info->developer);
-      info->developer = NULL;
-      if (info->origin)
-         free(info->origin);
-      if (info->franchise)
-         free(info->franchise);
-      if (info->edge_magazine_review)
-         free(info->edge_magazine_review);
-
-      if (info->cero_rating)
-         free(info->cero_rating);
-      if (info->pegi_rating)
-         free(info->pegi_rating);
-      if (info->enhancement_hw)
-         free(info->enhancement_hw);
-      if (info->elspa_rating)
-         free(info->elspa_rating);
-      if (info->esrb_rating)
-         free(info->esrb_rating);
-      if (info->bbfc_rating)
-         free(info->bbfc_rating);
-      if (info->sha1)
-         free(info->sha1);
-      if (info->md5)
-         free(info->md5);
+      database_info_index_table_insert(table, old.slots[i].key,
+            old.slots[i].db, old.slots[i].offset,
+            has_strings, has_strings ? old.strings[i] : 0);
    }
 
-   free(database_info_list->list);
-   free(database_info_list);
+   free(old.slots);
+   free(old.strings);
+
+   return true;
+}
+
+static bool database_info_index_table_insert(
+      database_info_index_table_t *table, uint32_t key,
+      uint32_t db, uint64_t offset, bool has_string, uint32_t string)
+{
+   size_t i;
+
+   /* Keep the load factor at or below 1/2. */
+   if ((table->count + 1) * 2 > table->size)
+      if (!database_info_index_table_grow(table, has_string))
+         return false;
+
+   for (i = key & (table->size - 1); table->slots[i].offset;
+         i = (i + 1) & (table->size - 1));
+
+   table->slots[i].offset = offset;
+   table->slots[i].key    = key;
+   table->slots[i].db     = db;
+
+   if (has_string)
+      table->strings[i]   = string;
+
+   table->count++;
+
+   return true;
+}
+
+static bool database_info_index_add_string(database_info_index_t *index,
+      const char *s, size_t len, uint32_t *out)
+{
+   if (index->heap_size + len + 1 > index->heap_cap)
+   {
+      size_t new_cap = index->heap_cap ? index->heap_cap : 4096;
+      char *new_heap = NULL;
+
+      while (index->heap_size + len + 1 > new_cap)
+         new_cap *= 2;
+
+      if (new_cap > UINT32_MAX)
+         return false;
+
+      new_heap = (char*)realloc(index->heap, new_cap);
+
+      if (!new_heap)
+         return false;
+
+      index->heap     = new_heap;
+      index->heap_cap = new_cap;
+   }
+
+   memcpy(index->heap + index->heap_size, s, len);
+   index->heap[index->heap_size + len] = '\0';
+
+   *out              = (uint32_t)index->heap_size;
+   index->heap_size += len + 1;
+
+   return true;
+}
+
+static const struct rmsgpack_dom_value *database_info_index_get_field(
+      const struct rmsgpack_dom_value *item, const char *name, size_t len)
+{
+   unsigned i;
+
+   for (i = 0; i < item->val.map.len; i++)
+   {
+      const struct rmsgpack_dom_value *key = &item->val.map.items[i].key;
+
+      if (key->type == RDT_STRING && key->val.string.len == len
+            && !memcmp(key->val.string.buff, name, len))
+         return &item->val.map.items[i].value;
+   }
+
+   return NULL;
+}
+
+/**
+ * database_info_index_new:
+ *
+ * Creates an empty CRC32/serial index. Databases are added with
+ * database_info_index_add().
+ *
+ * Returns: new index, or NULL on allocation failure.
+ **/
+database_info_index_t *database_info_index_new(void)
+{
+   return (database_info_index_t*)calloc(1, sizeof(database_info_index_t));
+}
+
+/**
+ * database_info_index_add:
+ * @index               : Index handle.
+ * @rdb_path            : Database to add.
+ *
+ * Reads the crc and serial fields of every entry of @rdb_path into
+ * @index. Only the keys and the entry offsets are kept in memory;
+ * the entries themselves are read back on demand by
+ * database_info_index_read().
+ *
+ * Returns: 0 on success, otherwise -1. The database is numbered in
+ * @index either way, in the order it was added.
+ **/
+int database_info_index_add(database_info_index_t *index,
+      const char *rdb_path)
+{
+   struct rmsgpack_dom_value item;
+   int ret                  = -1;
+   char **new_paths         = NULL;
+   libretrodb_t **new_dbs   = NULL;
+   libretrodb_t *db         = NULL;
+   libretrodb_cursor_t *cur = NULL;
+   uint32_t db_index        = index->num_dbs;
+
+   new_paths = (char**)realloc(index->paths,
+         (index->num_dbs + 1) * sizeof(*new_paths));
+   if (!new_paths)
+      return -1;
+   index->paths = new_paths;
+
+   new_dbs = (libretrodb_t**)realloc(index->dbs,
+         (index->num_dbs + 1) * sizeof(*new_dbs));
+   if (!new_dbs)
+      return -1;
+   index->dbs = new_dbs;
+
+   index->paths[db_index] = strdup(rdb_path);
+   index->dbs[db_index]   = NULL;
+   index->num_dbs++;
+
+   db  = libretrodb_new();
+   cur = libretrodb_cursor_new();
+
+   if (!db || !cur)
+      goto end;
+
+   if (database_cursor_open(db, cur, rdb_path, NULL, NULL) != 0)
+      goto end;
+
+   for (;;)
+   {
+      const struct rmsgpack_dom_value *crc    = NULL;
+      const struct rmsgpack_dom_value *serial = NULL;
+      uint64_t offset = libretrodb_cursor_tell(cur);
+
+      if (libretrodb_cursor_read_item(cur, &item) != 0)
+         break;
+
+      if (item.type == RDT_MAP)
+      {
+         crc    = database_info_index_get_field(&item, "crc", 3);
+         serial = database_info_index_get_field(&item, "serial", 6);
+      }
+
+      if (crc && crc->type == RDT_BINARY && crc->val.binary.len == 4)
+      {
+         uint32_t value;
+
+         memcpy(&value, crc->val.binary.buff, sizeof(value));
+         value = swap_if_little32(value);
+
+         if (value)
+            database_info_index_table_insert(&index->crc,
+                  value, db_index, offset, false, 0);
+      }
+
+      if (serial && (serial->type == RDT_STRING
+               || serial->type == RDT_BINARY) && serial->val.string.len)
+      {
+         uint32_t string;
+
+         if (database_info_index_add_string(index, serial->val.string.buff,
+                  serial->val.string.len, &string))
+            database_info_index_table_insert(&index->serial,
+                  msg_hash_calculate(index->heap + string),
+                  db_index, offset, true, string);
+      }
+   }
+
+   ret = 0;
+
+end:
+   database_cursor_close(db, cur);
+
+   if (db)
+      libretrodb_free(db);
+   if (cur)
+      libretrodb_cursor_free(cur);
+
+   return ret;
+}
+
+/**
+ * database_info_index_free:
+ * @index               : Index handle.
+ *
+ * Frees @index and closes the databases it has read entries from.
+ **/
+void database_info_index_free(database_info_index_t *index)
+{
+   unsigned i;
+
+   if (!index)
+      return;
+
+   for (i = 0; i < index->num_dbs; i++)
+   {
+      free(index->paths[i]);
+
+      if (index->dbs[i])
+      {
+         libretrodb_close(index->dbs[i]);
+         libretrodb_free(index->dbs[i]);
+      }
+   }
+
+   free(index->paths);
+   free(index->dbs);
+   free(index->crc.slots);
+   free(index->serial.slots);
+   free(index->serial.strings);
+   free(index->heap);
+   free(index);
+}
+
+/**
+ * database_info_index_find_crc:
+ * @index               : Index handle.
+ * @crc                 : CRC32 to look up.
+ * @matches             : Entries with a crc of @crc.
+ * @max_matches         : Size of @matches.
+ *
+ * Returns: number of entries found, at most @max_matches.
+ **/
+size_t database_info_index_find_crc(const database_info_index_t *index,
+      uint32_t crc, database_info_index_match_t *matches,
+      size_t max_matches)
+{
+   size_t i;
+   size_t found                             = 0;
+   const database_info_index_table_t *table = &index->crc;
+
+   if (!table->size || !crc)
+      return 0;
+
+   for (i = crc & (table->size - 1);
+         table->slots[i].offset && found < max_matches;
+         i = (i + 1) & (table->size - 1))
+   {
+      if (table->slots[i].key != crc)
+         continue;
+
+      matches[found].db     = table->slots[i].db;
+      matches[found].offset = table->slots[i].offset;
+      found++;
+   }
+
+   return found;
+}
+
+/**
+ * database_info_index_find_serial:
+ * @index               : Index handle.
+ * @serial              : Serial to look up.
+ * @matches             : Entries with a serial of @serial.
+ * @max_matches         : Size of @matches.
+ *
+ * Returns: number of entries found, at most @max_matches.
+ **/
+size_t database_info_index_find_serial(const database_info_index_t *index,
+      const char *serial, database_info_index_match_t *matches,
+      size_t max_matches)
+{
+   size_t i;
+   uint32_t key;
+   size_t found                             = 0;
+   const database_info_index_table_t *table = &index->serial;
+
+   if (!table->size || !serial || !*serial)
+      return 0;
+
+   key = msg_hash_calculate(serial);
+
+   for (i = key & (table->size - 1);
+         table->slots[i].offset && found < max_matches;
+         i = (i + 1) & (table->size - 1))
+   {
+      if (table->slots[i].key != key)
+         continue;
+      if (strcmp(index->heap + table->strings[i], serial))
+         continue;
+
+      matches[found].db     = table->slots[i].db;
+      matches[found].offset = table->slots[i].offset;
+      found++;
+   }
+
+   return found;
+}
+
+/**
+ * database_info_index_get_path:
+ * @index               : Index handle.
+ * @db                  : Database number.
+ *
+ * Returns: path of database @db of @index.
+ **/
+const char *database_info_index_get_path(const database_info_index_t *index,
+      unsigned db)
+{
+   if (db >= index->num_dbs)
+      return NULL;
+   return index->paths[db];
+}
+
+/**
+ * database_info_index_read:
+ * @index               : Index handle.
+ * @matches             : Entries to read.
+ * @num_matches         : Number of entries in @matches.
+ *
+ * Reads back entries found by database_info_index_find_crc() or
+ * database_info_index_find_serial(). Not safe to call from several
+ * threads on the same @index.
+ *
+ * Returns: list of @num_matches entries, in the order of @matches,
+ * or NULL on allocation failure. Entries that could not be read are
+ * left zeroed. Has to be freed with database_info_list_free().
+ **/
+database_info_list_t *database_info_index_read(database_info_index_t *index,
+      const database_info_index_match_t *matches, size_t num_matches)
+{
+   size_t i;
+   database_info_list_t *list = (database_info_list_t*)
+      calloc(1, sizeof(*list));
+
+   if (!list)
+      return NULL;
+
+   list->list = (database_info_t*)calloc(num_matches ? num_matches : 1,
+         sizeof(*list->list));
+
+   if (!list->list)
+   {
+      free(list);
+      return NULL;
+   }
+
+   list->count = num_matches;
+
+   for (i = 0; i < num_matches; i++)
+   {
+      struct rmsgpack_dom_value item;
+      unsigned db_index = matches[i].db;
+
+      if (db_index >= index->num_dbs)
+         continue;
+
+      if (!index->dbs[db_index])
+      {
+         libretrodb_t *db = libretrodb_new();
+
+         if (!db)
+            continue;
+
+         if (libretrodb_open(index->paths[db_index], db) != 0)
+         {
+            libretrodb_free(db);
+            continue;
+         }
+
+         index->dbs[db_index] = db;
+      }
+
+      if (libretrodb_read_entry(index->dbs[db_index],
+               matches[i].offset, &item) != 0)
+         continue;
+
+      database_info_parse_item(&item, &list->list[i], NULL);
+
+      rmsgpack_dom_value_free(&item);
+   }
+
+   return list;
 }
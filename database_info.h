@@ -98,10 +98,41 @@ typedef struct
 } database_info_list_t;
 
 database_info_list_t *database_info_list_new(const char *rdb_path,
-      const char *query);
+      const char *query, const char **fields);
 
 void database_info_list_free(database_info_list_t *list);
 
+/* In-memory index of the crc and serial fields of one or
+ * more databases. */
+typedef struct database_info_index database_info_index_t;
+
+typedef struct
+{
+   unsigned db;
+   uint64_t offset;
+} database_info_index_match_t;
+
+database_info_index_t *database_info_index_new(void);
+
+int database_info_index_add(database_info_index_t *index,
+      const char *rdb_path);
+
+void database_info_index_free(database_info_index_t *index);
+
+size_t database_info_index_find_crc(const database_info_index_t *index,
+      uint32_t crc, database_info_index_match_t *matches,
+      size_t max_matches);
+
+size_t database_info_index_find_serial(const database_info_index_t *index,
+      const char *serial, database_info_index_match_t *matches,
+      size_t max_matches);
+
+const char *database_info_index_get_path(const database_info_index_t *index,
+      unsigned db);
+
+database_info_list_t *database_info_index_read(database_info_index_t *index,
+      const database_info_index_match_t *matches, size_t num_matches);
+
 database_info_handle_t *database_info_dir_init(const char *dir,
       enum database_type type);
 
@@ -28,6 +28,7 @@
 #include <compat/strl.h>
 #include <compat/posix_string.h>
 #include <retro_assert.h>
+#include <retro_log.h>
 #include <retro_miscellaneous.h>
 #include <file/file_path.h>
 #include <retro_file.h>
@@ -35,6 +36,9 @@
 #ifdef HAVE_COMPRESSION
 #include <file/file_extract.h>
 #endif
+#ifdef HAVE_ZLIB
+#include <compat/zlib.h>
+#endif
 
 #include "file_ops.h"
 
@@ -193,7 +197,7 @@ static SRes ConvertUtf16toCharString(const uint16_t *s, char *outstring)
 static int read_7zip_file(
       const char *archive_path,
       const char *relative_path, void **buf,
-      const char *optional_outfile)
+      const char *optional_outfile, uint32_t *crc)
 {
    CFileInStream archiveStream;
    CLookToRead lookStream;
@@ -283,6 +287,11 @@ static int read_7zip_file(
                break; /* This goes to the error section. */
 
             outsize = outSizeProcessed;
+
+            /* SzArEx_Extract() already checked the CRC if there is one. */
+            if (crc)
+               *crc = f->CrcDefined ? f->Crc
+                  : CrcCalc(output + offset, outsize);
             
             if (optional_outfile != NULL)
             {
@@ -490,7 +499,7 @@ error:
 
 static int read_zip_file(const char *archive_path,
       const char *relative_path, void **buf,
-      const char* optional_outfile)
+      const char* optional_outfile, uint32_t *crc)
 {
    uLong i;
    unz_global_info global_info;
@@ -527,6 +536,8 @@ static int read_zip_file(const char *archive_path,
       if ( last_char == '/' || last_char == '\\' ) { }
       else if (!strcmp(filename, relative_path))
       {
+         bool crc_checked;
+
          /* We found the correct file in the zip, 
           * now extract it to *buf. */
          if (unzOpenCurrentFile(zipfile) != UNZ_OK )
@@ -574,13 +585,19 @@ static int read_zip_file(const char *archive_path,
 
             retro_fclose(outsink);
          }
-         finished_reading = true;
-      }
 
-      unzCloseCurrentFile(zipfile);
+         /* unzip computes the CRC while inflating and checks it
+          * against the archive when the file gets closed. */
+         crc_checked = unzCloseCurrentFile(zipfile) == UNZ_OK;
+
+         if (crc && optional_outfile == 0)
+            *crc = crc_checked ? file_info.crc :
+               zlib_crc32_calculate((const uint8_t*)*buf,
+                     file_info.uncompressed_size);
 
-      if (finished_reading)
+         finished_reading = true;
          break;
+      }
 
       if ((i + 1) < global_info.number_entry)
       {
@@ -609,12 +626,8 @@ error:
 #endif
 
 #ifdef HAVE_COMPRESSION
-/* Generic compressed file loader.
- * Extracts to buf, unless optional_filename != 0
- * Then extracts to optional_filename and leaves buf alone.
- */
-int read_compressed_file(const char * path, void **buf,
-      const char* optional_filename, ssize_t *length)
+static int read_compressed_file_crc(const char * path, void **buf,
+      const char* optional_filename, ssize_t *length, uint32_t *crc)
 {
    const char* file_ext               = NULL;
    char *archive_found                = NULL;
@@ -665,7 +678,7 @@ int read_compressed_file(const char * path, void **buf,
 #ifdef HAVE_7ZIP
    if (strcasecmp(file_ext,"7z") == 0)
    {
-      *length = read_7zip_file(archive_path,archive_found,buf,optional_filename);
+      *length = read_7zip_file(archive_path,archive_found,buf,optional_filename,crc);
       if (*length != -1)
          return 1;
    }
@@ -673,13 +686,24 @@ int read_compressed_file(const char * path, void **buf,
 #ifdef HAVE_ZLIB
    if (strcasecmp(file_ext,"zip") == 0)
    {
-      *length = read_zip_file(archive_path,archive_found,buf,optional_filename);
+      *length = read_zip_file(archive_path,archive_found,buf,optional_filename,crc);
       if (*length != -1)
          return 1;
    }
 #endif
    return 0;
 }
+
+/* Generic compressed file loader.
+ * Extracts to buf, unless optional_filename != 0
+ * Then extracts to optional_filename and leaves buf alone.
+ */
+int read_compressed_file(const char * path, void **buf,
+      const char* optional_filename, ssize_t *length)
+{
+   return read_compressed_file_crc(path, buf, optional_filename,
+         length, NULL);
+}
 #endif
 
 /**
@@ -706,6 +730,91 @@ int read_file(const char *path, void **buf, ssize_t *length)
    return retro_read_file(path, buf, length);
 }
 
+/* Content is read and checksummed in chunks of this size, so that
+ * each chunk is still in cache when its CRC gets computed. */
+#define READ_FILE_CRC32_CHUNK_SIZE (256 * 1024)
+
+/**
+ * read_file_crc32:
+ * @path             : path to file.
+ * @buf              : buffer to allocate and read the contents of the
+ *                     file into. Needs to be freed manually.
+ * @length           : Number of items read, -1 on error.
+ * @crc              : CRC32 of the contents.
+ *
+ * Same as read_file(), also working out the CRC32 of the file
+ * while reading it instead of in another pass over the buffer.
+ * Files inside archives get the CRC32 the archive holds for them,
+ * which was checked while extracting.
+ *
+ * Returns: 1 if file read, 0 on error.
+ */
+int read_file_crc32(const char *path, void **buf, ssize_t *length,
+      uint32_t *crc)
+{
+   ssize_t size     = 0;
+   ssize_t offset   = 0;
+   uint8_t *content = NULL;
+   RFILE *file      = NULL;
+
+   *crc = 0;
+
+#ifdef HAVE_COMPRESSION
+   if (path_contains_compressed_file(path))
+   {
+      if (read_compressed_file_crc(path, buf, NULL, length, crc))
+         return 1;
+   }
+#endif
+
+   if (!(file = retro_fopen(path, RFILE_MODE_READ, -1)))
+      goto error;
+
+   if (retro_fseek(file, 0, SEEK_END) != 0)
+      goto error;
+
+   if ((size = retro_ftell(file)) < 0)
+      goto error;
+
+   retro_frewind(file);
+
+   if (!(content = (uint8_t*)malloc(size + 1)))
+      goto error;
+
+   while (offset < size)
+   {
+      ssize_t chunk = min(size - offset, READ_FILE_CRC32_CHUNK_SIZE);
+      ssize_t ret   = retro_fread(file, content + offset, chunk);
+
+      if (ret <= 0)
+         break;
+
+#ifdef HAVE_ZLIB
+      *crc = crc32(*crc, content + offset, ret);
+#endif
+      offset += ret;
+   }
+
+   if (offset < size)
+      RARCH_WARN("Didn't read whole file: %s.\n", path);
+
+   retro_fclose(file);
+
+   /* Allow for easy reading of strings to be safe. */
+   content[offset] = '\0';
+
+   *buf    = content;
+   *length = offset;
+   return 1;
+
+error:
+   if (file)
+      retro_fclose(file);
+   free(content);
+   *length = -1;
+   return 0;
+}
+
 struct string_list *compressed_file_list_new(const char *path,
       const char* ext)
 {
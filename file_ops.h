@@ -51,6 +51,24 @@ int read_compressed_file(const char * path, void **buf,
  */
 int read_file(const char *path, void **buf, ssize_t *length);
 
+/**
+ * read_file_crc32:
+ * @path             : path to file.
+ * @buf              : buffer to allocate and read the contents of the
+ *                     file into. Needs to be freed manually.
+ * @length           : Number of items read, -1 on error.
+ * @crc              : CRC32 of the contents.
+ *
+ * Same as read_file(), also working out the CRC32 of the file
+ * while reading it instead of in another pass over the buffer.
+ * Files inside archives get the CRC32 the archive holds for them,
+ * which was checked while extracting.
+ *
+ * Returns: 1 if file read, 0 on error.
+ */
+int read_file_crc32(const char *path, void **buf, ssize_t *length,
+      uint32_t *crc);
+
 /**
  * write_file:
  * @path             : path to file.
@@ -17,6 +17,7 @@
 #include <string.h>
 
 #include <string/string_list.h>
+#include <memalign.h>
 
 #include "video_thread_wrapper.h"
 #include "video_pixel_converter.h"
@@ -56,6 +57,21 @@ typedef struct video_driver_state
       unsigned out_bpp;
       bool out_rgb32;
    } filter;
+
+   struct
+   {
+      /* Fallback buffer for drivers which cannot hand out
+       * their own memory. */
+      void *pool;
+      size_t pool_size;
+      /* Last buffer handed out to the core. */
+      const void *data;
+   } framebuffer;
+
+#ifdef HAVE_THREADS
+   /* Shared by the frame-level stages, such as softfilters. */
+   thread_pool_t *thread_pool;
+#endif
 } video_driver_state_t;
 
 static video_driver_state_t video_state;
@@ -284,6 +300,81 @@ uintptr_t video_driver_get_current_framebuffer(void)
    return 0;
 }
 
+static void deinit_video_framebuffer(void)
+{
+   /* The buffer might be gone with the driver, don't
+    * let the cached frame point into it. */
+   if (video_state.framebuffer.data
+         && video_state.frame_cache.data == video_state.framebuffer.data)
+      video_state.frame_cache.data = NULL;
+
+   if (video_state.framebuffer.pool)
+      memalign_free(video_state.framebuffer.pool);
+   video_state.framebuffer.pool      = NULL;
+   video_state.framebuffer.pool_size = 0;
+   video_state.framebuffer.data      = NULL;
+}
+
+bool video_driver_get_current_software_framebuffer(
+      struct retro_framebuffer *framebuffer)
+{
+   size_t pitch, size;
+   driver_t                   *driver = driver_get_ptr();
+   const video_poke_interface_t *poke = video_driver_get_poke_ptr(driver);
+
+   if (!framebuffer || !driver->video_data)
+      return false;
+   if (!framebuffer->width || !framebuffer->height)
+      return false;
+   if (video_state.hw_render_callback.context_type != RETRO_HW_CONTEXT_NONE)
+      return false;
+
+   /* A softfilter writes into its own buffer anyway,
+    * let the core keep rendering into its own memory. */
+   if (video_state.filter.filter)
+      return false;
+
+   /* Hand out the format the video driver was set up with,
+    * so 0RGB1555 cores can skip the conversion pass. */
+   framebuffer->format = 
+      (video_state.pix_fmt == RETRO_PIXEL_FORMAT_XRGB8888) ?
+      RETRO_PIXEL_FORMAT_XRGB8888 : RETRO_PIXEL_FORMAT_RGB565;
+   framebuffer->memory_flags = RETRO_MEMORY_TYPE_CACHED;
+
+   if (poke && poke->get_current_software_framebuffer
+         && poke->get_current_software_framebuffer(
+            driver->video_data, framebuffer))
+   {
+      video_state.framebuffer.data = framebuffer->data;
+      return true;
+   }
+
+   pitch = framebuffer->width *
+      ((framebuffer->format == RETRO_PIXEL_FORMAT_XRGB8888) ?
+       sizeof(uint32_t) : sizeof(uint16_t));
+   size  = pitch * framebuffer->height;
+
+   if (size > video_state.framebuffer.pool_size)
+   {
+      deinit_video_framebuffer();
+
+      video_state.framebuffer.pool = memalign_alloc(64, size);
+      if (!video_state.framebuffer.pool)
+         return false;
+      video_state.framebuffer.pool_size = size;
+   }
+
+   framebuffer->data            = video_state.framebuffer.pool;
+   framebuffer->pitch           = pitch;
+   video_state.framebuffer.data = framebuffer->data;
+   return true;
+}
+
+bool video_driver_is_software_framebuffer(const void *data)
+{
+   return data && data == video_state.framebuffer.data;
+}
+
 static uint64_t video_frame_count;
 
 uint64_t *video_driver_get_frame_count(void)
@@ -352,7 +443,8 @@ static void init_video_filter(enum retro_pixel_format colfmt)
 
    video_state.filter.filter = rarch_softfilter_new(
          settings->video.softfilter_plugin,
-         RARCH_SOFTFILTER_THREADS_AUTO, colfmt, width, height);
+         RARCH_SOFTFILTER_THREADS_AUTO, video_driver_get_thread_pool(),
+         colfmt, width, height);
 
    if (!video_state.filter.filter)
    {
@@ -441,6 +533,13 @@ void uninit_video_input(void)
 
    deinit_video_filter();
 
+   deinit_video_framebuffer();
+
+#ifdef HAVE_THREADS
+   thread_pool_free(video_state.thread_pool);
+   video_state.thread_pool = NULL;
+#endif
+
    video_driver_unset_callback();
    event_command(EVENT_CMD_SHADER_DIR_DEINIT);
    video_monitor_compute_fps_statistics();
@@ -460,6 +559,13 @@ void init_video(void)
    struct retro_system_av_info *av_info =
       video_viewport_get_system_av_info();
 
+#ifdef HAVE_THREADS
+   /* Created before the driver, so a threaded driver
+    * never races the main thread to create it. */
+   if (!video_state.thread_pool && retro_get_cpu_cores() > 1)
+      video_state.thread_pool = thread_pool_new(retro_get_cpu_cores());
+#endif
+
    init_video_filter(video_state.pix_fmt);
    event_command(EVENT_CMD_SHADER_DIR_INIT);
 
@@ -1224,6 +1330,24 @@ void *video_driver_frame_filter_get_buf_ptr(void)
    return video_state.filter.buffer;
 }
 
+/**
+ * video_driver_get_thread_pool:
+ *
+ * Gets the thread pool shared by frame-level stages. It is
+ * created with one thread per CPU core by init_video().
+ *
+ * Returns: thread pool, or NULL if there is only one core
+ * or threads are unavailable.
+ **/
+thread_pool_t *video_driver_get_thread_pool(void)
+{
+#ifdef HAVE_THREADS
+   return video_state.thread_pool;
+#else
+   return NULL;
+#endif
+}
+
 enum retro_pixel_format video_driver_get_pixel_format(void)
 {
    return video_state.pix_fmt;
@@ -124,6 +124,11 @@ typedef struct video_poke_interface
    void (*grab_mouse_toggle)(void *data);
 
    struct video_shader *(*get_current_shader)(void *data);
+
+   /* Hand out a buffer the core can render the next frame into.
+    * Used by RETRO_ENVIRONMENT_GET_CURRENT_SOFTWARE_FRAMEBUFFER. */
+   bool (*get_current_software_framebuffer)(void *data,
+         struct retro_framebuffer *framebuffer);
 } video_poke_interface_t;
 
 typedef struct video_driver
@@ -267,6 +272,30 @@ void *video_driver_get_ptr(const video_driver_t **drv);
  **/
 uintptr_t video_driver_get_current_framebuffer(void);
 
+/**
+ * video_driver_get_current_software_framebuffer:
+ * @framebuffer        : Framebuffer to fill in. width, height and
+ *                       access_flags are set by the core.
+ *
+ * Hands out a frontend-owned buffer the core can render into.
+ * Frames submitted from it skip the pixel conversion and, with the
+ * threaded video wrapper, the copy into the video thread's frame.
+ * Used by RETRO_ENVIRONMENT_GET_CURRENT_SOFTWARE_FRAMEBUFFER.
+ *
+ * Returns: true (1) if @framebuffer was filled in, otherwise false (0).
+ **/
+bool video_driver_get_current_software_framebuffer(
+      struct retro_framebuffer *framebuffer);
+
+/**
+ * video_driver_is_software_framebuffer:
+ * @data               : Frame data passed to the video refresh callback.
+ *
+ * Returns: true (1) if @data is the buffer last handed out by
+ * video_driver_get_current_software_framebuffer(), otherwise false (0).
+ **/
+bool video_driver_is_software_framebuffer(const void *data);
+
 retro_proc_address_t video_driver_get_proc_address(const char *sym);
 
 bool video_driver_set_shader(enum rarch_shader_type type,
@@ -382,6 +411,8 @@ bool video_driver_cached_frame_has_valid_fb(void);
 
 uint64_t *video_driver_get_frame_count(void);
 
+thread_pool_t *video_driver_get_thread_pool(void);
+
 #ifdef __cplusplus
 }
 #endif
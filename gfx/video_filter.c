@@ -15,6 +15,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <file/config_file_userdata.h>
 #include <file/file_path.h>
@@ -35,46 +36,16 @@ struct rarch_soft_plug
    const struct softfilter_implementation *impl;
 };
 
-#ifdef HAVE_THREADS
-#include <rthreads/rthreads.h>
+/* Row tiles queued per pool thread, so threads that finish
+ * early can steal work from the others. */
+#define SOFTFILTER_TILES_PER_THREAD 4
 
-struct filter_thread_data
-{
-   sthread_t *thread;
-   const struct softfilter_work_packet *packet;
-   scond_t *cond;
-   slock_t *lock;
-   void *userdata;
-   bool die;
-   bool done;
-};
+/* Counters stay registered after the filter is gone,
+ * so they live here rather than in rarch_softfilter. */
+#define SOFTFILTER_MAX_PERF 16
 
-static void filter_thread_loop(void *data)
-{
-   struct filter_thread_data *thr = (struct filter_thread_data*)data;
-
-   for (;;)
-   {
-      bool die;
-      slock_lock(thr->lock);
-      while (thr->done && !thr->die)
-         scond_wait(thr->cond, thr->lock);
-      die = thr->die;
-      slock_unlock(thr->lock);
-
-      if (die)
-         break;
-
-      if (thr->packet && thr->packet->work)
-         thr->packet->work(thr->userdata, thr->packet->thread_data);
-
-      slock_lock(thr->lock);
-      thr->done = true;
-      scond_signal(thr->cond);
-      slock_unlock(thr->lock);
-   }
-}
-#endif
+static struct retro_perf_counter softfilter_perf[SOFTFILTER_MAX_PERF];
+static char softfilter_perf_ident[SOFTFILTER_MAX_PERF][64];
 
 struct rarch_softfilter
 {
@@ -92,11 +63,37 @@ struct rarch_softfilter
    struct softfilter_work_packet *packets;
    unsigned threads;
 
-#ifdef HAVE_THREADS
-   struct filter_thread_data *thread_data;
-#endif
+   thread_pool_t *pool;
+   struct retro_perf_counter *perf;
 };
 
+/**
+ * softfilter_get_perf:
+ * @ident               : short identifier of the filter.
+ *
+ * Returns: performance counter timing filters called @ident,
+ * or NULL if all counters are in use.
+ **/
+static struct retro_perf_counter *softfilter_get_perf(const char *ident)
+{
+   unsigned i;
+
+   for (i = 0; i < SOFTFILTER_MAX_PERF; i++)
+   {
+      if (!*softfilter_perf_ident[i])
+      {
+         snprintf(softfilter_perf_ident[i], sizeof(softfilter_perf_ident[i]),
+               "softfilter_%s", ident);
+         return &softfilter_perf[i];
+      }
+
+      if (!strcmp(softfilter_perf_ident[i] + strlen("softfilter_"), ident))
+         return &softfilter_perf[i];
+   }
+
+   return NULL;
+}
+
 static const struct softfilter_implementation *
 softfilter_find_implementation(rarch_softfilter_t *filt, const char *ident)
 {
@@ -127,6 +124,7 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
       unsigned threads)
 {
    unsigned input_fmts, input_fmt, output_fmts, i = 0;
+   unsigned pool_threads = 1;
    struct config_file_userdata userdata;
    char key[64]  = {0};
    char name[64] = {0};
@@ -198,11 +196,18 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
    filt->max_width = max_width;
    filt->max_height = max_height;
 
+#ifdef HAVE_THREADS
+   if (filt->pool)
+      pool_threads = thread_pool_get_threads(filt->pool);
+#endif
+
+   if (threads == RARCH_SOFTFILTER_THREADS_AUTO)
+      threads = pool_threads > 1 ?
+         pool_threads * SOFTFILTER_TILES_PER_THREAD : 1;
+
    filt->impl_data = filt->impl->create(
          &softfilter_config, input_fmt, input_fmt, max_width, max_height,
-         threads != RARCH_SOFTFILTER_THREADS_AUTO ? threads : 
-         retro_get_cpu_cores(), cpu_features,
-         &userdata);
+         threads, cpu_features, &userdata);
    if (!filt->impl_data)
    {
       RARCH_ERR("Failed to create softfilter state.\n");
@@ -216,7 +221,8 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
       return false;
    }
 
-   RARCH_LOG("Using %u threads for softfilter.\n", threads);
+   RARCH_LOG("Using %u tiles on %u threads for softfilter.\n",
+         threads, pool_threads);
 
    filt->packets = (struct softfilter_work_packet*)
       calloc(threads, sizeof(*filt->packets));
@@ -226,30 +232,11 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
       return false;
    }
 
-#ifdef HAVE_THREADS
-   filt->thread_data = (struct filter_thread_data*)
-      calloc(threads, sizeof(*filt->thread_data));
-   if (!filt->thread_data)
-      return false;
    filt->threads = threads;
-
-   for (i = 0; i < threads; i++)
-   {
-      filt->thread_data[i].userdata = filt->impl_data;
-      filt->thread_data[i].done = true;
-
-      filt->thread_data[i].lock = slock_new();
-      if (!filt->thread_data[i].lock)
-         return false;
-      filt->thread_data[i].cond = scond_new();
-      if (!filt->thread_data[i].cond)
-         return false;
-      filt->thread_data[i].thread = sthread_create(
-            filter_thread_loop, &filt->thread_data[i]);
-      if (!filt->thread_data[i].thread)
-         return false;
-   }
-#endif
+   filt->perf    = softfilter_get_perf(filt->impl->short_ident);
+   if (filt->perf)
+      rarch_perf_init(filt->perf,
+            softfilter_perf_ident[filt->perf - softfilter_perf]);
 
    return true;
 }
@@ -375,7 +362,7 @@ static bool append_softfilter_plugs(rarch_softfilter_t *filt,
 #endif
 
 rarch_softfilter_t *rarch_softfilter_new(const char *filter_config,
-      unsigned threads,
+      unsigned threads, thread_pool_t *pool,
       enum retro_pixel_format in_pixel_format,
       unsigned max_width, unsigned max_height)
 {
@@ -390,6 +377,8 @@ rarch_softfilter_t *rarch_softfilter_new(const char *filter_config,
    if (!filt)
       return NULL;
 
+   filt->pool = pool;
+
    filt->conf = config_file_new(filter_config);
    if (!filt->conf)
    {
@@ -455,21 +444,6 @@ void rarch_softfilter_free(rarch_softfilter_t *filt)
    free(filt->plugs);
 #endif
 
-#ifdef HAVE_THREADS
-   for (i = 0; i < filt->threads; i++)
-   {
-      if (!filt->thread_data[i].thread)
-         continue;
-      slock_lock(filt->thread_data[i].lock);
-      filt->thread_data[i].die = true;
-      scond_signal(filt->thread_data[i].cond);
-      slock_unlock(filt->thread_data[i].lock);
-      sthread_join(filt->thread_data[i].thread);
-      slock_free(filt->thread_data[i].lock);
-      scond_free(filt->thread_data[i].cond);
-   }
-   free(filt->thread_data);
-#endif
    free(filt);
 }
 
@@ -495,44 +469,41 @@ enum retro_pixel_format rarch_softfilter_get_output_format(
    return filt->out_pix_fmt;
 }
 
+static void softfilter_run_packet(void *data, unsigned index)
+{
+   rarch_softfilter_t *filt = (rarch_softfilter_t*)data;
+
+   if (filt->packets[index].work)
+      filt->packets[index].work(filt->impl_data,
+            filt->packets[index].thread_data);
+}
+
 void rarch_softfilter_process(rarch_softfilter_t *filt,
       void *output, size_t output_stride,
       const void *input, unsigned width, unsigned height, size_t input_stride)
 {
    unsigned i;
 
-   if (filt && filt->impl && filt->impl->get_work_packets)
-      filt->impl->get_work_packets(filt->impl_data, filt->packets,
-            output, output_stride, input, width, height, input_stride);
-   
+   if (!filt || !filt->impl || !filt->impl->get_work_packets)
+      return;
+
+   retro_perf_start(filt->perf);
+
+   filt->impl->get_work_packets(filt->impl_data, filt->packets,
+         output, output_stride, input, width, height, input_stride);
+
 #ifdef HAVE_THREADS
-   /* Fire off workers */
-   for (i = 0; i < filt->threads; i++)
+   if (filt->pool)
    {
-#if 0
-      RARCH_LOG("Firing off filter thread %u ...\n", i);
-#endif
-      filt->thread_data[i].packet = &filt->packets[i];
-      slock_lock(filt->thread_data[i].lock);
-      filt->thread_data[i].done = false;
-      scond_signal(filt->thread_data[i].cond);
-      slock_unlock(filt->thread_data[i].lock);
+      thread_pool_run(filt->pool, softfilter_run_packet,
+            filt, filt->threads);
+      retro_perf_stop(filt->perf);
+      return;
    }
-
-   /* Wait for workers */
-   for (i = 0; i < filt->threads; i++)
-   {
-#if 0
-      RARCH_LOG("Waiting for filter thread %u ...\n", i);
 #endif
-      slock_lock(filt->thread_data[i].lock);
-      while (!filt->thread_data[i].done)
-         scond_wait(filt->thread_data[i].cond, filt->thread_data[i].lock);
-      slock_unlock(filt->thread_data[i].lock);
-   }
-#else
+
    for (i = 0; i < filt->threads; i++)
-      filt->packets[i].work(filt->impl_data, filt->packets[i].thread_data);
-#endif
-}
+      softfilter_run_packet(filt, i);
 
+   retro_perf_stop(filt->perf);
+}
@@ -20,11 +20,26 @@
 #include "../libretro.h"
 #include <stddef.h>
 
+#include <rthreads/thread_pool.h>
+
 #define RARCH_SOFTFILTER_THREADS_AUTO 0
 typedef struct rarch_softfilter rarch_softfilter_t;
 
+/**
+ * rarch_softfilter_new:
+ * @filter_path         : path to the filter config.
+ * @threads             : number of row tiles to split frames into,
+ *                        or RARCH_SOFTFILTER_THREADS_AUTO.
+ * @pool                : thread pool running the tiles, or NULL
+ *                        to run them on the calling thread.
+ * @in_pixel_format     : pixel format of the input frames.
+ * @max_width           : maximum width of the input frames.
+ * @max_height          : maximum height of the input frames.
+ *
+ * Returns: new softfilter if successful, otherwise NULL.
+ **/
 rarch_softfilter_t *rarch_softfilter_new(const char *filter_path,
-      unsigned threads,
+      unsigned threads, thread_pool_t *pool,
       enum retro_pixel_format in_pixel_format,
       unsigned max_width, unsigned max_height);
 
@@ -233,7 +233,7 @@ static void *twoxbr_generic_create(const struct softfilter_config *config,
       return NULL;
    filt->workers = (struct softfilter_thread_data*)
       calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
    if (!filt->workers)
    {
@@ -563,7 +563,10 @@ static void twoxbr_generic_xrgb8888(void *data, unsigned width, unsigned height,
 
    (void)filt;
 
-   nextline = (last) ? 0 : src_stride;
+   /* Only the current row is sampled. The whole frame used to be
+    * a single packet with 'last' set, so nextline was always 0,
+    * and row tiles must not change the output. */
+   nextline = 0;
    
    for (; height; height--)
    {
@@ -622,7 +625,7 @@ static void twoxbr_generic_rgb565(void *data, unsigned width, unsigned height,
    uint16_t pg_green_mask   = GREEN_MASK565;
    uint16_t pg_blue_mask    = BLUE_MASK565;
    uint16_t pg_lbmask       = PG_LBMASK565;
-   unsigned nextline        = (last) ? 0 : src_stride;
+   unsigned nextline        = 0;
  
    for (; height; height--)
    {
@@ -728,7 +731,7 @@ static void twoxbr_generic_packets(void *data,
  
       /* Workers need to know if they can access 
        * pixels outside their given buffer. */
-      thr->first = y_start;
+      thr->first = y_start == 0;
       thr->last = y_end == height;
  
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
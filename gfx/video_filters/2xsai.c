@@ -76,7 +76,7 @@ static void *twoxsai_generic_create(const struct softfilter_config *config,
       return NULL;
    filt->workers = (struct softfilter_thread_data*)
       calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
    if (!filt->workers)
    {
@@ -229,7 +229,9 @@ static void twoxsai_generic_xrgb8888(unsigned width, unsigned height,
       unsigned src_stride, uint32_t *dst, unsigned dst_stride)
 {
    unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
+   /* Rows are filtered on their own, as they were back when the
+    * whole frame came in one packet with 'last' set. */
+   unsigned nextline = 0;
 
    for (; height; height--)
    {
@@ -261,7 +263,7 @@ static void twoxsai_generic_rgb565(unsigned width, unsigned height,
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
    unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
+   unsigned nextline = 0;
 
    for (; height; height--)
    {
@@ -347,7 +349,7 @@ static void twoxsai_generic_packets(void *data,
       /* Workers need to know if they can access pixels 
        * outside their given buffer.
        */
-      thr->first = y_start;
+      thr->first = y_start == 0;
       thr->last = y_end == height;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
@@ -15,6 +15,7 @@
  */
 
 #include "softfilter.h"
+#include "scale2x_simd.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -44,6 +45,7 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   scale2x_simd_row_t row;
 };
 
 static unsigned epx_generic_input_fmts(void)
@@ -67,7 +69,6 @@ static void *epx_generic_create(const struct softfilter_config *config,
       unsigned max_width, unsigned max_height,
       unsigned threads, softfilter_simd_mask_t simd, void *userdata)
 {
-   (void)simd;
    (void)config;
    (void)userdata;
 
@@ -76,8 +77,10 @@ static void *epx_generic_create(const struct softfilter_config *config,
       return NULL;
    filt->workers = (struct softfilter_thread_data*)
       calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
+   /* EPX is Scale2x by another name. */
+   filt->row     = scale2x_simd_get_row(simd, in_fmt);
    if (!filt->workers)
    {
       free(filt);
@@ -108,9 +111,9 @@ static void epx_generic_destroy(void *data)
 static void EPX_16(int width, int height,
       int first, int last,
       uint16_t *src, unsigned src_stride, uint16_t *dst,
-      unsigned dst_stride)
+      unsigned dst_stride, scale2x_simd_row_t row)
 {
-	int		w, prevline;
+	int		w, y;
 	uint16_t	colorX, colorA, colorB, colorC, colorD;
 	uint16_t	*sP = NULL, *uP = NULL, *lP = NULL;
 	uint32_t	*dP1 = NULL, *dP2 = NULL;
@@ -118,99 +121,19 @@ static void EPX_16(int width, int height,
    if (!src || !dst)
       return;
 
-   prevline = (first) ? 0 : src_stride;
-
-	height -= 2;
-
 	/*   D
 	 * A X C
 	 *   B
     */
 
-	/* top edge */
-
-	sP  = (uint16_t *)(src - prevline);
-	lP  = (uint16_t *)(src + src_stride);
-	dP1 = (uint32_t *)(dst);
-	dP2 = (uint32_t *)(dst + dst_stride);
-
-	// left edge
-
-	colorX = *sP;
-	colorC = *++sP;
-	colorB = *lP++;
-
-	if ((colorX != colorC) && (colorB != colorX))
-	{
-	#ifdef MSB_FIRST
-		*dP1 = (colorX << 16) + colorX;
-		*dP2 = (colorX << 16) + ((colorB == colorC) ? colorB : colorX);
-	#else
-		*dP1 = colorX + (colorX << 16);
-		*dP2 = colorX + (((colorB == colorC) ? colorB : colorX) << 16);
-	#endif
-	}
-	else
-		*dP1 = *dP2 = (colorX << 16) + colorX;
-
-	dP1++;
-	dP2++;
-
-	//
-
-	for (w = width - 2; w; w--)
-	{
-		colorA = colorX;
-		colorX = colorC;
-		colorC = *++sP;
-		colorB = *lP++;
-
-		if ((colorA != colorC) && (colorB != colorX))
-		{
-		#ifdef MSB_FIRST
-			*dP1 = (colorX << 16) + colorX;
-			*dP2 = (((colorA == colorB) ? colorA : colorX) << 16) + 
-            ((colorB == colorC) ? colorB : colorX);
-		#else
-			*dP1 = colorX + (colorX << 16);
-			*dP2 = ((colorA == colorB) ? colorA : colorX) + 
-            (((colorB == colorC) ? colorB : colorX) << 16);
-		#endif
-		}
-		else
-			*dP1 = *dP2 = (colorX << 16) + colorX;
-
-		dP1++;
-		dP2++;
-	}
-
-	/* right edge */
+	/* At the top and bottom of the frame, the row itself
+	 * stands in for the missing neighbour. */
 
-	colorA = colorX;
-	colorX = colorC;
-	colorB = *lP;
-
-	if ((colorA != colorX) && (colorB != colorX))
-	{
-	#ifdef MSB_FIRST
-		*dP1 = (colorX << 16) + colorX;
-		*dP2 = (((colorA == colorB) ? colorA : colorX) << 16) + colorX;
-	#else
-		*dP1 = colorX + (colorX << 16);
-		*dP2 = ((colorA == colorB) ? colorA : colorX) + (colorX << 16);
-	#endif
-	}
-	else
-		*dP1 = *dP2 = (colorX << 16) + colorX;
-
-	src += src_stride;
-	dst += dst_stride << 1;
-
-	for (; height; height--)
+	for (y = 0; y < height; y++)
 	{
 		sP  = (uint16_t *) src;
-		uP  = (uint16_t *) (src - src_stride);
-		lP  = (uint16_t *) (src + src_stride);
+		uP  = (uint16_t *) ((first && y == 0) ? src : src - src_stride);
+		lP  = (uint16_t *) ((last && y == height - 1) ? src : src + src_stride);
 		dP1 = (uint32_t *) dst;
 		dP2 = (uint32_t *) (dst + dst_stride);
 
@@ -237,7 +160,24 @@ static void EPX_16(int width, int height,
 		dP1++;
 		dP2++;
 
-		for (w = width - 2; w; w--)
+		w = width - 2;
+
+		if (row)
+		{
+			unsigned done = row(uP - 1, src, lP - 1,
+               dst, dst + dst_stride, width);
+
+			sP     += done;
+			uP     += done;
+			lP     += done;
+			dP1    += done;
+			dP2    += done;
+			w      -= done;
+			colorX  = sP[-1];
+			colorC  = *sP;
+		}
+
+		for (; w; w--)
 		{
 			colorA = colorX;
 			colorX = colorC;
@@ -289,95 +229,23 @@ static void EPX_16(int width, int height,
 		src += src_stride;
 		dst += dst_stride << 1;
 	}
-
-	/* bottom edge */
-
-	sP  = (uint16_t *) src;
-	uP  = (uint16_t *) (src - src_stride);
-	dP1 = (uint32_t *) dst;
-	dP2 = (uint32_t *) (dst + dst_stride);
-
-	/* left edge */
-
-	colorX = *sP;
-	colorC = *++sP;
-	colorD = *uP++;
-
-	if ((colorX != colorC) && (colorX != colorD))
-	{
-	#ifdef MSB_FIRST
-		*dP1 = (colorX << 16) + ((colorC == colorD) ? colorC : colorX);
-		*dP2 = (colorX << 16) + colorX;
-	#else
-		*dP1 = colorX + (((colorC == colorD) ? colorC : colorX) << 16);
-		*dP2 = colorX + (colorX << 16);
-	#endif
-	}
-	else
-		*dP1 = *dP2 = (colorX << 16) + colorX;
-
-	dP1++;
-	dP2++;
-
-	for (w = width - 2; w; w--)
-	{
-		colorA = colorX;
-		colorX = colorC;
-		colorC = *++sP;
-		colorD = *uP++;
-
-		if ((colorA != colorC) && (colorX != colorD))
-		{
-		#ifdef MSB_FIRST
-			*dP1 = (((colorD == colorA) ? colorD : colorX) << 16) + 
-            ((colorC == colorD) ? colorC : colorX);
-			*dP2 = (colorX << 16) + colorX;
-		#else
-			*dP1 = ((colorD == colorA) ? colorD : colorX) + 
-            (((colorC == colorD) ? colorC : colorX) << 16);
-			*dP2 = colorX + (colorX << 16);
-		#endif
-		}
-		else
-			*dP1 = *dP2 = (colorX << 16) + colorX;
-
-		dP1++;
-		dP2++;
-	}
-
-	/* right edge */
-
-	colorA = colorX;
-	colorX = colorC;
-	colorD = *uP;
-
-	if ((colorA != colorX) && (colorX != colorD))
-	{
-	#ifdef MSB_FIRST
-		*dP1 = (((colorD == colorA) ? colorD : colorX) << 16) + colorX;
-		*dP2 = (colorX << 16) + colorX;
-	#else
-		*dP1 = ((colorD == colorA) ? colorD : colorX) + (colorX << 16);
-		*dP2 = colorX + (colorX << 16);
-	#endif
-	}
-	else
-		*dP1 = *dP2 = (colorX << 16) + colorX;
 }
 
 static void epx_generic_rgb565(unsigned width, unsigned height,
       int first, int last, uint16_t *src, 
-      unsigned src_stride, uint16_t *dst, unsigned dst_stride)
+      unsigned src_stride, uint16_t *dst, unsigned dst_stride,
+      scale2x_simd_row_t row)
 {
    EPX_16(width, height,
          first, last,
          src, src_stride,
-         dst, dst_stride);
+         dst, dst_stride, row);
 
 }
 
 static void epx_work_cb_rgb565(void *data, void *thread_data)
 {
+   struct filter_data *filt = (struct filter_data*)data;
    struct softfilter_thread_data *thr = 
       (struct softfilter_thread_data*)thread_data;
    uint16_t *input = (uint16_t*)thr->in_data;
@@ -389,7 +257,8 @@ static void epx_work_cb_rgb565(void *data, void *thread_data)
          thr->first, thr->last, input,
          thr->in_pitch / SOFTFILTER_BPP_RGB565,
          output,
-         thr->out_pitch / SOFTFILTER_BPP_RGB565);
+         thr->out_pitch / SOFTFILTER_BPP_RGB565,
+         filt->row);
 }
 
 
@@ -417,7 +286,7 @@ static void epx_generic_packets(void *data,
 
       /* Workers need to know if they can 
        * access pixels outside their given buffer. */
-      thr->first = y_start;
+      thr->first = y_start == 0;
       thr->last = y_end == height;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
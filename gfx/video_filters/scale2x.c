@@ -17,6 +17,7 @@
 // Compile: gcc -o scale2x.so -shared scale2x.c -std=c99 -O3 -Wall -pedantic -fPIC
 
 #include "softfilter.h"
+#include "scale2x_simd.h"
 #include <stdlib.h>
 
 #ifdef RARCH_INTERNAL
@@ -45,13 +46,16 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   scale2x_simd_row_t row;
 };
 
-#define SCALE2X_GENERIC(typename_t, width, height, first, last, src, src_stride, dst, dst_stride, out0, out1) \
+#define SCALE2X_GENERIC(typename_t, width, height, first, last, src, src_stride, dst, dst_stride, out0, out1, row) \
    for (y = 0; y < height; ++y) \
    { \
       const int prevline = ((y == 0) && first) ? 0 : src_stride; \
       const int nextline = ((y == height - 1) && last) ? 0 : src_stride; \
+      const unsigned done = row ? row(src - prevline, src, \
+            src + nextline, out0, out1, width) : 0; \
       \
       for (x = 0; x < width; ++x) \
       { \
@@ -75,6 +79,15 @@ struct filter_data
             *out1++ = C; \
             *out1++ = C; \
          } \
+         \
+         /* Skip over the columns done by the SIMD kernel. */ \
+         if (x == 0 && done) \
+         { \
+            x    += done; \
+            src  += done; \
+            out0 += done * SCALE2X_SCALE; \
+            out1 += done * SCALE2X_SCALE; \
+         } \
       } \
       \
       src += src_stride - width; \
@@ -85,27 +98,27 @@ struct filter_data
 static void scale2x_generic_rgb565(unsigned width, unsigned height,
       int first, int last,
       const uint16_t *src, unsigned src_stride,
-      uint16_t *dst, unsigned dst_stride)
+      uint16_t *dst, unsigned dst_stride, scale2x_simd_row_t row)
 {
    unsigned x, y;
    uint16_t *out0, *out1;
    out0 = (uint16_t*)dst;
    out1 = (uint16_t*)(dst + dst_stride);
    SCALE2X_GENERIC(uint16_t, width, height, first, last,
-         src, src_stride, dst, dst_stride, out0, out1);
+         src, src_stride, dst, dst_stride, out0, out1, row);
 }
 
 static void scale2x_generic_xrgb8888(unsigned width, unsigned height,
       int first, int last,
       const uint32_t *src, unsigned src_stride,
-      uint32_t *dst, unsigned dst_stride)
+      uint32_t *dst, unsigned dst_stride, scale2x_simd_row_t row)
 {
    unsigned x, y;
    uint32_t *out0 = (uint32_t*)dst;
    uint32_t *out1 = (uint32_t*)(dst + dst_stride);
 
    SCALE2X_GENERIC(uint32_t, width, height, first, last,
-         src, src_stride, dst, dst_stride, out0, out1);
+         src, src_stride, dst, dst_stride, out0, out1, row);
 }
 
 static unsigned scale2x_generic_input_fmts(void)
@@ -129,7 +142,6 @@ static void *scale2x_generic_create(const struct softfilter_config *config,
       unsigned max_width, unsigned max_height,
       unsigned threads, softfilter_simd_mask_t simd, void *userdata)
 {
-   (void)simd;
    (void)config;
    (void)userdata;
 
@@ -138,8 +150,9 @@ static void *scale2x_generic_create(const struct softfilter_config *config,
       return NULL;
    filt->workers = (struct softfilter_thread_data*)
       calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
+   filt->row     = scale2x_simd_get_row(simd, in_fmt);
    if (!filt->workers)
    {
       free(filt);
@@ -169,6 +182,7 @@ static void scale2x_generic_destroy(void *data)
 
 static void scale2x_work_cb_xrgb8888(void *data, void *thread_data)
 {
+   struct filter_data *filt = (struct filter_data*)data;
    struct softfilter_thread_data *thr = 
       (struct softfilter_thread_data*)thread_data;
    const uint32_t *input = (const uint32_t*)thr->in_data;
@@ -180,11 +194,13 @@ static void scale2x_work_cb_xrgb8888(void *data, void *thread_data)
          thr->first, thr->last, input,
          thr->in_pitch / SOFTFILTER_BPP_XRGB8888,
          output,
-         thr->out_pitch / SOFTFILTER_BPP_XRGB8888);
+         thr->out_pitch / SOFTFILTER_BPP_XRGB8888,
+         filt->row);
 }
 
 static void scale2x_work_cb_rgb565(void *data, void *thread_data)
 {
+   struct filter_data *filt = (struct filter_data*)data;
    struct softfilter_thread_data *thr = 
       (struct softfilter_thread_data*)thread_data;
    const uint16_t *input = (const uint16_t*)thr->in_data;
@@ -196,7 +212,8 @@ static void scale2x_work_cb_rgb565(void *data, void *thread_data)
          thr->first, thr->last, input, 
          thr->in_pitch / SOFTFILTER_BPP_RGB565,
          output,
-         thr->out_pitch / SOFTFILTER_BPP_RGB565);
+         thr->out_pitch / SOFTFILTER_BPP_RGB565,
+         filt->row);
 }
 
 static void scale2x_generic_packets(void *data,
@@ -223,7 +240,7 @@ static void scale2x_generic_packets(void *data,
 
       /* Workers need to know if they can access pixels 
        * outside their given buffer. */
-      thr->first = y_start;
+      thr->first = y_start == 0;
       thr->last = y_end == height;
 
       if (filt->in_fmt == SOFTFILTER_FMT_XRGB8888)
@@ -0,0 +1,242 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* SIMD row kernels shared by the Scale2x and EPX filters, which
+ * are the same algorithm under different names:
+ *
+ *     A
+ *   B C D  ->  out0: [A==B ? A : C] [A==D ? A : C]
+ *     E        out1: [E==B ? E : C] [E==D ? E : C]
+ *
+ * Every output pixel is C unless A != E and B != D. */
+
+#ifndef __SOFTFILTER_SCALE2X_SIMD_H
+#define __SOFTFILTER_SCALE2X_SIMD_H
+
+#include "softfilter.h"
+
+#if defined(__SSE2__)
+#define HAVE_SCALE2X_SSE2
+#include <emmintrin.h>
+
+#if defined(__AVX2__) || (defined(__GNUC__) && !defined(__clang__) && \
+      (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+/* GCC can build the AVX2 kernels for a generic target,
+ * they are only used if the CPU reports AVX2 at runtime. */
+#define HAVE_SCALE2X_AVX2
+#include <immintrin.h>
+#ifdef __AVX2__
+#define SCALE2X_AVX2_TARGET
+#else
+#define SCALE2X_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define HAVE_SCALE2X_NEON
+#include <arm_neon.h>
+#endif
+
+/* Scales row @src, with @above and @below as its neighbours,
+ * into @out0 and @out1, starting at column 1. Columns are only
+ * handled while their right neighbour is still inside the row,
+ * so the caller does column 0 and whatever is left at the end.
+ *
+ * Returns: number of columns done. */
+typedef unsigned (*scale2x_simd_row_t)(const void *above,
+      const void *src, const void *below,
+      void *out0, void *out1, unsigned width);
+
+#ifdef HAVE_SCALE2X_SSE2
+#define SCALE2X_SSE2_SELECT(mask, a, b) \
+   _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b))
+
+#define SCALE2X_SSE2_ROW(name, typename_t, lanes, cmpeq, unpacklo, unpackhi) \
+static unsigned name(const void *above_, const void *src_, \
+      const void *below_, void *out0_, void *out1_, unsigned width) \
+{ \
+   unsigned x; \
+   const typename_t *above = (const typename_t*)above_; \
+   const typename_t *src   = (const typename_t*)src_; \
+   const typename_t *below = (const typename_t*)below_; \
+   typename_t *out0        = (typename_t*)out0_; \
+   typename_t *out1        = (typename_t*)out1_; \
+   \
+   for (x = 1; x + lanes < width; x += lanes) \
+   { \
+      __m128i a    = _mm_loadu_si128((const __m128i*)(above + x)); \
+      __m128i b    = _mm_loadu_si128((const __m128i*)(src + x - 1)); \
+      __m128i c    = _mm_loadu_si128((const __m128i*)(src + x)); \
+      __m128i d    = _mm_loadu_si128((const __m128i*)(src + x + 1)); \
+      __m128i e    = _mm_loadu_si128((const __m128i*)(below + x)); \
+      __m128i keep = _mm_or_si128(cmpeq(a, e), cmpeq(b, d)); \
+      __m128i p00  = SCALE2X_SSE2_SELECT( \
+            _mm_andnot_si128(keep, cmpeq(a, b)), a, c); \
+      __m128i p01  = SCALE2X_SSE2_SELECT( \
+            _mm_andnot_si128(keep, cmpeq(a, d)), a, c); \
+      __m128i p10  = SCALE2X_SSE2_SELECT( \
+            _mm_andnot_si128(keep, cmpeq(e, b)), e, c); \
+      __m128i p11  = SCALE2X_SSE2_SELECT( \
+            _mm_andnot_si128(keep, cmpeq(e, d)), e, c); \
+      \
+      _mm_storeu_si128((__m128i*)(out0 + 2 * x), unpacklo(p00, p01)); \
+      _mm_storeu_si128((__m128i*)(out0 + 2 * x + lanes), unpackhi(p00, p01)); \
+      _mm_storeu_si128((__m128i*)(out1 + 2 * x), unpacklo(p10, p11)); \
+      _mm_storeu_si128((__m128i*)(out1 + 2 * x + lanes), unpackhi(p10, p11)); \
+   } \
+   \
+   return x - 1; \
+}
+
+SCALE2X_SSE2_ROW(scale2x_row_rgb565_sse2, uint16_t, 8,
+      _mm_cmpeq_epi16, _mm_unpacklo_epi16, _mm_unpackhi_epi16)
+SCALE2X_SSE2_ROW(scale2x_row_xrgb8888_sse2, uint32_t, 4,
+      _mm_cmpeq_epi32, _mm_unpacklo_epi32, _mm_unpackhi_epi32)
+#endif
+
+#ifdef HAVE_SCALE2X_AVX2
+#define SCALE2X_AVX2_SELECT(mask, a, b) \
+   _mm256_or_si256(_mm256_and_si256(mask, a), _mm256_andnot_si256(mask, b))
+
+/* unpacklo/hi interleave within each 128-bit half,
+ * the permutes put the halves back in pixel order. */
+#define SCALE2X_AVX2_ROW(name, typename_t, lanes, cmpeq, unpacklo, unpackhi) \
+static SCALE2X_AVX2_TARGET unsigned name(const void *above_, \
+      const void *src_, const void *below_, \
+      void *out0_, void *out1_, unsigned width) \
+{ \
+   unsigned x; \
+   const typename_t *above = (const typename_t*)above_; \
+   const typename_t *src   = (const typename_t*)src_; \
+   const typename_t *below = (const typename_t*)below_; \
+   typename_t *out0        = (typename_t*)out0_; \
+   typename_t *out1        = (typename_t*)out1_; \
+   \
+   for (x = 1; x + lanes < width; x += lanes) \
+   { \
+      __m256i a    = _mm256_loadu_si256((const __m256i*)(above + x)); \
+      __m256i b    = _mm256_loadu_si256((const __m256i*)(src + x - 1)); \
+      __m256i c    = _mm256_loadu_si256((const __m256i*)(src + x)); \
+      __m256i d    = _mm256_loadu_si256((const __m256i*)(src + x + 1)); \
+      __m256i e    = _mm256_loadu_si256((const __m256i*)(below + x)); \
+      __m256i keep = _mm256_or_si256(cmpeq(a, e), cmpeq(b, d)); \
+      __m256i p00  = SCALE2X_AVX2_SELECT( \
+            _mm256_andnot_si256(keep, cmpeq(a, b)), a, c); \
+      __m256i p01  = SCALE2X_AVX2_SELECT( \
+            _mm256_andnot_si256(keep, cmpeq(a, d)), a, c); \
+      __m256i p10  = SCALE2X_AVX2_SELECT( \
+            _mm256_andnot_si256(keep, cmpeq(e, b)), e, c); \
+      __m256i p11  = SCALE2X_AVX2_SELECT( \
+            _mm256_andnot_si256(keep, cmpeq(e, d)), e, c); \
+      __m256i lo0  = unpacklo(p00, p01); \
+      __m256i hi0  = unpackhi(p00, p01); \
+      __m256i lo1  = unpacklo(p10, p11); \
+      __m256i hi1  = unpackhi(p10, p11); \
+      \
+      _mm256_storeu_si256((__m256i*)(out0 + 2 * x), \
+            _mm256_permute2x128_si256(lo0, hi0, 0x20)); \
+      _mm256_storeu_si256((__m256i*)(out0 + 2 * x + lanes), \
+            _mm256_permute2x128_si256(lo0, hi0, 0x31)); \
+      _mm256_storeu_si256((__m256i*)(out1 + 2 * x), \
+            _mm256_permute2x128_si256(lo1, hi1, 0x20)); \
+      _mm256_storeu_si256((__m256i*)(out1 + 2 * x + lanes), \
+            _mm256_permute2x128_si256(lo1, hi1, 0x31)); \
+   } \
+   \
+   return x - 1; \
+}
+
+SCALE2X_AVX2_ROW(scale2x_row_rgb565_avx2, uint16_t, 16,
+      _mm256_cmpeq_epi16, _mm256_unpacklo_epi16, _mm256_unpackhi_epi16)
+SCALE2X_AVX2_ROW(scale2x_row_xrgb8888_avx2, uint32_t, 8,
+      _mm256_cmpeq_epi32, _mm256_unpacklo_epi32, _mm256_unpackhi_epi32)
+#endif
+
+#ifdef HAVE_SCALE2X_NEON
+/* vst2q interleaves the two outputs of each row for free. */
+#define SCALE2X_NEON_ROW(name, typename_t, lanes, vec_t, pair_t, sfx) \
+static unsigned name(const void *above_, const void *src_, \
+      const void *below_, void *out0_, void *out1_, unsigned width) \
+{ \
+   unsigned x; \
+   const typename_t *above = (const typename_t*)above_; \
+   const typename_t *src   = (const typename_t*)src_; \
+   const typename_t *below = (const typename_t*)below_; \
+   typename_t *out0        = (typename_t*)out0_; \
+   typename_t *out1        = (typename_t*)out1_; \
+   \
+   for (x = 1; x + lanes < width; x += lanes) \
+   { \
+      pair_t p0, p1; \
+      vec_t a    = vld1q_##sfx(above + x); \
+      vec_t b    = vld1q_##sfx(src + x - 1); \
+      vec_t c    = vld1q_##sfx(src + x); \
+      vec_t d    = vld1q_##sfx(src + x + 1); \
+      vec_t e    = vld1q_##sfx(below + x); \
+      vec_t keep = vorrq_##sfx(vceqq_##sfx(a, e), vceqq_##sfx(b, d)); \
+      \
+      p0.val[0]  = vbslq_##sfx(vbicq_##sfx(vceqq_##sfx(a, b), keep), a, c); \
+      p0.val[1]  = vbslq_##sfx(vbicq_##sfx(vceqq_##sfx(a, d), keep), a, c); \
+      p1.val[0]  = vbslq_##sfx(vbicq_##sfx(vceqq_##sfx(e, b), keep), e, c); \
+      p1.val[1]  = vbslq_##sfx(vbicq_##sfx(vceqq_##sfx(e, d), keep), e, c); \
+      \
+      vst2q_##sfx(out0 + 2 * x, p0); \
+      vst2q_##sfx(out1 + 2 * x, p1); \
+   } \
+   \
+   return x - 1; \
+}
+
+SCALE2X_NEON_ROW(scale2x_row_rgb565_neon, uint16_t, 8,
+      uint16x8_t, uint16x8x2_t, u16)
+SCALE2X_NEON_ROW(scale2x_row_xrgb8888_neon, uint32_t, 4,
+      uint32x4_t, uint32x4x2_t, u32)
+#endif
+
+/**
+ * scale2x_simd_get_row:
+ * @simd                    : SIMD features of the CPU.
+ * @fmt                     : SOFTFILTER_FMT_RGB565 or SOFTFILTER_FMT_XRGB8888.
+ *
+ * Returns: fastest row kernel the CPU can run for @fmt,
+ * or NULL if there is none.
+ */
+static scale2x_simd_row_t scale2x_simd_get_row(
+      softfilter_simd_mask_t simd, unsigned fmt)
+{
+   int rgb565 = fmt == SOFTFILTER_FMT_RGB565;
+
+   (void)simd;
+   (void)rgb565;
+
+#ifdef HAVE_SCALE2X_AVX2
+   /* AVX is only reported once the OS saves YMM state. */
+   if ((simd & SOFTFILTER_SIMD_AVX) && (simd & SOFTFILTER_SIMD_AVX2))
+      return rgb565 ? scale2x_row_rgb565_avx2 : scale2x_row_xrgb8888_avx2;
+#endif
+#ifdef HAVE_SCALE2X_SSE2
+   if (simd & SOFTFILTER_SIMD_SSE2)
+      return rgb565 ? scale2x_row_rgb565_sse2 : scale2x_row_xrgb8888_sse2;
+#endif
+#ifdef HAVE_SCALE2X_NEON
+   if (simd & SOFTFILTER_SIMD_NEON)
+      return rgb565 ? scale2x_row_rgb565_neon : scale2x_row_xrgb8888_neon;
+#endif
+
+   return NULL;
+}
+
+#endif
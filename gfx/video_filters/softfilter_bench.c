@@ -0,0 +1,219 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Times every softfilter config in a directory through
+ * rarch_softfilter_new(), with SIMD masked off and with the
+ * features of the CPU. Build with "make bench". */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <file/dir_list.h>
+#include <file/file_path.h>
+
+#include "../../general.h"
+#include "../../performance.h"
+#include "../video_filter.h"
+
+/* Runs every filter and frame size at least this long. */
+#define BENCH_MIN_USEC 200000
+
+/* Built from performance.c under this name, see the Makefile. */
+uint64_t softfilter_bench_cpu_features(void);
+
+static global_t g_global;
+static uint64_t bench_simd_mask;
+
+global_t *global_get_ptr(void)
+{
+   return &g_global;
+}
+
+bool rarch_main_verbosity(void)
+{
+   return getenv("SOFTFILTER_BENCH_VERBOSE") != NULL;
+}
+
+/* rarch_softfilter_new() hands this mask to the filters. */
+uint64_t retro_get_cpu_features(void)
+{
+   return bench_simd_mask;
+}
+
+static const struct
+{
+   unsigned width;
+   unsigned height;
+} sizes[] = {
+   {  320,  240 },
+   {  640,  480 },
+   { 1920, 1080 },
+};
+
+static const struct
+{
+   enum retro_pixel_format fmt;
+   const char *name;
+   unsigned bpp;
+} formats[] = {
+   { RETRO_PIXEL_FORMAT_RGB565,   "RGB565",   2 },
+   { RETRO_PIXEL_FORMAT_XRGB8888, "XRGB8888", 4 },
+};
+
+/**
+ * bench_filter:
+ *
+ * Times one filter config on frames of one size and format.
+ *
+ * Returns: microseconds per frame, or a negative value if the
+ * filter could not be created for that format.
+ **/
+static double bench_filter(const char *path, thread_pool_t *pool,
+      unsigned fmt, unsigned width, unsigned height)
+{
+   unsigned i;
+   unsigned out_width       = 0;
+   unsigned out_height      = 0;
+   unsigned frames          = 0;
+   size_t in_stride         = width * formats[fmt].bpp;
+   size_t out_stride        = 0;
+   retro_time_t start       = 0;
+   retro_time_t elapsed     = 0;
+   uint8_t *input           = NULL;
+   uint8_t *output          = NULL;
+   double ret               = -1.0;
+   rarch_softfilter_t *filt = rarch_softfilter_new(path,
+         RARCH_SOFTFILTER_THREADS_AUTO, pool,
+         formats[fmt].fmt, width, height);
+
+   if (!filt)
+      return ret;
+
+   rarch_softfilter_get_max_output_size(filt, &out_width, &out_height);
+   out_stride = out_width *
+      (rarch_softfilter_get_output_format(filt)
+       == RETRO_PIXEL_FORMAT_XRGB8888 ? 4 : 2);
+
+   input  = (uint8_t*)malloc(in_stride * height);
+   output = (uint8_t*)malloc(out_stride * out_height);
+   if (!input || !output)
+      goto end;
+
+   srand(1);
+   for (i = 0; i < in_stride * height; i++)
+      input[i] = rand();
+
+   /* Warm up the caches and the pool threads. */
+   rarch_softfilter_process(filt, output, out_stride,
+         input, width, height, in_stride);
+
+   start = retro_get_time_usec();
+   do
+   {
+      rarch_softfilter_process(filt, output, out_stride,
+            input, width, height, in_stride);
+      frames++;
+      elapsed = retro_get_time_usec() - start;
+   } while (elapsed < BENCH_MIN_USEC);
+
+   ret = (double)elapsed / frames;
+
+end:
+   free(input);
+   free(output);
+   rarch_softfilter_free(filt);
+   return ret;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i, fmt, size;
+   unsigned threads          = 0;
+   const char *dir           = ".";
+   uint64_t cpu_mask         = softfilter_bench_cpu_features();
+   struct string_list *filts = NULL;
+   thread_pool_t *pool       = NULL;
+
+   if (argc > 3)
+   {
+      fprintf(stderr, "Usage: %s [filter directory [threads]]\n", argv[0]);
+      return 1;
+   }
+
+   if (argc >= 2)
+      dir     = argv[1];
+   if (argc == 3)
+      threads = atoi(argv[2]);
+
+   filts = dir_list_new(dir, "filt", false, false);
+   if (!filts || !filts->size)
+   {
+      fprintf(stderr, "No .filt files in %s.\n", dir);
+      string_list_free(filts);
+      return 1;
+   }
+   dir_list_sort(filts, true);
+
+#ifdef HAVE_THREADS
+   if (threads > 1)
+      pool = thread_pool_new(threads);
+#endif
+
+   printf("CPU SIMD mask 0x%llx, %u pool threads.\n",
+         (unsigned long long)cpu_mask, pool ? threads : 0);
+   printf("%-32s  %-8s  %9s  %12s  %12s  %8s\n", "filter", "format",
+         "size", "C Mpix/s", "SIMD Mpix/s", "speedup");
+
+   for (i = 0; i < filts->size; i++)
+   {
+      const char *path = filts->elems[i].data;
+
+      for (fmt = 0; fmt < sizeof(formats) / sizeof(formats[0]); fmt++)
+      {
+         for (size = 0; size < sizeof(sizes) / sizeof(sizes[0]); size++)
+         {
+            char dims[32] = {0};
+            double pixels = (double)sizes[size].width * sizes[size].height;
+            double plain, simd;
+
+            bench_simd_mask = 0;
+            plain = bench_filter(path, pool, fmt,
+                  sizes[size].width, sizes[size].height);
+            if (plain < 0.0)
+               break;
+
+            bench_simd_mask = cpu_mask;
+            simd = bench_filter(path, pool, fmt,
+                  sizes[size].width, sizes[size].height);
+
+            snprintf(dims, sizeof(dims), "%ux%u",
+                  sizes[size].width, sizes[size].height);
+            printf("%-32s  %-8s  %9s  %12.1f  %12.1f  %7.2fx\n",
+                  path_basename(path), formats[fmt].name, dims,
+                  pixels / plain, pixels / simd, plain / simd);
+         }
+      }
+   }
+
+#ifdef HAVE_THREADS
+   if (pool)
+      thread_pool_free(pool);
+#endif
+   string_list_free(filts);
+   return 0;
+}
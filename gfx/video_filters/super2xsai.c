@@ -77,7 +77,7 @@ static void *supertwoxsai_generic_create(const struct softfilter_config *config,
    (void)userdata;
 
    filt->workers = (struct softfilter_thread_data*)calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
 
    if (!filt->workers)
@@ -205,7 +205,9 @@ static void supertwoxsai_generic_xrgb8888(unsigned width, unsigned height,
       unsigned src_stride, uint32_t *dst, unsigned dst_stride)
 {
    unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
+   /* Rows are filtered on their own, as they were back when the
+    * whole frame came in one packet with 'last' set. */
+   unsigned nextline = 0;
 
    for (; height; height--)
    {
@@ -235,7 +237,7 @@ static void supertwoxsai_generic_rgb565(unsigned width, unsigned height,
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
    unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
+   unsigned nextline = 0;
 
    for (; height; height--)
    {
@@ -306,7 +308,7 @@ static void supertwoxsai_generic_packets(void *data,
       thr->height = y_end - y_start;
 
       // Workers need to know if they can access pixels outside their given buffer.
-      thr->first = y_start;
+      thr->first = y_start == 0;
       thr->last = y_end == height;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
@@ -36,18 +36,11 @@ void deinit_pixel_converter(void)
    if (!scaler_ptr)
       return;
 
-   scaler_ctx_gen_reset(scaler_ptr->scaler);
-
-   if (scaler_ptr->scaler)
-      free(scaler_ptr->scaler);
    if (scaler_ptr->scaler_out)
       free(scaler_ptr->scaler_out);
-   if (scaler_ptr)
-      free(scaler_ptr);
+   free(scaler_ptr);
 
-   scaler_ptr->scaler     = NULL;
-   scaler_ptr->scaler_out = NULL;
-   scaler_ptr             = NULL;
+   scaler_ptr = NULL;
 }
 
 bool init_video_pixel_converter(unsigned size)
@@ -68,20 +61,9 @@ bool init_video_pixel_converter(unsigned size)
    if (!scaler_ptr)
       goto error;
 
-   scaler_ptr->scaler = (struct scaler_ctx*)calloc(1, sizeof(*scaler_ptr->scaler));
-
-   if (!scaler_ptr->scaler)
-      goto error;
-
-   scaler_ptr->scaler->scaler_type = SCALER_TYPE_POINT;
-   scaler_ptr->scaler->in_fmt      = SCALER_FMT_0RGB1555;
-
-   /* TODO: Pick either ARGB8888 or RGB565 depending on driver. */
-   scaler_ptr->scaler->out_fmt     = SCALER_FMT_RGB565;
-
-   if (!scaler_ctx_gen_filter(scaler_ptr->scaler))
-      goto error;
-
+   /* Frames are converted, never scaled, so there is no need
+    * for a scaler context. Bind the converter once here. */
+   scaler_ptr->convert    = pixconv_get_fastest(conv_0rgb1555_rgb565);
    scaler_ptr->scaler_out = calloc(sizeof(uint16_t), size * size);
 
    if (!scaler_ptr->scaler_out)
@@ -90,15 +72,7 @@ bool init_video_pixel_converter(unsigned size)
    return true;
 
 error:
-   if (scaler_ptr->scaler_out)
-      free(scaler_ptr->scaler_out);
-   if (scaler_ptr->scaler)
-      free(scaler_ptr->scaler);
-   if (scaler_ptr)
-      free(scaler_ptr);
-
-   scaler_ptr = NULL;
-
+   deinit_pixel_converter();
    return false;
 }
 
@@ -131,14 +105,9 @@ bool video_pixel_frame_scale(const void *data,
 
    retro_perf_start(&video_frame_conv);
 
-   scaler->scaler->in_width      = width;
-   scaler->scaler->in_height     = height;
-   scaler->scaler->out_width     = width;
-   scaler->scaler->out_height    = height;
-   scaler->scaler->in_stride     = pitch;
-   scaler->scaler->out_stride    = width * sizeof(uint16_t);
-
-   scaler_ctx_scale(scaler->scaler, scaler->scaler_out, data);
+   scaler->out_stride = width * sizeof(uint16_t);
+   scaler->convert(scaler->scaler_out, data, width, height,
+         scaler->out_stride, pitch);
 
    retro_perf_stop(&video_frame_conv);
 
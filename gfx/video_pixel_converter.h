@@ -19,14 +19,18 @@
 
 #include <boolean.h>
 
+#include <gfx/scaler/pixconv.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 typedef struct video_pixel_scaler
 {
-   struct scaler_ctx *scaler;
+   /* 0RGB1555 -> RGB565, bound once for the CPU we run on. */
+   pixconv_t convert;
    void *scaler_out;
+   unsigned out_stride;
 } video_pixel_scaler_t;
 
 void deinit_pixel_converter(void);
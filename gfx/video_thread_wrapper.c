@@ -18,6 +18,9 @@
 #include <string.h>
 #include <limits.h>
 
+#include <retro_atomic.h>
+#include <memalign.h>
+
 #include "video_thread_wrapper.h"
 #include "../performance.h"
 
@@ -356,6 +359,57 @@ static bool thread_handle_packet(thread_video_t *thr, const thread_packet_t *inc
    return false;
 }
 
+static bool thread_frame_is_fresh(thread_video_t *thr)
+{
+   return retro_atomic_load(&thr->frame.mailbox) & THREAD_VIDEO_FRAME_FRESH;
+}
+
+/* The latency histogram as perf counters, so it shows up next to
+ * thr_frame. Each counts the frames of its bucket and their total
+ * latency in perf ticks. */
+static struct retro_perf_counter thread_latency_perf[
+   THREAD_VIDEO_LATENCY_BUCKETS];
+
+static const char *thread_latency_perf_ident[
+   THREAD_VIDEO_LATENCY_BUCKETS] = {
+   "thr_latency_under_0.5ms",
+   "thr_latency_under_1ms",
+   "thr_latency_under_2ms",
+   "thr_latency_under_4ms",
+   "thr_latency_under_8ms",
+   "thr_latency_under_16ms",
+   "thr_latency_under_32ms",
+   "thr_latency_under_64ms",
+   "thr_latency_under_128ms",
+   "thr_latency_slower",
+};
+
+static void thread_update_latency(thread_video_t *thr,
+      const thread_video_frame_t *frame)
+{
+   unsigned bucket        = 0;
+   retro_time_t threshold = 500;
+   retro_time_t latency   = retro_get_time_usec() - frame->time;
+   struct retro_perf_counter *perf = NULL;
+
+   while (latency >= threshold && bucket < THREAD_VIDEO_LATENCY_BUCKETS - 1)
+   {
+      threshold <<= 1;
+      bucket++;
+   }
+
+   thr->latency[bucket]++;
+
+   /* Registered on the main thread by thread_init(), only
+    * if performance counters are enabled. */
+   perf = &thread_latency_perf[bucket];
+   if (perf->registered)
+   {
+      perf->total += retro_get_perf_counter() - frame->tick;
+      perf->call_cnt++;
+   }
+}
+
 static void thread_loop(void *data)
 {
    thread_video_t *thr = (thread_video_t*)data;
@@ -368,10 +422,16 @@ static void thread_loop(void *data)
       bool updated = false;
 
       slock_lock(thr->lock);
-      while (thr->send_cmd == CMD_NONE && !thr->frame.updated)
+      while (thr->send_cmd == CMD_NONE && !thread_frame_is_fresh(thr))
          scond_wait(thr->cond_thread, thr->lock);
-      if (thr->frame.updated)
+
+      /* Take the newest frame, give back the one we presented last. */
+      if (thread_frame_is_fresh(thr))
+      {
+         thr->frame.read_slot = retro_atomic_xchg(&thr->frame.mailbox,
+               thr->frame.read_slot) & ~THREAD_VIDEO_FRAME_FRESH;
          updated = true;
+      }
 
       /* To avoid race condition where send_cmd is updated 
        * right after the switch is checked. */
@@ -389,6 +449,8 @@ static void thread_loop(void *data)
          bool               focus = false;
          bool        has_windowed = true;
          struct video_viewport vp = {0};
+         const thread_video_frame_t *frame =
+            &thr->frame.slots[thr->frame.read_slot];
 
          slock_lock(thr->frame.lock);
 
@@ -396,12 +458,14 @@ static void thread_loop(void *data)
 
          if (thr->driver && thr->driver->frame)
             ret = thr->driver->frame(thr->driver_data,
-               thr->frame.buffer, thr->frame.width, thr->frame.height,
-               thr->frame.count,
-               thr->frame.pitch, *thr->frame.msg ? thr->frame.msg : NULL);
+               frame->buffer, frame->width, frame->height,
+               frame->count,
+               frame->pitch, *frame->msg ? frame->msg : NULL);
 
          slock_unlock(thr->frame.lock);
 
+         thread_update_latency(thr, frame);
+
          if (thr->driver && thr->driver->alive)
             alive = ret && thr->driver->alive(thr->driver_data);
 
@@ -418,7 +482,6 @@ static void thread_loop(void *data)
          thr->alive         = alive;
          thr->focus         = focus;
          thr->has_windowed  = has_windowed;
-         thr->frame.updated = false;
          thr->vp            = vp;
          scond_signal(thr->cond_cmd);
          slock_unlock(thr->lock);
@@ -490,10 +553,12 @@ static bool thread_frame(void *data, const void *frame_,
       unsigned width, unsigned height, uint64_t frame_count,
       unsigned pitch, const char *msg)
 {
+   int prev;
    unsigned copy_stride;
    static struct retro_perf_counter thr_frame = {0};
    const uint8_t *src                  = NULL;
    uint8_t *dst                        = NULL;
+   thread_video_frame_t *frame         = NULL;
    thread_video_t *thr                 = (thread_video_t*)data;
 
    /* If called from within read_viewport, we're actually in the 
@@ -511,24 +576,21 @@ static bool thread_frame(void *data, const void *frame_,
    rarch_perf_init(&thr_frame, "thr_frame");
    retro_perf_start(&thr_frame);
 
-   copy_stride = width * (thr->info.rgb32 
-         ? sizeof(uint32_t) : sizeof(uint16_t));
-
-   src = (const uint8_t*)frame_;
-   dst = thr->frame.buffer;
-
-   slock_lock(thr->lock);
-
-   if (!thr->nonblock)
+   if (!thr->nonblock && thread_frame_is_fresh(thr))
    {
+      /* The video thread hasn't even picked up the last frame yet.
+       * Give it up to a frame period before we replace it, so we
+       * stay paced to the display without audio sync. */
       settings_t *settings = config_get_ptr();
 
       retro_time_t target_frame_time = (retro_time_t)
          roundf(1000000 / settings->video.refresh_rate);
       retro_time_t target = thr->last_time + target_frame_time;
 
+      slock_lock(thr->lock);
+
       /* Ideally, use absolute time, but that is only a good idea on POSIX. */
-      while (thr->frame.updated)
+      while (thread_frame_is_fresh(thr))
       {
          retro_time_t current = retro_get_time_usec();
          retro_time_t delta   = target - current;
@@ -539,44 +601,59 @@ static bool thread_frame(void *data, const void *frame_,
          if (!scond_wait_timeout(thr->cond_cmd, thr->lock, delta))
             break;
       }
+
+      slock_unlock(thr->lock);
    }
 
-   /* Drop frame if updated flag is still set, as thread is 
-    * still working on last frame. */
-   if (!thr->frame.updated)
-   {
-      if (src)
-      {
-         unsigned h;
-         for (h = 0; h < height; h++, src += pitch, dst += copy_stride)
-            memcpy(dst, src, copy_stride);
-      }
+   copy_stride = width * (thr->info.rgb32 
+         ? sizeof(uint32_t) : sizeof(uint16_t));
 
-      thr->frame.updated = true;
-      thr->frame.width  = width;
-      thr->frame.height = height;
-      thr->frame.count  = frame_count;
-      thr->frame.pitch  = copy_stride;
+   /* The write slot is never seen by the video thread,
+    * so fill it in without holding any lock. */
+   frame = &thr->frame.slots[thr->frame.write_slot];
+   src   = (const uint8_t*)frame_;
+   dst   = frame->buffer;
 
-      if (msg)
-         strlcpy(thr->frame.msg, msg, sizeof(thr->frame.msg));
-      else
-         *thr->frame.msg = '\0';
+   /* Nothing to copy if the core rendered straight into the slot,
+    * see thread_get_current_software_framebuffer(). */
+   if (src && src != dst)
+   {
+      unsigned h;
+      for (h = 0; h < height; h++, src += pitch, dst += copy_stride)
+         memcpy(dst, src, copy_stride);
+   }
 
-      scond_signal(thr->cond_thread);
+   frame->width  = width;
+   frame->height = height;
+   frame->count  = frame_count;
+   frame->pitch  = copy_stride;
+   frame->time   = retro_get_time_usec();
+   frame->tick   = retro_get_perf_counter();
 
-#if defined(HAVE_MENU)
-      if (thr->texture.enable)
-      {
-         while (thr->frame.updated)
-            scond_wait(thr->cond_cmd, thr->lock);
-      }
-#endif
-      thr->hit_count++;
-   }
+   if (msg)
+      strlcpy(frame->msg, msg, sizeof(frame->msg));
    else
+      *frame->msg = '\0';
+
+   prev = retro_atomic_xchg(&thr->frame.mailbox,
+         thr->frame.write_slot | THREAD_VIDEO_FRAME_FRESH);
+   thr->frame.write_slot = prev & ~THREAD_VIDEO_FRAME_FRESH;
+
+   /* Previous frame was replaced before the video thread got to it. */
+   if (prev & THREAD_VIDEO_FRAME_FRESH)
       thr->miss_count++;
+   thr->hit_count++;
 
+   slock_lock(thr->lock);
+   scond_signal(thr->cond_thread);
+
+#if defined(HAVE_MENU)
+   if (thr->texture.enable)
+   {
+      while (thread_frame_is_fresh(thr))
+         scond_wait(thr->cond_cmd, thr->lock);
+   }
+#endif
    slock_unlock(thr->lock);
 
    retro_perf_stop(&thr_frame);
@@ -595,6 +672,7 @@ static void thread_set_nonblock_state(void *data, bool state)
 static bool thread_init(thread_video_t *thr, const video_info_t *info,
       const input_driver_t **input, void **input_data)
 {
+   unsigned i;
    size_t max_size;
    thread_packet_t pkt = {CMD_INIT};
 
@@ -614,12 +692,25 @@ static bool thread_init(thread_video_t *thr, const video_info_t *info,
    max_size                  = info->input_scale * RARCH_SCALE_BASE;
    max_size                 *= max_size;
    max_size                 *= info->rgb32 ? sizeof(uint32_t) : sizeof(uint16_t);
-   thr->frame.buffer        = (uint8_t*)malloc(max_size);
 
-   if (!thr->frame.buffer)
-      return false;
+   for (i = 0; i < THREAD_VIDEO_FRAMES; i++)
+   {
+      thr->frame.slots[i].buffer = (uint8_t*)memalign_alloc(64, max_size);
 
-   memset(thr->frame.buffer, 0x80, max_size);
+      if (!thr->frame.slots[i].buffer)
+         return false;
+
+      memset(thr->frame.slots[i].buffer, 0x80, max_size);
+   }
+
+   thr->frame.size       = max_size;
+   thr->frame.write_slot = 0;
+   thr->frame.read_slot  = 1;
+   thr->frame.mailbox    = 2;
+
+   for (i = 0; i < THREAD_VIDEO_LATENCY_BUCKETS; i++)
+      rarch_perf_init(&thread_latency_perf[i],
+            thread_latency_perf_ident[i]);
 
    thr->last_time       = retro_get_time_usec();
    thr->thread          = sthread_create(thread_loop, thr);
@@ -714,6 +805,7 @@ static bool thread_read_viewport(void *data, uint8_t *buffer)
 
 static void thread_free(void *data)
 {
+   unsigned i;
    thread_video_t *thr = (thread_video_t*)data;
    thread_packet_t pkt = { CMD_FREE };
 
@@ -727,7 +819,11 @@ static void thread_free(void *data)
 #if defined(HAVE_MENU)
    free(thr->texture.frame);
 #endif
-   free(thr->frame.buffer);
+   for (i = 0; i < THREAD_VIDEO_FRAMES; i++)
+   {
+      if (thr->frame.slots[i].buffer)
+         memalign_free(thr->frame.slots[i].buffer);
+   }
    slock_free(thr->frame.lock);
    slock_free(thr->lock);
    scond_free(thr->cond_cmd);
@@ -739,6 +835,16 @@ static void thread_free(void *data)
    RARCH_LOG("Threaded video stats: Frames pushed: %u, Frames dropped: %u.\n",
          thr->hit_count, thr->miss_count);
 
+   for (i = 0; i < THREAD_VIDEO_LATENCY_BUCKETS; i++)
+   {
+      if (i < THREAD_VIDEO_LATENCY_BUCKETS - 1)
+         RARCH_LOG("Threaded video latency < %6.1f ms: %u\n",
+               0.5 * (1 << i), thr->latency[i]);
+      else
+         RARCH_LOG("Threaded video latency slower:      %u\n",
+               thr->latency[i]);
+   }
+
    free(thr);
 }
 
@@ -1001,6 +1107,31 @@ static struct video_shader *thread_get_current_shader(void *data)
    return thr->poke->get_current_shader(thr->driver_data);
 }
 
+static bool thread_get_current_software_framebuffer(void *data,
+      struct retro_framebuffer *framebuffer)
+{
+   thread_video_t *thr = (thread_video_t*)data;
+   size_t pitch;
+
+   if (!thr)
+      return false;
+
+   pitch = framebuffer->width * (thr->info.rgb32
+         ? sizeof(uint32_t) : sizeof(uint16_t));
+
+   if (pitch * framebuffer->height > thr->frame.size)
+      return false;
+
+   /* The write slot belongs to the emulation thread until
+    * thread_frame() publishes it, so the core can render
+    * into it directly. */
+   framebuffer->data   = thr->frame.slots[thr->frame.write_slot].buffer;
+   framebuffer->pitch  = pitch;
+   framebuffer->format = thr->info.rgb32
+      ? RETRO_PIXEL_FORMAT_XRGB8888 : RETRO_PIXEL_FORMAT_RGB565;
+   return true;
+}
+
 static const video_poke_interface_t thread_poke = {
    thread_set_video_mode,
    thread_set_filtering,
@@ -1021,6 +1152,7 @@ static const video_poke_interface_t thread_poke = {
    NULL,
 
    thread_get_current_shader,
+   thread_get_current_software_framebuffer,
 };
 
 static void thread_get_poke_interface(void *data,
@@ -144,6 +144,31 @@ typedef struct
    } data;
 } thread_packet_t;
 
+/* Frames are triple-buffered between the emulation thread and
+ * the video thread. */
+#define THREAD_VIDEO_FRAMES 3
+
+/* Set in thread_video::frame.mailbox while the frame in it
+ * has not been picked up by the video thread yet. */
+#define THREAD_VIDEO_FRAME_FRESH 0x100
+
+/* Frame latency histogram; bucket 0 counts frames shown within
+ * 0.5 ms of being pushed, every next bucket doubles that, and the
+ * last bucket counts everything slower. */
+#define THREAD_VIDEO_LATENCY_BUCKETS 10
+
+typedef struct thread_video_frame
+{
+   uint8_t *buffer;
+   unsigned width;
+   unsigned height;
+   unsigned pitch;
+   uint64_t count;
+   retro_time_t time;
+   retro_perf_tick_t tick;
+   char msg[PATH_MAX_LENGTH];
+} thread_video_frame_t;
+
 typedef struct thread_video
 {
    slock_t *lock;
@@ -188,6 +213,7 @@ typedef struct thread_video
    retro_time_t last_time;
    unsigned hit_count;
    unsigned miss_count;
+   unsigned latency[THREAD_VIDEO_LATENCY_BUCKETS];
 
    float *alpha_mod;
    unsigned alpha_mods;
@@ -207,14 +233,17 @@ typedef struct thread_video
    struct
    {
       slock_t *lock;
-      uint8_t *buffer;
-      unsigned width;
-      unsigned height;
-      unsigned pitch;
-      bool updated;
+      thread_video_frame_t slots[THREAD_VIDEO_FRAMES];
+      /* Size of each slot buffer. */
+      size_t size;
+      /* Slot of the last pushed frame, possibly with
+       * THREAD_VIDEO_FRAME_FRESH set. Only ever exchanged atomically. */
+      volatile int mailbox;
+      /* Owned by the emulation thread. */
+      unsigned write_slot;
+      /* Owned by the video thread. */
+      unsigned read_slot;
       bool within_thread;
-      uint64_t count;
-      char msg[PATH_MAX_LENGTH];
    } frame;
 
    video_driver_t video_thread;
@@ -576,6 +576,7 @@ CORES
 FILE
 ============================================================ */
 #include "../content.c"
+#include "../save_writer.c"
 #include "../libretro-common/file/file_path.c"
 #include "../file_path_special.c"
 #ifndef IOS
@@ -698,6 +699,7 @@ RECORDING
 #include "../record/drivers/record_null.c"
 
 #ifdef HAVE_FFMPEG
+#include "../libretro-common/queues/spsc_queue.c"
 #include "../record/drivers/record_ffmpeg.c"
 #endif
 
@@ -708,6 +710,7 @@ THREAD
 #include "../thread/xenon_sdl_threads.c"
 #elif defined(HAVE_THREADS)
 #include "../libretro-common/rthreads/rthreads.c"
+#include "../libretro-common/rthreads/thread_pool.c"
 #include "../gfx/video_thread_wrapper.c"
 #include "../audio/audio_thread_wrapper.c"
 #include "../autosave.c"
@@ -890,6 +893,7 @@ XML
 #ifdef HAVE_LIBRETRODB
 #include "../libretro-db/bintree.c"
 #include "../libretro-db/libretrodb.c"
+#include "../libretro-db/libretrodb_columns.c"
 #include "../libretro-db/rmsgpack.c"
 #include "../libretro-db/rmsgpack_dom.c"
 #include "../libretro-db/query.c"
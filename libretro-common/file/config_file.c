@@ -47,9 +47,102 @@
 
 #define MAX_INCLUDE_DEPTH 16
 
+/* Smallest index size, and the inverse of the maximum
+ * load factor of the index. */
+#define CONFIG_INDEX_MIN_SIZE 64
+#define CONFIG_INDEX_LOAD     2
+
 static config_file_t *config_file_new_internal(const char *path, unsigned depth);
 void config_file_free(config_file_t *conf);
 
+static bool config_index_insert(config_file_t *conf,
+      struct config_entry_list *entry);
+
+static bool config_index_resize(config_file_t *conf, size_t size)
+{
+   size_t i;
+   struct config_entry_list **old_index = conf->index;
+   size_t old_size                      = conf->index_size;
+
+   conf->index = (struct config_entry_list**)
+      calloc(size, sizeof(*conf->index));
+
+   if (!conf->index)
+   {
+      conf->index = old_index;
+      return false;
+   }
+
+   conf->index_size  = size;
+   conf->index_count = 0;
+
+   for (i = 0; i < old_size; i++)
+      if (old_index[i])
+         config_index_insert(conf, old_index[i]);
+
+   free(old_index);
+   return true;
+}
+
+/**
+ * config_index_insert:
+ * @conf                : Config file.
+ * @entry               : Entry to index.
+ *
+ * Adds @entry to the index unless an entry with the same key
+ * is already there. Lookups return the first entry in list
+ * order, so entries must be inserted in list order.
+ *
+ * Returns: false if the index could not be grown.
+ **/
+static bool config_index_insert(config_file_t *conf,
+      struct config_entry_list *entry)
+{
+   size_t i;
+
+   if ((conf->index_count + 1) * CONFIG_INDEX_LOAD > conf->index_size)
+   {
+      size_t size = conf->index_size ?
+         conf->index_size * 2 : CONFIG_INDEX_MIN_SIZE;
+      if (!config_index_resize(conf, size))
+         return false;
+   }
+
+   for (i = entry->key_hash & (conf->index_size - 1); conf->index[i];
+         i = (i + 1) & (conf->index_size - 1))
+   {
+      if (conf->index[i]->key_hash == entry->key_hash
+            && !strcmp(conf->index[i]->key, entry->key))
+         return true;
+   }
+
+   conf->index[i] = entry;
+   conf->index_count++;
+   return true;
+}
+
+static void config_index_rebuild(config_file_t *conf)
+{
+   struct config_entry_list *entry = NULL;
+
+   if (conf->index)
+      memset(conf->index, 0, conf->index_size * sizeof(*conf->index));
+   conf->index_count = 0;
+
+   for (entry = conf->entries; entry; entry = entry->next)
+   {
+      if (!config_index_insert(conf, entry))
+      {
+         /* Fall back to walking the list. */
+         free(conf->index);
+         conf->index       = NULL;
+         conf->index_size  = 0;
+         conf->index_count = 0;
+         return;
+      }
+   }
+}
+
 static char *getaline(FILE *file)
 {
    char* newline = (char*)malloc(9);
@@ -351,8 +444,13 @@ bool config_append_file(config_file_t *conf, const char *path)
    if (new_conf->tail)
    {
       new_conf->tail->next = conf->entries;
+      if (!conf->entries)
+         conf->tail        = new_conf->tail;
       conf->entries        = new_conf->entries; /* Pilfer. */
       new_conf->entries    = NULL;
+
+      /* The new entries take priority. */
+      config_index_rebuild(conf);
    }
 
    config_file_free(new_conf);
@@ -427,6 +525,11 @@ static config_file_t *config_file_new_internal(
 
    fclose(file);
 
+   /* Included files are merged into their parent,
+    * which indexes all of it at once. */
+   if (depth == 0)
+      config_index_rebuild(conf);
+
    return conf;
 
 error:
@@ -485,6 +588,8 @@ config_file_t *config_file_new_from_string(const char *from_string)
 
    string_list_free(lines);
 
+   config_index_rebuild(conf);
+
    return conf;
 }
 
@@ -521,38 +626,44 @@ void config_file_free(config_file_t *conf)
       free(hold);
    }
 
+   free(conf->index);
    free(conf->path);
    free(conf);
 }
 
 static struct config_entry_list *config_get_entry(const config_file_t *conf,
-      const char *key, struct config_entry_list **prev)
+      const char *key)
 {
    struct config_entry_list *entry;
-   struct config_entry_list *previous = NULL;
-
    uint32_t hash = djb2_calculate(key);
 
-   if (prev)
-      previous = *prev;
+   if (conf->index)
+   {
+      size_t i;
+
+      for (i = hash & (conf->index_size - 1); conf->index[i];
+            i = (i + 1) & (conf->index_size - 1))
+      {
+         entry = conf->index[i];
+         if (hash == entry->key_hash && !strcmp(key, entry->key))
+            return entry;
+      }
+
+      return NULL;
+   }
 
    for (entry = conf->entries; entry; entry = entry->next)
    {
       if (hash == entry->key_hash && !strcmp(key, entry->key))
          return entry;
-
-      previous = entry;
    }
 
-   if (prev)
-      *prev = previous;
-
    return NULL;
 }
 
 bool config_get_double(config_file_t *conf, const char *key, double *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
       *in = strtod(entry->value, NULL);
@@ -562,7 +673,7 @@ bool config_get_double(config_file_t *conf, const char *key, double *in)
 
 bool config_get_float(config_file_t *conf, const char *key, float *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -575,7 +686,7 @@ bool config_get_float(config_file_t *conf, const char *key, float *in)
 
 bool config_get_int(config_file_t *conf, const char *key, int *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -591,7 +702,7 @@ bool config_get_int(config_file_t *conf, const char *key, int *in)
 
 bool config_get_uint64(config_file_t *conf, const char *key, uint64_t *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -607,7 +718,7 @@ bool config_get_uint64(config_file_t *conf, const char *key, uint64_t *in)
 
 bool config_get_uint(config_file_t *conf, const char *key, unsigned *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -623,7 +734,7 @@ bool config_get_uint(config_file_t *conf, const char *key, unsigned *in)
 
 bool config_get_hex(config_file_t *conf, const char *key, unsigned *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -639,7 +750,7 @@ bool config_get_hex(config_file_t *conf, const char *key, unsigned *in)
 
 bool config_get_char(config_file_t *conf, const char *key, char *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -654,7 +765,7 @@ bool config_get_char(config_file_t *conf, const char *key, char *in)
 
 bool config_get_string(config_file_t *conf, const char *key, char **str)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
       *str = strdup(entry->value);
@@ -665,7 +776,7 @@ bool config_get_string(config_file_t *conf, const char *key, char **str)
 bool config_get_array(config_file_t *conf, const char *key,
       char *buf, size_t size)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
       return strlcpy(buf, entry->value, size) < size;
@@ -679,7 +790,7 @@ bool config_get_path(config_file_t *conf, const char *key,
 #if defined(RARCH_CONSOLE)
    return config_get_array(conf, key, buf, size);
 #else
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
       fill_pathname_expand_special(buf, entry->value, size);
@@ -690,7 +801,7 @@ bool config_get_path(config_file_t *conf, const char *key,
 
 bool config_get_bool(config_file_t *conf, const char *key, bool *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -711,8 +822,7 @@ bool config_get_bool(config_file_t *conf, const char *key, bool *in)
 
 void config_set_string(config_file_t *conf, const char *key, const char *val)
 {
-   struct config_entry_list *last  = conf->entries;
-   struct config_entry_list *entry = config_get_entry(conf, key, &last);
+   struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry && !entry->readonly)
    {
@@ -726,13 +836,23 @@ void config_set_string(config_file_t *conf, const char *key, const char *val)
    if (!entry)
       return;
 
-   entry->key   = strdup(key);
-   entry->value = strdup(val);
+   entry->key      = strdup(key);
+   entry->value    = strdup(val);
+   entry->key_hash = djb2_calculate(key);
 
-   if (last)
-      last->next = entry;
+   if (conf->tail)
+      conf->tail->next = entry;
    else
       conf->entries = entry;
+   conf->tail = entry;
+
+   /* Only index on top of a complete index, or when this
+    * is the first entry of an empty config. */
+   if (conf->index || !conf->entries->next)
+   {
+      if (!config_index_insert(conf, entry))
+         config_index_rebuild(conf);
+   }
 }
 
 void config_set_path(config_file_t *conf, const char *entry, const char *val)
@@ -843,16 +963,7 @@ void config_file_dump(config_file_t *conf, FILE *file)
 
 bool config_entry_exists(config_file_t *conf, const char *entry)
 {
-   struct config_entry_list *list = conf->entries;
-
-   while (list)
-   {
-      if (!strcmp(entry, list->key))
-         return true;
-      list = list->next;
-   }
-
-   return false;
+   return config_get_entry(conf, entry) != NULL;
 }
 
 bool config_get_entry_list_head(config_file_t *conf,
@@ -360,6 +360,52 @@ uint32_t zlib_crc32_adjust(uint32_t crc, uint8_t data)
    return ~crc32(~crc, &data, 1);
 }
 
+/* Output window for each inflate() call while extracting, so the
+ * CRC of every chunk is taken while it's still in cache. */
+#define ZLIB_INFLATE_CHUNK_SIZE (256 * 1024)
+
+/**
+ * zlib_inflate_data_to_file_crc:
+ * @handle                      : handle set up by
+ *                                zlib_inflate_data_to_file_init().
+ * @size                        : output file size
+ *
+ * Inflates the whole file, computing handle->real_checksum as
+ * the data comes out.
+ *
+ * Returns: like zlib_inflate_data_to_file_iterate() once done.
+ **/
+static int zlib_inflate_data_to_file_crc(zlib_file_handle_t *handle,
+      uint32_t size)
+{
+   int ret          = 0;
+   uint32_t done    = 0;
+   z_stream *stream = (z_stream*)handle->stream;
+
+   handle->real_checksum = crc32(0L, Z_NULL, 0);
+
+   for (;;)
+   {
+      uint32_t produced;
+      uint32_t chunk    = min(size - done, ZLIB_INFLATE_CHUNK_SIZE);
+
+      stream->next_out  = handle->data + done;
+      stream->avail_out = chunk;
+
+      ret      = zlib_inflate_data_to_file_iterate(stream);
+      produced = chunk - stream->avail_out;
+
+      handle->real_checksum = crc32(handle->real_checksum,
+            handle->data + done, produced);
+      done += produced;
+
+      if (ret != 0 || !produced)
+         break;
+   }
+
+   return ret;
+}
+
 /**
  * zlib_inflate_data_to_file:
  * @path                        : filename path of archive.
@@ -390,8 +436,6 @@ int zlib_inflate_data_to_file(zlib_file_handle_t *handle,
       goto end;
    }
 
-   handle->real_checksum = zlib_crc32_calculate(handle->data, size);
-
 #if 0
    if (handle->real_checksum != checksum)
    {
@@ -652,9 +696,7 @@ static int zip_extract_cb(const char *name, const char *valid_exts,
                if (!zlib_inflate_data_to_file_init(&handle, cdata, csize, size))
                   return 0;
 
-               do{
-                  ret = zlib_inflate_data_to_file_iterate(handle.stream);
-               }while(ret == 0);
+               ret = zlib_inflate_data_to_file_crc(&handle, size);
 
                if (zlib_inflate_data_to_file(&handle, ret, new_path, valid_exts,
                         cdata, csize, size, checksum))
@@ -818,9 +860,7 @@ bool zlib_perform_mode(const char *path, const char *valid_exts,
             if (!zlib_inflate_data_to_file_init(&handle, cdata, csize, size))
                return false;
 
-            do{
-               ret = zlib_inflate_data_to_file_iterate(handle.stream);
-            }while(ret == 0);
+            ret = zlib_inflate_data_to_file_crc(&handle, size);
 
             if (!zlib_inflate_data_to_file(&handle, ret, path, valid_exts,
                      cdata, csize, size, crc32))
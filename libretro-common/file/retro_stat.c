@@ -79,7 +79,8 @@ enum stat_mode
    IS_VALID
 };
 
-static bool path_stat(const char *path, enum stat_mode mode, int32_t *size)
+static bool path_stat(const char *path, enum stat_mode mode,
+      int32_t *size, int64_t *mtime)
 {
 #if defined(VITA) || defined(PSP)
    SceIoStat buf;
@@ -119,6 +120,19 @@ static bool path_stat(const char *path, enum stat_mode mode, int32_t *size)
       *size = buf.st_size;
 #endif
 
+   if (mtime)
+   {
+#if defined(VITA) || defined(PSP)
+      /* Not a plain timestamp here. */
+      *mtime = 0;
+#elif defined(_WIN32)
+      *mtime = ((int64_t)file_info.ftLastWriteTime.dwHighDateTime << 32)
+         | file_info.ftLastWriteTime.dwLowDateTime;
+#else
+      *mtime = (int64_t)buf.st_mtime;
+#endif
+   }
+
    switch (mode)
    {
       case IS_DIRECTORY:
@@ -154,28 +168,48 @@ static bool path_stat(const char *path, enum stat_mode mode, int32_t *size)
  */
 bool path_is_directory(const char *path)
 {
-   return path_stat(path, IS_DIRECTORY, NULL);
+   return path_stat(path, IS_DIRECTORY, NULL, NULL);
 }
 
 bool path_is_character_special(const char *path)
 {
-   return path_stat(path, IS_CHARACTER_SPECIAL, NULL);
+   return path_stat(path, IS_CHARACTER_SPECIAL, NULL, NULL);
 }
 
 bool path_is_valid(const char *path)
 {
-   return path_stat(path, IS_VALID, NULL);
+   return path_stat(path, IS_VALID, NULL, NULL);
 }
 
 int32_t path_get_size(const char *path)
 {
    int32_t filesize = 0;
-   if (path_stat(path, IS_VALID, &filesize))
+   if (path_stat(path, IS_VALID, &filesize, NULL))
       return filesize;
 
    return -1;
 }
 
+/**
+ * path_get_mtime:
+ * @path               : path
+ *
+ * Gets the last modification time of a file. The unit is
+ * platform-specific, only compare it against other values
+ * returned by this function. Always 0 on platforms that do
+ * not have it.
+ *
+ * Returns: modification time, or -1 if @path does not exist.
+ */
+int64_t path_get_mtime(const char *path)
+{
+   int64_t mtime = 0;
+   if (path_stat(path, IS_VALID, NULL, &mtime))
+      return mtime;
+
+   return -1;
+}
+
 /**
  * path_mkdir_norecurse:
  * @dir                : directory
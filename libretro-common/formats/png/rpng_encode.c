@@ -25,6 +25,7 @@
 #include <string.h>
 
 #include <retro_file.h>
+#include <compat/zlib.h>
 
 #include "rpng_internal.h"
 
@@ -45,19 +46,18 @@ static void dword_write_be(uint8_t *buf, uint32_t val)
    *buf++ = (uint8_t)(val >>  0);
 }
 
-static bool png_write_crc(RFILE *file, const uint8_t *data, size_t size)
+static void png_write_crc(uint8_t *buf, size_t size)
 {
-   uint8_t crc_raw[4] = {0};
-   uint32_t crc = zlib_crc32_calculate(data, size);
-
-   dword_write_be(crc_raw, crc);
-   return retro_fwrite(file, crc_raw, sizeof(crc_raw)) == sizeof(crc_raw);
+   /* The CRC covers the chunk tag and data, not the length. */
+   dword_write_be(buf + size, zlib_crc32_calculate(
+            buf + sizeof(uint32_t), size - sizeof(uint32_t)));
 }
 
-static bool png_write_ihdr(RFILE *file, const struct png_ihdr *ihdr)
+/* Builds the 25 byte IHDR chunk in @buf. */
+static void png_build_ihdr(uint8_t *buf, const struct png_ihdr *ihdr)
 {
-   uint8_t ihdr_raw[21];
-   
+   uint8_t *ihdr_raw = buf;
+
    ihdr_raw[0]  = '0';                 /* Size */
    ihdr_raw[1]  = '0';
    ihdr_raw[2]  = '0';
@@ -80,45 +80,22 @@ static bool png_write_ihdr(RFILE *file, const struct png_ihdr *ihdr)
    ihdr_raw[19] =   ihdr->filter;
    ihdr_raw[20] =   ihdr->interlace;
 
-   dword_write_be(ihdr_raw +  0, sizeof(ihdr_raw) - 8);
+   dword_write_be(ihdr_raw +  0, 21 - 8);
    dword_write_be(ihdr_raw +  8, ihdr->width);
    dword_write_be(ihdr_raw + 12, ihdr->height);
-   if (retro_fwrite(file, ihdr_raw, sizeof(ihdr_raw)) != sizeof(ihdr_raw))
-      return false;
-
-   if (!png_write_crc(file, ihdr_raw + sizeof(uint32_t),
-            sizeof(ihdr_raw) - sizeof(uint32_t)))
-      return false;
-
-   return true;
+   png_write_crc(ihdr_raw, 21);
 }
 
-static bool png_write_idat(RFILE *file, const uint8_t *data, size_t size)
-{
-   if (retro_fwrite(file, data, size) != (ssize_t)size)
-      return false;
-
-   if (!png_write_crc(file, data + sizeof(uint32_t), size - sizeof(uint32_t)))
-      return false;
-
-   return true;
-}
-
-static bool png_write_iend(RFILE *file)
+/* Builds the 12 byte IEND chunk in @buf. */
+static void png_build_iend(uint8_t *buf)
 {
    const uint8_t data[] = {
       0, 0, 0, 0,
       'I', 'E', 'N', 'D',
    };
 
-   if (retro_fwrite(file, data, sizeof(data)) != sizeof(data))
-      return false;
-
-   if (!png_write_crc(file, data + sizeof(uint32_t),
-            sizeof(data) - sizeof(uint32_t)))
-      return false;
-
-   return true;
+   memcpy(buf, data, sizeof(data));
+   png_write_crc(buf, sizeof(data));
 }
 
 static void copy_argb_line(uint8_t *dst, const uint32_t *src, unsigned width)
@@ -205,65 +182,95 @@ static unsigned filter_paeth(uint8_t *target,
    return count_sad(target, width);
 }
 
-static bool rpng_save_image(const char *path,
-      const uint8_t *data,
-      unsigned width, unsigned height, unsigned pitch, unsigned bpp)
-{
-   unsigned h;
-   bool ret = true;
-   struct png_ihdr ihdr = {0};
-
-   size_t encode_buf_size  = 0;
-   uint8_t *encode_buf     = NULL;
-   uint8_t *deflate_buf    = NULL;
-   uint8_t *rgba_line      = NULL;
-   uint8_t *up_filtered    = NULL;
-   uint8_t *sub_filtered   = NULL;
-   uint8_t *avg_filtered   = NULL;
-   uint8_t *paeth_filtered = NULL;
-   uint8_t *prev_encoded   = NULL;
-   uint8_t *encode_target  = NULL;
-   void *stream            = NULL;
-
-   RFILE *file = retro_fopen(path, RFILE_MODE_WRITE, -1);
-   if (!file)
-      GOTO_END_ERROR();
+/* Deflate input is cut into chunks of this size when
+ * encoding on a thread pool. Each chunk is primed with the
+ * last RPNG_DEFLATE_WINDOW bytes of the chunk before it, so
+ * splitting costs almost nothing in compression. */
+#define RPNG_DEFLATE_CHUNK   (128 * 1024)
+#define RPNG_DEFLATE_WINDOW  (32 * 1024)
+#define RPNG_DEFLATE_LEVEL   9
+#define RPNG_BANDS_PER_THREAD 4
 
-   if (retro_fwrite(file, png_magic, sizeof(png_magic)) != sizeof(png_magic))
-      GOTO_END_ERROR();
+struct rpng_deflate_chunk
+{
+   uint8_t *out;
+   size_t out_size;
+   size_t in_size;
+   uint32_t adler;
+};
 
-   ihdr.width = width;
-   ihdr.height = height;
-   ihdr.depth = 8;
-   ihdr.color_type = bpp == sizeof(uint32_t) ? 6 : 2; /* RGBA or RGB */
-   if (!png_write_ihdr(file, &ihdr))
-      GOTO_END_ERROR();
+struct rpng_encoder
+{
+   const uint8_t *data;
+   unsigned width;
+   unsigned height;
+   unsigned pitch;
+   unsigned bpp;
+   unsigned bands;
+
+   /* Filtered scanlines, each prefixed with its filter type. */
+   uint8_t *encode_buf;
+   size_t encode_buf_size;
+
+   struct rpng_deflate_chunk *chunks;
+   unsigned num_chunks;
+   bool failed;
+};
+
+static void copy_line(const struct rpng_encoder *enc,
+      uint8_t *dst, unsigned h)
+{
+   const uint8_t *src = enc->data + (size_t)h * enc->pitch;
 
-   encode_buf_size = (width * bpp + 1) * height;
-   encode_buf = (uint8_t*)malloc(encode_buf_size);
-   if (!encode_buf)
-      GOTO_END_ERROR();
+   if (enc->bpp == sizeof(uint32_t))
+      copy_argb_line(dst, (const uint32_t*)src, enc->width);
+   else
+      copy_bgr24_line(dst, src, enc->width);
+}
 
-   prev_encoded = (uint8_t*)calloc(1, width * bpp);
-   if (!prev_encoded)
-      GOTO_END_ERROR();
+/**
+ * rpng_filter_band:
+ * @data         : pointer to encoder object.
+ * @band         : index of the band of rows to filter.
+ *
+ * Filters one band of rows into the encode buffer. Rows
+ * only look at the unfiltered row above them, so bands
+ * can be filtered in any order.
+ **/
+static void rpng_filter_band(void *data, unsigned band)
+{
+   unsigned h;
+   struct rpng_encoder *enc = (struct rpng_encoder*)data;
+   size_t line_size         = enc->width * enc->bpp;
+   unsigned y               = (unsigned)(
+         (uint64_t)enc->height * band / enc->bands);
+   unsigned y_end           = (unsigned)(
+         (uint64_t)enc->height * (band + 1) / enc->bands);
+   uint8_t *encode_target   = enc->encode_buf + (line_size + 1) * y;
+   uint8_t *rgba_line       = (uint8_t*)malloc(line_size);
+   uint8_t *prev_encoded    = (uint8_t*)calloc(1, line_size);
+   uint8_t *up_filtered     = (uint8_t*)malloc(line_size);
+   uint8_t *sub_filtered    = (uint8_t*)malloc(line_size);
+   uint8_t *avg_filtered    = (uint8_t*)malloc(line_size);
+   uint8_t *paeth_filtered  = (uint8_t*)malloc(line_size);
+   unsigned width           = enc->width;
+   unsigned bpp             = enc->bpp;
+
+   if (!rgba_line || !prev_encoded || !up_filtered
+         || !sub_filtered || !avg_filtered || !paeth_filtered)
+   {
+      enc->failed = true;
+      goto end;
+   }
 
-   rgba_line      = (uint8_t*)malloc(width * bpp);
-   up_filtered    = (uint8_t*)malloc(width * bpp);
-   sub_filtered   = (uint8_t*)malloc(width * bpp);
-   avg_filtered   = (uint8_t*)malloc(width * bpp);
-   paeth_filtered = (uint8_t*)malloc(width * bpp);
-   if (!rgba_line || !up_filtered || !sub_filtered || !avg_filtered || !paeth_filtered)
-      GOTO_END_ERROR();
+   if (y > 0)
+      copy_line(enc, prev_encoded, y - 1);
 
-   encode_target = encode_buf;
-   for (h = 0; h < height;
-         h++, encode_target += width * bpp, data += pitch)
+   for (h = y; h < y_end; h++, encode_target += line_size)
    {
-      if (bpp == sizeof(uint32_t))
-         copy_argb_line(rgba_line, (const uint32_t*)data, width);
-      else
-         copy_bgr24_line(rgba_line, data, width);
+      uint8_t *tmp;
+
+      copy_line(enc, rgba_line, h);
 
       /* Try every filtering method, and choose the method
        * which has most entries as zero.
@@ -311,58 +318,270 @@ static bool rpng_save_image(const char *path,
          }
 
          *encode_target++ = filter;
-         memcpy(encode_target, chosen_filtered, width * bpp);
-
-         memcpy(prev_encoded, rgba_line, width * bpp);
+         memcpy(encode_target, chosen_filtered, line_size);
       }
+
+      /* The current line is the previous one for the next row. */
+      tmp          = prev_encoded;
+      prev_encoded = rgba_line;
+      rgba_line    = tmp;
    }
 
-   deflate_buf = (uint8_t*)malloc(encode_buf_size * 2); /* Just to be sure. */
-   if (!deflate_buf)
+end:
+   free(rgba_line);
+   free(prev_encoded);
+   free(up_filtered);
+   free(sub_filtered);
+   free(avg_filtered);
+   free(paeth_filtered);
+}
+
+/**
+ * rpng_deflate_chunk:
+ * @data         : pointer to encoder object.
+ * @index        : index of the chunk to compress.
+ *
+ * Compresses one chunk of the encode buffer to a raw deflate
+ * stream. All chunks but the last end with a sync flush, which
+ * byte-aligns them without ending the stream, so the chunks
+ * can simply be concatenated afterwards.
+ **/
+static void rpng_deflate_chunk(void *data, unsigned index)
+{
+   z_stream stream;
+   int flush;
+   struct rpng_encoder *enc        = (struct rpng_encoder*)data;
+   struct rpng_deflate_chunk *chunk = &enc->chunks[index];
+   size_t offset                   = (size_t)index * RPNG_DEFLATE_CHUNK;
+   size_t size                     = enc->encode_buf_size - offset;
+   bool last                       = index + 1 == enc->num_chunks;
+   size_t out_size                 = 0;
+
+   if (enc->num_chunks > 1 && size > RPNG_DEFLATE_CHUNK)
+      size = RPNG_DEFLATE_CHUNK;
+
+   memset(&stream, 0, sizeof(stream));
+   if (deflateInit2(&stream, RPNG_DEFLATE_LEVEL, Z_DEFLATED,
+            -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+   {
+      enc->failed = true;
+      return;
+   }
+
+   if (offset)
+   {
+      size_t dict_size = offset < RPNG_DEFLATE_WINDOW
+         ? offset : RPNG_DEFLATE_WINDOW;
+      deflateSetDictionary(&stream,
+            enc->encode_buf + offset - dict_size, (uInt)dict_size);
+   }
+
+   /* A sync flush adds an empty stored block on top of the bound. */
+   out_size   = deflateBound(&stream, (uLong)size) + 16;
+   chunk->out = (uint8_t*)malloc(out_size);
+   if (!chunk->out)
+      goto error;
+
+   stream.next_in   = enc->encode_buf + offset;
+   stream.avail_in  = (uInt)size;
+   stream.next_out  = chunk->out;
+   stream.avail_out = (uInt)out_size;
+   flush            = last ? Z_FINISH : Z_SYNC_FLUSH;
+
+   if (deflate(&stream, flush) != (last ? Z_STREAM_END : Z_OK)
+         || stream.avail_in || !stream.avail_out)
+      goto error;
+
+   chunk->out_size = out_size - stream.avail_out;
+   chunk->in_size  = size;
+   chunk->adler    = adler32(adler32(0, NULL, 0),
+         enc->encode_buf + offset, (uInt)size);
+   deflateEnd(&stream);
+   return;
+
+error:
+   deflateEnd(&stream);
+   enc->failed = true;
+}
+
+static void rpng_encoder_run(struct rpng_encoder *enc,
+      thread_pool_task_t task, unsigned count, thread_pool_t *pool)
+{
+   unsigned i;
+
+#ifdef HAVE_THREADS
+   if (pool && count > 1)
+   {
+      thread_pool_run(pool, task, enc, count);
+      return;
+   }
+#endif
+
+   for (i = 0; i < count; i++)
+      task(enc, i);
+}
+
+/**
+ * rpng_encode_image:
+ * @data         : pixels, top-down.
+ * @width        : width of the image.
+ * @height       : height of the image.
+ * @pitch        : distance between two rows of @data, in bytes.
+ * @bpp          : 4 for ARGB8888, 3 for BGR24.
+ * @pool         : thread pool to encode on, or NULL.
+ * @size         : size of the returned file.
+ *
+ * Encodes a PNG file in memory. Without @pool, all filtered rows go
+ * through one deflate stream. With @pool, rows are filtered in bands
+ * and deflated in independent chunks across the pool's threads; the
+ * chunks are joined into a single zlib stream.
+ *
+ * Returns: the PNG file, allocated with malloc(), or NULL.
+ **/
+static uint8_t *rpng_encode_image(const uint8_t *data,
+      unsigned width, unsigned height, unsigned pitch, unsigned bpp,
+      thread_pool_t *pool, size_t *size)
+{
+   unsigned i;
+   uint8_t *out     = NULL;
+   uint8_t *idat    = NULL;
+   size_t idat_size = 0;
+   uint32_t adler   = 0;
+   unsigned threads = 1;
+   bool ret         = true;
+   struct rpng_encoder enc;
+
+   memset(&enc, 0, sizeof(enc));
+
+   if (!width || !height)
       GOTO_END_ERROR();
 
-   stream = zlib_stream_new();
+#ifdef HAVE_THREADS
+   if (pool)
+      threads = thread_pool_get_threads(pool);
+#endif
 
-   if (!stream)
+   enc.data            = data;
+   enc.width           = width;
+   enc.height          = height;
+   enc.pitch           = pitch;
+   enc.bpp             = bpp;
+   enc.bands           = threads > 1 ? threads * RPNG_BANDS_PER_THREAD : 1;
+   if (enc.bands > height)
+      enc.bands        = height;
+   enc.encode_buf_size = (size_t)(width * bpp + 1) * height;
+   enc.encode_buf      = (uint8_t*)malloc(enc.encode_buf_size);
+   if (!enc.encode_buf)
       GOTO_END_ERROR();
 
-   zlib_set_stream(
-         stream,
-         encode_buf_size,
-         encode_buf_size * 2,
-         encode_buf,
-         deflate_buf + 8);
+   rpng_encoder_run(&enc, rpng_filter_band, enc.bands, pool);
+   if (enc.failed)
+      GOTO_END_ERROR();
 
-   zlib_deflate_init(stream, 9);
+   /* Chunk boundaries don't depend on the number of threads,
+    * so a given pool always produces the same file. */
+   enc.num_chunks = 1;
+   if (pool)
+      enc.num_chunks = (unsigned)((enc.encode_buf_size
+               + RPNG_DEFLATE_CHUNK - 1) / RPNG_DEFLATE_CHUNK);
+   enc.chunks = (struct rpng_deflate_chunk*)
+      calloc(enc.num_chunks, sizeof(*enc.chunks));
+   if (!enc.chunks)
+      GOTO_END_ERROR();
 
-   if (zlib_deflate_data_to_file(stream) != 1)
-   {
-      zlib_stream_deflate_free(stream);
+   rpng_encoder_run(&enc, rpng_deflate_chunk, enc.num_chunks, pool);
+   if (enc.failed)
       GOTO_END_ERROR();
+
+   /* IDAT: length, tag, zlib header, deflate chunks, Adler-32. */
+   idat_size = 8 + 2 + 4;
+   for (i = 0; i < enc.num_chunks; i++)
+      idat_size += enc.chunks[i].out_size;
+
+   *size = sizeof(png_magic) + 25 + idat_size + 4 + 12;
+   out   = (uint8_t*)malloc(*size);
+   if (!out)
+      GOTO_END_ERROR();
+
+   memcpy(out, png_magic, sizeof(png_magic));
+   {
+      struct png_ihdr ihdr = {0};
+
+      ihdr.width      = width;
+      ihdr.height     = height;
+      ihdr.depth      = 8;
+      ihdr.color_type = bpp == sizeof(uint32_t) ? 6 : 2; /* RGBA or RGB */
+      png_build_ihdr(out + sizeof(png_magic), &ihdr);
+   }
+
+   idat = out + sizeof(png_magic) + 25;
+   dword_write_be(idat + 0, (uint32_t)(idat_size - 8));
+   memcpy(idat + 4, "IDAT", 4);
+   /* Deflate with a 32K window at maximum compression. */
+   idat[8] = 0x78;
+   idat[9] = 0xda;
+
+   adler     = enc.chunks[0].adler;
+   idat_size = 10;
+   for (i = 0; i < enc.num_chunks; i++)
+   {
+      const struct rpng_deflate_chunk *chunk = &enc.chunks[i];
+
+      if (i > 0)
+         adler = adler32_combine(adler, chunk->adler,
+               (z_off_t)chunk->in_size);
+
+      memcpy(idat + idat_size, chunk->out, chunk->out_size);
+      idat_size += chunk->out_size;
    }
+   dword_write_be(idat + idat_size, adler);
+   idat_size += 4;
+
+   png_write_crc(idat, idat_size);
+   idat_size += 4;
 
-   zlib_stream_deflate_free(stream);
+   png_build_iend(idat + idat_size);
 
-   memcpy(deflate_buf + 4, "IDAT", 4);
-   dword_write_be(deflate_buf + 0, zlib_stream_get_total_out(stream));
-   if (!png_write_idat(file, deflate_buf, zlib_stream_get_total_out(stream) + 8))
+end:
+   if (enc.chunks)
+   {
+      for (i = 0; i < enc.num_chunks; i++)
+         free(enc.chunks[i].out);
+      free(enc.chunks);
+   }
+   free(enc.encode_buf);
+
+   if (!ret)
+   {
+      free(out);
+      return NULL;
+   }
+   return out;
+}
+
+static bool rpng_save_image(const char *path,
+      const uint8_t *data,
+      unsigned width, unsigned height, unsigned pitch, unsigned bpp)
+{
+   size_t size = 0;
+   bool ret    = true;
+   RFILE *file = NULL;
+   uint8_t *png = rpng_encode_image(data,
+         width, height, pitch, bpp, NULL, &size);
+
+   if (!png)
+      GOTO_END_ERROR();
+
+   file = retro_fopen(path, RFILE_MODE_WRITE, -1);
+   if (!file)
       GOTO_END_ERROR();
 
-   if (!png_write_iend(file))
+   if (retro_fwrite(file, png, size) != (ssize_t)size)
       GOTO_END_ERROR();
 
 end:
    retro_fclose(file);
-   free(encode_buf);
-   free(deflate_buf);
-   free(rgba_line);
-   free(prev_encoded);
-   free(up_filtered);
-   free(sub_filtered);
-   free(avg_filtered);
-   free(paeth_filtered);
-
-   zlib_stream_free(stream);
+   free(png);
    return ret;
 }
 
@@ -380,4 +599,20 @@ bool rpng_save_image_bgr24(const char *path, const uint8_t *data,
          width, height, pitch, 3);
 }
 
+uint8_t *rpng_encode_image_argb(const uint32_t *data,
+      unsigned width, unsigned height, unsigned pitch,
+      thread_pool_t *pool, size_t *size)
+{
+   return rpng_encode_image((const uint8_t*)data,
+         width, height, pitch, sizeof(uint32_t), pool, size);
+}
+
+uint8_t *rpng_encode_image_bgr24(const uint8_t *data,
+      unsigned width, unsigned height, unsigned pitch,
+      thread_pool_t *pool, size_t *size)
+{
+   return rpng_encode_image(data,
+         width, height, pitch, 3, pool, size);
+}
+
 #endif
@@ -30,6 +30,12 @@
 
 #include <file/nbio.h>
 #include <formats/rpng.h>
+#include <rthreads/thread_pool.h>
+
+/* Odd sizes, so bands and deflate chunks don't split evenly. */
+#define TEST_ENCODE_WIDTH   333
+#define TEST_ENCODE_HEIGHT  257
+#define TEST_ENCODE_THREADS 4
 
 static int test_rpng(const char *in_path)
 {
@@ -108,6 +114,113 @@ static int test_rpng(const char *in_path)
    return 0;
 }
 
+static bool test_encode_roundtrip(const char *path, const uint8_t *png,
+      size_t size, const uint32_t *expected)
+{
+   bool ret       = false;
+   uint32_t *data = NULL;
+   unsigned width = 0;
+   unsigned height = 0;
+   FILE *file     = fopen(path, "wb");
+
+   if (!png || !file)
+      goto end;
+   if (fwrite(png, 1, size, file) != size)
+      goto end;
+   fclose(file);
+   file = NULL;
+
+   if (!rpng_load_image_argb(path, &data, &width, &height))
+      goto end;
+
+   ret = width == TEST_ENCODE_WIDTH && height == TEST_ENCODE_HEIGHT
+      && !memcmp(data, expected,
+            TEST_ENCODE_WIDTH * TEST_ENCODE_HEIGHT * sizeof(uint32_t));
+
+end:
+   if (file)
+      fclose(file);
+   free(data);
+   return ret;
+}
+
+/* Encodes the same image without and with a thread pool, in both
+ * pixel formats, and checks that every file decodes to the input. */
+static int test_rpng_encode(void)
+{
+   unsigned x, y;
+   size_t size        = 0;
+   uint8_t *png       = NULL;
+   int ret            = 0;
+   thread_pool_t *pool = thread_pool_new(TEST_ENCODE_THREADS);
+   /* Padded pitches, like a video driver's framebuffer. */
+   unsigned argb_pitch = (TEST_ENCODE_WIDTH + 3) * sizeof(uint32_t);
+   unsigned bgr_pitch  = TEST_ENCODE_WIDTH * 3 + 5;
+   uint32_t *expected  = (uint32_t*)malloc(
+         TEST_ENCODE_WIDTH * TEST_ENCODE_HEIGHT * sizeof(uint32_t));
+   uint32_t *argb      = (uint32_t*)calloc(TEST_ENCODE_HEIGHT, argb_pitch);
+   uint8_t *bgr        = (uint8_t*)calloc(TEST_ENCODE_HEIGHT, bgr_pitch);
+
+   if (!pool || !expected || !argb || !bgr)
+   {
+      ret = 6;
+      goto end;
+   }
+
+   /* Flat areas and noise, so every filter type gets picked. */
+   srand(1);
+   for (y = 0; y < TEST_ENCODE_HEIGHT; y++)
+   {
+      for (x = 0; x < TEST_ENCODE_WIDTH; x++)
+      {
+         uint32_t col = (y & 32) ? (uint32_t)rand() : x * 0x010203 + y;
+         uint8_t *pix = bgr + y * bgr_pitch + x * 3;
+
+         col |= 0xff000000;
+         expected[y * TEST_ENCODE_WIDTH + x]                = col;
+         argb[y * (argb_pitch / sizeof(uint32_t)) + x]      = col;
+         pix[0] = (uint8_t)(col >>  0);
+         pix[1] = (uint8_t)(col >>  8);
+         pix[2] = (uint8_t)(col >> 16);
+      }
+   }
+
+   png = rpng_encode_image_argb(argb, TEST_ENCODE_WIDTH,
+         TEST_ENCODE_HEIGHT, argb_pitch, NULL, &size);
+   if (!test_encode_roundtrip("/tmp/test_serial.png", png, size, expected))
+      ret = 7;
+   free(png);
+
+   png = rpng_encode_image_argb(argb, TEST_ENCODE_WIDTH,
+         TEST_ENCODE_HEIGHT, argb_pitch, pool, &size);
+   if (!test_encode_roundtrip("/tmp/test_pooled.png", png, size, expected))
+      ret = 8;
+   free(png);
+
+   png = rpng_encode_image_bgr24(bgr, TEST_ENCODE_WIDTH,
+         TEST_ENCODE_HEIGHT, bgr_pitch, NULL, &size);
+   if (!test_encode_roundtrip("/tmp/test_serial.png", png, size, expected))
+      ret = 9;
+   free(png);
+
+   png = rpng_encode_image_bgr24(bgr, TEST_ENCODE_WIDTH,
+         TEST_ENCODE_HEIGHT, bgr_pitch, pool, &size);
+   if (!test_encode_roundtrip("/tmp/test_pooled.png", png, size, expected))
+      ret = 10;
+   free(png);
+
+   if (!ret)
+      fprintf(stderr, "Serial and pooled encodes round-trip!\n");
+
+end:
+   if (pool)
+      thread_pool_free(pool);
+   free(expected);
+   free(argb);
+   free(bgr);
+   return ret;
+}
+
 int main(int argc, char *argv[])
 {
    const char *in_path = "/tmp/test.png";
@@ -129,5 +242,11 @@ int main(int argc, char *argv[])
       return -1;
    }
 
+   if (test_rpng_encode() != 0)
+   {
+      fprintf(stderr, "Encode test failed.\n");
+      return -1;
+   }
+
    return 0;
 }
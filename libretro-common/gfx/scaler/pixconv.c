@@ -31,10 +31,72 @@
 
 #ifdef SCALER_NO_SIMD
 #undef __SSE2__
+#undef __AVX2__
+#undef __ARM_NEON__
+#undef __ARM_NEON
 #endif
 
 #if defined(__SSE2__)
 #include <emmintrin.h>
+
+#if defined(__AVX2__) || (defined(__GNUC__) && !defined(__clang__) && \
+      (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+/* GCC can build the AVX2 kernels for a generic target,
+ * pixconv_get_fastest() only hands them out if the CPU
+ * reports AVX2 at runtime. */
+#define HAVE_PIXCONV_AVX2
+#include <immintrin.h>
+#ifdef __AVX2__
+#define PIXCONV_AVX2_TARGET
+#else
+#define PIXCONV_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define HAVE_PIXCONV_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(HAVE_PIXCONV_NEON)
+/* Expand eight 0RGB1555 pixels to 8-bit B, G, R planes,
+ * replicating the top bits into the low ones like the C paths do. */
+static INLINE uint8x8x3_t expand_0rgb1555_neon(uint16x8_t in)
+{
+   uint8x8x3_t bgr;
+   uint8x8_t r = vand_u8(vshrn_n_u16(in, 7), vdup_n_u8(0xf8));
+   uint8x8_t g = vand_u8(vshrn_n_u16(in, 2), vdup_n_u8(0xf8));
+   uint8x8_t b = vmovn_u16(vshlq_n_u16(in, 3));
+
+   bgr.val[0] = vorr_u8(b, vshr_n_u8(b, 5));
+   bgr.val[1] = vorr_u8(g, vshr_n_u8(g, 5));
+   bgr.val[2] = vorr_u8(r, vshr_n_u8(r, 5));
+   return bgr;
+}
+
+/* Same as above for eight RGB565 pixels. */
+static INLINE uint8x8x3_t expand_rgb565_neon(uint16x8_t in)
+{
+   uint8x8x3_t bgr;
+   uint8x8_t r = vand_u8(vshrn_n_u16(in, 8), vdup_n_u8(0xf8));
+   uint8x8_t g = vand_u8(vshrn_n_u16(in, 3), vdup_n_u8(0xfc));
+   uint8x8_t b = vmovn_u16(vshlq_n_u16(in, 3));
+
+   bgr.val[0] = vorr_u8(b, vshr_n_u8(b, 5));
+   bgr.val[1] = vorr_u8(g, vshr_n_u8(g, 6));
+   bgr.val[2] = vorr_u8(r, vshr_n_u8(r, 5));
+   return bgr;
+}
+
+static INLINE void store_argb8888_neon(uint32_t *output, uint8x8x3_t bgr)
+{
+   uint8x8x4_t argb;
+   argb.val[0] = bgr.val[0];
+   argb.val[1] = bgr.val[1];
+   argb.val[2] = bgr.val[2];
+   argb.val[3] = vdup_n_u8(0xff);
+   vst4_u8((uint8_t*)output, argb);
+}
 #endif
 
 void conv_rgb565_0rgb1555(void *output_, const void *input_,
@@ -45,25 +107,36 @@ void conv_rgb565_0rgb1555(void *output_, const void *input_,
    const uint16_t *input = (const uint16_t*)input_;
    uint16_t *output = (uint16_t*)output_;
 
-#if defined(__SSE2_)
+#if defined(__SSE2__)
    int max_width = width - 7;
 
    const __m128i hi_mask   = _mm_set1_epi16(0x7fe0);
    const __m128i lo_mask   = _mm_set1_epi16(0x1f);
+#elif defined(HAVE_PIXCONV_NEON)
+   const uint16x8_t hi_mask = vdupq_n_u16(0x7fe0);
+   const uint16x8_t lo_mask = vdupq_n_u16(0x1f);
 #endif
 
    for (h = 0; h < height;
          h++, output += out_stride >> 1, input += in_stride >> 1)
    {
       int w = 0;
-#if defined(__SSE2_)
+#if defined(__SSE2__)
       for (; w < max_width; w += 8)
       {
          const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
-         __m128i hi = _mm_and_si128(_mm_slli_epi16(in, 1), hi_mask);
+         __m128i hi = _mm_and_si128(_mm_srli_epi16(in, 1), hi_mask);
          __m128i lo = _mm_and_si128(in, lo_mask);
          _mm_storeu_si128((__m128i*)(output + w), _mm_or_si128(hi, lo));
       }
+#elif defined(HAVE_PIXCONV_NEON)
+      for (; w + 8 <= width; w += 8)
+      {
+         const uint16x8_t in = vld1q_u16(input + w);
+         uint16x8_t hi = vandq_u16(vshrq_n_u16(in, 1), hi_mask);
+         uint16x8_t lo = vandq_u16(in, lo_mask);
+         vst1q_u16(output + w, vorrq_u16(hi, lo));
+      }
 #endif
 
       for (; w < width; w++)
@@ -91,6 +164,10 @@ void conv_0rgb1555_rgb565(void *output_, const void *input_,
          (int16_t)((0x1f << 11) | (0x1f << 6)));
    const __m128i lo_mask   = _mm_set1_epi16(0x1f);
    const __m128i glow_mask = _mm_set1_epi16(1 << 5);
+#elif defined(HAVE_PIXCONV_NEON)
+   const uint16x8_t hi_mask   = vdupq_n_u16((0x1f << 11) | (0x1f << 6));
+   const uint16x8_t lo_mask   = vdupq_n_u16(0x1f);
+   const uint16x8_t glow_mask = vdupq_n_u16(1 << 5);
 #endif
 
    for (h = 0; h < height;
@@ -107,6 +184,15 @@ void conv_0rgb1555_rgb565(void *output_, const void *input_,
          _mm_storeu_si128((__m128i*)(output + w),
                _mm_or_si128(rg, _mm_or_si128(b, glow)));
       }
+#elif defined(HAVE_PIXCONV_NEON)
+      for (; w + 8 <= width; w += 8)
+      {
+         const uint16x8_t in = vld1q_u16(input + w);
+         uint16x8_t rg   = vandq_u16(vshlq_n_u16(in, 1), hi_mask);
+         uint16x8_t b    = vandq_u16(in, lo_mask);
+         uint16x8_t glow = vandq_u16(vshrq_n_u16(in, 4), glow_mask);
+         vst1q_u16(output + w, vorrq_u16(rg, vorrq_u16(b, glow)));
+      }
 #endif
 
       for (; w < width; w++)
@@ -170,6 +256,10 @@ void conv_0rgb1555_argb8888(void *output_, const void *input_,
          _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
          _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
       }
+#elif defined(HAVE_PIXCONV_NEON)
+      for (; w + 8 <= width; w += 8)
+         store_argb8888_neon(output + w,
+               expand_0rgb1555_neon(vld1q_u16(input + w)));
 #endif
 
       for (; w < width; w++)
@@ -238,6 +328,10 @@ void conv_rgb565_argb8888(void *output_, const void *input_,
          _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
          _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
       }
+#elif defined(HAVE_PIXCONV_NEON)
+      for (; w + 8 <= width; w += 8)
+         store_argb8888_neon(output + w,
+               expand_rgb565_neon(vld1q_u16(input + w)));
 #endif
 
       for (; w < width; w++)
@@ -264,19 +358,15 @@ void conv_argb8888_rgba4444(void *output_, const void *input_,
    uint16_t *output      = (uint16_t*)output_;
 
    for (h = 0; h < height;
-         h++, output += out_stride >> 2, input += in_stride >> 1)
+         h++, output += out_stride >> 1, input += in_stride >> 2)
    {
       for (w = 0; w < width; w++)
       {
          uint32_t col = input[w];
-         uint32_t r = (col >> 16) & 0xf;
-         uint32_t g = (col >>  8) & 0xf;
-         uint32_t b = (col) & 0xf;
-         uint32_t a = (col >>  24) & 0xf;
-         r = (r >> 4) | r;
-         g = (g >> 4) | g;
-         b = (b >> 4) | b;
-         a = (a >> 4) | a;
+         uint32_t r = (col >> 20) & 0xf;
+         uint32_t g = (col >> 12) & 0xf;
+         uint32_t b = (col >>  4) & 0xf;
+         uint32_t a = (col >> 28) & 0xf;
 
          output[w] = (r << 12) | (g << 8) | (b << 4) | a;
       }
@@ -448,6 +538,9 @@ void conv_0rgb1555_bgr24(void *output_, const void *input_,
          /* Non-POT pixel sizes ftl :( */
          store_bgr24_sse2(out, res_lo0, res_hi0, res_lo1, res_hi1);
       }
+#elif defined(HAVE_PIXCONV_NEON)
+      for (; w + 8 <= width; w += 8, out += 24)
+         vst3_u8(out, expand_0rgb1555_neon(vld1q_u16(input + w)));
 #endif
 
       for (; w < width; w++)
@@ -533,6 +626,9 @@ void conv_rgb565_bgr24(void *output_, const void *input_,
 
          store_bgr24_sse2(out, res_lo0, res_hi0, res_lo1, res_hi1);
       }
+#elif defined(HAVE_PIXCONV_NEON)
+      for (; w + 8 <= width; w += 8, out += 24)
+         vst3_u8(out, expand_rgb565_neon(vld1q_u16(input + w)));
 #endif
 
       for (; w < width; w++)
@@ -622,6 +718,16 @@ void conv_argb8888_bgr24(void *output_, const void *input_,
                _mm_loadu_si128((const __m128i*)(input + w +  8)),
                _mm_loadu_si128((const __m128i*)(input + w + 12)));
       }
+#elif defined(HAVE_PIXCONV_NEON)
+      for (; w + 16 <= width; w += 16, out += 48)
+      {
+         uint8x16x4_t argb = vld4q_u8((const uint8_t*)(input + w));
+         uint8x16x3_t bgr;
+         bgr.val[0] = argb.val[0];
+         bgr.val[1] = argb.val[1];
+         bgr.val[2] = argb.val[2];
+         vst3q_u8(out, bgr);
+      }
 #endif
 
       for (; w < width; w++)
@@ -638,14 +744,42 @@ void conv_argb8888_abgr8888(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint32_t *input = (const uint32_t*)input_;
    uint32_t *output      = (uint32_t*)output_;
 
+#if defined(__SSE2__)
+   const __m128i mask_ag = _mm_set1_epi32((int)0xff00ff00);
+   const __m128i mask_r  = _mm_set1_epi32(0x00ff0000);
+   const __m128i mask_b  = _mm_set1_epi32(0x000000ff);
+#endif
+
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      int w = 0;
+#if defined(__SSE2__)
+      for (; w + 4 <= width; w += 4)
+      {
+         const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+         __m128i r  = _mm_and_si128(_mm_slli_epi32(in, 16), mask_r);
+         __m128i b  = _mm_and_si128(_mm_srli_epi32(in, 16), mask_b);
+         __m128i ag = _mm_and_si128(in, mask_ag);
+         _mm_storeu_si128((__m128i*)(output + w),
+               _mm_or_si128(ag, _mm_or_si128(r, b)));
+      }
+#elif defined(HAVE_PIXCONV_NEON)
+      for (; w + 16 <= width; w += 16)
+      {
+         uint8x16x4_t argb = vld4q_u8((const uint8_t*)(input + w));
+         uint8x16_t   b    = argb.val[0];
+         argb.val[0]       = argb.val[2];
+         argb.val[2]       = b;
+         vst4q_u8((uint8_t*)(output + w), argb);
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          output[w] = ((col << 16) & 0xff0000) | 
@@ -816,3 +950,351 @@ void conv_copy(void *output_, const void *input_,
       memcpy(output, input, copy_len);
 }
 
+
+#ifdef HAVE_PIXCONV_AVX2
+/* The AVX2 converters do 16 pixels per step and hand the rest
+ * of each row to the SSE2/C converter they stand in for. */
+
+static PIXCONV_AVX2_TARGET INLINE void pack_argb8888_avx2(
+      __m256i r, __m256i g, __m256i b, __m256i *lo, __m256i *hi)
+{
+   const __m256i a   = _mm256_set1_epi16(0x00ff);
+   __m256i res_lo    = _mm256_or_si256(_mm256_unpacklo_epi8(b, g),
+         _mm256_slli_si256(_mm256_unpacklo_epi8(r, a), 2));
+   __m256i res_hi    = _mm256_or_si256(_mm256_unpackhi_epi8(b, g),
+         _mm256_slli_si256(_mm256_unpackhi_epi8(r, a), 2));
+
+   /* Unpacks work per 128-bit lane, put the pixels back in order. */
+   *lo = _mm256_permute2x128_si256(res_lo, res_hi, 0x20);
+   *hi = _mm256_permute2x128_si256(res_lo, res_hi, 0x31);
+}
+
+static PIXCONV_AVX2_TARGET INLINE void expand_0rgb1555_avx2(
+      __m256i in, __m256i *lo, __m256i *hi)
+{
+   const __m256i pix_mask_r  = _mm256_set1_epi16(0x1f << 10);
+   const __m256i pix_mask_gb = _mm256_set1_epi16(0x1f <<  5);
+   const __m256i mul15_mid   = _mm256_set1_epi16(0x4200);
+   const __m256i mul15_hi    = _mm256_set1_epi16(0x0210);
+   __m256i r = _mm256_and_si256(in, pix_mask_r);
+   __m256i g = _mm256_and_si256(in, pix_mask_gb);
+   __m256i b = _mm256_and_si256(_mm256_slli_epi16(in, 5), pix_mask_gb);
+
+   pack_argb8888_avx2(
+         _mm256_mulhi_epi16(r, mul15_hi),
+         _mm256_mulhi_epi16(g, mul15_mid),
+         _mm256_mulhi_epi16(b, mul15_mid), lo, hi);
+}
+
+static PIXCONV_AVX2_TARGET INLINE void expand_rgb565_avx2(
+      __m256i in, __m256i *lo, __m256i *hi)
+{
+   const __m256i pix_mask_r = _mm256_set1_epi16(0x1f << 10);
+   const __m256i pix_mask_g = _mm256_set1_epi16(0x3f <<  5);
+   const __m256i pix_mask_b = _mm256_set1_epi16(0x1f <<  5);
+   const __m256i mul16_r    = _mm256_set1_epi16(0x0210);
+   const __m256i mul16_g    = _mm256_set1_epi16(0x2080);
+   const __m256i mul16_b    = _mm256_set1_epi16(0x4200);
+   __m256i r = _mm256_and_si256(_mm256_srli_epi16(in, 1), pix_mask_r);
+   __m256i g = _mm256_and_si256(in, pix_mask_g);
+   __m256i b = _mm256_and_si256(_mm256_slli_epi16(in, 5), pix_mask_b);
+
+   pack_argb8888_avx2(
+         _mm256_mulhi_epi16(r, mul16_r),
+         _mm256_mulhi_epi16(g, mul16_g),
+         _mm256_mulhi_epi16(b, mul16_b), lo, hi);
+}
+
+/* Writes exactly 24 bytes, so it is safe up to the end of a row. */
+static PIXCONV_AVX2_TARGET INLINE void store_bgr24_avx2(
+      uint8_t *out, __m256i argb)
+{
+   const __m256i shuf = _mm256_setr_epi8(
+         0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+         0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+   const __m256i perm = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+   __m256i bgr        = _mm256_permutevar8x32_epi32(
+         _mm256_shuffle_epi8(argb, shuf), perm);
+
+   _mm_storeu_si128((__m128i*)out, _mm256_castsi256_si128(bgr));
+   _mm_storel_epi64((__m128i*)(out + 16),
+         _mm256_extracti128_si256(bgr, 1));
+}
+
+static PIXCONV_AVX2_TARGET void conv_0rgb1555_rgb565_avx2(
+      void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input   = (const uint16_t*)input_;
+   uint16_t *output        = (uint16_t*)output_;
+   const __m256i hi_mask   = _mm256_set1_epi16(
+         (int16_t)((0x1f << 11) | (0x1f << 6)));
+   const __m256i lo_mask   = _mm256_set1_epi16(0x1f);
+   const __m256i glow_mask = _mm256_set1_epi16(1 << 5);
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 1, input += in_stride >> 1)
+   {
+      int w = 0;
+      for (; w + 16 <= width; w += 16)
+      {
+         const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+         __m256i rg   = _mm256_and_si256(_mm256_slli_epi16(in, 1), hi_mask);
+         __m256i b    = _mm256_and_si256(in, lo_mask);
+         __m256i glow = _mm256_and_si256(_mm256_srli_epi16(in, 4), glow_mask);
+         _mm256_storeu_si256((__m256i*)(output + w),
+               _mm256_or_si256(rg, _mm256_or_si256(b, glow)));
+      }
+
+      if (w < width)
+         conv_0rgb1555_rgb565(output + w, input + w,
+               width - w, 1, out_stride, in_stride);
+   }
+}
+
+static PIXCONV_AVX2_TARGET void conv_rgb565_0rgb1555_avx2(
+      void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+   const __m256i hi_mask = _mm256_set1_epi16(0x7fe0);
+   const __m256i lo_mask = _mm256_set1_epi16(0x1f);
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 1, input += in_stride >> 1)
+   {
+      int w = 0;
+      for (; w + 16 <= width; w += 16)
+      {
+         const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+         __m256i hi = _mm256_and_si256(_mm256_srli_epi16(in, 1), hi_mask);
+         __m256i lo = _mm256_and_si256(in, lo_mask);
+         _mm256_storeu_si256((__m256i*)(output + w),
+               _mm256_or_si256(hi, lo));
+      }
+
+      if (w < width)
+         conv_rgb565_0rgb1555(output + w, input + w,
+               width - w, 1, out_stride, in_stride);
+   }
+}
+
+static PIXCONV_AVX2_TARGET void conv_0rgb1555_argb8888_avx2(
+      void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 2, input += in_stride >> 1)
+   {
+      int w = 0;
+      for (; w + 16 <= width; w += 16)
+      {
+         __m256i lo, hi;
+         expand_0rgb1555_avx2(
+               _mm256_loadu_si256((const __m256i*)(input + w)), &lo, &hi);
+         _mm256_storeu_si256((__m256i*)(output + w + 0), lo);
+         _mm256_storeu_si256((__m256i*)(output + w + 8), hi);
+      }
+
+      if (w < width)
+         conv_0rgb1555_argb8888(output + w, input + w,
+               width - w, 1, out_stride, in_stride);
+   }
+}
+
+static PIXCONV_AVX2_TARGET void conv_rgb565_argb8888_avx2(
+      void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 2, input += in_stride >> 1)
+   {
+      int w = 0;
+      for (; w + 16 <= width; w += 16)
+      {
+         __m256i lo, hi;
+         expand_rgb565_avx2(
+               _mm256_loadu_si256((const __m256i*)(input + w)), &lo, &hi);
+         _mm256_storeu_si256((__m256i*)(output + w + 0), lo);
+         _mm256_storeu_si256((__m256i*)(output + w + 8), hi);
+      }
+
+      if (w < width)
+         conv_rgb565_argb8888(output + w, input + w,
+               width - w, 1, out_stride, in_stride);
+   }
+}
+
+static PIXCONV_AVX2_TARGET void conv_0rgb1555_bgr24_avx2(
+      void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint8_t *output       = (uint8_t*)output_;
+
+   for (h = 0; h < height;
+         h++, output += out_stride, input += in_stride >> 1)
+   {
+      int w = 0;
+      for (; w + 16 <= width; w += 16)
+      {
+         __m256i lo, hi;
+         expand_0rgb1555_avx2(
+               _mm256_loadu_si256((const __m256i*)(input + w)), &lo, &hi);
+         store_bgr24_avx2(output + 3 * w +  0, lo);
+         store_bgr24_avx2(output + 3 * w + 24, hi);
+      }
+
+      if (w < width)
+         conv_0rgb1555_bgr24(output + 3 * w, input + w,
+               width - w, 1, out_stride, in_stride);
+   }
+}
+
+static PIXCONV_AVX2_TARGET void conv_rgb565_bgr24_avx2(
+      void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint8_t *output       = (uint8_t*)output_;
+
+   for (h = 0; h < height;
+         h++, output += out_stride, input += in_stride >> 1)
+   {
+      int w = 0;
+      for (; w + 16 <= width; w += 16)
+      {
+         __m256i lo, hi;
+         expand_rgb565_avx2(
+               _mm256_loadu_si256((const __m256i*)(input + w)), &lo, &hi);
+         store_bgr24_avx2(output + 3 * w +  0, lo);
+         store_bgr24_avx2(output + 3 * w + 24, hi);
+      }
+
+      if (w < width)
+         conv_rgb565_bgr24(output + 3 * w, input + w,
+               width - w, 1, out_stride, in_stride);
+   }
+}
+
+static PIXCONV_AVX2_TARGET void conv_argb8888_bgr24_avx2(
+      void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint8_t *output       = (uint8_t*)output_;
+
+   for (h = 0; h < height;
+         h++, output += out_stride, input += in_stride >> 2)
+   {
+      int w = 0;
+      for (; w + 16 <= width; w += 16)
+      {
+         store_bgr24_avx2(output + 3 * w +  0,
+               _mm256_loadu_si256((const __m256i*)(input + w + 0)));
+         store_bgr24_avx2(output + 3 * w + 24,
+               _mm256_loadu_si256((const __m256i*)(input + w + 8)));
+      }
+
+      if (w < width)
+         conv_argb8888_bgr24(output + 3 * w, input + w,
+               width - w, 1, out_stride, in_stride);
+   }
+}
+
+static PIXCONV_AVX2_TARGET void conv_argb8888_abgr8888_avx2(
+      void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+   const __m256i shuf    = _mm256_setr_epi8(
+         2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+         2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 2, input += in_stride >> 2)
+   {
+      int w = 0;
+      for (; w + 16 <= width; w += 16)
+      {
+         __m256i in0 = _mm256_loadu_si256((const __m256i*)(input + w + 0));
+         __m256i in1 = _mm256_loadu_si256((const __m256i*)(input + w + 8));
+         _mm256_storeu_si256((__m256i*)(output + w + 0),
+               _mm256_shuffle_epi8(in0, shuf));
+         _mm256_storeu_si256((__m256i*)(output + w + 8),
+               _mm256_shuffle_epi8(in1, shuf));
+      }
+
+      if (w < width)
+         conv_argb8888_abgr8888(output + w, input + w,
+               width - w, 1, out_stride, in_stride);
+   }
+}
+#endif
+
+/**
+ * pixconv_get_fastest:
+ * @conv         : one of the conv_* converters.
+ *
+ * Looks up the fastest variant of @conv the CPU can run.
+ * Meant to be called once when a converter is bound,
+ * not per frame.
+ *
+ * Returns: the faster variant, or @conv if there is none.
+ **/
+pixconv_t pixconv_get_fastest(pixconv_t conv)
+{
+#ifdef HAVE_PIXCONV_AVX2
+   static const struct
+   {
+      pixconv_t conv;
+      pixconv_t avx2;
+   } avx2_convs[] = {
+      { conv_0rgb1555_rgb565,   conv_0rgb1555_rgb565_avx2   },
+      { conv_rgb565_0rgb1555,   conv_rgb565_0rgb1555_avx2   },
+      { conv_0rgb1555_argb8888, conv_0rgb1555_argb8888_avx2 },
+      { conv_rgb565_argb8888,   conv_rgb565_argb8888_avx2   },
+      { conv_0rgb1555_bgr24,    conv_0rgb1555_bgr24_avx2    },
+      { conv_rgb565_bgr24,      conv_rgb565_bgr24_avx2      },
+      { conv_argb8888_bgr24,    conv_argb8888_bgr24_avx2    },
+      { conv_argb8888_abgr8888, conv_argb8888_abgr8888_avx2 },
+   };
+   unsigned i;
+
+#ifndef __AVX2__
+   __builtin_cpu_init();
+   if (!__builtin_cpu_supports("avx2"))
+      return conv;
+#endif
+
+   for (i = 0; i < sizeof(avx2_convs) / sizeof(avx2_convs[0]); i++)
+      if (avx2_convs[i].conv == conv)
+         return avx2_convs[i].avx2;
+#endif
+
+   return conv;
+}
@@ -0,0 +1,244 @@
+/* Copyright  (C) 2010-2015 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (pixconv_test.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <dynamic/dylib.h>
+#include <gfx/scaler/pixconv.h>
+
+/* Times every converter at least this long. */
+#define BENCH_MIN_USEC 200000
+
+#define PIXCONV(conv, in_bpp, out_bpp, align) \
+   { #conv, conv, in_bpp, out_bpp, align }
+
+static const struct
+{
+   const char *name;
+   pixconv_t conv;
+   unsigned in_bpp;
+   unsigned out_bpp;
+   /* Widths have to be a multiple of this. */
+   unsigned align;
+} convs[] = {
+   PIXCONV(conv_0rgb1555_argb8888, 2, 4, 1),
+   PIXCONV(conv_0rgb1555_rgb565,   2, 2, 1),
+   PIXCONV(conv_rgb565_0rgb1555,   2, 2, 1),
+   PIXCONV(conv_rgb565_argb8888,   2, 4, 1),
+   PIXCONV(conv_rgba4444_argb8888, 2, 4, 1),
+   PIXCONV(conv_rgba4444_rgb565,   2, 2, 1),
+   PIXCONV(conv_bgr24_argb8888,    3, 4, 1),
+   PIXCONV(conv_argb8888_0rgb1555, 4, 2, 1),
+   PIXCONV(conv_argb8888_rgba4444, 4, 2, 1),
+   PIXCONV(conv_argb8888_bgr24,    4, 3, 1),
+   PIXCONV(conv_argb8888_abgr8888, 4, 4, 1),
+   PIXCONV(conv_0rgb1555_bgr24,    2, 3, 1),
+   PIXCONV(conv_rgb565_bgr24,      2, 3, 1),
+   PIXCONV(conv_yuyv_argb8888,     2, 4, 2),
+   PIXCONV(conv_copy,              4, 4, 1),
+};
+
+static int64_t bench_time_usec(void)
+{
+   struct timespec tv;
+   clock_gettime(CLOCK_MONOTONIC, &tv);
+   return (int64_t)tv.tv_sec * 1000000 + tv.tv_nsec / 1000;
+}
+
+/**
+ * test_conv:
+ * @i            : index into convs.
+ * @fast         : converter under test.
+ * @ref          : same converter from the SCALER_NO_SIMD build.
+ *
+ * Compares @fast against @ref for widths 1-99 with odd strides.
+ * The padding of the output rows has to be left alone as well.
+ *
+ * Returns: true (1) if all outputs match, otherwise false (0).
+ **/
+static bool test_conv(unsigned i, pixconv_t fast, pixconv_t ref)
+{
+   int width;
+   const int height = 3;
+   bool ret         = true;
+
+   for (width = convs[i].align; width < 100; width += convs[i].align)
+   {
+      int j;
+      /* Odd strides in pixels, so rows don't stay aligned. */
+      int in_stride       = (width + 1 + 2 * (width % 3)) * convs[i].in_bpp;
+      int out_stride      = (width + 3 + 2 * (width % 2)) * convs[i].out_bpp;
+      uint8_t *input      = (uint8_t*)malloc(in_stride * height);
+      uint8_t *out_fast   = (uint8_t*)malloc(out_stride * height);
+      uint8_t *out_ref    = (uint8_t*)malloc(out_stride * height);
+
+      if (!input || !out_fast || !out_ref)
+      {
+         free(input);
+         free(out_fast);
+         free(out_ref);
+         return false;
+      }
+
+      for (j = 0; j < in_stride * height; j++)
+         input[j] = rand();
+      memset(out_fast, 0xa5, out_stride * height);
+      memset(out_ref,  0xa5, out_stride * height);
+
+      fast(out_fast, input, width, height, out_stride, in_stride);
+      ref(out_ref, input, width, height, out_stride, in_stride);
+
+      for (j = 0; j < out_stride * height; j++)
+      {
+         if (out_fast[j] != out_ref[j])
+         {
+            fprintf(stderr, "%s: width %d, byte %d differs: %02x, expected %02x.\n",
+                  convs[i].name, width, j, out_fast[j], out_ref[j]);
+            ret = false;
+            break;
+         }
+      }
+
+      free(input);
+      free(out_fast);
+      free(out_ref);
+
+      if (!ret)
+         break;
+   }
+
+   return ret;
+}
+
+/**
+ * bench_conv:
+ *
+ * Returns: throughput of @conv at @width x @height in Mpix/s.
+ **/
+static double bench_conv(unsigned i, pixconv_t conv,
+      int width, int height)
+{
+   int j;
+   int64_t start, elapsed;
+   unsigned frames     = 0;
+   int in_stride       = width * convs[i].in_bpp;
+   int out_stride      = width * convs[i].out_bpp;
+   uint8_t *input      = (uint8_t*)malloc(in_stride * height);
+   uint8_t *output     = (uint8_t*)malloc(out_stride * height);
+   double ret          = 0.0;
+
+   if (!input || !output)
+      goto end;
+
+   for (j = 0; j < in_stride * height; j++)
+      input[j] = rand();
+
+   /* Warm up the caches. */
+   conv(output, input, width, height, out_stride, in_stride);
+
+   start = bench_time_usec();
+   do
+   {
+      conv(output, input, width, height, out_stride, in_stride);
+      frames++;
+      elapsed = bench_time_usec() - start;
+   } while (elapsed < BENCH_MIN_USEC);
+
+   ret = (double)width * height * frames / elapsed;
+
+end:
+   free(input);
+   free(output);
+   return ret;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i;
+   int failed          = 0;
+   const char *ref_lib = "./pixconv_ref.so";
+   dylib_t lib         = NULL;
+
+   if (argc > 2)
+   {
+      fprintf(stderr, "Usage: %s [SCALER_NO_SIMD build of pixconv.c]\n", argv[0]);
+      return 1;
+   }
+
+   if (argc == 2)
+      ref_lib = argv[1];
+
+   lib = dylib_load(ref_lib);
+   if (!lib)
+   {
+      fprintf(stderr, "Could not load %s: %s\n", ref_lib, dylib_error());
+      return 1;
+   }
+
+   srand(1);
+
+   printf("Mpix/s at 320x240, C is the SCALER_NO_SIMD build.\n");
+   printf("%-24s  %6s  %10s  %10s  %10s\n",
+         "converter", "test", "C", "default", "fastest");
+
+   for (i = 0; i < sizeof(convs) / sizeof(convs[0]); i++)
+   {
+      pixconv_t ref  = (pixconv_t)dylib_proc(lib, convs[i].name);
+      pixconv_t fast = pixconv_get_fastest(convs[i].conv);
+      bool ok;
+
+      if (!ref)
+      {
+         fprintf(stderr, "%s is missing from %s.\n", convs[i].name, ref_lib);
+         failed++;
+         continue;
+      }
+
+      /* The default converter may have SSE2 or NEON paths
+       * of its own, test it as well as the fastest one. */
+      ok = test_conv(i, convs[i].conv, ref);
+      if (fast != convs[i].conv)
+         ok = test_conv(i, fast, ref) && ok;
+      if (!ok)
+         failed++;
+
+      printf("%-24s  %6s  %10.1f  %10.1f  %10.1f\n",
+            convs[i].name + strlen("conv_"), ok ? "ok" : "FAILED",
+            bench_conv(i, ref, 320, 240),
+            bench_conv(i, convs[i].conv, 320, 240),
+            bench_conv(i, fast, 320, 240));
+   }
+
+   dylib_close(lib);
+
+   if (failed)
+   {
+      fprintf(stderr, "%d converters failed.\n", failed);
+      return 1;
+   }
+
+   return 0;
+}
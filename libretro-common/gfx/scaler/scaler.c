@@ -30,6 +30,29 @@
 #include <gfx/scaler/filter.h>
 #include <gfx/scaler/pixconv.h>
 
+/* Bands handed to each pool thread per pass, so that work stealing
+ * can even out threads that fall behind. */
+#define SCALER_BANDS_PER_THREAD 4
+/* Smaller bands cost more in hand-over than they save. */
+#define SCALER_MIN_BAND_ROWS    8
+
+struct scaler_pass
+{
+   struct scaler_ctx *ctx;
+
+   void *output;
+   const void *input;
+
+   /* ARGB8888 frames the scaler itself reads and writes. */
+   void *output_frame;
+   const void *input_frame;
+   int output_stride;
+   int input_stride;
+
+   int rows;
+   unsigned bands;
+};
+
 /**
  * scaler_alloc:
  * @elem_size    : size of the elements to be used.
@@ -206,6 +229,7 @@ static bool set_direct_pix_conv(struct scaler_ctx *ctx)
    if (!ctx->direct_pixconv)
       return false;
 
+   ctx->direct_pixconv = pixconv_get_fastest(ctx->direct_pixconv);
    return true;
 }
 
@@ -259,6 +283,8 @@ static bool set_pix_conv(struct scaler_ctx *ctx)
          return false;
    }
 
+   ctx->in_pixconv  = pixconv_get_fastest(ctx->in_pixconv);
+   ctx->out_pixconv = pixconv_get_fastest(ctx->out_pixconv);
    return true;
 }
 
@@ -270,8 +296,7 @@ bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
       ctx->unscaled = true; /* Only pixel format conversion ... */
    else
    {
-      ctx->scaler_horiz = scaler_argb8888_horiz;
-      ctx->scaler_vert  = scaler_argb8888_vert;
+      scaler_argb8888_select(ctx);
       ctx->unscaled     = false;
    }
 
@@ -314,6 +339,123 @@ void scaler_ctx_gen_reset(struct scaler_ctx *ctx)
    memset(&ctx->output, 0, sizeof(ctx->output));
 }
 
+static void scaler_pass_get_band(const struct scaler_pass *pass,
+      unsigned index, int *y, int *height)
+{
+   *y      = (int)((int64_t)pass->rows * index / pass->bands);
+   *height = (int)((int64_t)pass->rows * (index + 1) / pass->bands) - *y;
+}
+
+static void scaler_pass_direct(void *data, unsigned index)
+{
+   int y, height;
+   struct scaler_pass *pass = (struct scaler_pass*)data;
+   struct scaler_ctx *ctx   = pass->ctx;
+
+   scaler_pass_get_band(pass, index, &y, &height);
+
+   ctx->direct_pixconv(
+         (uint8_t*)pass->output + y * ctx->out_stride,
+         (const uint8_t*)pass->input + y * ctx->in_stride,
+         ctx->out_width, height,
+         ctx->out_stride, ctx->in_stride);
+}
+
+/* Converts and horizontally scales a band of input rows. */
+static void scaler_pass_input(void *data, unsigned index)
+{
+   int y, height;
+   struct scaler_pass *pass = (struct scaler_pass*)data;
+   struct scaler_ctx *ctx   = pass->ctx;
+
+   scaler_pass_get_band(pass, index, &y, &height);
+
+   if (ctx->in_fmt != SCALER_FMT_ARGB8888)
+      ctx->in_pixconv(
+            (uint8_t*)ctx->input.frame + y * ctx->input.stride,
+            (const uint8_t*)pass->input + y * ctx->in_stride,
+            ctx->in_width, height,
+            ctx->input.stride, ctx->in_stride);
+
+   if (!ctx->scaler_special && ctx->scaler_horiz)
+      ctx->scaler_horiz(ctx, pass->input_frame,
+            pass->input_stride, y, height);
+}
+
+/* Vertically scales and converts a band of output rows. */
+static void scaler_pass_output(void *data, unsigned index)
+{
+   int y, height;
+   struct scaler_pass *pass = (struct scaler_pass*)data;
+   struct scaler_ctx *ctx   = pass->ctx;
+
+   scaler_pass_get_band(pass, index, &y, &height);
+
+   if (ctx->scaler_special)
+   {
+      /* Take some special, and (hopefully) more optimized path. */
+      ctx->scaler_special(ctx, pass->output_frame, pass->input_frame,
+            ctx->out_width, ctx->out_height,
+            ctx->in_width, ctx->in_height,
+            pass->output_stride, pass->input_stride,
+            y, height);
+   }
+   else if (ctx->scaler_vert)
+   {
+      /* Take generic filter path. */
+      ctx->scaler_vert(ctx, pass->output_frame,
+            pass->output_stride, y, height);
+   }
+
+   if (ctx->out_fmt != SCALER_FMT_ARGB8888)
+      ctx->out_pixconv(
+            (uint8_t*)pass->output + y * ctx->out_stride,
+            (const uint8_t*)ctx->output.frame + y * ctx->output.stride,
+            ctx->out_width, height,
+            ctx->out_stride, ctx->output.stride);
+}
+
+/**
+ * scaler_pass_run:
+ * @pass         : pass to run.
+ * @task         : callback that runs one band of the pass.
+ * @rows         : number of rows to split into bands.
+ *
+ * Runs @task over all bands of @rows, on the context's
+ * thread pool if it has one and the frame is large enough.
+ **/
+static void scaler_pass_run(struct scaler_pass *pass,
+      thread_pool_task_t task, int rows)
+{
+   unsigned threads = 1;
+
+#ifdef HAVE_THREADS
+   threads = thread_pool_get_threads(pass->ctx->pool);
+#endif
+
+   pass->rows  = rows;
+   pass->bands = 1;
+
+   if (threads > 1)
+   {
+      pass->bands = threads * SCALER_BANDS_PER_THREAD;
+      if ((int)pass->bands > rows / SCALER_MIN_BAND_ROWS)
+         pass->bands = rows / SCALER_MIN_BAND_ROWS;
+      if (pass->bands < 1)
+         pass->bands = 1;
+   }
+
+#ifdef HAVE_THREADS
+   if (pass->bands > 1)
+   {
+      thread_pool_run(pass->ctx->pool, task, pass, pass->bands);
+      return;
+   }
+#endif
+
+   task(pass, 0);
+}
+
 /**
  * scaler_ctx_scale:
  * @ctx          : pointer to scaler context object.
@@ -325,55 +467,39 @@ void scaler_ctx_gen_reset(struct scaler_ctx *ctx)
 void scaler_ctx_scale(struct scaler_ctx *ctx,
       void *output, const void *input)
 {
-   const void *input_frame = input;
-   void *output_frame      = output;
-   int input_stride        = ctx->in_stride;
-   int output_stride       = ctx->out_stride;
+   struct scaler_pass pass = {0};
+
+   pass.ctx           = ctx;
+   pass.output        = output;
+   pass.input         = input;
+   pass.output_frame  = output;
+   pass.input_frame   = input;
+   pass.output_stride = ctx->out_stride;
+   pass.input_stride  = ctx->in_stride;
 
    if (ctx->unscaled)
    {
       /* Just perform straight pixel conversion. */
-      ctx->direct_pixconv(output, input,
-            ctx->out_width, ctx->out_height,
-            ctx->out_stride, ctx->in_stride);
+      scaler_pass_run(&pass, scaler_pass_direct, ctx->out_height);
       return;
    }
 
    if (ctx->in_fmt != SCALER_FMT_ARGB8888)
    {
-      ctx->in_pixconv(ctx->input.frame, input,
-            ctx->in_width, ctx->in_height,
-            ctx->input.stride, ctx->in_stride);
-
-      input_frame       = ctx->input.frame;
-      input_stride      = ctx->input.stride;
+      pass.input_frame   = ctx->input.frame;
+      pass.input_stride  = ctx->input.stride;
    }
 
    if (ctx->out_fmt != SCALER_FMT_ARGB8888)
    {
-      output_frame  = ctx->output.frame;
-      output_stride = ctx->output.stride;
+      pass.output_frame  = ctx->output.frame;
+      pass.output_stride = ctx->output.stride;
    }
 
-   if (ctx->scaler_special)
-   {
-      /* Take some special, and (hopefully) more optimized path. */
-      ctx->scaler_special(ctx, output_frame, input_frame,
-            ctx->out_width, ctx->out_height,
-            ctx->in_width, ctx->in_height,
-            output_stride, input_stride);
-   }
-   else
-   {
-      /* Take generic filter path. */
-      if (ctx->scaler_horiz)
-         ctx->scaler_horiz(ctx, input_frame, input_stride);
-      if (ctx->scaler_vert)
-         ctx->scaler_vert (ctx, output, output_stride);
-   }
+   /* The vertical pass reads rows of the horizontal pass
+    * from any band, so the two can't overlap. */
+   if (ctx->in_fmt != SCALER_FMT_ARGB8888 || !ctx->scaler_special)
+      scaler_pass_run(&pass, scaler_pass_input, ctx->in_height);
 
-   if (ctx->out_fmt != SCALER_FMT_ARGB8888)
-      ctx->out_pixconv(output, ctx->output.frame,
-            ctx->out_width, ctx->out_height,
-            ctx->out_stride, ctx->output.stride);
+   scaler_pass_run(&pass, scaler_pass_output, ctx->out_height);
 }
@@ -0,0 +1,205 @@
+/* Copyright  (C) 2010-2015 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (scaler_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <gfx/scaler/scaler.h>
+#include <rthreads/thread_pool.h>
+
+/* Runs every format pair at least this long. */
+#define BENCH_MIN_USEC 200000
+
+static const struct
+{
+   enum scaler_pix_fmt fmt;
+   const char *name;
+   unsigned bpp;
+} formats[] = {
+   { SCALER_FMT_ARGB8888, "ARGB8888", 4 },
+   { SCALER_FMT_ABGR8888, "ABGR8888", 4 },
+   { SCALER_FMT_0RGB1555, "0RGB1555", 2 },
+   { SCALER_FMT_RGB565,   "RGB565",   2 },
+   { SCALER_FMT_BGR24,    "BGR24",    3 },
+   { SCALER_FMT_YUYV,     "YUYV",     2 },
+   { SCALER_FMT_RGBA4444, "RGBA4444", 2 },
+};
+
+static const struct
+{
+   enum scaler_type type;
+   const char *name;
+} types[] = {
+   { SCALER_TYPE_POINT,    "point"    },
+   { SCALER_TYPE_BILINEAR, "bilinear" },
+   { SCALER_TYPE_SINC,     "sinc"     },
+};
+
+static int64_t bench_time_usec(void)
+{
+   struct timespec tv;
+   clock_gettime(CLOCK_MONOTONIC, &tv);
+   return (int64_t)tv.tv_sec * 1000000 + tv.tv_nsec / 1000;
+}
+
+/**
+ * bench_scale:
+ *
+ * Times scaler_ctx_scale() for one format pair and scaler type.
+ *
+ * Returns: microseconds per frame, or a negative value if the
+ * scaler doesn't support the combination.
+ **/
+static double bench_scale(unsigned in_fmt, unsigned out_fmt,
+      unsigned type, thread_pool_t *pool,
+      int in_width, int in_height, int out_width, int out_height)
+{
+   int i;
+   unsigned frames = 0;
+   int64_t start, elapsed;
+   struct scaler_ctx ctx = {0};
+   uint8_t *input        = NULL;
+   uint8_t *output       = NULL;
+   double ret            = -1.0;
+
+   ctx.in_width    = in_width;
+   ctx.in_height   = in_height;
+   ctx.in_stride   = in_width * formats[in_fmt].bpp;
+   ctx.out_width   = out_width;
+   ctx.out_height  = out_height;
+   ctx.out_stride  = out_width * formats[out_fmt].bpp;
+   ctx.in_fmt      = formats[in_fmt].fmt;
+   ctx.out_fmt     = formats[out_fmt].fmt;
+   ctx.scaler_type = types[type].type;
+   ctx.pool        = pool;
+
+   if (!scaler_ctx_gen_filter(&ctx))
+      goto end;
+
+   input  = (uint8_t*)malloc(ctx.in_stride * in_height);
+   output = (uint8_t*)malloc(ctx.out_stride * out_height);
+   if (!input || !output)
+      goto end;
+
+   srand(1);
+   for (i = 0; i < ctx.in_stride * in_height; i++)
+      input[i] = rand();
+
+   /* Warm up the caches and the pool threads. */
+   scaler_ctx_scale(&ctx, output, input);
+
+   start = bench_time_usec();
+   do
+   {
+      scaler_ctx_scale(&ctx, output, input);
+      frames++;
+      elapsed = bench_time_usec() - start;
+   } while (elapsed < BENCH_MIN_USEC);
+
+   ret = (double)elapsed / frames;
+
+end:
+   free(input);
+   free(output);
+   scaler_ctx_gen_reset(&ctx);
+   return ret;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned in_fmt, out_fmt, type;
+   unsigned threads    = 4;
+   int in_width        = 320;
+   int in_height       = 240;
+   int out_width       = 1280;
+   int out_height      = 960;
+   thread_pool_t *pool = NULL;
+
+   if (argc != 1 && argc != 5 && argc != 6)
+   {
+      fprintf(stderr, "Usage: %s [in_width in_height out_width out_height [threads]]\n",
+            argv[0]);
+      return 1;
+   }
+
+   if (argc >= 5)
+   {
+      in_width   = atoi(argv[1]);
+      in_height  = atoi(argv[2]);
+      out_width  = atoi(argv[3]);
+      out_height = atoi(argv[4]);
+   }
+   if (argc == 6)
+      threads    = atoi(argv[5]);
+
+   if (in_width <= 0 || in_height <= 0 || out_width <= 0 || out_height <= 0)
+   {
+      fprintf(stderr, "Invalid frame size.\n");
+      return 1;
+   }
+
+   if (threads)
+      pool = thread_pool_new(threads);
+
+   printf("%dx%d -> %dx%d, pool of %u threads.\n",
+         in_width, in_height, out_width, out_height,
+         pool ? thread_pool_get_threads(pool) : 0);
+   printf("%-8s  %-8s  %-8s  %12s  %12s  %8s\n",
+         "in", "out", "scaler", "serial Mpix/s", "pool Mpix/s", "speedup");
+
+   for (type = 0; type < sizeof(types) / sizeof(types[0]); type++)
+   {
+      for (in_fmt = 0; in_fmt < sizeof(formats) / sizeof(formats[0]); in_fmt++)
+      {
+         for (out_fmt = 0; out_fmt < sizeof(formats) / sizeof(formats[0]); out_fmt++)
+         {
+            double pixels = (double)out_width * out_height;
+            double serial = bench_scale(in_fmt, out_fmt, type, NULL,
+                  in_width, in_height, out_width, out_height);
+            double pooled = -1.0;
+
+            if (serial < 0.0)
+               continue;
+
+            if (pool)
+               pooled = bench_scale(in_fmt, out_fmt, type, pool,
+                     in_width, in_height, out_width, out_height);
+
+            if (pooled > 0.0)
+               printf("%-8s  %-8s  %-8s  %12.1f  %12.1f  %7.2fx\n",
+                     formats[in_fmt].name, formats[out_fmt].name,
+                     types[type].name, pixels / serial, pixels / pooled,
+                     serial / pooled);
+            else
+               printf("%-8s  %-8s  %-8s  %12.1f  %12s  %8s\n",
+                     formats[in_fmt].name, formats[out_fmt].name,
+                     types[type].name, pixels / serial, "-", "-");
+         }
+      }
+   }
+
+   thread_pool_free(pool);
+   return 0;
+}
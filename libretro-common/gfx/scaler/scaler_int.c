@@ -26,6 +26,9 @@
 
 #ifdef SCALER_NO_SIMD
 #undef __SSE2__
+#undef __AVX2__
+#undef __ARM_NEON__
+#undef __ARM_NEON
 #endif
 
 #if defined(__SSE2__)
@@ -33,6 +36,23 @@
 #ifdef _WIN32
 #include <intrin.h>
 #endif
+
+#if defined(__AVX2__) || (defined(__GNUC__) && !defined(__clang__) && \
+      (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+/* GCC can build the AVX2 kernels for a generic target,
+ * they are only used if the CPU reports AVX2 at runtime. */
+#define HAVE_SCALER_AVX2
+#include <immintrin.h>
+#ifdef __AVX2__
+#define SCALER_AVX2_TARGET
+#else
+#define SCALER_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define HAVE_SCALER_NEON
+#include <arm_neon.h>
 #endif
 
 /* ARGB8888 scaler is split in two:
@@ -51,63 +71,116 @@
  * Scaling is now complete. Channels are shifted right by 3, and saturated into 8-bit values.
  *
  * The C version of scalers perform the exact same operations as the SIMD code for testing purposes.
+ *
+ * All passes only work on the rows [y, y + height) of their output,
+ * so that a frame can be split into bands and scaled in parallel.
+ *
+ * The vertical SIMD passes work on several output pixels at once.
+ * Rows of the scaled frame are padded to eight pixels, so they may
+ * read (but never use) a few pixels past the end of a row.
  */
 
 #if defined(__SSE2__)
-void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int stride)
+void scaler_argb8888_vert(const struct scaler_ctx *ctx,
+      void *output_, int stride, int y, int height)
 {
-   int h, w, y;
-   const uint64_t *input = ctx->scaled.frame;
-   uint32_t      *output = (uint32_t*)output_;
+   int h, w, t;
+   const int input_stride     = ctx->scaled.stride >> 3;
+   const uint64_t *input      = ctx->scaled.frame;
+   uint32_t *output           = (uint32_t*)((uint8_t*)output_ + y * stride);
 
-   const int16_t *filter_vert = ctx->vert.filter;
+   const int16_t *filter_vert = ctx->vert.filter + y * ctx->vert.filter_stride;
 
-   for (h = 0; h < ctx->out_height; h++, filter_vert += ctx->vert.filter_stride, output += stride >> 2)
+   for (h = y; h < y + height; h++, filter_vert += ctx->vert.filter_stride, output += stride >> 2)
    {
-      const uint64_t *input_base = input + ctx->vert.filter_pos[h] * (ctx->scaled.stride >> 3);
+      const uint64_t *input_base = input + ctx->vert.filter_pos[h] * input_stride;
 
-      for (w = 0; w < ctx->out_width; w++)
+      for (w = 0; w < ctx->out_width; w += 2)
       {
          __m128i final;
          __m128i res = _mm_setzero_si128();
 
          const uint64_t *input_base_y = input_base + w;
 
-         for (y = 0; (y + 1) < ctx->vert.filter_len; y += 2, input_base_y += (ctx->scaled.stride >> 2))
+         for (t = 0; t < ctx->vert.filter_len; t++, input_base_y += input_stride)
          {
-            __m128i coeff = _mm_set_epi64x(filter_vert[y + 1] * 0x0001000100010001ll, filter_vert[y + 0] * 0x0001000100010001ll);
-            __m128i col   = _mm_set_epi64x(input_base_y[ctx->scaled.stride >> 3], input_base_y[0]);
+            __m128i coeff = _mm_set1_epi16(filter_vert[t]);
+            __m128i col   = _mm_loadu_si128((const __m128i*)input_base_y);
 
             res = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
          }
 
-         for (; y < ctx->vert.filter_len; y++, input_base_y += (ctx->scaled.stride >> 3))
+         res       = _mm_srai_epi16(res, (7 - 2 - 2));
+
+         final     = _mm_packus_epi16(res, res);
+
+         if (w + 1 < ctx->out_width)
+            _mm_storel_epi64((__m128i*)(output + w), final);
+         else
+            output[w] = _mm_cvtsi128_si32(final);
+      }
+   }
+}
+#elif defined(HAVE_SCALER_NEON)
+static INLINE int16x8_t scaler_neon_mulhi(int16x8_t col, int16x4_t coeff_lo,
+      int16x4_t coeff_hi)
+{
+   return vcombine_s16(
+         vshrn_n_s32(vmull_s16(vget_low_s16(col), coeff_lo), 16),
+         vshrn_n_s32(vmull_s16(vget_high_s16(col), coeff_hi), 16));
+}
+
+void scaler_argb8888_vert(const struct scaler_ctx *ctx,
+      void *output_, int stride, int y, int height)
+{
+   int h, w, t;
+   const int input_stride     = ctx->scaled.stride >> 3;
+   const uint64_t *input      = ctx->scaled.frame;
+   uint32_t *output           = (uint32_t*)((uint8_t*)output_ + y * stride);
+
+   const int16_t *filter_vert = ctx->vert.filter + y * ctx->vert.filter_stride;
+
+   for (h = y; h < y + height; h++, filter_vert += ctx->vert.filter_stride, output += stride >> 2)
+   {
+      const uint64_t *input_base = input + ctx->vert.filter_pos[h] * input_stride;
+
+      for (w = 0; w < ctx->out_width; w += 2)
+      {
+         uint8x8_t final;
+         int16x8_t res = vdupq_n_s16(0);
+
+         const uint64_t *input_base_y = input_base + w;
+
+         for (t = 0; t < ctx->vert.filter_len; t++, input_base_y += input_stride)
          {
-            __m128i coeff = _mm_set_epi64x(0, filter_vert[y] * 0x0001000100010001ll);
-            __m128i col   = _mm_set_epi64x(0, input_base_y[0]);
+            int16x4_t coeff = vdup_n_s16(filter_vert[t]);
+            int16x8_t col   = vreinterpretq_s16_u64(vld1q_u64(input_base_y));
 
-            res = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+            res = vqaddq_s16(scaler_neon_mulhi(col, coeff, coeff), res);
          }
 
-         res       = _mm_adds_epi16(_mm_srli_si128(res, 8), res);
-         res       = _mm_srai_epi16(res, (7 - 2 - 2));
+         res       = vshrq_n_s16(res, (7 - 2 - 2));
 
-         final     = _mm_packus_epi16(res, res);
+         final     = vqmovun_s16(res);
 
-         output[w] = _mm_cvtsi128_si32(final);
+         if (w + 1 < ctx->out_width)
+            vst1_u8((uint8_t*)(output + w), final);
+         else
+            vst1_lane_u32(output + w, vreinterpret_u32_u8(final), 0);
       }
    }
 }
 #else
-void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int stride)
+void scaler_argb8888_vert(const struct scaler_ctx *ctx,
+      void *output_, int stride, int y, int height)
 {
-   int h, w, y;
+   int h, w, t;
    const uint64_t      *input = ctx->scaled.frame;
-   uint32_t           *output = (uint32_t*)output_;
+   uint32_t           *output = (uint32_t*)((uint8_t*)output_ + y * stride);
 
-   const int16_t *filter_vert = ctx->vert.filter;
+   const int16_t *filter_vert = ctx->vert.filter + y * ctx->vert.filter_stride;
 
-   for (h = 0; h < ctx->out_height; h++, filter_vert += ctx->vert.filter_stride, output += stride >> 2)
+   for (h = y; h < y + height; h++, filter_vert += ctx->vert.filter_stride, output += stride >> 2)
    {
       const uint64_t *input_base = input + ctx->vert.filter_pos[h] * (ctx->scaled.stride >> 3);
 
@@ -119,7 +192,7 @@ void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int strid
          int16_t res_b = 0;
 
          const uint64_t *input_base_y = input_base + w;
-         for (y = 0; y < ctx->vert.filter_len; y++, input_base_y += (ctx->scaled.stride >> 3))
+         for (t = 0; t < ctx->vert.filter_len; t++, input_base_y += (ctx->scaled.stride >> 3))
          {
             uint64_t col = *input_base_y;
 
@@ -128,7 +201,7 @@ void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int strid
             int16_t g = (col >> 16) & 0xffff;
             int16_t b = (col >>  0) & 0xffff;
 
-            int16_t coeff = filter_vert[y];
+            int16_t coeff = filter_vert[t];
 
             res_a += (a * coeff) >> 16;
             res_r += (r * coeff) >> 16;
@@ -148,56 +221,92 @@ void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int strid
 #endif
 
 #if defined(__SSE2__)
-void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int stride)
+static INLINE __m128i scaler_argb8888_horiz_pixel(const int16_t *filter_horiz,
+      const uint32_t *input_base_x, int filter_len)
+{
+   int x;
+   __m128i res = _mm_setzero_si128();
+
+   for (x = 0; (x + 1) < filter_len; x += 2)
+   {
+      __m128i coeff = _mm_unpacklo_epi64(_mm_set1_epi16(filter_horiz[x + 0]), _mm_set1_epi16(filter_horiz[x + 1]));
+
+      __m128i col = _mm_unpacklo_epi8(_mm_set_epi64x(0,
+               ((uint64_t)input_base_x[x + 1] << 32) | input_base_x[x + 0]), _mm_setzero_si128());
+
+      col = _mm_slli_epi16(col, 7);
+      res = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+   }
+
+   for (; x < filter_len; x++)
+   {
+      __m128i coeff = _mm_unpacklo_epi64(_mm_set1_epi16(filter_horiz[x]), _mm_setzero_si128());
+      __m128i col   = _mm_unpacklo_epi8(_mm_set_epi32(0, 0, 0, input_base_x[x]), _mm_setzero_si128());
+
+      col = _mm_slli_epi16(col, 7);
+      res = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+   }
+
+   return _mm_adds_epi16(_mm_srli_si128(res, 8), res);
+}
+
+void scaler_argb8888_horiz(const struct scaler_ctx *ctx,
+      const void *input_, int stride, int y, int height)
+{
+   int h, w;
+   const uint32_t *input = (const uint32_t*)((const uint8_t*)input_ + y * stride);
+   uint64_t *output      = ctx->scaled.frame + y * (ctx->scaled.stride >> 3);
+
+   for (h = 0; h < height; h++, input += stride >> 2, output += ctx->scaled.stride >> 3)
+   {
+      const int16_t *filter_horiz = ctx->horiz.filter;
+
+      for (w = 0; w < ctx->scaled.width; w++, filter_horiz += ctx->horiz.filter_stride)
+         _mm_storel_epi64((__m128i*)(output + w),
+               scaler_argb8888_horiz_pixel(filter_horiz,
+                  input + ctx->horiz.filter_pos[w], ctx->horiz.filter_len));
+   }
+}
+#elif defined(HAVE_SCALER_NEON)
+void scaler_argb8888_horiz(const struct scaler_ctx *ctx,
+      const void *input_, int stride, int y, int height)
 {
    int h, w, x;
-   const uint32_t *input = (const uint32_t*)input_;
-   uint64_t *output      = ctx->scaled.frame;
+   const uint32_t *input = (const uint32_t*)((const uint8_t*)input_ + y * stride);
+   uint64_t *output      = ctx->scaled.frame + y * (ctx->scaled.stride >> 3);
 
-   for (h = 0; h < ctx->scaled.height; h++, input += stride >> 2, output += ctx->scaled.stride >> 3)
+   for (h = 0; h < height; h++, input += stride >> 2, output += ctx->scaled.stride >> 3)
    {
       const int16_t *filter_horiz = ctx->horiz.filter;
 
       for (w = 0; w < ctx->scaled.width; w++, filter_horiz += ctx->horiz.filter_stride)
       {
-         __m128i res = _mm_setzero_si128();
+         int16x8_t res = vdupq_n_s16(0);
 
          const uint32_t *input_base_x = input + ctx->horiz.filter_pos[w];
 
+         /* Even taps go to the low half, odd taps to the high half. */
          for (x = 0; (x + 1) < ctx->horiz.filter_len; x += 2)
          {
-            __m128i coeff = _mm_set_epi64x(filter_horiz[x + 1] * 0x0001000100010001ll, filter_horiz[x + 0] * 0x0001000100010001ll);
-
-            __m128i col = _mm_unpacklo_epi8(_mm_set_epi64x(0,
-                     ((uint64_t)input_base_x[x + 1] << 32) | input_base_x[x + 0]), _mm_setzero_si128());
+            int16x8_t col = vreinterpretq_s16_u16(vshlq_n_u16(
+                     vmovl_u8(vld1_u8((const uint8_t*)(input_base_x + x))), 7));
 
-            col = _mm_slli_epi16(col, 7);
-            res = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+            res = vqaddq_s16(scaler_neon_mulhi(col,
+                     vdup_n_s16(filter_horiz[x + 0]),
+                     vdup_n_s16(filter_horiz[x + 1])), res);
          }
 
          for (; x < ctx->horiz.filter_len; x++)
          {
-            __m128i coeff = _mm_set_epi64x(0, filter_horiz[x] * 0x0001000100010001ll);
-            __m128i col   = _mm_unpacklo_epi8(_mm_set_epi32(0, 0, 0, input_base_x[x]), _mm_setzero_si128());
+            int16x8_t col = vreinterpretq_s16_u16(vshlq_n_u16(
+                     vmovl_u8(vcreate_u8(input_base_x[x])), 7));
 
-            col = _mm_slli_epi16(col, 7);
-            res = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+            res = vqaddq_s16(scaler_neon_mulhi(col,
+                     vdup_n_s16(filter_horiz[x]), vdup_n_s16(0)), res);
          }
 
-         res       = _mm_adds_epi16(_mm_srli_si128(res, 8), res);
-
-#ifdef __x86_64__
-         output[w] = _mm_cvtsi128_si64(res);
-#else /* 32-bit doesn't have si64. Do it in two steps. */
-         union
-         {
-            uint32_t *u32;
-            uint64_t *u64;
-         } u;
-         u.u64 = output + w;
-         u.u32[0] = _mm_cvtsi128_si32(res);
-         u.u32[1] = _mm_cvtsi128_si32(_mm_srli_si128(res, 4));
-#endif
+         vst1_s16((int16_t*)(output + w),
+               vqadd_s16(vget_low_s16(res), vget_high_s16(res)));
       }
    }
 }
@@ -207,13 +316,14 @@ static INLINE uint64_t build_argb64(uint16_t a, uint16_t r, uint16_t g, uint16_t
    return ((uint64_t)a << 48) | ((uint64_t)r << 32) | ((uint64_t)g << 16) | ((uint64_t)b << 0);
 }
 
-void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int stride)
+void scaler_argb8888_horiz(const struct scaler_ctx *ctx,
+      const void *input_, int stride, int y, int height)
 {
    int h, w, x;
-   const uint32_t *input = (uint32_t*)input_;
-   uint64_t *output      = ctx->scaled.frame;
+   const uint32_t *input = (const uint32_t*)((const uint8_t*)input_ + y * stride);
+   uint64_t *output      = ctx->scaled.frame + y * (ctx->scaled.stride >> 3);
 
-   for (h = 0; h < ctx->scaled.height; h++, input += stride >> 2, output += ctx->scaled.stride >> 3)
+   for (h = 0; h < height; h++, input += stride >> 2, output += ctx->scaled.stride >> 3)
    {
       const int16_t *filter_horiz = ctx->horiz.filter;
 
@@ -249,11 +359,161 @@ void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int
 }
 #endif
 
+#ifdef HAVE_SCALER_AVX2
+/* Same as the SSE2 pass, four output pixels at a time. */
+static SCALER_AVX2_TARGET void scaler_argb8888_vert_avx2(
+      const struct scaler_ctx *ctx,
+      void *output_, int stride, int y, int height)
+{
+   int h, w, t;
+   const int input_stride     = ctx->scaled.stride >> 3;
+   const uint64_t *input      = ctx->scaled.frame;
+   uint32_t *output           = (uint32_t*)((uint8_t*)output_ + y * stride);
+
+   const int16_t *filter_vert = ctx->vert.filter + y * ctx->vert.filter_stride;
+
+   for (h = y; h < y + height; h++, filter_vert += ctx->vert.filter_stride, output += stride >> 2)
+   {
+      const uint64_t *input_base = input + ctx->vert.filter_pos[h] * input_stride;
+
+      for (w = 0; w < ctx->out_width; w += 4)
+      {
+         __m128i final;
+         __m256i res = _mm256_setzero_si256();
+
+         const uint64_t *input_base_y = input_base + w;
+
+         for (t = 0; t < ctx->vert.filter_len; t++, input_base_y += input_stride)
+         {
+            __m256i coeff = _mm256_set1_epi16(filter_vert[t]);
+            __m256i col   = _mm256_loadu_si256((const __m256i*)input_base_y);
+
+            res = _mm256_adds_epi16(_mm256_mulhi_epi16(col, coeff), res);
+         }
+
+         res   = _mm256_srai_epi16(res, (7 - 2 - 2));
+
+         /* packus works within 128-bit lanes, gather the
+          * low halves of both lanes. */
+         final = _mm256_castsi256_si128(_mm256_permute4x64_epi64(
+                  _mm256_packus_epi16(res, res), 0x08));
+
+         switch (ctx->out_width - w)
+         {
+            case 1:
+               output[w] = _mm_cvtsi128_si32(final);
+               break;
+            case 3:
+               output[w + 2] = _mm_cvtsi128_si32(_mm_srli_si128(final, 8));
+               /* fall-through */
+            case 2:
+               _mm_storel_epi64((__m128i*)(output + w), final);
+               break;
+            default:
+               _mm_storeu_si128((__m128i*)(output + w), final);
+               break;
+         }
+      }
+   }
+}
+
+/* Same as the SSE2 pass, with two output pixels side by side
+ * in the two 128-bit lanes. */
+static SCALER_AVX2_TARGET void scaler_argb8888_horiz_avx2(
+      const struct scaler_ctx *ctx,
+      const void *input_, int stride, int y, int height)
+{
+   int h, w, x;
+   const __m256i expand  = _mm256_set_epi32(3, 3, 2, 2, 1, 1, 0, 0);
+   const int filter_len  = ctx->horiz.filter_len;
+   const uint32_t *input = (const uint32_t*)((const uint8_t*)input_ + y * stride);
+   uint64_t *output      = ctx->scaled.frame + y * (ctx->scaled.stride >> 3);
+
+   for (h = 0; h < height; h++, input += stride >> 2, output += ctx->scaled.stride >> 3)
+   {
+      const int16_t *filter_horiz = ctx->horiz.filter;
+
+      for (w = 0; (w + 1) < ctx->scaled.width; w += 2, filter_horiz += 2 * ctx->horiz.filter_stride)
+      {
+         __m256i res = _mm256_setzero_si256();
+
+         const int16_t *filter_horiz1  = filter_horiz + ctx->horiz.filter_stride;
+         const uint32_t *input_base_x0 = input + ctx->horiz.filter_pos[w + 0];
+         const uint32_t *input_base_x1 = input + ctx->horiz.filter_pos[w + 1];
+
+         for (x = 0; (x + 1) < filter_len; x += 2)
+         {
+            __m128i coeff = _mm_set_epi16(0, 0, 0, 0,
+                  filter_horiz1[x + 1], filter_horiz1[x + 0],
+                  filter_horiz[x + 1], filter_horiz[x + 0]);
+            __m128i col   = _mm_unpacklo_epi64(
+                  _mm_loadl_epi64((const __m128i*)(input_base_x0 + x)),
+                  _mm_loadl_epi64((const __m128i*)(input_base_x1 + x)));
+            __m256i col16 = _mm256_slli_epi16(_mm256_cvtepu8_epi16(col), 7);
+
+            res = _mm256_adds_epi16(_mm256_mulhi_epi16(col16,
+                     _mm256_permutevar8x32_epi32(_mm256_castsi128_si256(
+                           _mm_unpacklo_epi16(coeff, coeff)), expand)), res);
+         }
+
+         for (; x < filter_len; x++)
+         {
+            __m128i coeff = _mm_set_epi16(0, 0, 0, 0,
+                  0, filter_horiz1[x], 0, filter_horiz[x]);
+            __m128i col   = _mm_set_epi32(0, input_base_x1[x],
+                  0, input_base_x0[x]);
+            __m256i col16 = _mm256_slli_epi16(_mm256_cvtepu8_epi16(col), 7);
+
+            res = _mm256_adds_epi16(_mm256_mulhi_epi16(col16,
+                     _mm256_permutevar8x32_epi32(_mm256_castsi128_si256(
+                           _mm_unpacklo_epi16(coeff, coeff)), expand)), res);
+         }
+
+         res = _mm256_adds_epi16(_mm256_srli_si256(res, 8), res);
+
+         _mm_storel_epi64((__m128i*)(output + w + 0),
+               _mm256_castsi256_si128(res));
+         _mm_storel_epi64((__m128i*)(output + w + 1),
+               _mm256_extracti128_si256(res, 1));
+      }
+
+      if (w < ctx->scaled.width)
+         _mm_storel_epi64((__m128i*)(output + w),
+               scaler_argb8888_horiz_pixel(filter_horiz,
+                  input + ctx->horiz.filter_pos[w], filter_len));
+   }
+}
+#endif
+
+/**
+ * scaler_argb8888_select:
+ * @ctx          : pointer to scaler context object.
+ *
+ * Binds the fastest horizontal and vertical passes
+ * the CPU can run to @ctx.
+ **/
+void scaler_argb8888_select(struct scaler_ctx *ctx)
+{
+   ctx->scaler_horiz = scaler_argb8888_horiz;
+   ctx->scaler_vert  = scaler_argb8888_vert;
+
+#ifdef HAVE_SCALER_AVX2
+#ifndef __AVX2__
+   __builtin_cpu_init();
+   if (!__builtin_cpu_supports("avx2"))
+      return;
+#endif
+   ctx->scaler_horiz = scaler_argb8888_horiz_avx2;
+   ctx->scaler_vert  = scaler_argb8888_vert_avx2;
+#endif
+}
+
 void scaler_argb8888_point_special(const struct scaler_ctx *ctx,
       void *output_, const void *input_,
       int out_width, int out_height,
       int in_width, int in_height,
-      int out_stride, int in_stride)
+      int out_stride, int in_stride,
+      int y, int height)
 {
    int h, w;
    const uint32_t *input = NULL;
@@ -270,10 +530,11 @@ void scaler_argb8888_point_special(const struct scaler_ctx *ctx,
    if (y_pos < 0)
       y_pos = 0;
 
-   input = (const uint32_t*)input_;
-   output = (uint32_t*)output_;
+   input  = (const uint32_t*)input_;
+   output = (uint32_t*)((uint8_t*)output_ + y * out_stride);
+   y_pos += y * y_step;
 
-   for (h = 0; h < out_height; h++, y_pos += y_step, output += out_stride >> 2)
+   for (h = 0; h < height; h++, y_pos += y_step, output += out_stride >> 2)
    {
       int x = x_pos;
       const uint32_t *inp = input + (y_pos >> 16) * (in_stride >> 2);
@@ -282,4 +543,3 @@ void scaler_argb8888_point_special(const struct scaler_ctx *ctx,
          output[w] = inp[x >> 16];
    }
 }
-
@@ -60,6 +60,12 @@ struct config_file
    unsigned include_depth;
 
    struct config_include_list *includes;
+
+   /* Open addressing hash table mapping each key to the
+    * first entry with that key. index_size is a power of two. */
+   struct config_entry_list **index;
+   size_t index_size;
+   size_t index_count;
 };
 
 typedef struct config_file config_file_t;
@@ -28,6 +28,7 @@
 
 #include <boolean.h>
 #include <file/file_extract.h>
+#include <rthreads/thread_pool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -60,6 +61,33 @@ bool rpng_save_image_argb(const char *path, const uint32_t *data,
       unsigned width, unsigned height, unsigned pitch);
 bool rpng_save_image_bgr24(const char *path, const uint8_t *data,
       unsigned width, unsigned height, unsigned pitch);
+
+/**
+ * rpng_encode_image_argb:
+ * @data                 : ARGB8888 pixels, top-down.
+ * @width                : width of the image.
+ * @height               : height of the image.
+ * @pitch                : distance between two rows of @data, in bytes.
+ * @pool                 : thread pool to encode on, or NULL.
+ * @size                 : size of the returned file.
+ *
+ * Encodes a PNG file in memory. With @pool, rows are filtered
+ * in bands and deflated in chunks across the pool's threads.
+ *
+ * Returns: the PNG file, to be freed with free(), or NULL.
+ */
+uint8_t *rpng_encode_image_argb(const uint32_t *data,
+      unsigned width, unsigned height, unsigned pitch,
+      thread_pool_t *pool, size_t *size);
+
+/**
+ * rpng_encode_image_bgr24:
+ *
+ * Same as rpng_encode_image_argb() for BGR24 pixels.
+ */
+uint8_t *rpng_encode_image_bgr24(const uint8_t *data,
+      unsigned width, unsigned height, unsigned pitch,
+      thread_pool_t *pool, size_t *size);
 #endif
 
 #ifdef __cplusplus
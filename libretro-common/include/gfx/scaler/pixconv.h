@@ -25,6 +25,10 @@
 
 #include <clamping.h>
 
+typedef void (*pixconv_t)(void *output, const void *input,
+      int width, int height,
+      int out_stride, int in_stride);
+
 void conv_0rgb1555_argb8888(void *output, const void *input,
       int width, int height,
       int out_stride, int in_stride);
@@ -89,5 +93,7 @@ void conv_copy(void *output, const void *input,
       int width, int height,
       int out_stride, int in_stride);
 
+pixconv_t pixconv_get_fastest(pixconv_t conv);
+
 #endif
 
@@ -31,6 +31,7 @@ extern "C" {
 #include <stddef.h>
 #include <boolean.h>
 #include <clamping.h>
+#include <rthreads/thread_pool.h>
 
 #define FILTER_UNITY (1 << 14)
 
@@ -75,12 +76,14 @@ struct scaler_ctx
    enum scaler_pix_fmt out_fmt;
    enum scaler_type scaler_type;
 
+   /* The passes only do the rows [y, y + height) of their output,
+    * given as the last two arguments. */
    void (*scaler_horiz)(const struct scaler_ctx*,
-         const void*, int);
+         const void*, int, int, int);
    void (*scaler_vert)(const struct scaler_ctx*,
-         void*, int);
+         void*, int, int, int);
    void (*scaler_special)(const struct scaler_ctx*,
-         void*, const void*, int, int, int, int, int, int);
+         void*, const void*, int, int, int, int, int, int, int, int);
 
    void (*in_pixconv)(void*, const void*, int, int, int, int);
    void (*out_pixconv)(void*, const void*, int, int, int, int);
@@ -89,6 +92,10 @@ struct scaler_ctx
    bool unscaled;
    struct scaler_filter horiz, vert;
 
+   /* Optional, not owned by the context. If set, scaler_ctx_scale()
+    * splits the frame into bands of rows and runs them on the pool. */
+   thread_pool_t *pool;
+
    struct
    {
       uint32_t *frame;
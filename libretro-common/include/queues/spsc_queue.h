@@ -0,0 +1,82 @@
+/* Copyright  (C) 2010-2015 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (spsc_queue.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_SPSC_QUEUE_H
+#define __LIBRETRO_SDK_SPSC_QUEUE_H
+
+#include <boolean.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bounded queue of pointers between exactly one producer thread
+ * and one consumer thread. Neither side ever takes a lock; an
+ * item pushed is visible to the consumer together with everything
+ * the producer wrote before pushing it.
+ *
+ * The queue doesn't block. Threads that need to sleep until
+ * there is room or something to pop have to bring their own
+ * condition variable. */
+typedef struct spsc_queue spsc_queue_t;
+
+/**
+ * spsc_queue_new:
+ * @capacity          : number of items the queue can hold.
+ *
+ * Returns: new queue, or NULL on allocation failure.
+ **/
+spsc_queue_t *spsc_queue_new(unsigned capacity);
+
+void spsc_queue_free(spsc_queue_t *queue);
+
+/**
+ * spsc_queue_push:
+ * @queue             : queue, only ever pushed to by this thread.
+ * @item              : item to push, must not be NULL.
+ *
+ * Returns: true if @item was pushed, false if the queue is full.
+ **/
+bool spsc_queue_push(spsc_queue_t *queue, void *item);
+
+/**
+ * spsc_queue_pop:
+ * @queue             : queue, only ever popped from by this thread.
+ *
+ * Returns: oldest item in the queue, or NULL if it is empty.
+ **/
+void *spsc_queue_pop(spsc_queue_t *queue);
+
+/**
+ * spsc_queue_size:
+ * @queue             : queue.
+ *
+ * Returns: number of items in the queue. Only a snapshot,
+ * the other thread may change it right away.
+ **/
+unsigned spsc_queue_size(spsc_queue_t *queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,121 @@
+/* Copyright  (C) 2010-2015 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (retro_atomic.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_ATOMIC_H
+#define __LIBRETRO_SDK_ATOMIC_H
+
+#include <retro_inline.h>
+
+/* Minimal set of atomic operations on int, enough to hand buffers
+ * between two threads without a lock.
+ *
+ * Loads have acquire semantics, stores have release semantics and
+ * exchanges are full barriers. */
+
+#if defined(_MSC_VER)
+#if defined(_XBOX)
+#include <xtl.h>
+#else
+#include <windows.h>
+#endif
+
+static INLINE int retro_atomic_xchg(volatile int *ptr, int val)
+{
+   return (int)InterlockedExchange((volatile LONG*)ptr, (LONG)val);
+}
+
+static INLINE int retro_atomic_load(volatile int *ptr)
+{
+   int val = *ptr;
+   MemoryBarrier();
+   return val;
+}
+
+static INLINE void retro_atomic_store(volatile int *ptr, int val)
+{
+   MemoryBarrier();
+   *ptr = val;
+}
+
+#elif defined(__clang__) || (defined(__GNUC__) && \
+      (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+
+static INLINE int retro_atomic_xchg(volatile int *ptr, int val)
+{
+   return __atomic_exchange_n(ptr, val, __ATOMIC_ACQ_REL);
+}
+
+static INLINE int retro_atomic_load(volatile int *ptr)
+{
+   return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+static INLINE void retro_atomic_store(volatile int *ptr, int val)
+{
+   __atomic_store_n(ptr, val, __ATOMIC_RELEASE);
+}
+
+#elif defined(__GNUC__)
+
+static INLINE int retro_atomic_xchg(volatile int *ptr, int val)
+{
+   /* __sync_lock_test_and_set is only an acquire barrier. */
+   __sync_synchronize();
+   return __sync_lock_test_and_set(ptr, val);
+}
+
+static INLINE int retro_atomic_load(volatile int *ptr)
+{
+   int val = *ptr;
+   __sync_synchronize();
+   return val;
+}
+
+static INLINE void retro_atomic_store(volatile int *ptr, int val)
+{
+   __sync_synchronize();
+   *ptr = val;
+}
+
+#else
+
+/* No atomics for this compiler; rthreads.c does the operations
+ * under a lock instead, so link it in. */
+#define RETRO_ATOMIC_LOCKED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int retro_atomic_xchg(volatile int *ptr, int val);
+
+int retro_atomic_load(volatile int *ptr);
+
+void retro_atomic_store(volatile int *ptr, int val);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+#endif
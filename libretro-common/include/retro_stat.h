@@ -48,6 +48,19 @@ bool path_is_valid(const char *path);
 
 int32_t path_get_size(const char *path);
 
+/**
+ * path_get_mtime:
+ * @path               : path
+ *
+ * Gets the last modification time of a file. The unit is
+ * platform-specific, only compare it against other values
+ * returned by this function. Always 0 on platforms that do
+ * not have it.
+ *
+ * Returns: modification time, or -1 if @path does not exist.
+ */
+int64_t path_get_mtime(const char *path);
+
 /**
  * path_mkdir_norecurse:
  * @dir                : directory
@@ -0,0 +1,87 @@
+/* Copyright  (C) 2010-2015 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (thread_pool.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_THREAD_POOL_H__
+#define __LIBRETRO_SDK_THREAD_POOL_H__
+
+#if defined(__cplusplus) && !defined(_MSC_VER)
+extern "C" {
+#endif
+
+typedef struct thread_pool thread_pool_t;
+
+/* Runs task number @index of a batch. */
+typedef void (*thread_pool_task_t)(void *userdata, unsigned index);
+
+/**
+ * thread_pool_new:
+ * @threads                 : number of threads that run tasks,
+ *                            including the caller of thread_pool_run().
+ *
+ * Create a pool of persistent worker threads. @threads - 1
+ * threads are spawned; the thread calling thread_pool_run()
+ * works through the batch alongside them.
+ *
+ * Returns: pointer to new thread pool if successful, otherwise NULL.
+ */
+thread_pool_t *thread_pool_new(unsigned threads);
+
+/**
+ * thread_pool_free:
+ * @pool                    : pointer to thread pool object
+ *
+ * Stops the worker threads and frees the pool.
+ */
+void thread_pool_free(thread_pool_t *pool);
+
+/**
+ * thread_pool_get_threads:
+ * @pool                    : pointer to thread pool object
+ *
+ * Returns: number of threads that run tasks, including the caller.
+ */
+unsigned thread_pool_get_threads(thread_pool_t *pool);
+
+/**
+ * thread_pool_run:
+ * @pool                    : pointer to thread pool object
+ * @task                    : callback run once per task.
+ * @userdata                : passed on to @task.
+ * @count                   : number of tasks in the batch.
+ *
+ * Runs @task for every index in [0, @count) and waits for all
+ * of them to finish. Each thread starts on its own contiguous
+ * share of the batch; once it runs dry, it steals half of what
+ * is left of another thread's share, so uneven tasks or uneven
+ * cores don't leave threads idle.
+ *
+ * Batches started from different threads run one after
+ * another. A task must not start a batch on its own pool.
+ */
+void thread_pool_run(thread_pool_t *pool, thread_pool_task_t task,
+      void *userdata, unsigned count);
+
+#if defined(__cplusplus) && !defined(_MSC_VER)
+}
+#endif
+
+#endif
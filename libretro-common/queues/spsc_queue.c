@@ -0,0 +1,112 @@
+/* Copyright  (C) 2010-2015 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (spsc_queue.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+
+#include <retro_atomic.h>
+#include <queues/spsc_queue.h>
+
+/* Keeps the indices written by the two threads on separate
+ * cache lines, so they don't keep stealing each other's line. */
+#define SPSC_QUEUE_PAD 64
+
+struct spsc_queue
+{
+   void **items;
+   /* One slot always stays empty, to tell a full queue from
+    * an empty one without a shared counter. */
+   int size;
+
+   /* Next slot to pop. Written by the consumer only. */
+   volatile int head;
+   char pad0[SPSC_QUEUE_PAD];
+   /* Next slot to push. Written by the producer only. */
+   volatile int tail;
+   char pad1[SPSC_QUEUE_PAD];
+};
+
+spsc_queue_t *spsc_queue_new(unsigned capacity)
+{
+   spsc_queue_t *queue = (spsc_queue_t*)calloc(1, sizeof(*queue));
+
+   if (!queue)
+      return NULL;
+
+   queue->size  = capacity + 1;
+   queue->items = (void**)calloc(queue->size, sizeof(*queue->items));
+
+   if (!queue->items)
+   {
+      free(queue);
+      return NULL;
+   }
+
+   return queue;
+}
+
+void spsc_queue_free(spsc_queue_t *queue)
+{
+   if (!queue)
+      return;
+
+   free(queue->items);
+   free(queue);
+}
+
+bool spsc_queue_push(spsc_queue_t *queue, void *item)
+{
+   /* Only this thread writes tail, no need for a barrier. */
+   int tail = queue->tail;
+   int next = tail + 1 == queue->size ? 0 : tail + 1;
+
+   if (next == retro_atomic_load(&queue->head))
+      return false;
+
+   queue->items[tail] = item;
+   /* Release: the item, and whatever it points to, become
+    * visible before the new tail does. */
+   retro_atomic_store(&queue->tail, next);
+   return true;
+}
+
+void *spsc_queue_pop(spsc_queue_t *queue)
+{
+   void *item;
+   int head = queue->head;
+
+   if (head == retro_atomic_load(&queue->tail))
+      return NULL;
+
+   item = queue->items[head];
+   /* Release: done reading the slot before the producer
+    * may reuse it. */
+   retro_atomic_store(&queue->head, head + 1 == queue->size ? 0 : head + 1);
+   return item;
+}
+
+unsigned spsc_queue_size(spsc_queue_t *queue)
+{
+   int head = retro_atomic_load(&queue->head);
+   int tail = retro_atomic_load(&queue->tail);
+
+   return (unsigned)(tail >= head ? tail - head : tail + queue->size - head);
+}
@@ -23,6 +23,7 @@
 #include <stdlib.h>
 
 #include <rthreads/rthreads.h>
+#include <retro_atomic.h>
 
 #if defined(_WIN32)
 #ifdef _XBOX
@@ -51,6 +52,12 @@ struct thread_data
    void *userdata;
 };
 
+#ifdef RETRO_ATOMIC_LOCKED
+/* Guards the retro_atomic_* fallbacks. sthread_create() makes it
+ * before the first thread starts; until then nothing can race. */
+static slock_t *retro_atomic_lock;
+#endif
+
 struct sthread
 {
 #ifdef _WIN32
@@ -109,6 +116,16 @@ sthread_t *sthread_create(void (*thread_func)(void*), void *userdata)
    if (!thread)
       return NULL;
 
+#ifdef RETRO_ATOMIC_LOCKED
+   if (!retro_atomic_lock)
+      retro_atomic_lock = slock_new();
+   if (!retro_atomic_lock)
+   {
+      free(thread);
+      return NULL;
+   }
+#endif
+
    data = (struct thread_data*)calloc(1, sizeof(*data));
    if (!data)
    {
@@ -425,3 +442,41 @@ bool scond_wait_timeout(scond_t *cond, slock_t *lock, int64_t timeout_us)
    return (ret == 0);
 #endif
 }
+
+#ifdef RETRO_ATOMIC_LOCKED
+int retro_atomic_xchg(volatile int *ptr, int val)
+{
+   int ret;
+
+   if (retro_atomic_lock)
+      slock_lock(retro_atomic_lock);
+   ret  = *ptr;
+   *ptr = val;
+   if (retro_atomic_lock)
+      slock_unlock(retro_atomic_lock);
+
+   return ret;
+}
+
+int retro_atomic_load(volatile int *ptr)
+{
+   int ret;
+
+   if (retro_atomic_lock)
+      slock_lock(retro_atomic_lock);
+   ret = *ptr;
+   if (retro_atomic_lock)
+      slock_unlock(retro_atomic_lock);
+
+   return ret;
+}
+
+void retro_atomic_store(volatile int *ptr, int val)
+{
+   if (retro_atomic_lock)
+      slock_lock(retro_atomic_lock);
+   *ptr = val;
+   if (retro_atomic_lock)
+      slock_unlock(retro_atomic_lock);
+}
+#endif
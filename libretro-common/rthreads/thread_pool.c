@@ -0,0 +1,297 @@
+/* Copyright  (C) 2010-2015 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (thread_pool.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+
+#include <boolean.h>
+#include <rthreads/rthreads.h>
+#include <rthreads/thread_pool.h>
+
+/* Range of task indices a thread still has to run.
+ * The owner takes from the front, thieves from the back. */
+struct thread_pool_queue
+{
+   slock_t *lock;
+   unsigned begin;
+   unsigned end;
+};
+
+struct thread_pool_worker
+{
+   thread_pool_t *pool;
+   sthread_t *thread;
+   unsigned index;
+};
+
+struct thread_pool
+{
+   /* Index 0 is the thread calling thread_pool_run(). */
+   struct thread_pool_queue *queues;
+   struct thread_pool_worker *workers;
+   unsigned threads;
+
+   /* Held for a whole batch, so batches from different
+    * threads take turns. */
+   slock_t *run_lock;
+
+   slock_t *lock;
+   /* Signalled when a batch starts or the pool shuts down. */
+   scond_t *cond;
+   /* Signalled when the last worker is done with a batch. */
+   scond_t *done_cond;
+   unsigned generation;
+   unsigned active;
+   bool quit;
+
+   thread_pool_task_t task;
+   void *userdata;
+};
+
+static bool thread_pool_pop(struct thread_pool_queue *queue,
+      unsigned *index)
+{
+   bool ret = false;
+
+   slock_lock(queue->lock);
+   if (queue->begin < queue->end)
+   {
+      *index = queue->begin++;
+      ret    = true;
+   }
+   slock_unlock(queue->lock);
+
+   return ret;
+}
+
+/**
+ * thread_pool_steal:
+ * @pool                    : pointer to thread pool object
+ * @self                    : index of the thread looking for work.
+ *
+ * Moves the back half of the first non-empty share found into
+ * the share of @self.
+ *
+ * Returns: true if anything was stolen, otherwise false.
+ */
+static bool thread_pool_steal(thread_pool_t *pool, unsigned self)
+{
+   unsigned i;
+
+   for (i = 1; i < pool->threads; i++)
+   {
+      unsigned begin, end;
+      struct thread_pool_queue *victim =
+         &pool->queues[(self + i) % pool->threads];
+
+      /* Tasks still in a share haven't been started, so even
+       * the last one is up for grabs. */
+      slock_lock(victim->lock);
+      end         = victim->end;
+      begin       = end - (end - victim->begin + 1) / 2;
+      victim->end = begin;
+      slock_unlock(victim->lock);
+
+      if (begin == end)
+         continue;
+
+      slock_lock(pool->queues[self].lock);
+      pool->queues[self].begin = begin;
+      pool->queues[self].end   = end;
+      slock_unlock(pool->queues[self].lock);
+      return true;
+   }
+
+   return false;
+}
+
+static void thread_pool_work(thread_pool_t *pool, unsigned self)
+{
+   for (;;)
+   {
+      unsigned index;
+
+      if (thread_pool_pop(&pool->queues[self], &index))
+         pool->task(pool->userdata, index);
+      else if (!thread_pool_steal(pool, self))
+         break;
+   }
+}
+
+static void thread_pool_thread(void *data)
+{
+   struct thread_pool_worker *worker = (struct thread_pool_worker*)data;
+   thread_pool_t *pool               = worker->pool;
+   unsigned generation               = 0;
+
+   slock_lock(pool->lock);
+
+   for (;;)
+   {
+      while (pool->generation == generation && !pool->quit)
+         scond_wait(pool->cond, pool->lock);
+
+      if (pool->quit)
+         break;
+
+      generation = pool->generation;
+      slock_unlock(pool->lock);
+
+      thread_pool_work(pool, worker->index);
+
+      slock_lock(pool->lock);
+      if (--pool->active == 0)
+         scond_signal(pool->done_cond);
+   }
+
+   slock_unlock(pool->lock);
+}
+
+thread_pool_t *thread_pool_new(unsigned threads)
+{
+   unsigned i;
+   thread_pool_t *pool = NULL;
+
+   if (!threads)
+      return NULL;
+
+   pool = (thread_pool_t*)calloc(1, sizeof(*pool));
+   if (!pool)
+      return NULL;
+
+   pool->queues    = (struct thread_pool_queue*)
+      calloc(threads, sizeof(*pool->queues));
+   pool->workers   = (struct thread_pool_worker*)
+      calloc(threads, sizeof(*pool->workers));
+   pool->run_lock  = slock_new();
+   pool->lock      = slock_new();
+   pool->cond      = scond_new();
+   pool->done_cond = scond_new();
+
+   if (!pool->queues || !pool->workers || !pool->run_lock
+         || !pool->lock || !pool->cond || !pool->done_cond)
+      goto error;
+
+   for (i = 0; i < threads; i++)
+   {
+      pool->queues[i].lock = slock_new();
+      if (!pool->queues[i].lock)
+         goto error;
+      pool->threads++;
+   }
+
+   for (i = 1; i < threads; i++)
+   {
+      pool->workers[i].pool   = pool;
+      pool->workers[i].index  = i;
+      pool->workers[i].thread = sthread_create(thread_pool_thread,
+            &pool->workers[i]);
+      if (!pool->workers[i].thread)
+         goto error;
+   }
+
+   return pool;
+
+error:
+   thread_pool_free(pool);
+   return NULL;
+}
+
+void thread_pool_free(thread_pool_t *pool)
+{
+   unsigned i;
+
+   if (!pool)
+      return;
+
+   if (pool->lock)
+   {
+      slock_lock(pool->lock);
+      pool->quit = true;
+      if (pool->cond)
+         scond_broadcast(pool->cond);
+      slock_unlock(pool->lock);
+   }
+
+   for (i = 1; i < pool->threads; i++)
+   {
+      if (pool->workers[i].thread)
+         sthread_join(pool->workers[i].thread);
+   }
+
+   for (i = 0; i < pool->threads; i++)
+      slock_free(pool->queues[i].lock);
+
+   if (pool->run_lock)
+      slock_free(pool->run_lock);
+   if (pool->lock)
+      slock_free(pool->lock);
+   if (pool->cond)
+      scond_free(pool->cond);
+   if (pool->done_cond)
+      scond_free(pool->done_cond);
+
+   free(pool->queues);
+   free(pool->workers);
+   free(pool);
+}
+
+unsigned thread_pool_get_threads(thread_pool_t *pool)
+{
+   if (!pool)
+      return 0;
+   return pool->threads;
+}
+
+void thread_pool_run(thread_pool_t *pool, thread_pool_task_t task,
+      void *userdata, unsigned count)
+{
+   unsigned i;
+
+   if (!pool || !task || !count)
+      return;
+
+   slock_lock(pool->run_lock);
+
+   /* All workers are idle, so the shares can be set up unlocked. */
+   for (i = 0; i < pool->threads; i++)
+   {
+      pool->queues[i].begin = (unsigned)((uint64_t)count * i / pool->threads);
+      pool->queues[i].end   = (unsigned)((uint64_t)count * (i + 1) / pool->threads);
+   }
+
+   slock_lock(pool->lock);
+   pool->task     = task;
+   pool->userdata = userdata;
+   pool->active   = pool->threads - 1;
+   pool->generation++;
+   scond_broadcast(pool->cond);
+   slock_unlock(pool->lock);
+
+   thread_pool_work(pool, 0);
+
+   slock_lock(pool->lock);
+   while (pool->active)
+      scond_wait(pool->done_cond, pool->lock);
+   slock_unlock(pool->lock);
+
+   slock_unlock(pool->run_lock);
+}
@@ -26,10 +26,28 @@
 
 struct node_iter_ctx
 {
-	libretrodb_t *db;
+	RFILE *fd;
 	libretrodb_index_t *idx;
 };
 
+struct libretrodb_index
+{
+	char name[50];
+	uint64_t key_size;
+	uint64_t next;
+};
+
+/* An index read into memory on first use. Entries are
+ * (key, offset) pairs sorted by key, entry_size bytes each. */
+typedef struct libretrodb_index_cache
+{
+   libretrodb_index_t header;
+   uint8_t *entries;
+   uint64_t count;
+   size_t entry_size;
+   struct libretrodb_index_cache *next;
+} libretrodb_index_cache_t;
+
 struct libretrodb
 {
 	RFILE *fd;
@@ -37,13 +55,7 @@ struct libretrodb
 	uint64_t count;
 	uint64_t first_index_offset;
    char path[1024];
-};
-
-struct libretrodb_index
-{
-	char name[50];
-	uint64_t key_size;
-	uint64_t next;
+   libretrodb_index_cache_t *indexes;
 };
 
 typedef struct libretrodb_metadata
@@ -57,6 +69,15 @@ typedef struct libretrodb_header
 	uint64_t metadata_offset;
 } libretrodb_header_t;
 
+/* Cursors walk the whole file front to back, so they read it
+ * in big chunks and parse each item into an arena that is
+ * simply reset for the next one. */
+#define LIBRETRODB_CURSOR_BUFFER_SIZE (64 * 1024)
+
+/* Most keys a query may be narrowed down to before the cursor
+ * falls back to scanning. */
+#define LIBRETRODB_CURSOR_MAX_KEYS 256
+
 struct libretrodb_cursor
 {
 	int is_valid;
@@ -64,6 +85,14 @@ struct libretrodb_cursor
 	int eof;
 	libretrodb_query_t *query;
 	libretrodb_t *db;
+   rmsgpack_reader_t reader;
+   struct rmsgpack_dom_arena *arena;
+   /* Entries to visit when the query could be answered
+    * through indexes, in file order. */
+   int indexed;
+   uint64_t *offsets;
+   size_t num_offsets;
+   size_t next_offset;
 };
 
 static struct rmsgpack_dom_value sentinal;
@@ -121,7 +150,7 @@ int libretrodb_create(RFILE *fd, libretrodb_value_provider value_provider,
    struct rmsgpack_dom_value item;
    uint64_t item_count        = 0;
    libretrodb_header_t header = {{0}};
-   ssize_t root = retro_fseek(fd, 0, SEEK_CUR);
+   ssize_t root = retro_ftell(fd);
 
    memcpy(header.magic_number, MAGIC_NUMBER, sizeof(MAGIC_NUMBER)-1);
 
@@ -147,7 +176,7 @@ int libretrodb_create(RFILE *fd, libretrodb_value_provider value_provider,
    if ((rv = rmsgpack_dom_write(fd, &sentinal)) < 0)
       goto clean;
 
-   header.metadata_offset = swap_if_little64(retro_fseek(fd, 0, SEEK_CUR));
+   header.metadata_offset = swap_if_little64(retro_ftell(fd));
    md.count = item_count;
    libretrodb_write_metadata(fd, &md);
    retro_fseek(fd, root, SEEK_SET);
@@ -177,8 +206,24 @@ static void libretrodb_write_index_header(RFILE *fd, libretrodb_index_t *idx)
    rmsgpack_write_uint(fd, idx->next);
 }
 
+static void libretrodb_free_indexes(libretrodb_t *db)
+{
+   libretrodb_index_cache_t *cache = db->indexes;
+
+   while (cache)
+   {
+      libretrodb_index_cache_t *next = cache->next;
+      free(cache->entries);
+      free(cache);
+      cache = next;
+   }
+
+   db->indexes = NULL;
+}
+
 void libretrodb_close(libretrodb_t *db)
 {
+   libretrodb_free_indexes(db);
    if (db->fd)
       retro_fclose(db->fd);
    db->fd = NULL;
@@ -195,7 +240,7 @@ int libretrodb_open(const char *path, libretrodb_t *db)
       return -errno;
 
    strlcpy(db->path, path, sizeof(db->path));
-   db->root = retro_fseek(fd, 0, SEEK_CUR);
+   db->root = retro_ftell(fd);
 
    if ((rv = retro_fread(fd, &header, sizeof(header))) == -1)
    {
@@ -203,7 +248,8 @@ int libretrodb_open(const char *path, libretrodb_t *db)
       goto error;
    }
 
-   if (strncmp(header.magic_number, MAGIC_NUMBER, sizeof(MAGIC_NUMBER)) != 0)
+   if (strncmp(header.magic_number, MAGIC_NUMBER,
+            sizeof(MAGIC_NUMBER) - 1) != 0)
    {
       rv = -EINVAL;
       goto error;
@@ -219,7 +265,8 @@ int libretrodb_open(const char *path, libretrodb_t *db)
    }
 
    db->count = md.count;
-   db->first_index_offset = retro_fseek(fd, 0, SEEK_CUR);
+   db->first_index_offset = retro_ftell(fd);
+   db->indexes = NULL;
    db->fd = fd;
    return 0;
 
@@ -232,17 +279,24 @@ error:
 static int libretrodb_find_index(libretrodb_t *db, const char *index_name,
       libretrodb_index_t *idx)
 {
-   ssize_t eof    = retro_fseek(db->fd, 0, SEEK_END);
-   ssize_t offset = retro_fseek(db->fd, (ssize_t)db->first_index_offset, SEEK_SET);
+   ssize_t eof, offset;
+
+   /* retro_fseek() does not return the new position. */
+   retro_fseek(db->fd, 0, SEEK_END);
+   eof    = retro_ftell(db->fd);
+   retro_fseek(db->fd, (ssize_t)db->first_index_offset, SEEK_SET);
+   offset = retro_ftell(db->fd);
 
    while (offset < eof)
    {
-      libretrodb_read_index_header(db->fd, idx);
+      if (libretrodb_read_index_header(db->fd, idx) < 0)
+         return -1;
 
-      if (strncmp(index_name, idx->name, strlen(idx->name)) == 0)
+      if (strcmp(index_name, idx->name) == 0)
          return 0;
 
-      offset = retro_fseek(db->fd, (ssize_t)idx->next, SEEK_CUR);
+      retro_fseek(db->fd, (ssize_t)idx->next, SEEK_CUR);
+      offset = retro_ftell(db->fd);
    }
 
    return -1;
@@ -253,68 +307,220 @@ static int node_compare(const void *a, const void *b, void *ctx)
    return memcmp(a, b, *(uint8_t *)ctx);
 }
 
-static int binsearch(const void *buff, const void *item,
-      uint64_t count, uint8_t field_size, uint64_t *offset)
+/**
+ * libretrodb_get_index:
+ * @db                  : Handle to database.
+ * @index_name          : Name of the index.
+ *
+ * Looks up index @index_name, reading it from the database file
+ * the first time it is asked for. The index then stays in memory
+ * until the database is closed.
+ *
+ * Returns: cached index, or NULL if @db has no such index.
+ **/
+static libretrodb_index_cache_t *libretrodb_get_index(libretrodb_t *db,
+      const char *index_name)
 {
-   int mid            = count / 2;
-   int item_size      = field_size + sizeof(uint64_t);
-   uint64_t *current  = (uint64_t *)buff + (mid * item_size);
-   int rv             = node_compare(current, item, &field_size);
+   libretrodb_index_t idx;
+   ssize_t nread                   = 0;
+   libretrodb_index_cache_t *cache = NULL;
+
+   for (cache = db->indexes; cache; cache = cache->next)
+      if (strcmp(cache->header.name, index_name) == 0)
+         return cache;
 
-   if (rv == 0)
+   if (libretrodb_find_index(db, index_name, &idx) < 0)
+      return NULL;
+
+   if (idx.key_size == 0 || idx.key_size > UINT8_MAX)
+      return NULL;
+
+   cache = (libretrodb_index_cache_t*)calloc(1, sizeof(*cache));
+   if (!cache)
+      return NULL;
+
+   cache->header     = idx;
+   cache->entry_size = (size_t)idx.key_size + sizeof(uint64_t);
+   cache->count      = idx.next / cache->entry_size;
+   cache->entries    = (uint8_t*)malloc(
+         (size_t)(cache->count * cache->entry_size) + 1);
+
+   if (!cache->entries)
+      goto error;
+
+   while (nread < (ssize_t)(cache->count * cache->entry_size))
    {
-      *offset = *(uint64_t *)(current + field_size);
-      return 0;
+      ssize_t rv = retro_fread(db->fd, cache->entries + nread,
+            (size_t)(cache->count * cache->entry_size) - nread);
+
+      if (rv <= 0)
+         goto error;
+      nread += rv;
    }
 
-   if (count == 0)
-      return -1;
+   cache->next = db->indexes;
+   db->indexes = cache;
+   return cache;
+
+error:
+   free(cache->entries);
+   free(cache);
+   return NULL;
+}
 
-   if (rv > 0)
-      return binsearch(buff, item, mid, field_size, offset);
+/**
+ * binsearch:
+ * @idx                 : Index to search.
+ * @item                : Key, idx->header.key_size bytes.
+ * @offset              : Set to the file offset of the matching
+ *                        entry.
+ *
+ * Returns: 0 if @item was found, otherwise -1.
+ **/
+static int binsearch(const libretrodb_index_cache_t *idx,
+      const void *item, uint64_t *offset)
+{
+   size_t key_size = (size_t)idx->header.key_size;
+   uint64_t lo     = 0;
+   uint64_t hi     = idx->count;
 
-   return binsearch(current + item_size, item,
-         count - mid, field_size, offset);
+   while (lo < hi)
+   {
+      uint64_t mid           = lo + (hi - lo) / 2;
+      const uint8_t *current = idx->entries + mid * idx->entry_size;
+      int rv                 = memcmp(current, item, key_size);
+
+      if (rv == 0)
+      {
+         memcpy(offset, current + key_size, sizeof(uint64_t));
+         return 0;
+      }
+
+      if (rv < 0)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   return -1;
 }
 
 int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
       const void *key, struct rmsgpack_dom_value *out)
 {
-   libretrodb_index_t idx;
-   int rv;
-   void *buff;
    uint64_t offset;
-   ssize_t bufflen, nread = 0;
+   libretrodb_index_cache_t *idx = libretrodb_get_index(db, index_name);
 
-   if (libretrodb_find_index(db, index_name, &idx) < 0)
+   if (!idx)
       return -1;
 
-   bufflen = idx.next;
-   buff = malloc(bufflen);
+   if (binsearch(idx, key, &offset) != 0)
+      return -1;
+
+   retro_fseek(db->fd, (ssize_t)offset, SEEK_SET);
+
+   return rmsgpack_dom_read(db->fd, out);
+}
+
+/**
+ * libretrodb_read_entry:
+ * @db                  : Handle to database.
+ * @offset              : Offset of the entry, as given by
+ *                        libretrodb_cursor_tell().
+ * @out                 : Entry read from @db.
+ *
+ * Reads the entry at @offset, e.g. one remembered by an external
+ * index over @db.
+ *
+ * Returns: 0 on success, otherwise a negative value.
+ **/
+int libretrodb_read_entry(libretrodb_t *db, uint64_t offset,
+      struct rmsgpack_dom_value *out)
+{
+   if (offset < db->root + sizeof(libretrodb_header_t)
+         || offset >= db->first_index_offset)
+      return -EINVAL;
+
+   retro_fseek(db->fd, (ssize_t)offset, SEEK_SET);
+
+   return rmsgpack_dom_read(db->fd, out);
+}
 
-   if (!buff)
+struct libretrodb_batch_entry
+{
+   uint64_t offset;
+   size_t slot;
+};
+
+static int libretrodb_batch_entry_compare(const void *a, const void *b)
+{
+   const struct libretrodb_batch_entry *ea =
+      (const struct libretrodb_batch_entry*)a;
+   const struct libretrodb_batch_entry *eb =
+      (const struct libretrodb_batch_entry*)b;
+
+   if (ea->offset < eb->offset)
+      return -1;
+   return ea->offset > eb->offset;
+}
+
+/**
+ * libretrodb_find_entries:
+ * @db                  : Handle to database.
+ * @index_name          : Name of the index to search.
+ * @keys                : Keys to look up.
+ * @num_keys            : Number of keys in @keys.
+ * @out                 : Array of @num_keys values.
+ *
+ * Looks up many keys in one go. Entries are read in file order,
+ * no matter what order @keys are in. @out[i] is set to the entry
+ * matching @keys[i], or to a nil value if there is none.
+ *
+ * Returns: number of keys found, or negative on error.
+ **/
+int libretrodb_find_entries(libretrodb_t *db, const char *index_name,
+      const void * const *keys, size_t num_keys,
+      struct rmsgpack_dom_value *out)
+{
+   size_t i;
+   size_t found                          = 0;
+   struct libretrodb_batch_entry *batch  = NULL;
+   libretrodb_index_cache_t *idx         = NULL;
+
+   for (i = 0; i < num_keys; i++)
+      out[i].type = RDT_NULL;
+
+   if (num_keys == 0)
+      return 0;
+
+   if (!(idx = libretrodb_get_index(db, index_name)))
+      return -1;
+
+   batch = (struct libretrodb_batch_entry*)
+      malloc(num_keys * sizeof(*batch));
+   if (!batch)
       return -ENOMEM;
 
-   while (nread < bufflen)
+   for (i = 0; i < num_keys; i++)
    {
-      void *buff_ = (uint64_t *)buff + nread;
-      rv = retro_fread(db->fd, buff_, bufflen - nread);
-
-      if (rv <= 0)
-      {
-         free(buff);
-         return -errno;
-      }
-      nread += rv;
+      if (binsearch(idx, keys[i], &batch[found].offset) != 0)
+         continue;
+      batch[found++].slot = i;
    }
 
-   rv = binsearch(buff, key, db->count, (ssize_t)idx.key_size, &offset);
-   free(buff);
+   qsort(batch, found, sizeof(*batch), libretrodb_batch_entry_compare);
 
-   if (rv == 0)
-      retro_fseek(db->fd, (ssize_t)offset, SEEK_SET);
+   for (i = 0; i < found; i++)
+   {
+      struct rmsgpack_dom_value *value = &out[batch[i].slot];
 
-   return rmsgpack_dom_read(db->fd, out);
+      retro_fseek(db->fd, (ssize_t)batch[i].offset, SEEK_SET);
+      if (rmsgpack_dom_read(db->fd, value) < 0)
+         value->type = RDT_NULL;
+   }
+
+   free(batch);
+   return (int)found;
 }
 
 /**
@@ -327,10 +533,25 @@ int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
  **/
 int libretrodb_cursor_reset(libretrodb_cursor_t *cursor)
 {
-   cursor->eof = 0;
-   return retro_fseek(cursor->fd,
-         (ssize_t)(cursor->db->root + sizeof(libretrodb_header_t)),
-         SEEK_SET);
+   cursor->eof         = 0;
+   cursor->next_offset = 0;
+   return rmsgpack_reader_seek(&cursor->reader,
+         cursor->db->root + sizeof(libretrodb_header_t));
+}
+
+/**
+ * libretrodb_cursor_tell:
+ * @cursor              : Handle to database cursor.
+ *
+ * Gets the offset of the next entry @cursor will read. For cursors
+ * without a query, that is the offset of the entry returned by the
+ * next call to libretrodb_cursor_read_item().
+ *
+ * Returns: offset of the next entry.
+ **/
+uint64_t libretrodb_cursor_tell(libretrodb_cursor_t *cursor)
+{
+   return rmsgpack_reader_tell(&cursor->reader);
 }
 
 int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
@@ -342,7 +563,22 @@ int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
       return EOF;
 
 retry:
-   rv = rmsgpack_dom_read(cursor->fd, out);
+   rmsgpack_dom_arena_reset(cursor->arena);
+
+   if (cursor->indexed)
+   {
+      if (cursor->next_offset >= cursor->num_offsets)
+      {
+         cursor->eof = 1;
+         return EOF;
+      }
+
+      if ((rv = rmsgpack_reader_seek(&cursor->reader,
+                  cursor->offsets[cursor->next_offset++])) < 0)
+         return rv;
+   }
+
+   rv = rmsgpack_dom_reader_read(&cursor->reader, cursor->arena, out);
    if (rv < 0)
       return rv;
 
@@ -355,10 +591,7 @@ retry:
    if (cursor->query)
    {
       if (!libretrodb_query_filter(cursor->query, out))
-      {
-         rmsgpack_dom_value_free(out);
          goto retry;
-      }
    }
 
    return 0;
@@ -375,17 +608,131 @@ void libretrodb_cursor_close(libretrodb_cursor_t *cursor)
    if (!cursor)
       return;
 
+   rmsgpack_reader_deinit(&cursor->reader);
+
    if (cursor->fd)
       retro_fclose(cursor->fd);
 
    if (cursor->query)
       libretrodb_query_free(cursor->query);
 
-   cursor->is_valid = 0;
+   rmsgpack_dom_arena_free(cursor->arena);
+
+   if (cursor->offsets)
+      free(cursor->offsets);
+
+   cursor->is_valid    = 0;
+   cursor->indexed     = 0;
+   cursor->offsets     = NULL;
+   cursor->num_offsets = 0;
    cursor->eof      = 1;
    cursor->fd       = NULL;
    cursor->db       = NULL;
    cursor->query    = NULL;
+   cursor->arena    = NULL;
+}
+
+static int libretrodb_index_usable(const char *field,
+      const struct rmsgpack_dom_value *value, void *data)
+{
+   libretrodb_index_cache_t *idx = NULL;
+
+   if (value->type != RDT_BINARY)
+      return 0;
+
+   /* Indexes don't record the field they were built from,
+    * they are expected to be named after it. */
+   if (!(idx = libretrodb_get_index((libretrodb_t*)data, field)))
+      return 0;
+
+   return value->val.binary.len == idx->header.key_size;
+}
+
+static int libretrodb_offset_compare(const void *a, const void *b)
+{
+   uint64_t oa = *(const uint64_t*)a;
+   uint64_t ob = *(const uint64_t*)b;
+
+   if (oa < ob)
+      return -1;
+   return oa > ob;
+}
+
+/**
+ * libretrodb_cursor_plan_query:
+ * @cursor              : Handle to database cursor.
+ *
+ * Turns the cursor's query into index seeks if it only
+ * matches entries with given values in indexed fields.
+ * Otherwise, the cursor is left to scan every entry.
+ **/
+static void libretrodb_cursor_plan_query(libretrodb_cursor_t *cursor)
+{
+   int i, num_keys;
+   size_t found = 0;
+   libretrodb_query_key_t keys[LIBRETRODB_CURSOR_MAX_KEYS];
+
+   num_keys = libretrodb_query_plan(cursor->query, libretrodb_index_usable,
+         cursor->db, keys, LIBRETRODB_CURSOR_MAX_KEYS);
+
+   if (num_keys < 0)
+      return;
+
+   if (num_keys > 0)
+   {
+      cursor->offsets = (uint64_t*)malloc(num_keys * sizeof(uint64_t));
+      if (!cursor->offsets)
+         return;
+   }
+
+   for (i = 0; i < num_keys; i++)
+   {
+      libretrodb_index_cache_t *idx = libretrodb_get_index(
+            cursor->db, keys[i].field);
+
+      if (idx && binsearch(idx, keys[i].value->val.binary.buff,
+               &cursor->offsets[found]) == 0)
+         found++;
+   }
+
+   qsort(cursor->offsets, found, sizeof(uint64_t),
+         libretrodb_offset_compare);
+
+   /* or() may name the same entry twice. */
+   cursor->num_offsets = 0;
+   for (i = 0; i < (int)found; i++)
+   {
+      if (cursor->num_offsets && cursor->offsets[i]
+            == cursor->offsets[cursor->num_offsets - 1])
+         continue;
+      cursor->offsets[cursor->num_offsets++] = cursor->offsets[i];
+   }
+
+   cursor->indexed = 1;
+}
+
+/**
+ * libretrodb_cursor_get_plan:
+ * @cursor              : Handle to database cursor.
+ * @count               : Set to the number of entries @cursor
+ *                        will look at.
+ *
+ * Tells how the cursor's query is going to be answered.
+ *
+ * Returns: 1 if only entries found through indexes are read,
+ * 0 if the whole database is scanned.
+ **/
+int libretrodb_cursor_get_plan(libretrodb_cursor_t *cursor,
+      uint64_t *count)
+{
+   if (cursor->indexed)
+   {
+      *count = cursor->num_offsets;
+      return 1;
+   }
+
+   *count = cursor->db ? cursor->db->count : 0;
+   return 0;
 }
 
 /**
@@ -394,43 +741,68 @@ void libretrodb_cursor_close(libretrodb_cursor_t *cursor)
  * @cursor              : Handle to database cursor.
  * @q                   : Query to execute.
  *
- * Opens cursor to database based on query @q.
+ * Opens cursor to database based on query @q. If @q pins a
+ * binary field to one or a few values and @db has an index
+ * named after that field, only the entries found through the
+ * index are read.
  *
  * Returns: 0 if successful, otherwise negative.
  **/
 int libretrodb_cursor_open(libretrodb_t *db, libretrodb_cursor_t *cursor,
       libretrodb_query_t *q)
 {
+   int rv;
+
    cursor->fd = retro_fopen(db->path, RFILE_MODE_READ, -1);
 
    if (!cursor->fd)
       return -errno;
 
+   if ((rv = rmsgpack_reader_init(&cursor->reader, cursor->fd,
+               LIBRETRODB_CURSOR_BUFFER_SIZE)) < 0)
+      goto error;
+
+   if (!(cursor->arena = rmsgpack_dom_arena_new(0)))
+   {
+      rv = -ENOMEM;
+      goto error;
+   }
+
    cursor->db = db;
    cursor->is_valid = 1;
    libretrodb_cursor_reset(cursor);
    cursor->query = q;
 
    if (q)
+   {
       libretrodb_query_inc_ref(q);
+      libretrodb_cursor_plan_query(cursor);
+   }
 
    return 0;
+
+error:
+   rmsgpack_reader_deinit(&cursor->reader);
+   retro_fclose(cursor->fd);
+   cursor->fd = NULL;
+   return rv;
 }
 
 static int node_iter(void *value, void *ctx)
 {
    struct node_iter_ctx *nictx = (struct node_iter_ctx*)ctx;
 
-   if (retro_fwrite(nictx->db->fd, value,
+   if (retro_fwrite(nictx->fd, value,
             (ssize_t)(nictx->idx->key_size + sizeof(uint64_t))) > 0)
       return 0;
 
    return -1;
 }
 
-static uint64_t libretrodb_tell(libretrodb_t *db)
+static int node_free(void *value, void *ctx)
 {
-   return retro_fseek(db->fd, 0, SEEK_CUR);
+   free(value);
+   return 0;
 }
 
 int libretrodb_create_index(libretrodb_t *db,
@@ -442,12 +814,11 @@ int libretrodb_create_index(libretrodb_t *db,
    libretrodb_index_t idx;
    struct rmsgpack_dom_value item;
    struct rmsgpack_dom_value *field;
-   uint64_t idx_header_offset;
+   RFILE *fd                   = NULL;
    libretrodb_cursor_t cur     = {0};
-   void *buff                  = NULL;
-   uint64_t *buff_u64          = NULL;
+   uint8_t *buff               = NULL;
    uint8_t field_size          = 0;
-   uint64_t item_loc           = libretrodb_tell(db);
+   uint64_t item_loc           = 0;
    bintree_t *tree             = bintree_new(node_compare, &field_size);
 
    if (!tree || (libretrodb_cursor_open(db, &cur, NULL) != 0))
@@ -456,6 +827,8 @@ int libretrodb_create_index(libretrodb_t *db,
       goto clean;
    }
 
+   item_loc = libretrodb_cursor_tell(&cur);
+
    key.type = RDT_STRING;
    key.val.string.len = strlen(field_name);
 
@@ -503,7 +876,7 @@ int libretrodb_create_index(libretrodb_t *db,
          goto clean;
       }
 
-      buff = malloc(field_size + sizeof(uint64_t));
+      buff = (uint8_t*)malloc(field_size + sizeof(uint64_t));
       if (!buff)
       {
          rv = -ENOMEM;
@@ -511,10 +884,7 @@ int libretrodb_create_index(libretrodb_t *db,
       }
 
       memcpy(buff, field->val.binary.buff, field_size);
-
-      buff_u64 = (uint64_t *)buff + field_size;
-
-      memcpy(buff_u64, &item_loc, sizeof(uint64_t));
+      memcpy(buff + field_size, &item_loc, sizeof(uint64_t));
 
       if (bintree_insert(tree, buff) != 0)
       {
@@ -525,13 +895,19 @@ int libretrodb_create_index(libretrodb_t *db,
          goto clean;
       }
       buff = NULL;
-      rmsgpack_dom_value_free(&item);
-      item_loc = libretrodb_tell(db);
+      item_loc = libretrodb_cursor_tell(&cur);
+   }
+
+   /* db->fd is read-only, append the index through a handle
+    * of our own. */
+   if (!(fd = retro_fopen(db->path, RFILE_MODE_READ_WRITE, -1)))
+   {
+      rv = -errno;
+      goto clean;
    }
 
-   idx_header_offset = retro_fseek(db->fd, 0, SEEK_END);
+   retro_fseek(fd, 0, SEEK_END);
 
-   (void)idx_header_offset;
    (void)rv;
 
    strncpy(idx.name, name, 50);
@@ -539,17 +915,24 @@ int libretrodb_create_index(libretrodb_t *db,
    idx.name[49] = '\0';
    idx.key_size = field_size;
    idx.next = db->count * (field_size + sizeof(uint64_t));
-   libretrodb_write_index_header(db->fd, &idx);
+   libretrodb_write_index_header(fd, &idx);
 
-   nictx.db = db;
+   nictx.fd  = fd;
    nictx.idx = &idx;
    bintree_iterate(tree, node_iter, &nictx);
-   bintree_free(tree);
+   retro_fclose(fd);
+
+   /* Let lookups pick up the new index. */
+   libretrodb_free_indexes(db);
 
 clean:
-   rmsgpack_dom_value_free(&item);
    if (buff)
       free(buff);
+   if (tree)
+   {
+      bintree_iterate(tree, node_free, NULL);
+      bintree_free(tree);
+   }
    if (cur.is_valid)
       libretrodb_cursor_close(&cur);
    return 0;
@@ -574,6 +957,31 @@ void libretrodb_cursor_free(libretrodb_cursor_t *dbc)
    free(dbc);
 }
 
+/**
+ * libretrodb_get_count:
+ * @db                  : Handle to database.
+ *
+ * Returns: number of entries in @db.
+ **/
+uint64_t libretrodb_get_count(libretrodb_t *db)
+{
+   return db->count;
+}
+
+/**
+ * libretrodb_get_entries_size:
+ * @db                  : Handle to database.
+ *
+ * Gets the size of the entries and metadata of @db. Unlike the
+ * file size, this does not change when an index is added.
+ *
+ * Returns: size in bytes.
+ **/
+uint64_t libretrodb_get_entries_size(libretrodb_t *db)
+{
+   return db->first_index_offset - db->root;
+}
+
 libretrodb_t *libretrodb_new(void)
 {
    libretrodb_t *db = (libretrodb_t*)calloc(1, sizeof(*db));
@@ -35,6 +35,30 @@ int libretrodb_create_index(libretrodb_t *db, const char *name,
 int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
         const void *key, struct rmsgpack_dom_value *out);
 
+/**
+ * libretrodb_find_entries:
+ * @db                  : Handle to database.
+ * @index_name          : Name of the index to search.
+ * @keys                : Keys to look up.
+ * @num_keys            : Number of keys in @keys.
+ * @out                 : Array of @num_keys values.
+ *
+ * Looks up many keys in one go. @out[i] is set to the entry
+ * matching @keys[i], or to a nil value if there is none.
+ *
+ * Returns: number of keys found, or negative on error.
+ **/
+int libretrodb_find_entries(libretrodb_t *db, const char *index_name,
+      const void * const *keys, size_t num_keys,
+      struct rmsgpack_dom_value *out);
+
+int libretrodb_read_entry(libretrodb_t *db, uint64_t offset,
+      struct rmsgpack_dom_value *out);
+
+uint64_t libretrodb_get_count(libretrodb_t *db);
+
+uint64_t libretrodb_get_entries_size(libretrodb_t *db);
+
 libretrodb_t *libretrodb_new(void);
 
 void libretrodb_free(libretrodb_t *db);
@@ -49,7 +73,10 @@ void libretrodb_cursor_free(libretrodb_cursor_t *dbc);
  * @cursor              : Handle to database cursor.
  * @q                   : Query to execute.
  *
- * Opens cursor to database based on query @q.
+ * Opens cursor to database based on query @q. If @q pins a
+ * binary field to one or a few values and @db has an index
+ * named after that field, only the entries found through the
+ * index are read.
  *
  * Returns: 0 if successful, otherwise negative.
  **/
@@ -80,9 +107,26 @@ void *libretrodb_query_compile(libretrodb_t *db, const char *query,
 
 void libretrodb_query_free(void *q);
 
+/**
+ * libretrodb_cursor_read_item:
+ * @cursor              : Handle to database cursor.
+ * @out                 : Next item matching the cursor's query.
+ *
+ * Reads the next item. @out belongs to @cursor and stays valid
+ * until the next read or until @cursor is closed; do not pass it
+ * to rmsgpack_dom_value_free().
+ *
+ * Returns: 0 if successful, EOF at the end of the database,
+ * otherwise negative.
+ **/
 int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
       struct rmsgpack_dom_value *out);
 
+uint64_t libretrodb_cursor_tell(libretrodb_cursor_t *cursor);
+
+int libretrodb_cursor_get_plan(libretrodb_cursor_t *cursor,
+      uint64_t *count);
+
 #ifdef __cplusplus
 }
 #endif
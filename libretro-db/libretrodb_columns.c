@@ -0,0 +1,691 @@
+/*
+ * Columnar sidecar for libretrodb databases.
+ *
+ * Walking a database with a cursor decodes every field of every
+ * entry. A sidecar stores each field as a column instead, so that
+ * readers interested in a couple of fields only load those.
+ *
+ * Layout, all integers little endian:
+ *
+ *   header     "RDBCOLS1", u64 count, u64 entries size,
+ *              u32 number of columns, u32 reserved
+ *   directory  per column: char name[32], u32 type, u32 reserved,
+ *              u64 offset, u64 size
+ *   columns    numbers: presence bitmap padded to 8 bytes,
+ *                       then one u64 per entry
+ *              strings and binaries: one u32 heap offset per entry,
+ *                       0 if missing, then the heap of
+ *                       u32 length, bytes, '\0'
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <retro_file.h>
+#include <retro_endianness.h>
+#include <compat/strl.h>
+
+#include "libretrodb.h"
+#include "libretrodb_columns.h"
+#include "rmsgpack_dom.h"
+
+#define COLUMNS_MAGIC        "RDBCOLS1"
+#define COLUMNS_MAGIC_LEN    8
+#define COLUMNS_HEADER_SIZE  32
+#define COLUMNS_ENTRY_SIZE   56
+#define COLUMNS_NAME_LEN     32
+#define COLUMNS_MAX          64
+
+enum columns_type
+{
+   /* Field with values of different types, can't be read
+    * from the sidecar. */
+   COLUMN_MIXED = 0,
+   COLUMN_UINT,
+   COLUMN_INT,
+   COLUMN_BOOL,
+   COLUMN_STRING,
+   COLUMN_BINARY
+};
+
+struct libretrodb_columns_column
+{
+   char name[COLUMNS_NAME_LEN];
+   unsigned type;
+   uint8_t *data;
+   uint64_t size;
+   /* Numbers */
+   const uint8_t *bitmap;
+   const uint8_t *values;
+   /* Strings and binaries */
+   const uint8_t *offsets;
+   const uint8_t *heap;
+   uint64_t heap_size;
+};
+
+struct libretrodb_columns
+{
+   uint64_t count;
+   unsigned num_columns;
+   struct libretrodb_columns_column *columns;
+   struct rmsgpack_dom_pair *pairs;
+};
+
+static void columns_put32(uint8_t *p, uint32_t v)
+{
+   v = swap_if_big32(v);
+   memcpy(p, &v, sizeof(v));
+}
+
+static void columns_put64(uint8_t *p, uint64_t v)
+{
+   v = swap_if_big64(v);
+   memcpy(p, &v, sizeof(v));
+}
+
+static uint32_t columns_get32(const uint8_t *p)
+{
+   uint32_t v;
+   memcpy(&v, p, sizeof(v));
+   return swap_if_big32(v);
+}
+
+static uint64_t columns_get64(const uint8_t *p)
+{
+   uint64_t v;
+   memcpy(&v, p, sizeof(v));
+   return swap_if_big64(v);
+}
+
+static uint64_t columns_bitmap_size(uint64_t count)
+{
+   return ((count + 63) / 64) * 8;
+}
+
+static unsigned columns_type_of(const struct rmsgpack_dom_value *value)
+{
+   switch (value->type)
+   {
+      case RDT_UINT:
+         return COLUMN_UINT;
+      case RDT_INT:
+         return COLUMN_INT;
+      case RDT_BOOL:
+         return COLUMN_BOOL;
+      case RDT_STRING:
+         return COLUMN_STRING;
+      case RDT_BINARY:
+         return COLUMN_BINARY;
+      default:
+         break;
+   }
+
+   return COLUMN_MIXED;
+}
+
+/* Column being built by libretrodb_columns_create(). */
+struct columns_builder
+{
+   char name[COLUMNS_NAME_LEN];
+   unsigned type;
+   uint8_t *data;
+   uint64_t data_size;
+   uint8_t *heap;
+   uint64_t heap_size;
+   uint64_t heap_cap;
+};
+
+static struct columns_builder *columns_builder_find(
+      struct columns_builder *builders, unsigned num,
+      const struct rmsgpack_dom_value *key)
+{
+   unsigned i;
+
+   for (i = 0; i < num; i++)
+      if (strlen(builders[i].name) == key->val.string.len
+            && !memcmp(builders[i].name, key->val.string.buff,
+               key->val.string.len))
+         return &builders[i];
+
+   return NULL;
+}
+
+static int columns_builder_add_heap(struct columns_builder *b,
+      const char *buff, uint32_t len, uint32_t *offset)
+{
+   uint64_t needed = b->heap_size + sizeof(uint32_t) + len + 1;
+
+   if (needed > UINT32_MAX)
+      return -EFBIG;
+
+   if (needed > b->heap_cap)
+   {
+      uint64_t cap  = b->heap_cap;
+      uint8_t *heap = NULL;
+
+      while (cap < needed)
+         cap *= 2;
+
+      if (!(heap = (uint8_t*)realloc(b->heap, (size_t)cap)))
+         return -ENOMEM;
+
+      b->heap     = heap;
+      b->heap_cap = cap;
+   }
+
+   *offset = (uint32_t)b->heap_size;
+
+   columns_put32(b->heap + b->heap_size, len);
+   memcpy(b->heap + b->heap_size + sizeof(uint32_t), buff, len);
+   b->heap[b->heap_size + sizeof(uint32_t) + len] = '\0';
+   b->heap_size = needed;
+   return 0;
+}
+
+static int columns_builder_set(struct columns_builder *b, uint64_t count,
+      uint64_t row, const struct rmsgpack_dom_value *value)
+{
+   uint32_t offset = 0;
+   int rv          = 0;
+
+   switch (b->type)
+   {
+      case COLUMN_UINT:
+      case COLUMN_INT:
+      case COLUMN_BOOL:
+         b->data[row / 8] |= 1 << (row % 8);
+         columns_put64(b->data + columns_bitmap_size(count) + row * 8,
+               (b->type == COLUMN_UINT) ? value->val.uint_
+               : (b->type == COLUMN_INT) ? (uint64_t)value->val.int_
+               : (uint64_t)value->val.bool_);
+         break;
+      case COLUMN_STRING:
+      case COLUMN_BINARY:
+         if ((rv = columns_builder_add_heap(b, value->val.string.buff,
+                     value->val.string.len, &offset)) < 0)
+            return rv;
+         columns_put32(b->data + row * 4, offset);
+         break;
+   }
+
+   return 0;
+}
+
+static int columns_write(RFILE *fd, const void *data, uint64_t size)
+{
+   if (size && retro_fwrite(fd, data, (size_t)size) != (ssize_t)size)
+      return -EIO;
+   return 0;
+}
+
+/**
+ * libretrodb_columns_create:
+ * @db                  : Handle to database.
+ * @path                : Sidecar to write, usually the database
+ *                        path followed by LIBRETRODB_COLUMNS_EXTENSION.
+ *
+ * Writes a columnar copy of the entries of @db to @path. Fields
+ * holding maps or arrays, or values of more than one type, are
+ * recorded as unreadable so that readers fall back to @db for them.
+ *
+ * Returns: 0 on success, otherwise a negative value.
+ **/
+int libretrodb_columns_create(libretrodb_t *db, const char *path)
+{
+   unsigned i;
+   struct rmsgpack_dom_value item;
+   uint8_t header[COLUMNS_HEADER_SIZE];
+   uint8_t entry[COLUMNS_ENTRY_SIZE];
+   struct columns_builder builders[COLUMNS_MAX];
+   uint64_t offset              = 0;
+   uint64_t count               = 0;
+   uint64_t row                 = 0;
+   unsigned num                 = 0;
+   RFILE *fd                    = NULL;
+   libretrodb_cursor_t *cur     = libretrodb_cursor_new();
+   int rv                       = -ENOMEM;
+
+   memset(builders, 0, sizeof(builders));
+
+   if (!cur)
+      goto end;
+
+   if ((rv = libretrodb_cursor_open(db, cur, NULL)) < 0)
+      goto end;
+
+   /* First pass, find out the columns and their types. */
+   while (libretrodb_cursor_read_item(cur, &item) == 0)
+   {
+      count++;
+
+      if (item.type != RDT_MAP)
+         continue;
+
+      for (i = 0; i < item.val.map.len; i++)
+      {
+         const struct rmsgpack_dom_value *key   = &item.val.map.items[i].key;
+         const struct rmsgpack_dom_value *value = &item.val.map.items[i].value;
+         struct columns_builder *b              = NULL;
+
+         if (key->type != RDT_STRING || key->val.string.len >= COLUMNS_NAME_LEN)
+         {
+            rv = -EINVAL;
+            goto end;
+         }
+
+         if (value->type == RDT_NULL)
+            continue;
+
+         if (!(b = columns_builder_find(builders, num, key)))
+         {
+            if (num == COLUMNS_MAX)
+            {
+               rv = -E2BIG;
+               goto end;
+            }
+
+            b = &builders[num++];
+            memcpy(b->name, key->val.string.buff, key->val.string.len);
+            b->type = columns_type_of(value);
+         }
+         else if (b->type != columns_type_of(value))
+            b->type = COLUMN_MIXED;
+      }
+   }
+
+   for (i = 0; i < num; i++)
+   {
+      switch (builders[i].type)
+      {
+         case COLUMN_UINT:
+         case COLUMN_INT:
+         case COLUMN_BOOL:
+            builders[i].data_size = columns_bitmap_size(count) + count * 8;
+            break;
+         case COLUMN_STRING:
+         case COLUMN_BINARY:
+            builders[i].data_size = count * 4;
+            builders[i].heap_size = sizeof(uint32_t); /* 0 is missing */
+            break;
+         default:
+            continue;
+      }
+
+      rv = -ENOMEM;
+      if (!(builders[i].data = (uint8_t*)calloc(1,
+                  (size_t)builders[i].data_size + 1)))
+         goto end;
+
+      if (builders[i].heap_size)
+      {
+         builders[i].heap_cap = 4096;
+         if (!(builders[i].heap = (uint8_t*)calloc(1,
+                     (size_t)builders[i].heap_cap)))
+            goto end;
+      }
+   }
+
+   /* Second pass, fill the columns in. */
+   libretrodb_cursor_reset(cur);
+
+   for (row = 0; row < count
+         && libretrodb_cursor_read_item(cur, &item) == 0; row++)
+   {
+      if (item.type != RDT_MAP)
+         continue;
+
+      for (i = 0; i < item.val.map.len; i++)
+      {
+         const struct rmsgpack_dom_pair *pair = &item.val.map.items[i];
+         struct columns_builder *b            = columns_builder_find(
+               builders, num, &pair->key);
+
+         if (!b || b->type == COLUMN_MIXED || pair->value.type == RDT_NULL)
+            continue;
+
+         if ((rv = columns_builder_set(b, count, row, &pair->value)) < 0)
+            goto end;
+      }
+   }
+
+   if (!(fd = retro_fopen(path, RFILE_MODE_WRITE, -1)))
+   {
+      rv = -errno;
+      goto end;
+   }
+
+   memcpy(header, COLUMNS_MAGIC, COLUMNS_MAGIC_LEN);
+   columns_put64(header + 8,  count);
+   columns_put64(header + 16, libretrodb_get_entries_size(db));
+   columns_put32(header + 24, num);
+   columns_put32(header + 28, 0);
+
+   if ((rv = columns_write(fd, header, sizeof(header))) < 0)
+      goto end;
+
+   offset = COLUMNS_HEADER_SIZE + num * COLUMNS_ENTRY_SIZE;
+
+   for (i = 0; i < num; i++)
+   {
+      uint64_t size = builders[i].data_size + builders[i].heap_size;
+
+      memset(entry, 0, sizeof(entry));
+      memcpy(entry, builders[i].name, COLUMNS_NAME_LEN);
+      columns_put32(entry + 32, builders[i].type);
+      columns_put64(entry + 40, offset);
+      columns_put64(entry + 48, size);
+
+      if ((rv = columns_write(fd, entry, sizeof(entry))) < 0)
+         goto end;
+
+      offset += size;
+   }
+
+   for (i = 0; i < num; i++)
+   {
+      if ((rv = columns_write(fd, builders[i].data,
+                  builders[i].data_size)) < 0)
+         goto end;
+      if ((rv = columns_write(fd, builders[i].heap,
+                  builders[i].heap_size)) < 0)
+         goto end;
+   }
+
+   rv = 0;
+
+end:
+   if (fd)
+      retro_fclose(fd);
+   for (i = 0; i < num; i++)
+   {
+      free(builders[i].data);
+      free(builders[i].heap);
+   }
+   if (cur)
+   {
+      libretrodb_cursor_close(cur);
+      libretrodb_cursor_free(cur);
+   }
+   return rv;
+}
+
+static int columns_wanted(const char *name, const char * const *fields)
+{
+   if (!fields)
+      return 1;
+
+   for (; *fields; fields++)
+      if (!strcmp(*fields, name))
+         return 1;
+
+   return 0;
+}
+
+static int columns_read(RFILE *fd, void *data, uint64_t size)
+{
+   if (size && retro_fread(fd, data, (size_t)size) != (ssize_t)size)
+      return -1;
+   return 0;
+}
+
+static int columns_load(struct libretrodb_columns_column *column,
+      RFILE *fd, uint64_t count, uint64_t offset)
+{
+   uint64_t fixed = 0;
+
+   switch (column->type)
+   {
+      case COLUMN_UINT:
+      case COLUMN_INT:
+      case COLUMN_BOOL:
+         fixed = columns_bitmap_size(count) + count * 8;
+         if (column->size != fixed)
+            return -1;
+         break;
+      case COLUMN_STRING:
+      case COLUMN_BINARY:
+         fixed = count * 4;
+         if (column->size < fixed + sizeof(uint32_t))
+            return -1;
+         break;
+      default:
+         return -1;
+   }
+
+   if (!(column->data = (uint8_t*)malloc((size_t)column->size)))
+      return -1;
+
+   if (retro_fseek(fd, (ssize_t)offset, SEEK_SET) < 0)
+      return -1;
+   if (columns_read(fd, column->data, column->size) < 0)
+      return -1;
+
+   if (column->type == COLUMN_STRING || column->type == COLUMN_BINARY)
+   {
+      column->offsets   = column->data;
+      column->heap      = column->data + fixed;
+      column->heap_size = column->size - fixed;
+   }
+   else
+   {
+      column->bitmap = column->data;
+      column->values = column->data + columns_bitmap_size(count);
+   }
+
+   return 0;
+}
+
+/**
+ * libretrodb_columns_open:
+ * @db                  : Handle to the database @path was made from.
+ * @path                : Sidecar to open.
+ * @fields              : NULL-terminated list of the fields to load,
+ *                        or NULL for all of them.
+ *
+ * Loads the columns of @fields from the sidecar at @path. Fields
+ * the sidecar has no column for are missing from every entry.
+ *
+ * Returns: handle to the sidecar, or NULL if it can't be read, is
+ * out of date with @db or can't provide one of @fields.
+ **/
+libretrodb_columns_t *libretrodb_columns_open(libretrodb_t *db,
+      const char *path, const char * const *fields)
+{
+   unsigned i;
+   uint8_t header[COLUMNS_HEADER_SIZE];
+   uint8_t *directory         = NULL;
+   unsigned num               = 0;
+   libretrodb_columns_t *cols = NULL;
+   RFILE *fd                  = retro_fopen(path, RFILE_MODE_READ, -1);
+
+   if (!fd)
+      return NULL;
+
+   if (columns_read(fd, header, sizeof(header)) < 0)
+      goto error;
+
+   if (memcmp(header, COLUMNS_MAGIC, COLUMNS_MAGIC_LEN)
+         || columns_get64(header + 8)  != libretrodb_get_count(db)
+         || columns_get64(header + 16) != libretrodb_get_entries_size(db))
+      goto error;
+
+   if ((num = columns_get32(header + 24)) > COLUMNS_MAX)
+      goto error;
+
+   if (!(cols = (libretrodb_columns_t*)calloc(1, sizeof(*cols))))
+      goto error;
+
+   cols->count = columns_get64(header + 8);
+
+   directory    = (uint8_t*)malloc(num * COLUMNS_ENTRY_SIZE + 1);
+   cols->columns = (struct libretrodb_columns_column*)
+      calloc(num + 1, sizeof(*cols->columns));
+   cols->pairs   = (struct rmsgpack_dom_pair*)
+      calloc(num + 1, sizeof(*cols->pairs));
+
+   if (!directory || !cols->columns || !cols->pairs)
+      goto error;
+
+   if (columns_read(fd, directory, num * COLUMNS_ENTRY_SIZE) < 0)
+      goto error;
+
+   for (i = 0; i < num; i++)
+   {
+      const uint8_t *entry                     = directory + i * COLUMNS_ENTRY_SIZE;
+      struct libretrodb_columns_column *column = &cols->columns[cols->num_columns];
+
+      memcpy(column->name, entry, COLUMNS_NAME_LEN);
+      column->name[COLUMNS_NAME_LEN - 1] = '\0';
+
+      if (!columns_wanted(column->name, fields))
+         continue;
+
+      column->type = columns_get32(entry + 32);
+      column->size = columns_get64(entry + 48);
+
+      cols->num_columns++;
+
+      if (columns_load(column, fd, cols->count,
+               columns_get64(entry + 40)) < 0)
+         goto error;
+   }
+
+   free(directory);
+   retro_fclose(fd);
+   return cols;
+
+error:
+   free(directory);
+   libretrodb_columns_close(cols);
+   retro_fclose(fd);
+   return NULL;
+}
+
+/**
+ * libretrodb_columns_close:
+ * @cols                : Sidecar.
+ *
+ * Frees @cols and every value read from it.
+ **/
+void libretrodb_columns_close(libretrodb_columns_t *cols)
+{
+   unsigned i;
+
+   if (!cols)
+      return;
+
+   if (cols->columns)
+      for (i = 0; i < cols->num_columns; i++)
+         free(cols->columns[i].data);
+
+   free(cols->columns);
+   free(cols->pairs);
+   free(cols);
+}
+
+/**
+ * libretrodb_columns_count:
+ * @cols                : Sidecar.
+ *
+ * Returns: number of entries in @cols.
+ **/
+uint64_t libretrodb_columns_count(const libretrodb_columns_t *cols)
+{
+   return cols->count;
+}
+
+/**
+ * libretrodb_columns_read_row:
+ * @cols                : Sidecar.
+ * @row                 : Entry to read.
+ * @out                 : Map of the loaded fields that @row has.
+ *
+ * Reads an entry back as a map, like a cursor would, but limited
+ * to the loaded fields. @out points into @cols and stays valid
+ * until the next read; do not pass it to rmsgpack_dom_value_free().
+ *
+ * Returns: 0 on success, otherwise a negative value.
+ **/
+int libretrodb_columns_read_row(libretrodb_columns_t *cols,
+      uint64_t row, struct rmsgpack_dom_value *out)
+{
+   unsigned i;
+   unsigned len = 0;
+
+   if (row >= cols->count)
+      return -EINVAL;
+
+   for (i = 0; i < cols->num_columns; i++)
+   {
+      const struct libretrodb_columns_column *column = &cols->columns[i];
+      struct rmsgpack_dom_value *value = &cols->pairs[len].value;
+
+      switch (column->type)
+      {
+         case COLUMN_UINT:
+         case COLUMN_INT:
+         case COLUMN_BOOL:
+            {
+               uint64_t v;
+
+               if (!(column->bitmap[row / 8] & (1 << (row % 8))))
+                  continue;
+
+               v = columns_get64(column->values + row * 8);
+
+               if (column->type == COLUMN_UINT)
+               {
+                  value->type     = RDT_UINT;
+                  value->val.uint_ = v;
+               }
+               else if (column->type == COLUMN_INT)
+               {
+                  value->type     = RDT_INT;
+                  value->val.int_ = (int64_t)v;
+               }
+               else
+               {
+                  value->type      = RDT_BOOL;
+                  value->val.bool_ = (int)v;
+               }
+            }
+            break;
+         case COLUMN_STRING:
+         case COLUMN_BINARY:
+            {
+               uint32_t size;
+               uint32_t offset = columns_get32(column->offsets + row * 4);
+
+               if (!offset || (uint64_t)offset + sizeof(uint32_t)
+                     > column->heap_size)
+                  continue;
+
+               size = columns_get32(column->heap + offset);
+
+               if ((uint64_t)offset + sizeof(uint32_t) + size + 1
+                     > column->heap_size)
+                  continue;
+
+               value->type            = (column->type == COLUMN_STRING)
+                  ? RDT_STRING : RDT_BINARY;
+               value->val.string.len  = size;
+               value->val.string.buff = (char*)column->heap
+                  + offset + sizeof(uint32_t);
+            }
+            break;
+         default:
+            continue;
+      }
+
+      cols->pairs[len].key.type            = RDT_STRING;
+      cols->pairs[len].key.val.string.len  = strlen(column->name);
+      cols->pairs[len].key.val.string.buff = (char*)column->name;
+      len++;
+   }
+
+   out->type          = RDT_MAP;
+   out->val.map.len   = len;
+   out->val.map.items = cols->pairs;
+   return 0;
+}
@@ -0,0 +1,34 @@
+#ifndef __LIBRETRODB_COLUMNS_H__
+#define __LIBRETRODB_COLUMNS_H__
+
+#include <stdint.h>
+
+#include "libretrodb.h"
+#include "rmsgpack_dom.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Sidecars live next to their database, as <database>.cols */
+#define LIBRETRODB_COLUMNS_EXTENSION ".cols"
+
+typedef struct libretrodb_columns libretrodb_columns_t;
+
+int libretrodb_columns_create(libretrodb_t *db, const char *path);
+
+libretrodb_columns_t *libretrodb_columns_open(libretrodb_t *db,
+      const char *path, const char * const *fields);
+
+void libretrodb_columns_close(libretrodb_columns_t *cols);
+
+uint64_t libretrodb_columns_count(const libretrodb_columns_t *cols);
+
+int libretrodb_columns_read_row(libretrodb_columns_t *cols,
+      uint64_t row, struct rmsgpack_dom_value *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,7 +1,11 @@
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
+
+#include <retro_miscellaneous.h>
 
 #include "libretrodb.h"
+#include "libretrodb_columns.h"
 #include "rmsgpack_dom.h"
 
 int main(int argc, char ** argv)
@@ -9,7 +13,7 @@ int main(int argc, char ** argv)
    int rv;
    libretrodb_t *db;
    libretrodb_cursor_t *cur;
-   libretrodb_query_t *q;
+   libretrodb_query_t *q = NULL;
    struct rmsgpack_dom_value item;
    const char *command, *path, *query_exp, *error;
 
@@ -20,6 +24,8 @@ int main(int argc, char ** argv)
       printf("\tlist\n");
       printf("\tcreate-index <index name> <field name>\n");
       printf("\tfind <query expression>\n");
+      printf("\texplain <query expression>\n");
+      printf("\tcreate-columns\n");
       return 1;
    }
 
@@ -55,7 +61,6 @@ int main(int argc, char ** argv)
       {
          rmsgpack_dom_value_print(&item);
          printf("\n");
-         rmsgpack_dom_value_free(&item);
       }
    }
    else if (strcmp(command, "find") == 0)
@@ -86,9 +91,52 @@ int main(int argc, char ** argv)
       {
          rmsgpack_dom_value_print(&item);
          printf("\n");
-         rmsgpack_dom_value_free(&item);
       }
    }
+   else if (strcmp(command, "explain") == 0)
+   {
+      clock_t start;
+      uint64_t count   = 0;
+      uint64_t matches = 0;
+
+      if (argc != 4)
+      {
+         printf("Usage: %s <db file> explain <query expression>\n", argv[0]);
+         goto error;
+      }
+
+      query_exp = argv[3];
+      error = NULL;
+      q = libretrodb_query_compile(db, query_exp, strlen(query_exp), &error);
+
+      if (error)
+      {
+         printf("%s\n", error);
+         goto error;
+      }
+
+      start = clock();
+
+      if ((rv = libretrodb_cursor_open(db, cur, q)) != 0)
+      {
+         printf("Could not open cursor: %s\n", strerror(-rv));
+         goto error;
+      }
+
+      if (libretrodb_cursor_get_plan(cur, &count))
+         printf("plan: index lookup, %llu entries to read\n",
+               (unsigned long long)count);
+      else
+         printf("plan: full scan, %llu entries to read\n",
+               (unsigned long long)count);
+
+      while (libretrodb_cursor_read_item(cur, &item) == 0)
+         matches++;
+
+      printf("matched %llu entries in %.3f ms\n",
+            (unsigned long long)matches,
+            (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC);
+   }
    else if (strcmp(command, "create-index") == 0)
    {
       const char * index_name, * field_name;
@@ -104,12 +152,34 @@ int main(int argc, char ** argv)
 
       libretrodb_create_index(db, index_name, field_name);
    }
+   else if (strcmp(command, "create-columns") == 0)
+   {
+      char columns_path[PATH_MAX_LENGTH];
+
+      if (argc != 3)
+      {
+         printf("Usage: %s <db file> create-columns\n", argv[0]);
+         goto error;
+      }
+
+      snprintf(columns_path, sizeof(columns_path), "%s%s",
+            path, LIBRETRODB_COLUMNS_EXTENSION);
+
+      if ((rv = libretrodb_columns_create(db, columns_path)) != 0)
+      {
+         printf("Could not create '%s': %s\n", columns_path, strerror(-rv));
+         goto error;
+      }
+   }
    else
    {
       printf("Unknown command %s\n", argv[2]);
       goto error;
    }
 
+   libretrodb_cursor_close(cur);
+   if (q)
+      libretrodb_query_free(q);
    libretrodb_close(db);
 
 error:
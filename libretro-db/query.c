@@ -166,6 +166,8 @@ static void argument_free(struct argument *arg)
 
    for (i = 0; i < arg->a.invocation.argc; i++)
       argument_free(&arg->a.invocation.argv[i]);
+
+   free(arg->a.invocation.argv);
 }
 
 struct query
@@ -412,6 +414,154 @@ struct registered_func registered_functions[100] = {
    {NULL, NULL}
 };
 
+struct query_plan
+{
+   libretrodb_query_index_cb indexed;
+   void *data;
+   libretrodb_query_key_t *keys;
+   unsigned max_keys;
+   unsigned count;
+};
+
+static int query_plan_add(struct query_plan *plan, const char *field,
+      const struct rmsgpack_dom_value *value)
+{
+   if (plan->count >= plan->max_keys)
+      return -1;
+   if (!plan->indexed(field, value, plan->data))
+      return -1;
+
+   plan->keys[plan->count].field = field;
+   plan->keys[plan->count].value = value;
+   plan->count++;
+   return 0;
+}
+
+/* Plans the predicate @arg on a single field. */
+static int query_plan_field(struct query_plan *plan, const char *field,
+      const struct argument *arg)
+{
+   unsigned i;
+   unsigned start               = plan->count;
+   const struct invocation *inv = NULL;
+
+   if (arg->type == AT_VALUE)
+      return query_plan_add(plan, field, &arg->a.value);
+
+   inv = &arg->a.invocation;
+
+   if (inv->func == operator_or)
+   {
+      /* Any alternative may match, all of them need a key. */
+      for (i = 0; i < inv->argc; i++)
+      {
+         if (query_plan_field(plan, field, &inv->argv[i]) < 0)
+         {
+            plan->count = start;
+            return -1;
+         }
+      }
+      return 0;
+   }
+
+   if (inv->func == operator_and)
+   {
+      /* All of them have to match, one is enough to seek by. */
+      for (i = 0; i < inv->argc; i++)
+      {
+         if (query_plan_field(plan, field, &inv->argv[i]) == 0)
+            return 0;
+         plan->count = start;
+      }
+   }
+
+   return -1;
+}
+
+/* Plans a predicate on a whole entry. */
+static int query_plan_invocation(struct query_plan *plan,
+      const struct invocation *inv)
+{
+   unsigned i;
+   unsigned start = plan->count;
+
+   if (inv->func == all_map)
+   {
+      if (inv->argc % 2 != 0)
+         return -1;
+
+      for (i = 0; i < inv->argc; i += 2)
+      {
+         const struct argument *key = &inv->argv[i];
+
+         if (key->type != AT_VALUE || key->a.value.type != RDT_STRING)
+            continue;
+
+         if (query_plan_field(plan, key->a.value.val.string.buff,
+                  &inv->argv[i + 1]) == 0)
+            return 0;
+      }
+      return -1;
+   }
+
+   if (inv->func == operator_or || inv->func == operator_and)
+   {
+      for (i = 0; i < inv->argc; i++)
+      {
+         int rv = -1;
+
+         if (inv->argv[i].type == AT_FUNCTION)
+            rv = query_plan_invocation(plan, &inv->argv[i].a.invocation);
+
+         if (inv->func == operator_and && rv == 0)
+            return 0;
+         if (inv->func == operator_or && rv < 0)
+         {
+            plan->count = start;
+            return -1;
+         }
+      }
+      return (inv->func == operator_or) ? 0 : -1;
+   }
+
+   return -1;
+}
+
+/**
+ * libretrodb_query_plan:
+ * @q                   : Compiled query.
+ * @indexed             : Tells whether a field value can be looked
+ *                        up in an index.
+ * @data                : User data passed to @indexed.
+ * @keys                : Filled in with the keys to look up.
+ * @max_keys            : Size of @keys.
+ *
+ * Works out whether only entries having one of a few values in
+ * an indexed field can match @q, as for {crc: b"..."} or
+ * {crc: or(b"...", b"...")}. Entries found through @keys still
+ * have to be run through libretrodb_query_filter().
+ *
+ * Returns: number of keys in @keys, or -1 if @q can only be
+ * answered by looking at every entry.
+ **/
+int libretrodb_query_plan(libretrodb_query_t *q,
+      libretrodb_query_index_cb indexed, void *data,
+      libretrodb_query_key_t *keys, unsigned max_keys)
+{
+   struct query_plan plan;
+
+   plan.indexed  = indexed;
+   plan.data     = data;
+   plan.keys     = keys;
+   plan.max_keys = max_keys;
+   plan.count    = 0;
+
+   if (query_plan_invocation(&plan, &((struct query*)q)->root) < 0)
+      return -1;
+
+   return (int)plan.count;
+}
+
 static struct buffer chomp(struct buffer buff)
 {
    for (; (unsigned)buff.offset < buff.len && isspace((int)buff.data[buff.offset]); buff.offset++);
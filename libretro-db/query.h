@@ -16,6 +16,22 @@ void libretrodb_query_dec_ref(libretrodb_query_t *q);
 
 int libretrodb_query_filter(libretrodb_query_t *q, struct rmsgpack_dom_value *v);
 
+/* Field value a query can be narrowed down to through an index. */
+typedef struct libretrodb_query_key
+{
+   const char *field;
+   const struct rmsgpack_dom_value *value;
+} libretrodb_query_key_t;
+
+/* Returns non-zero if @value can be looked up in an index
+ * over @field. */
+typedef int (*libretrodb_query_index_cb)(const char *field,
+      const struct rmsgpack_dom_value *value, void *data);
+
+int libretrodb_query_plan(libretrodb_query_t *q,
+      libretrodb_query_index_cb indexed, void *data,
+      libretrodb_query_key_t *keys, unsigned max_keys);
+
 #ifdef __cplusplus
 }
 #endif
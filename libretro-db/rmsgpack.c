@@ -391,11 +391,180 @@ error:
    return -errno;
 }
 
-static int read_uint(RFILE *fd, uint64_t *out, size_t size)
+/**
+ * rmsgpack_reader_init:
+ * @reader              : Reader to set up.
+ * @fd                  : File to read from, positioned where
+ *                        reading should start.
+ * @size                : Size of the read buffer. 0 reads @fd
+ *                        directly, one retro_fread() per field.
+ *
+ * Sets up a reader over @fd. @fd must not be read or seeked
+ * behind the reader's back while it is in use.
+ *
+ * Returns: 0 on success, otherwise a negative value.
+ **/
+int rmsgpack_reader_init(rmsgpack_reader_t *reader, RFILE *fd, size_t size)
+{
+   ssize_t offset;
+
+   memset(reader, 0, sizeof(*reader));
+   reader->fd = fd;
+
+   if (!size)
+      return 0;
+
+   if ((offset = retro_ftell(fd)) < 0)
+      return -EINVAL;
+
+   reader->buff = (uint8_t*)malloc(size);
+   if (!reader->buff)
+      return -ENOMEM;
+
+   reader->size   = size;
+   reader->offset = (uint64_t)offset;
+   return 0;
+}
+
+/**
+ * rmsgpack_reader_deinit:
+ * @reader              : Reader to tear down.
+ *
+ * Frees the read buffer. The file itself is left open.
+ **/
+void rmsgpack_reader_deinit(rmsgpack_reader_t *reader)
+{
+   if (reader->buff)
+      free(reader->buff);
+   memset(reader, 0, sizeof(*reader));
+}
+
+/**
+ * rmsgpack_reader_seek:
+ * @reader              : Reader.
+ * @offset              : Absolute file offset.
+ *
+ * Moves the reader to @offset. Seeks that land in the bytes
+ * already buffered do not touch the file.
+ *
+ * Returns: 0 on success, otherwise a negative value.
+ **/
+int rmsgpack_reader_seek(rmsgpack_reader_t *reader, uint64_t offset)
+{
+   if (reader->buff)
+   {
+      if (offset >= reader->offset && offset <= reader->offset + reader->len)
+      {
+         reader->pos = (size_t)(offset - reader->offset);
+         return 0;
+      }
+
+      reader->offset = offset;
+      reader->len    = 0;
+      reader->pos    = 0;
+   }
+
+   if (retro_fseek(reader->fd, (ssize_t)offset, SEEK_SET) < 0)
+      return -EINVAL;
+   return 0;
+}
+
+/**
+ * rmsgpack_reader_tell:
+ * @reader              : Reader.
+ *
+ * Returns: file offset of the next value @reader will read.
+ **/
+uint64_t rmsgpack_reader_tell(rmsgpack_reader_t *reader)
+{
+   if (reader->buff)
+      return reader->offset + reader->pos;
+   return (uint64_t)retro_ftell(reader->fd);
+}
+
+static int reader_fill(rmsgpack_reader_t *reader)
+{
+   ssize_t rd;
+
+   reader->offset += reader->len;
+   reader->len     = 0;
+   reader->pos     = 0;
+
+   rd = retro_fread(reader->fd, reader->buff, reader->size);
+   if (rd <= 0)
+      return -1;
+
+   reader->len = (size_t)rd;
+   return 0;
+}
+
+static int reader_read(rmsgpack_reader_t *reader, void *s, size_t len)
+{
+   uint8_t *out = (uint8_t*)s;
+
+   if (!reader->buff)
+      return (retro_fread(reader->fd, s, len) == -1) ? -1 : 0;
+
+   while (len)
+   {
+      size_t avail = reader->len - reader->pos;
+
+      if (!avail)
+      {
+         /* Too big to be worth buffering, read it in place. */
+         if (len >= reader->size)
+         {
+            uint64_t offset = reader->offset + reader->len;
+
+            reader->offset = offset + len;
+            reader->len    = 0;
+            reader->pos    = 0;
+
+            if (retro_fread(reader->fd, out, len) != (ssize_t)len)
+               goto error;
+            return 0;
+         }
+
+         if (reader_fill(reader) != 0)
+            goto error;
+         continue;
+      }
+
+      if (avail > len)
+         avail = len;
+
+      memcpy(out, reader->buff + reader->pos, avail);
+      reader->pos += avail;
+      out         += avail;
+      len         -= avail;
+   }
+
+   return 0;
+
+error:
+   /* Truncated file. */
+   errno = EINVAL;
+   return -1;
+}
+
+static char *reader_alloc(rmsgpack_reader_t *reader, size_t size)
+{
+   if (reader->alloc)
+      return (char*)reader->alloc(reader->alloc_data, size);
+   return (char*)calloc(size, sizeof(char));
+}
+
+static void reader_release(rmsgpack_reader_t *reader, char *buff)
+{
+   if (!reader->alloc)
+      free(buff);
+}
+
+static int read_uint(rmsgpack_reader_t *reader, uint64_t *out, size_t size)
 {
    uint64_t tmp;
 
-   if (retro_fread(fd, &tmp, size) == -1)
+   if (reader_read(reader, &tmp, size) == -1)
       goto error;
 
    switch (size)
@@ -419,14 +588,14 @@ error:
    return -errno;
 }
 
-static int read_int(RFILE *fd, int64_t *out, size_t size)
+static int read_int(rmsgpack_reader_t *reader, int64_t *out, size_t size)
 {
    uint8_t tmp8 = 0;
    uint16_t tmp16;
    uint32_t tmp32;
    uint64_t tmp64;
 
-   if (retro_fread(fd, &tmp64, size) == -1)
+   if (reader_read(reader, &tmp64, size) == -1)
       goto error;
 
    (void)tmp8;
@@ -455,27 +624,31 @@ error:
    return -errno;
 }
 
-static int read_buff(RFILE *fd, size_t size, char **pbuff, uint64_t *len)
+static int read_buff(rmsgpack_reader_t *reader, size_t size,
+      char **pbuff, uint64_t *len)
 {
    uint64_t tmp_len = 0;
 
-   if (read_uint(fd, &tmp_len, size) == -1)
+   if (read_uint(reader, &tmp_len, size) == -1)
       return -errno;
 
-   *pbuff = (char *)calloc((size_t)(tmp_len + 1), sizeof(char));
+   *pbuff = reader_alloc(reader, (size_t)(tmp_len + 1));
+   if (!*pbuff)
+      return -ENOMEM;
 
-   if (retro_fread(fd, *pbuff, (size_t)tmp_len) == -1)
+   if (reader_read(reader, *pbuff, (size_t)tmp_len) == -1)
       goto error;
 
+   (*pbuff)[tmp_len] = '\0';
    *len = tmp_len;
    return 0;
 
 error:
-   free(*pbuff);
+   reader_release(reader, *pbuff);
    return -errno;
 }
 
-static int read_map(RFILE *fd, uint32_t len,
+static int read_map(rmsgpack_reader_t *reader, uint32_t len,
         struct rmsgpack_read_callbacks *callbacks, void *data)
 {
    int rv;
@@ -487,16 +660,16 @@ static int read_map(RFILE *fd, uint32_t len,
 
    for (i = 0; i < len; i++)
    {
-      if ((rv = rmsgpack_read(fd, callbacks, data)) < 0)
+      if ((rv = rmsgpack_reader_read(reader, callbacks, data)) < 0)
          return rv;
-      if ((rv = rmsgpack_read(fd, callbacks, data)) < 0)
+      if ((rv = rmsgpack_reader_read(reader, callbacks, data)) < 0)
          return rv;
    }
 
    return 0;
 }
 
-static int read_array(RFILE *fd, uint32_t len,
+static int read_array(rmsgpack_reader_t *reader, uint32_t len,
       struct rmsgpack_read_callbacks *callbacks, void *data)
 {
    int rv;
@@ -508,14 +681,27 @@ static int read_array(RFILE *fd, uint32_t len,
 
    for (i = 0; i < len; i++)
    {
-      if ((rv = rmsgpack_read(fd, callbacks, data)) < 0)
+      if ((rv = rmsgpack_reader_read(reader, callbacks, data)) < 0)
          return rv;
    }
 
    return 0;
 }
 
-int rmsgpack_read(RFILE *fd,
+/**
+ * rmsgpack_reader_read:
+ * @reader              : Reader.
+ * @callbacks           : Callbacks to hand the parsed value to.
+ * @data                : User data passed to @callbacks.
+ *
+ * Parses the next value from @reader. Strings and binaries are
+ * handed to @callbacks in buffers from @reader->alloc (calloc()
+ * by default) which then belong to the callback.
+ *
+ * Returns: 0 or the callback's return value on success,
+ * otherwise a negative value.
+ **/
+int rmsgpack_reader_read(rmsgpack_reader_t *reader,
       struct rmsgpack_read_callbacks *callbacks, void *data)
 {
    int rv;
@@ -525,7 +711,7 @@ int rmsgpack_read(RFILE *fd,
    uint8_t type      = 0;
    char *buff        = NULL;
 
-   if (retro_fread(fd, &type, sizeof(uint8_t)) == -1)
+   if (reader_read(reader, &type, sizeof(uint8_t)) == -1)
       goto error;
 
    if (type < MPF_FIXMAP)
@@ -537,28 +723,28 @@ int rmsgpack_read(RFILE *fd,
    else if (type < MPF_FIXARRAY)
    {
       tmp_len = type - MPF_FIXMAP;
-      return read_map(fd, (uint32_t)tmp_len, callbacks, data);
+      return read_map(reader, (uint32_t)tmp_len, callbacks, data);
    }
    else if (type < MPF_FIXSTR)
    {
       tmp_len = type - MPF_FIXARRAY;
-      return read_array(fd, (uint32_t)tmp_len, callbacks, data);
+      return read_array(reader, (uint32_t)tmp_len, callbacks, data);
    }
    else if (type < MPF_NIL)
    {
       tmp_len = type - MPF_FIXSTR;
-      buff = (char *)calloc((size_t)(tmp_len + 1), sizeof(char));
+      buff = reader_alloc(reader, (size_t)(tmp_len + 1));
       if (!buff)
          return -ENOMEM;
-      if (retro_fread(fd, buff, (ssize_t)tmp_len) == -1)
+      if (reader_read(reader, buff, (size_t)tmp_len) == -1)
       {
-         free(buff);
+         reader_release(reader, buff);
          goto error;
       }
       buff[tmp_len] = '\0';
       if (!callbacks->read_string)
       {
-         free(buff);
+         reader_release(reader, buff);
          return 0;
       }
       return callbacks->read_string(buff, (uint32_t)tmp_len, data);
@@ -587,12 +773,13 @@ int rmsgpack_read(RFILE *fd,
       case _MPF_BIN8:
       case _MPF_BIN16:
       case _MPF_BIN32:
-         if ((rv = read_buff(fd, 1<<(type - _MPF_BIN8),
+         if ((rv = read_buff(reader, 1<<(type - _MPF_BIN8),
                      &buff, &tmp_len)) < 0)
             return rv;
 
          if (callbacks->read_bin)
             return callbacks->read_bin(buff, (uint32_t)tmp_len, data);
+         reader_release(reader, buff);
          break;
       case _MPF_UINT8:
       case _MPF_UINT16:
@@ -600,7 +787,7 @@ int rmsgpack_read(RFILE *fd,
       case _MPF_UINT64:
          tmp_len  = UINT32_C(1) << (type - _MPF_UINT8);
          tmp_uint = 0;
-         if (read_uint(fd, &tmp_uint, (size_t)tmp_len) == -1)
+         if (read_uint(reader, &tmp_uint, (size_t)tmp_len) == -1)
             goto error;
 
          if (callbacks->read_uint)
@@ -612,7 +799,7 @@ int rmsgpack_read(RFILE *fd,
       case _MPF_INT64:
          tmp_len = UINT32_C(1) << (type - _MPF_INT8);
          tmp_int = 0;
-         if (read_int(fd, &tmp_int, (size_t)tmp_len) == -1)
+         if (read_int(reader, &tmp_int, (size_t)tmp_len) == -1)
             goto error;
 
          if (callbacks->read_int)
@@ -621,22 +808,24 @@ int rmsgpack_read(RFILE *fd,
       case _MPF_STR8:
       case _MPF_STR16:
       case _MPF_STR32:
-         if ((rv = read_buff(fd, 1<<(type - _MPF_STR8), &buff, &tmp_len)) < 0)
+         if ((rv = read_buff(reader, 1<<(type - _MPF_STR8),
+                     &buff, &tmp_len)) < 0)
             return rv;
 
          if (callbacks->read_string)
             return callbacks->read_string(buff, (uint32_t)tmp_len, data);
+         reader_release(reader, buff);
          break;
       case _MPF_ARRAY16:
       case _MPF_ARRAY32:
-         if (read_uint(fd, &tmp_len, 2<<(type - _MPF_ARRAY16)) == -1)
+         if (read_uint(reader, &tmp_len, 2<<(type - _MPF_ARRAY16)) == -1)
             goto error;
-         return read_array(fd, (uint32_t)tmp_len, callbacks, data);
+         return read_array(reader, (uint32_t)tmp_len, callbacks, data);
       case _MPF_MAP16:
       case _MPF_MAP32:
-         if (read_uint(fd, &tmp_len, 2<<(type - _MPF_MAP16)) == -1)
+         if (read_uint(reader, &tmp_len, 2<<(type - _MPF_MAP16)) == -1)
             goto error;
-         return read_map(fd, (uint32_t)tmp_len, callbacks, data);
+         return read_map(reader, (uint32_t)tmp_len, callbacks, data);
    }
 
    return 0;
@@ -644,3 +833,12 @@ int rmsgpack_read(RFILE *fd,
 error:
    return -errno;
 }
+
+int rmsgpack_read(RFILE *fd,
+      struct rmsgpack_read_callbacks *callbacks, void *data)
+{
+   rmsgpack_reader_t reader;
+
+   rmsgpack_reader_init(&reader, fd, 0);
+   return rmsgpack_reader_read(&reader, callbacks, data);
+}
@@ -2,6 +2,7 @@
 #define __RARCHDB_MSGPACK_H__
 
 #include <stdint.h>
+#include <stddef.h>
 
 #include <retro_file.h>
 
@@ -35,5 +36,33 @@ int rmsgpack_write_uint(RFILE *fd, uint64_t value );
 
 int rmsgpack_read(RFILE *fd, struct rmsgpack_read_callbacks *callbacks, void *data);
 
+/* Reads values through a buffer instead of one retro_fread()
+ * per field. */
+typedef struct rmsgpack_reader
+{
+   RFILE *fd;
+   uint8_t *buff;
+   size_t size;
+   size_t len;
+   size_t pos;
+   /* File offset of buff[0]. */
+   uint64_t offset;
+   /* Allocator for strings and binaries, calloc() when NULL.
+    * Memory must come back zeroed. */
+   void *(*alloc)(void *data, size_t size);
+   void *alloc_data;
+} rmsgpack_reader_t;
+
+int rmsgpack_reader_init(rmsgpack_reader_t *reader, RFILE *fd, size_t size);
+
+void rmsgpack_reader_deinit(rmsgpack_reader_t *reader);
+
+int rmsgpack_reader_seek(rmsgpack_reader_t *reader, uint64_t offset);
+
+uint64_t rmsgpack_reader_tell(rmsgpack_reader_t *reader);
+
+int rmsgpack_reader_read(rmsgpack_reader_t *reader,
+      struct rmsgpack_read_callbacks *callbacks, void *data);
+
 #endif
 
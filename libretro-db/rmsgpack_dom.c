@@ -11,12 +11,173 @@
 
 #define MAX_DEPTH 128
 
+/* Chained blocks handed out front to back. */
+struct rmsgpack_dom_arena_block
+{
+   struct rmsgpack_dom_arena_block *next;
+   size_t size;
+   size_t used;
+};
+
+struct rmsgpack_dom_arena
+{
+   struct rmsgpack_dom_arena_block *head;
+   size_t block_size;
+};
+
+#define DOM_ARENA_ALIGN(x) (((x) + 7) & ~(size_t)7)
+#define DOM_ARENA_HEADER   DOM_ARENA_ALIGN(sizeof(struct rmsgpack_dom_arena_block))
+
 struct dom_reader_state
 {
 	int i;
 	struct rmsgpack_dom_value *stack[MAX_DEPTH];
+   struct rmsgpack_dom_arena *arena;
 };
 
+static struct rmsgpack_dom_arena_block *rmsgpack_dom_arena_block_new(
+      size_t size)
+{
+   struct rmsgpack_dom_arena_block *block =
+      (struct rmsgpack_dom_arena_block*)malloc(DOM_ARENA_HEADER + size);
+
+   if (!block)
+      return NULL;
+
+   block->next = NULL;
+   block->size = size;
+   block->used = 0;
+   return block;
+}
+
+/**
+ * rmsgpack_dom_arena_new:
+ * @block_size          : Size of the first block, in bytes.
+ *
+ * Creates an arena that values can be read into with
+ * rmsgpack_dom_reader_read(), to be released all at once with
+ * rmsgpack_dom_arena_reset().
+ *
+ * Returns: new arena, or NULL on error.
+ **/
+struct rmsgpack_dom_arena *rmsgpack_dom_arena_new(size_t block_size)
+{
+   struct rmsgpack_dom_arena *arena = (struct rmsgpack_dom_arena*)
+      calloc(1, sizeof(*arena));
+
+   if (!arena)
+      return NULL;
+
+   arena->block_size = DOM_ARENA_ALIGN(block_size ? block_size : 4096);
+   arena->head       = rmsgpack_dom_arena_block_new(arena->block_size);
+
+   if (!arena->head)
+   {
+      free(arena);
+      return NULL;
+   }
+
+   return arena;
+}
+
+static void *rmsgpack_dom_arena_alloc(void *data, size_t size)
+{
+   struct rmsgpack_dom_arena *arena       = (struct rmsgpack_dom_arena*)data;
+   struct rmsgpack_dom_arena_block *block = arena->head;
+   uint8_t *ptr                           = NULL;
+
+   /* Aligning or adding the block header must not wrap. */
+   if (size > SIZE_MAX - DOM_ARENA_HEADER - 7)
+      return NULL;
+
+   size = DOM_ARENA_ALIGN(size);
+
+   if (size > block->size - block->used)
+   {
+      block = rmsgpack_dom_arena_block_new(
+            size > arena->block_size ? size : arena->block_size);
+      if (!block)
+         return NULL;
+      block->next = arena->head;
+      arena->head = block;
+   }
+
+   ptr          = (uint8_t*)block + DOM_ARENA_HEADER + block->used;
+   block->used += size;
+
+   memset(ptr, 0, size);
+   return ptr;
+}
+
+/**
+ * rmsgpack_dom_arena_reset:
+ * @arena               : Arena.
+ *
+ * Releases every value read into @arena. If the last values
+ * did not fit in one block, the blocks are merged so the next
+ * values of the same size need no allocation at all.
+ **/
+void rmsgpack_dom_arena_reset(struct rmsgpack_dom_arena *arena)
+{
+   struct rmsgpack_dom_arena_block *block  = arena->head;
+   struct rmsgpack_dom_arena_block *merged = NULL;
+   size_t size                             = 0;
+
+   if (!block->next)
+   {
+      block->used = 0;
+      return;
+   }
+
+   for (; block; block = block->next)
+      size += block->size;
+
+   if (!(merged = rmsgpack_dom_arena_block_new(size)))
+   {
+      /* Keep the newest block and drop the rest. */
+      block             = arena->head->next;
+      arena->head->next = NULL;
+      arena->head->used = 0;
+   }
+   else
+   {
+      block             = arena->head;
+      arena->head       = merged;
+      arena->block_size = size;
+   }
+
+   while (block)
+   {
+      struct rmsgpack_dom_arena_block *next = block->next;
+      free(block);
+      block = next;
+   }
+}
+
+/**
+ * rmsgpack_dom_arena_free:
+ * @arena               : Arena.
+ *
+ * Frees @arena and every value read into it.
+ **/
+void rmsgpack_dom_arena_free(struct rmsgpack_dom_arena *arena)
+{
+   struct rmsgpack_dom_arena_block *block;
+
+   if (!arena)
+      return;
+
+   block = arena->head;
+   while (block)
+   {
+      struct rmsgpack_dom_arena_block *next = block->next;
+      free(block);
+      block = next;
+   }
+
+   free(arena);
+}
+
 static struct rmsgpack_dom_value *dom_reader_state_pop(struct dom_reader_state *s)
 {
 	struct rmsgpack_dom_value *v = s->stack[s->i];
@@ -107,16 +268,24 @@ static int dom_read_map_start(uint32_t len, void *data)
    struct rmsgpack_dom_value *v = dom_reader_state_pop(dom_state);
 
    v->type = RDT_MAP;
-   v->val.map.len = len;
+   v->val.map.len = 0;
    v->val.map.items = NULL;
 
-   items = (struct rmsgpack_dom_pair *)calloc(len,
-         sizeof(struct rmsgpack_dom_pair));
+   if (len > SIZE_MAX / sizeof(struct rmsgpack_dom_pair))
+      return -ENOMEM;
+
+   if (dom_state->arena)
+      items = (struct rmsgpack_dom_pair *)rmsgpack_dom_arena_alloc(
+            dom_state->arena, len * sizeof(struct rmsgpack_dom_pair));
+   else
+      items = (struct rmsgpack_dom_pair *)calloc(len,
+            sizeof(struct rmsgpack_dom_pair));
 
    if (!items)
       return -ENOMEM;
 
    v->val.map.items = items;
+   v->val.map.len   = len;
 
    for (i = 0; i < len; i++)
    {
@@ -137,15 +306,24 @@ static int dom_read_array_start(uint32_t len, void *data)
 	struct rmsgpack_dom_value *items   = NULL;
 
 	v->type = RDT_ARRAY;
-	v->val.array.len = len;
+	v->val.array.len = 0;
 	v->val.array.items = NULL;
 
-	items = (struct rmsgpack_dom_value *)calloc(len, sizeof(struct rmsgpack_dom_pair));
+   if (len > SIZE_MAX / sizeof(struct rmsgpack_dom_value))
+      return -ENOMEM;
+
+   if (dom_state->arena)
+      items = (struct rmsgpack_dom_value *)rmsgpack_dom_arena_alloc(
+            dom_state->arena, len * sizeof(struct rmsgpack_dom_value));
+   else
+      items = (struct rmsgpack_dom_value *)calloc(len,
+            sizeof(struct rmsgpack_dom_pair));
 
 	if (!items)
 		return -ENOMEM;
 
 	v->val.array.items = items;
+	v->val.array.len   = len;
 
 	for (i = 0; i < len; i++)
    {
@@ -395,6 +573,7 @@ int rmsgpack_dom_read(RFILE *fd, struct rmsgpack_dom_value *out)
 
    s.i        = 0;
    s.stack[0] = out;
+   s.arena    = NULL;
 
    rv = rmsgpack_read(fd, &dom_reader_callbacks, &s);
 
@@ -404,6 +583,51 @@ int rmsgpack_dom_read(RFILE *fd, struct rmsgpack_dom_value *out)
    return rv;
 }
 
+/**
+ * rmsgpack_dom_reader_read:
+ * @reader              : Reader to parse from.
+ * @arena               : Arena to put @out in, or NULL.
+ * @out                 : Value read.
+ *
+ * Like rmsgpack_dom_read(), but reads through @reader. With an
+ * @arena, strings, binaries, maps and arrays of @out are carved
+ * out of it instead of being allocated one by one; @out must then
+ * not be passed to rmsgpack_dom_value_free() and stays valid until
+ * @arena is reset or freed.
+ *
+ * Returns: 0 on success, otherwise a negative value.
+ **/
+int rmsgpack_dom_reader_read(rmsgpack_reader_t *reader,
+      struct rmsgpack_dom_arena *arena, struct rmsgpack_dom_value *out)
+{
+   struct dom_reader_state s;
+   int rv = 0;
+
+   s.i        = 0;
+   s.stack[0] = out;
+   s.arena    = arena;
+
+   if (arena)
+   {
+      reader->alloc      = rmsgpack_dom_arena_alloc;
+      reader->alloc_data = arena;
+   }
+
+   rv = rmsgpack_reader_read(reader, &dom_reader_callbacks, &s);
+
+   reader->alloc      = NULL;
+   reader->alloc_data = NULL;
+
+   if (rv < 0)
+   {
+      if (!arena)
+         rmsgpack_dom_value_free(out);
+      out->type = RDT_NULL;
+   }
+
+   return rv;
+}
+
 int rmsgpack_dom_read_into(RFILE *fd, ...)
 {
    va_list ap;
@@ -5,6 +5,8 @@
 
 #include <retro_file.h>
 
+#include "rmsgpack.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -52,6 +54,8 @@ struct rmsgpack_dom_value
    } val;
 };
 
+struct rmsgpack_dom_arena;
+
 struct rmsgpack_dom_pair
 {
 	struct rmsgpack_dom_value key;
@@ -70,6 +74,15 @@ struct rmsgpack_dom_value *rmsgpack_dom_value_map_value(
 
 int rmsgpack_dom_read(RFILE *fd, struct rmsgpack_dom_value *out);
 
+struct rmsgpack_dom_arena *rmsgpack_dom_arena_new(size_t block_size);
+
+void rmsgpack_dom_arena_reset(struct rmsgpack_dom_arena *arena);
+
+void rmsgpack_dom_arena_free(struct rmsgpack_dom_arena *arena);
+
+int rmsgpack_dom_reader_read(rmsgpack_reader_t *reader,
+      struct rmsgpack_dom_arena *arena, struct rmsgpack_dom_value *out);
+
 int rmsgpack_dom_write(RFILE *fd, const struct rmsgpack_dom_value *obj);
 
 int rmsgpack_dom_read_into(RFILE *fd, ...);
@@ -66,12 +66,16 @@ static void video_frame(const void *data, unsigned width,
    if (!driver->video_active)
       return;
 
-   if (video_pixel_frame_scale(data, width, height, pitch))
+   /* Frames rendered into the buffer from
+    * RETRO_ENVIRONMENT_GET_CURRENT_SOFTWARE_FRAMEBUFFER are
+    * already in the driver's format, pass them on as they are. */
+   if (!video_driver_is_software_framebuffer(data)
+         && video_pixel_frame_scale(data, width, height, pitch))
    {
       video_pixel_scaler_t *scaler = scaler_get_ptr();
 
       data                        = scaler->scaler_out;
-      pitch                       = scaler->scaler->out_stride;
+      pitch                       = scaler->out_stride;
    }
 
    video_driver_cached_frame_set(data, width, height, pitch);
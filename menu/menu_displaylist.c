@@ -258,7 +258,7 @@ static int menu_displaylist_parse_core_info(menu_displaylist_info_t *info)
    global_t *global          = global_get_ptr();
    core_info_t *core_info    = global ? (core_info_t*)global->core_info.current : NULL;
 
-   if (!core_info || !core_info->data)
+   if (!core_info || !core_info->has_info)
    {
       menu_list_push(info->list,
             menu_hash_to_str(MENU_LABEL_VALUE_NO_CORE_INFORMATION_AVAILABLE),
@@ -1196,7 +1196,7 @@ static int menu_displaylist_parse_database_entry(menu_displaylist_info_t *info)
 
    database_info_build_query(query, sizeof(query), "displaylist_parse_database_entry", info->path_b);
 
-   if (!(db_info = database_info_list_new(info->path, query)))
+   if (!(db_info = database_info_list_new(info->path, query, NULL)))
       goto error;
 
    fill_short_pathname_representation(path_base, info->path,
@@ -1524,7 +1524,8 @@ static int menu_database_parse_query(file_list_t *list, const char *path,
 {
 #ifdef HAVE_LIBRETRODB
    unsigned i;
-   database_info_list_t *db_list = database_info_list_new(path, query);
+   static const char *fields[]   = { "name", NULL };
+   database_info_list_t *db_list = database_info_list_new(path, query, fields);
 
    if (!db_list)
       return -1;
@@ -78,7 +78,7 @@ static uint64_t bps_decode(struct bps_data *bps)
 
 static void bps_write(struct bps_data *bps, uint8_t data)
 {
-   if (!bps)
+   if (!bps || bps->output_offset >= bps->target_length)
       return;
 
    bps->target_data[bps->output_offset++] = data;
@@ -368,10 +368,12 @@ patch_error_t ups_apply_patch(
    return PATCH_SOURCE_INVALID;
 }
 
-patch_error_t ips_apply_patch(
+/* Applies the records of an IPS patch to @targetdata, which holds
+ * @targetcap bytes. With a NULL @targetdata nothing is written,
+ * only the size the patched content ends up at is worked out. */
+static patch_error_t ips_apply_records(
       const uint8_t *patchdata, size_t patchlen,
-      const uint8_t *sourcedata, size_t sourcelength,
-      uint8_t *targetdata, size_t *targetlength)
+      uint8_t *targetdata, size_t targetcap, size_t *targetlength)
 {
    uint32_t offset = 5;
 
@@ -383,10 +385,6 @@ patch_error_t ips_apply_patch(
          patchdata[4] != 'H')
       return PATCH_PATCH_INVALID;
 
-   memcpy(targetdata, sourcedata, sourcelength);
-
-   *targetlength = sourcelength;
-
    for (;;)
    {
       uint32_t address;
@@ -424,8 +422,15 @@ patch_error_t ips_apply_patch(
          if (offset > patchlen - length)
             break;
 
-         while (length--)
-            targetdata[address++] = patchdata[offset++];
+         if (targetdata)
+         {
+            if (address + length > targetcap)
+               return PATCH_TARGET_TOO_SMALL;
+            memcpy(targetdata + address, patchdata + offset, length);
+         }
+
+         address += length;
+         offset  += length;
       }
       else /* RLE */
       {
@@ -438,9 +443,14 @@ patch_error_t ips_apply_patch(
          if (length == 0) /* Illegal */
             break;
 
-         while (length--)
-            targetdata[address++] = patchdata[offset];
+         if (targetdata)
+         {
+            if (address + length > targetcap)
+               return PATCH_TARGET_TOO_SMALL;
+            memset(targetdata + address, patchdata[offset], length);
+         }
 
+         address += length;
          offset++;
       }
 
@@ -451,9 +461,76 @@ patch_error_t ips_apply_patch(
    return PATCH_PATCH_INVALID;
 }
 
+patch_error_t ips_apply_patch(
+      const uint8_t *patchdata, size_t patchlen,
+      const uint8_t *sourcedata, size_t sourcelength,
+      uint8_t *targetdata, size_t *targetlength)
+{
+   size_t targetcap = *targetlength;
+
+   if (targetcap < sourcelength)
+      return PATCH_TARGET_TOO_SMALL;
+
+   memcpy(targetdata, sourcedata, sourcelength);
+
+   *targetlength = sourcelength;
+
+   return ips_apply_records(patchdata, patchlen,
+         targetdata, targetcap, targetlength);
+}
+
+/* Reads one of the variable-length numbers of BPS and UPS headers. */
+static uint64_t patch_header_decode(const uint8_t *data, size_t len,
+      size_t *offset)
+{
+   uint64_t value = 0, shift = 1;
+
+   while (*offset < len)
+   {
+      uint8_t x = data[(*offset)++];
+      value    += (x & 0x7f) * shift;
+      if (x & 0x80)
+         break;
+      shift <<= 7;
+      value += shift;
+   }
+
+   return value;
+}
+
+static size_t bps_get_target_size(const uint8_t *patchdata,
+      size_t patchlen, size_t sourcelength)
+{
+   size_t offset = 4;
+
+   if (patchlen < 19 || memcmp(patchdata, "BPS1", 4))
+      return 0;
+
+   patch_header_decode(patchdata, patchlen, &offset);
+   return (size_t)patch_header_decode(patchdata, patchlen, &offset);
+}
+
+static size_t ups_get_target_size(const uint8_t *patchdata,
+      size_t patchlen, size_t sourcelength)
+{
+   size_t offset = 4;
+   uint64_t source_size, target_size;
+
+   if (patchlen < 18 || memcmp(patchdata, "UPS1", 4))
+      return 0;
+
+   /* UPS patches apply both ways, the content could be either side. */
+   source_size = patch_header_decode(patchdata, patchlen, &offset);
+   target_size = patch_header_decode(patchdata, patchlen, &offset);
+
+   return (size_t)(sourcelength == source_size ? target_size : source_size);
+}
+
+typedef size_t (*patch_size_func_t)(const uint8_t*, size_t, size_t);
+
 static bool apply_patch_content(uint8_t **buf,
       ssize_t *size, const char *patch_desc, const char *patch_path,
-      patch_func_t func)
+      patch_func_t func, patch_size_func_t size_func)
 {
    size_t target_size;
    ssize_t patch_size;
@@ -475,7 +552,16 @@ static bool apply_patch_content(uint8_t **buf,
    RARCH_LOG("Found %s file in \"%s\", attempting to patch ...\n",
          patch_desc, patch_path);
 
-   target_size = ret_size * 4; /* Just to be sure. */
+   /* The header tells how large the patched content is. */
+   target_size = size_func((const uint8_t*)patch_data, patch_size, ret_size);
+
+   if (!target_size)
+   {
+      RARCH_ERR("Failed to patch %s: Error #%u\n", patch_desc,
+            (unsigned)PATCH_PATCH_INVALID_HEADER);
+      free(patch_data);
+      return true;
+   }
 
    patched_content = (uint8_t*)malloc(target_size);
 
@@ -503,6 +589,8 @@ static bool apply_patch_content(uint8_t **buf,
       *buf = patched_content;
       *size = target_size;
    }
+   else
+      free(patched_content);
 
    free(patch_data);
    return true;
@@ -515,6 +603,70 @@ error:
    return false;
 }
 
+/* IPS patches only overwrite ranges of the content, so they are
+ * applied in place, growing the buffer if the patch extends it. */
+static bool apply_ips_patch_content(uint8_t **buf,
+      ssize_t *size, const char *patch_path)
+{
+   ssize_t patch_size;
+   void *patch_data   = NULL;
+   patch_error_t err  = PATCH_UNKNOWN;
+   size_t target_size = *size;
+   size_t cap         = *size;
+   uint8_t *ret_buf   = *buf;
+
+   if (!read_file(patch_path, &patch_data, &patch_size))
+      return false;
+   if (patch_size < 0)
+      return false;
+
+   if (!path_file_exists(patch_path))
+      return false;
+
+   RARCH_LOG("Found %s file in \"%s\", attempting to patch ...\n",
+         "IPS", patch_path);
+
+   /* Dry run first, a broken patch must leave the content as is. */
+   err = ips_apply_records((const uint8_t*)patch_data, patch_size,
+         NULL, 0, &target_size);
+
+   if (err == PATCH_SUCCESS && target_size > cap)
+   {
+      uint8_t *new_buf = (uint8_t*)realloc(ret_buf, target_size + 1);
+
+      if (!new_buf)
+      {
+         RARCH_ERR("Failed to allocate memory for patched content ...\n");
+         free(patch_data);
+         return false;
+      }
+
+      memset(new_buf + cap, 0, target_size + 1 - cap);
+      ret_buf = new_buf;
+      cap     = target_size;
+      *buf    = ret_buf;
+   }
+
+   if (err == PATCH_SUCCESS)
+   {
+      target_size = *size;
+      err = ips_apply_records((const uint8_t*)patch_data, patch_size,
+            ret_buf, cap, &target_size);
+   }
+
+   if (err == PATCH_SUCCESS)
+   {
+      RARCH_LOG("Content patched successfully (%s).\n", "IPS");
+      *size = target_size;
+   }
+   else
+      RARCH_ERR("Failed to patch %s: Error #%u\n", "IPS",
+            (unsigned)err);
+
+   free(patch_data);
+   return true;
+}
+
 static bool try_bps_patch(uint8_t **buf, ssize_t *size)
 {
    global_t *global = global_get_ptr();
@@ -526,7 +678,7 @@ static bool try_bps_patch(uint8_t **buf, ssize_t *size)
       return false;
 
    return apply_patch_content(buf, size, "BPS", global->name.bps,
-         bps_apply_patch);
+         bps_apply_patch, bps_get_target_size);
 }
 
 static bool try_ups_patch(uint8_t **buf, ssize_t *size)
@@ -540,7 +692,7 @@ static bool try_ups_patch(uint8_t **buf, ssize_t *size)
       return false;
 
    return apply_patch_content(buf, size, "UPS", global->name.ups,
-         ups_apply_patch);
+         ups_apply_patch, ups_get_target_size);
 }
 
 static bool try_ips_patch(uint8_t **buf, ssize_t *size)
@@ -553,8 +705,7 @@ static bool try_ips_patch(uint8_t **buf, ssize_t *size)
    if (global->name.ips[0] == '\0')
       return false;
 
-   return apply_patch_content(buf, size, "IPS", global->name.ips,
-         ips_apply_patch);
+   return apply_ips_patch_content(buf, size, global->name.ips);
 }
 
 /**
@@ -580,3 +731,37 @@ void patch_content(uint8_t **buf, ssize_t *size)
       RARCH_LOG("Did not find a valid content patch.\n");
    }
 }
+
+/**
+ * patch_content_pending:
+ *
+ * Checks whether patch_content() has a patch file to try. Content
+ * that is going to be patched needs to be read into a buffer
+ * allocated with malloc().
+ *
+ * Returns: true if a patch file exists, otherwise false.
+ **/
+bool patch_content_pending(void)
+{
+   global_t *global = global_get_ptr();
+
+   if (global->patch.block_patch)
+      return false;
+   if (global->patch.ips_pref + global->patch.bps_pref + global->patch.ups_pref > 1)
+      return false;
+
+   if (!global->patch.ups_pref && !global->patch.bps_pref
+         && global->name.ips[0] != '\0'
+         && path_file_exists(global->name.ips))
+      return true;
+   if (!global->patch.ups_pref && !global->patch.ips_pref
+         && global->name.bps[0] != '\0'
+         && path_file_exists(global->name.bps))
+      return true;
+   if (!global->patch.bps_pref && !global->patch.ips_pref
+         && global->name.ups[0] != '\0'
+         && path_file_exists(global->name.ups))
+      return true;
+
+   return false;
+}
@@ -20,6 +20,8 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#include <boolean.h>
+
 /* BPS/UPS/IPS implementation from bSNES (nall::).
  * Modified for RetroArch. */
 
@@ -68,4 +70,15 @@ patch_error_t ips_apply_patch(
  **/
 void patch_content(uint8_t **buf, ssize_t *size);
 
+/**
+ * patch_content_pending:
+ *
+ * Checks whether patch_content() has a patch file to try. Content
+ * that is going to be patched needs to be read into a buffer
+ * allocated with malloc().
+ *
+ * Returns: true if a patch file exists, otherwise false.
+ **/
+bool patch_content_pending(void);
+
 #endif
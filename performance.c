@@ -430,7 +430,7 @@ uint64_t retro_get_cpu_features(void)
    const int avx_flags = (1 << 27) | (1 << 28);
 #endif
 
-   char buf[sizeof(" MMX MMXEXT SSE SSE2 SSE3 SSSE3 SS4 SSE4.2 AES AVX AVX2 NEON VMX VMX128 VFPU PS")];
+   char buf[sizeof(" MMX MMXEXT SSE SSE2 SSE3 SSSE3 SS4 SSE4.2 AES AVX AVX2 FMA NEON VFPv3 VFPv4 VMX VMX128 VFPU PS")];
 
    memset(buf, 0, sizeof(buf));
 
@@ -492,7 +492,13 @@ uint64_t retro_get_cpu_features(void)
          && ((xgetbv_x86(0) & 0x6) == 0x6))
       cpu |= RETRO_SIMD_AVX;
 
-   if (max_flag >= 7)
+   /* FMA3 works on YMM registers, so it needs AVX state too. */
+   if ((cpu & RETRO_SIMD_AVX) && (flags[2] & (1 << 12)))
+      cpu |= RETRO_SIMD_FMA;
+
+   /* AVX2 needs the same OS support for YMM state as AVX,
+    * which the xgetbv check above has already established. */
+   if ((cpu & RETRO_SIMD_AVX) && max_flag >= 7)
    {
       x86_cpuid(7, flags);
       if (flags[1] & (1 << 5))
@@ -519,6 +525,9 @@ uint64_t retro_get_cpu_features(void)
       cpu |= RETRO_SIMD_NEON;
       arm_enable_runfast_mode();
    }
+#elif defined(__aarch64__)
+   /* AArch64 lists NEON as "asimd", but always has it. */
+   cpu |= RETRO_SIMD_NEON;
 #endif
    if (cpu_flags & CPU_ARM_FEATURE_VFPv3)
       cpu |= RETRO_SIMD_VFPV3;
@@ -547,6 +556,7 @@ uint64_t retro_get_cpu_features(void)
    if (cpu & RETRO_SIMD_AES)    strlcat(buf, " AES", sizeof(buf));
    if (cpu & RETRO_SIMD_AVX)    strlcat(buf, " AVX", sizeof(buf));
    if (cpu & RETRO_SIMD_AVX2)   strlcat(buf, " AVX2", sizeof(buf));
+   if (cpu & RETRO_SIMD_FMA)    strlcat(buf, " FMA", sizeof(buf));
    if (cpu & RETRO_SIMD_NEON)   strlcat(buf, " NEON", sizeof(buf));
    if (cpu & RETRO_SIMD_VFPV3)  strlcat(buf, " VFPv3", sizeof(buf));
    if (cpu & RETRO_SIMD_VFPV4)  strlcat(buf, " VFPv4", sizeof(buf));
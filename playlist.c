@@ -220,7 +220,7 @@ void content_playlist_push(content_playlist_t *playlist,
    }
 
    memmove(playlist->entries + 1, playlist->entries,
-         (playlist->cap - 1) * sizeof(content_playlist_entry_t));
+         playlist->size * sizeof(content_playlist_entry_t));
 
    playlist->entries[0].path      = path ? strdup(path) : NULL;
    playlist->entries[0].label     = label ? strdup(label) : NULL;
@@ -55,11 +55,13 @@ extern "C" {
 
 #include <boolean.h>
 #include <queues/fifo_buffer.h>
+#include <queues/spsc_queue.h>
 #include <rthreads/rthreads.h>
 #include <gfx/scaler/scaler.h>
 #include <file/config_file.h>
 
 #include "../../general.h"
+#include "../../performance.h"
 #include "../../audio/audio_utils.h"
 #include "../record_driver.h"
 
@@ -68,13 +70,20 @@ extern "C" {
 #define av_frame_free avcodec_free_frame
 #endif
 
+/* Scaled frames in flight between the scale and video encode stages. */
+#define MAX_CONV_FRAMES 4
+/* Encoded packets in flight to the mux stage, per stream. */
+#define MAX_PACKETS 64
+
 struct ff_video_info
 {
    AVCodecContext *codec;
    AVCodec *encoder;
 
-   AVFrame *conv_frame;
-   uint8_t *conv_frame_buf;
+   AVFrame *conv_frames[MAX_CONV_FRAMES];
+   uint8_t *conv_frame_bufs[MAX_CONV_FRAMES];
+   /* Last frame the scale stage produced. Dupes are copied from it. */
+   AVFrame *last_frame;
    int64_t frame_cnt;
 
    uint8_t *outbuf;
@@ -94,6 +103,8 @@ struct ff_video_info
    AVFormatContext *format;
 
    struct scaler_ctx scaler;
+   /* Runs the in-house scaler on the recording thread's behalf. */
+   thread_pool_t *scaler_pool;
    struct SwsContext *sws;
    bool use_sws;
 };
@@ -169,6 +180,34 @@ struct ff_config_param
    AVDictionary *audio_opts;
 };
 
+/* A pre-allocated frame buffer, handed from the emulator thread
+ * to the encoder thread and back again. */
+struct ff_video_slot
+{
+   struct ffemu_video_data attr;
+   uint8_t *buf;
+};
+
+/* Backpressure seen by the emulator thread.
+ * Only ever touched by the producer side. */
+struct ff_queue_stats
+{
+   unsigned frames;
+   unsigned stalls;
+   unsigned max_depth;
+   retro_time_t stall_usec;
+};
+
+/* One stage of the recording pipeline. Each stage sleeps on its own
+ * condition variable under ffmpeg_t::cond_lock, and is woken both when
+ * input arrives and when room frees up further down the pipeline. */
+struct ff_stage
+{
+   sthread_t *thread;
+   scond_t *cond;
+   volatile bool alive;
+};
+
 typedef struct ffmpeg
 {
    struct ff_video_info video;
@@ -178,16 +217,34 @@ typedef struct ffmpeg
    
    struct ffemu_params params;
 
-   scond_t *cond;
+   /* Wakes the emulator thread waiting for room to queue into. */
+   scond_t *space_cond;
    slock_t *cond_lock;
    slock_t *lock;
    fifo_buffer_t *audio_fifo;
-   fifo_buffer_t *video_fifo;
-   fifo_buffer_t *attr_fifo;
-   sthread_t *thread;
+
+   /* Frame slots travel emulator -> scale through video_queue
+    * and back through free_queue, neither of which takes a lock. */
+   struct ff_video_slot *video_slots;
+   spsc_queue_t *video_queue;
+   spsc_queue_t *free_queue;
+   /* Scaled frames travel scale -> video encode through conv_queue
+    * and back through conv_free. */
+   spsc_queue_t *conv_queue;
+   spsc_queue_t *conv_free;
+   /* Encoded packets on their way to the mux stage. */
+   spsc_queue_t *video_pkts;
+   spsc_queue_t *audio_pkts;
+   struct ff_queue_stats stats;
+
+   struct ff_stage scale;
+   struct ff_stage venc;
+   struct ff_stage aenc;
+   struct ff_stage mux;
+   /* One codec frame of audio, owned by the audio stage. */
+   void *aenc_buf;
 
    volatile bool alive;
-   volatile bool can_sleep;
 } ffmpeg_t;
 
 static bool ffmpeg_codec_has_sample_format(enum AVSampleFormat fmt,
@@ -311,6 +368,7 @@ static bool ffmpeg_init_audio(ffmpeg_t *handle)
       rarch_resampler_realloc(&audio->resampler_data,
             &audio->resampler,
             settings->audio.resampler,
+            (enum resampler_quality)settings->audio.resampler_quality,
             audio->ratio);
    }
    else
@@ -362,7 +420,10 @@ static bool ffmpeg_init_audio(ffmpeg_t *handle)
 
 static bool ffmpeg_init_video(ffmpeg_t *handle)
 {
+   unsigned i;
    size_t size;
+   unsigned scaler_threads        = 0;
+   unsigned cores                 = retro_get_cpu_cores();
    struct ff_config_param *params = &handle->config;
    struct ff_video_info *video    = &handle->video;
    struct ffemu_params *param     = &handle->params;
@@ -443,6 +504,17 @@ static bool ffmpeg_init_video(ffmpeg_t *handle)
          return false;
    }
 
+   /* With a thread count of 0, libavcodec already runs a thread per
+    * core, so only scale in parallel on the cores it leaves idle. */
+   if (params->threads && params->threads < cores)
+      scaler_threads = cores - params->threads;
+
+   if (!video->use_sws && scaler_threads > 1)
+   {
+      video->scaler_pool = thread_pool_new(scaler_threads);
+      video->scaler.pool = video->scaler_pool;
+   }
+
    video->codec = avcodec_alloc_context3(codec);
 
    /* Useful to set scale_factor to 2 for chroma subsampled formats to
@@ -460,7 +532,10 @@ static bool ffmpeg_init_video(ffmpeg_t *handle)
          param->aspect_ratio * param->out_height / param->out_width, 255);
    video->codec->pix_fmt             = video->pix_fmt;
 
+   /* A thread count of 0 lets libavcodec pick one per core. Allow
+    * both frame and slice threading; the codec uses what it supports. */
    video->codec->thread_count = params->threads;
+   video->codec->thread_type  = FF_THREAD_FRAME | FF_THREAD_SLICE;
 
    if (params->video_qscale)
    {
@@ -481,15 +556,32 @@ static bool ffmpeg_init_video(ffmpeg_t *handle)
     * clues how big this buffer should be. */
    video->outbuf_size = 1 << 23;
    video->outbuf = (uint8_t*)av_malloc(video->outbuf_size);
+   if (!video->outbuf)
+      return false;
 
    video->frame_drop_ratio = params->frame_drop_ratio;
 
    size = avpicture_get_size(video->pix_fmt, param->out_width,
          param->out_height);
-   video->conv_frame_buf = (uint8_t*)av_malloc(size);
-   video->conv_frame = av_frame_alloc();
-   avpicture_fill((AVPicture*)video->conv_frame, video->conv_frame_buf,
-         video->pix_fmt, param->out_width, param->out_height);
+
+   for (i = 0; i < MAX_CONV_FRAMES; i++)
+   {
+      video->conv_frame_bufs[i] = (uint8_t*)av_malloc(size);
+      video->conv_frames[i]     = av_frame_alloc();
+
+      if (!video->conv_frame_bufs[i] || !video->conv_frames[i])
+         return false;
+
+      avpicture_fill((AVPicture*)video->conv_frames[i],
+            video->conv_frame_bufs[i],
+            video->pix_fmt, param->out_width, param->out_height);
+
+      /* Frame threaded encoders take their own copy of the frame,
+       * which needs to know what it is copying. */
+      video->conv_frames[i]->format = video->pix_fmt;
+      video->conv_frames[i]->width  = param->out_width;
+      video->conv_frames[i]->height = param->out_height;
+   }
 
    return true;
 }
@@ -502,7 +594,7 @@ static bool ffmpeg_init_config(struct ff_config_param *params,
 
    params->out_pix_fmt = PIX_FMT_NONE;
    params->scale_factor = 1;
-   params->threads = 1;
+   params->threads = 0;
    params->frame_drop_ratio = 1;
 
    if (!config)
@@ -621,48 +713,166 @@ static bool ffmpeg_init_muxer_post(ffmpeg_t *handle)
 
 #define MAX_FRAMES 32
 
-static void ffmpeg_thread(void *data);
+static void ffmpeg_scale_thread(void *data);
+static void ffmpeg_video_thread(void *data);
+static void ffmpeg_audio_thread(void *data);
+static void ffmpeg_mux_thread(void *data);
+
+static bool ffmpeg_stage_start(struct ff_stage *stage,
+      ffmpeg_t *handle, void (*entry)(void*))
+{
+   stage->alive  = true;
+   stage->thread = sthread_create(entry, handle);
+   return stage->thread != NULL;
+}
+
+/* Lets the stage finish the item it is working on, then joins it.
+ * Whatever is still queued is left for ffmpeg_flush_buffers. */
+static void ffmpeg_stage_stop(struct ff_stage *stage, ffmpeg_t *handle)
+{
+   if (!stage->thread)
+      return;
+
+   slock_lock(handle->cond_lock);
+   stage->alive = false;
+   scond_signal(stage->cond);
+   slock_unlock(handle->cond_lock);
+
+   sthread_join(stage->thread);
+   stage->thread = NULL;
+}
+
+static void ffmpeg_stage_wake(struct ff_stage *stage, ffmpeg_t *handle)
+{
+   slock_lock(handle->cond_lock);
+   scond_signal(stage->cond);
+   slock_unlock(handle->cond_lock);
+}
 
 static bool init_thread(ffmpeg_t *handle)
 {
+   unsigned i;
+   size_t frame_size = handle->params.fb_width * handle->params.fb_height *
+      handle->video.pix_size;
+   /* For some reason, FFmpeg has a tendency to crash
+    * if we don't overallocate a bit. */
+   size_t slot_size  = frame_size +
+      handle->params.fb_width * handle->video.pix_size;
+
    handle->lock = slock_new();
    handle->cond_lock = slock_new();
-   handle->cond = scond_new();
+   handle->space_cond = scond_new();
+   handle->scale.cond = scond_new();
+   handle->venc.cond = scond_new();
+   handle->aenc.cond = scond_new();
+   handle->mux.cond = scond_new();
    handle->audio_fifo = fifo_new(32000 * sizeof(int16_t) *
          handle->params.channels * MAX_FRAMES / 60); /* Some arbitrary max size. */
-   handle->attr_fifo = fifo_new(sizeof(struct ffemu_video_data) * MAX_FRAMES);
-   handle->video_fifo = fifo_new(handle->params.fb_width * handle->params.fb_height *
-            handle->video.pix_size * MAX_FRAMES);
+   handle->video_queue = spsc_queue_new(MAX_FRAMES);
+   handle->free_queue = spsc_queue_new(MAX_FRAMES);
+   handle->conv_queue = spsc_queue_new(MAX_CONV_FRAMES);
+   handle->conv_free = spsc_queue_new(MAX_CONV_FRAMES);
+   handle->video_pkts = spsc_queue_new(MAX_PACKETS);
+   handle->audio_pkts = spsc_queue_new(MAX_PACKETS);
+   handle->video_slots = (struct ff_video_slot*)
+      calloc(MAX_FRAMES, sizeof(*handle->video_slots));
+
+   /* On failure, ffmpeg_free() releases whatever did get allocated. */
+   if (!handle->lock || !handle->cond_lock || !handle->space_cond
+         || !handle->scale.cond || !handle->venc.cond
+         || !handle->aenc.cond || !handle->mux.cond || !handle->audio_fifo)
+      return false;
+
+   if (!handle->video_queue || !handle->free_queue
+         || !handle->conv_queue || !handle->conv_free
+         || !handle->video_pkts || !handle->audio_pkts
+         || !handle->video_slots)
+      return false;
+
+   for (i = 0; i < MAX_FRAMES; i++)
+   {
+      handle->video_slots[i].buf = (uint8_t*)av_malloc(slot_size);
+      if (!handle->video_slots[i].buf)
+         return false;
+      spsc_queue_push(handle->free_queue, &handle->video_slots[i]);
+   }
+
+   for (i = 0; i < MAX_CONV_FRAMES; i++)
+      spsc_queue_push(handle->conv_free, handle->video.conv_frames[i]);
+
+   if (handle->config.audio_enable)
+   {
+      handle->aenc_buf = av_malloc(handle->audio.codec->frame_size *
+            handle->params.channels * sizeof(int16_t));
+      if (!handle->aenc_buf)
+         return false;
+   }
 
    handle->alive = true;
-   handle->can_sleep = true;
-   handle->thread = sthread_create(ffmpeg_thread, handle);
 
-   assert(handle->lock && handle->cond_lock &&
-      handle->cond && handle->audio_fifo &&
-      handle->attr_fifo && handle->video_fifo && handle->thread);
+   /* The muxer goes first so the encoders always have somewhere
+    * to send packets. */
+   if (!ffmpeg_stage_start(&handle->mux, handle, ffmpeg_mux_thread))
+      return false;
+   if (!ffmpeg_stage_start(&handle->venc, handle, ffmpeg_video_thread))
+      return false;
+   if (!ffmpeg_stage_start(&handle->scale, handle, ffmpeg_scale_thread))
+      return false;
+   if (handle->config.audio_enable &&
+         !ffmpeg_stage_start(&handle->aenc, handle, ffmpeg_audio_thread))
+      return false;
 
    return true;
 }
 
 static void deinit_thread(ffmpeg_t *handle)
 {
-   if (!handle->thread)
-      return;
-
-   slock_lock(handle->cond_lock);
-   handle->alive = false;
-   handle->can_sleep = false;
-   slock_unlock(handle->cond_lock);
+   if (handle->cond_lock && handle->space_cond)
+   {
+      slock_lock(handle->cond_lock);
+      handle->alive = false;
+      scond_broadcast(handle->space_cond);
+      slock_unlock(handle->cond_lock);
+   }
 
-   scond_signal(handle->cond);
-   sthread_join(handle->thread);
+   /* Stop in pipeline order. The muxer stays up until both encoders
+    * are gone, so they never block on a packet queue nobody drains. */
+   ffmpeg_stage_stop(&handle->scale, handle);
+   ffmpeg_stage_stop(&handle->venc, handle);
+   ffmpeg_stage_stop(&handle->aenc, handle);
+   ffmpeg_stage_stop(&handle->mux, handle);
 
    slock_free(handle->lock);
    slock_free(handle->cond_lock);
-   scond_free(handle->cond);
+   scond_free(handle->space_cond);
+   scond_free(handle->scale.cond);
+   scond_free(handle->venc.cond);
+   scond_free(handle->aenc.cond);
+   scond_free(handle->mux.cond);
+
+   handle->lock       = NULL;
+   handle->cond_lock  = NULL;
+   handle->space_cond = NULL;
+   handle->scale.cond = NULL;
+   handle->venc.cond  = NULL;
+   handle->aenc.cond  = NULL;
+   handle->mux.cond   = NULL;
+}
+
+static void ffmpeg_free_packets(spsc_queue_t *queue)
+{
+   AVPacket *pkt;
+
+   if (!queue)
+      return;
+
+   while ((pkt = (AVPacket*)spsc_queue_pop(queue)))
+   {
+      av_free_packet(pkt);
+      av_free(pkt);
+   }
 
-   handle->thread = NULL;
+   spsc_queue_free(queue);
 }
 
 static void deinit_thread_buf(ffmpeg_t *handle)
@@ -672,22 +882,36 @@ static void deinit_thread_buf(ffmpeg_t *handle)
       fifo_free(handle->audio_fifo);
       handle->audio_fifo = NULL;
    }
-   
-   if (handle->attr_fifo)
-   {
-      fifo_free(handle->attr_fifo);
-      handle->attr_fifo = NULL;
-   }
 
-   if (handle->video_fifo)
+   spsc_queue_free(handle->video_queue);
+   spsc_queue_free(handle->free_queue);
+   spsc_queue_free(handle->conv_queue);
+   spsc_queue_free(handle->conv_free);
+   ffmpeg_free_packets(handle->video_pkts);
+   ffmpeg_free_packets(handle->audio_pkts);
+   handle->video_queue = NULL;
+   handle->free_queue  = NULL;
+   handle->conv_queue  = NULL;
+   handle->conv_free   = NULL;
+   handle->video_pkts  = NULL;
+   handle->audio_pkts  = NULL;
+
+   av_free(handle->aenc_buf);
+   handle->aenc_buf = NULL;
+
+   if (handle->video_slots)
    {
-      fifo_free(handle->video_fifo);
-      handle->video_fifo = NULL;
+      unsigned i;
+      for (i = 0; i < MAX_FRAMES; i++)
+         av_free(handle->video_slots[i].buf);
+      free(handle->video_slots);
+      handle->video_slots = NULL;
    }
 }
 
 static void ffmpeg_free(void *data)
 {
+   unsigned i;
    ffmpeg_t *handle = (ffmpeg_t*)data;
    if (!handle)
       return;
@@ -709,10 +933,14 @@ static void ffmpeg_free(void *data)
       av_free(handle->video.codec);
    }
 
-   av_frame_free(&handle->video.conv_frame);
-   av_free(handle->video.conv_frame_buf);
+   for (i = 0; i < MAX_CONV_FRAMES; i++)
+   {
+      av_frame_free(&handle->video.conv_frames[i]);
+      av_free(handle->video.conv_frame_bufs[i]);
+   }
 
    scaler_ctx_gen_reset(&handle->video.scaler);
+   thread_pool_free(handle->video.scaler_pool);
 
    if (handle->video.sws)
       sws_freeContext(handle->video.sws);
@@ -773,14 +1001,32 @@ error:
    return NULL;
 }
 
+/* Blocks the emulator thread until the encoder hands back a slot.
+ * Returns NULL if the encoder thread is shutting down. */
+static struct ff_video_slot *ffmpeg_wait_free_slot(ffmpeg_t *handle)
+{
+   struct ff_video_slot *slot = NULL;
+   retro_time_t start         = retro_get_time_usec();
+
+   slock_lock(handle->cond_lock);
+   while (handle->alive && !(slot = (struct ff_video_slot*)
+            spsc_queue_pop(handle->free_queue)))
+      scond_wait(handle->space_cond, handle->cond_lock);
+   slock_unlock(handle->cond_lock);
+
+   handle->stats.stalls++;
+   handle->stats.stall_usec += retro_get_time_usec() - start;
+
+   return slot;
+}
+
 static bool ffmpeg_push_video(void *data,
       const struct ffemu_video_data *video_data)
 {
-   unsigned y;
+   unsigned depth;
    bool drop_frame;
-   struct ffemu_video_data attr_data;
-   ffmpeg_t *handle = (ffmpeg_t*)data;
-   int offset = 0;
+   struct ff_video_slot *slot = NULL;
+   ffmpeg_t *handle           = (ffmpeg_t*)data;
 
    if (!handle || !video_data)
       return false;
@@ -793,52 +1039,53 @@ static bool ffmpeg_push_video(void *data,
    if (drop_frame)
       return true;
 
-   for (;;)
-   {
-      unsigned avail;
-      slock_lock(handle->lock);
-      avail = fifo_write_avail(handle->attr_fifo);
-      slock_unlock(handle->lock);
-
-      if (!handle->alive)
-         return false;
-
-      if (avail >= sizeof(*video_data))
-         break;
-
-      slock_lock(handle->cond_lock);
-      if (handle->can_sleep)
-      {
-         handle->can_sleep = false;
-         scond_wait(handle->cond, handle->cond_lock);
-         handle->can_sleep = true;
-      }
-      else
-         scond_signal(handle->cond);
-
-      slock_unlock(handle->cond_lock);
-   }
+   if (!handle->alive)
+      return false;
 
-   slock_lock(handle->lock);
+   slot = (struct ff_video_slot*)spsc_queue_pop(handle->free_queue);
+   if (!slot)
+      slot = ffmpeg_wait_free_slot(handle);
+   if (!slot)
+      return false;
 
    /* Tightly pack our frame to conserve memory.
     * libretro tends to use a very large pitch.
+    * The core's buffer is only valid for the duration of
+    * this call, so this is the one copy the frame gets.
     */
-   attr_data = *video_data;
+   slot->attr      = *video_data;
+   slot->attr.data = slot->buf;
 
-   if (attr_data.is_dupe)
-      attr_data.width = attr_data.height = attr_data.pitch = 0;
+   if (slot->attr.is_dupe)
+      slot->attr.width = slot->attr.height = slot->attr.pitch = 0;
    else
-      attr_data.pitch = attr_data.width * handle->video.pix_size;
+   {
+      slot->attr.pitch = slot->attr.width * handle->video.pix_size;
+
+      if (video_data->pitch == slot->attr.pitch)
+         memcpy(slot->buf, video_data->data,
+               slot->attr.pitch * slot->attr.height);
+      else
+      {
+         unsigned y;
+         const uint8_t *in = (const uint8_t*)video_data->data;
+         uint8_t *out      = slot->buf;
 
-   fifo_write(handle->attr_fifo, &attr_data, sizeof(attr_data));
+         for (y = 0; y < slot->attr.height; y++,
+               in += video_data->pitch, out += slot->attr.pitch)
+            memcpy(out, in, slot->attr.pitch);
+      }
+   }
 
-   for (y = 0; y < attr_data.height; y++, offset += video_data->pitch)
-      fifo_write(handle->video_fifo,
-            (const uint8_t*)video_data->data + offset, attr_data.pitch);
+   /* Only MAX_FRAMES slots exist, so this cannot overflow. */
+   spsc_queue_push(handle->video_queue, slot);
 
-   slock_unlock(handle->lock);
-   scond_signal(handle->cond);
+   depth = spsc_queue_size(handle->video_queue);
+   if (depth > handle->stats.max_depth)
+      handle->stats.max_depth = depth;
+   handle->stats.frames++;
+
+   ffmpeg_stage_wake(&handle->scale, handle);
 
    return true;
 }
@@ -854,38 +1101,34 @@ static bool ffmpeg_push_audio(void *data,
    if (!handle->config.audio_enable)
       return true;
 
+   slock_lock(handle->cond_lock);
    for (;;)
    {
-      unsigned avail;
+      size_t avail;
       slock_lock(handle->lock);
       avail = fifo_write_avail(handle->audio_fifo);
       slock_unlock(handle->lock);
 
       if (!handle->alive)
+      {
+         slock_unlock(handle->cond_lock);
          return false;
+      }
 
       if (avail >= audio_data->frames * handle->params.channels
             * sizeof(int16_t))
          break;
 
-      slock_lock(handle->cond_lock);
-      if (handle->can_sleep)
-      {
-         handle->can_sleep = false;
-         scond_wait(handle->cond, handle->cond_lock);
-         handle->can_sleep = true;
-      }
-      else
-         scond_signal(handle->cond);
-
-      slock_unlock(handle->cond_lock);
+      scond_wait(handle->space_cond, handle->cond_lock);
    }
+   slock_unlock(handle->cond_lock);
 
    slock_lock(handle->lock);
    fifo_write(handle->audio_fifo, audio_data->data,
          audio_data->frames * handle->params.channels * sizeof(int16_t));
    slock_unlock(handle->lock);
-   scond_signal(handle->cond);
+
+   ffmpeg_stage_wake(&handle->aenc, handle);
 
    return true;
 }
@@ -925,8 +1168,47 @@ static bool encode_video(ffmpeg_t *handle, AVPacket *pkt, AVFrame *frame)
    return true;
 }
 
+/* Hands an encoded packet to the mux stage, waiting for room if the
+ * muxer is behind. Once the pipeline is torn down, writes it directly. */
+static bool ffmpeg_write_packet(ffmpeg_t *handle, struct ff_stage *stage,
+      spsc_queue_t *queue, AVPacket *pkt)
+{
+   AVPacket *copy = NULL;
+
+   if (!handle->mux.thread)
+      return av_interleaved_write_frame(handle->muxer.ctx, pkt) >= 0;
+
+   /* The encoders reuse their output buffer, so the packet
+    * needs its own copy of the data before it changes hands. */
+   copy = (AVPacket*)av_malloc(sizeof(*copy));
+   if (!copy)
+      return false;
+
+   *copy = *pkt;
+   if (av_dup_packet(copy) < 0)
+   {
+      av_free(copy);
+      return false;
+   }
+
+   slock_lock(handle->cond_lock);
+   while (!spsc_queue_push(queue, copy))
+      scond_wait(stage->cond, handle->cond_lock);
+   scond_signal(handle->mux.cond);
+   slock_unlock(handle->cond_lock);
+
+   return true;
+}
+
+static void ffmpeg_mux_packet(ffmpeg_t *handle, AVPacket *pkt)
+{
+   av_interleaved_write_frame(handle->muxer.ctx, pkt);
+   av_free_packet(pkt);
+   av_free(pkt);
+}
+
 static void ffmpeg_scale_input(ffmpeg_t *handle,
-      const struct ffemu_video_data *data)
+      const struct ffemu_video_data *data, AVFrame *frame)
 {
    /* Attempt to preserve more information if we scale down. */
    bool shrunk = handle->params.out_width < data->width
@@ -943,8 +1225,7 @@ static void ffmpeg_scale_input(ffmpeg_t *handle,
             shrunk ? SWS_BILINEAR : SWS_POINT, NULL, NULL, NULL);
 
       sws_scale(handle->video.sws, (const uint8_t* const*)&data->data,
-            &linesize, 0, data->height, handle->video.conv_frame->data,
-            handle->video.conv_frame->linesize);
+            &linesize, 0, data->height, frame->data, frame->linesize);
    }
    else
    {
@@ -960,33 +1241,47 @@ static void ffmpeg_scale_input(ffmpeg_t *handle,
 
          handle->video.scaler.out_width  = handle->params.out_width;
          handle->video.scaler.out_height = handle->params.out_height;
-         handle->video.scaler.out_stride = 
-            handle->video.conv_frame->linesize[0];
+         handle->video.scaler.out_stride = frame->linesize[0];
 
          scaler_ctx_gen_filter(&handle->video.scaler);
       }
 
       scaler_ctx_scale(&handle->video.scaler,
-            handle->video.conv_frame->data[0], data->data);
+            frame->data[0], data->data);
    }
 }
 
-static bool ffmpeg_push_video_thread(ffmpeg_t *handle,
-      const struct ffemu_video_data *data)
+/* Fills frame from a queued slot. A dupe repeats the last frame
+ * produced, which may still be queued for encoding; that is fine
+ * since the encoder only ever reads from it. */
+static void ffmpeg_convert_frame(ffmpeg_t *handle,
+      const struct ffemu_video_data *data, AVFrame *frame)
 {
-   AVPacket pkt;
+   AVFrame *last = handle->video.last_frame;
 
    if (!data->is_dupe)
-      ffmpeg_scale_input(handle, data);
+      ffmpeg_scale_input(handle, data, frame);
+   else if (last && last != frame)
+      av_picture_copy((AVPicture*)frame, (const AVPicture*)last,
+            handle->video.pix_fmt,
+            handle->params.out_width, handle->params.out_height);
+
+   handle->video.last_frame = frame;
+}
+
+static bool ffmpeg_encode_frame(ffmpeg_t *handle, AVFrame *frame)
+{
+   AVPacket pkt;
 
-   handle->video.conv_frame->pts = handle->video.frame_cnt;
+   frame->pts = handle->video.frame_cnt;
 
-   if (!encode_video(handle, &pkt, handle->video.conv_frame))
+   if (!encode_video(handle, &pkt, frame))
       return false;
 
    if (pkt.size)
    {
-      if (av_interleaved_write_frame(handle->muxer.ctx, &pkt) < 0)
+      if (!ffmpeg_write_packet(handle, &handle->venc,
+               handle->video_pkts, &pkt))
          return false;
    }
 
@@ -1215,7 +1510,8 @@ static bool ffmpeg_push_audio_thread(ffmpeg_t *handle,
 
       if (pkt.size)
       {
-         if (av_interleaved_write_frame(handle->muxer.ctx, &pkt) < 0)
+         if (!ffmpeg_write_packet(handle, &handle->aenc,
+                  handle->audio_pkts, &pkt))
             return false;
       }
    }
@@ -1244,7 +1540,8 @@ static void ffmpeg_flush_audio(ffmpeg_t *handle, void *audio_buf,
    {
       AVPacket pkt;
       if (!encode_audio(handle, &pkt, true) || !pkt.size ||
-            av_interleaved_write_frame(handle->muxer.ctx, &pkt) < 0)
+            !ffmpeg_write_packet(handle, &handle->aenc,
+               handle->audio_pkts, &pkt))
          break;
    }
 }
@@ -1255,7 +1552,8 @@ static void ffmpeg_flush_video(ffmpeg_t *handle)
    {
       AVPacket pkt;
       if (!encode_video(handle, &pkt, NULL) || !pkt.size ||
-            av_interleaved_write_frame(handle->muxer.ctx, &pkt) < 0)
+            !ffmpeg_write_packet(handle, &handle->venc,
+               handle->video_pkts, &pkt))
          break;
    }
 }
@@ -1263,8 +1561,8 @@ static void ffmpeg_flush_video(ffmpeg_t *handle)
 static void ffmpeg_flush_buffers(ffmpeg_t *handle)
 {
    bool did_work;
-   void *video_buf = av_malloc(2 * handle->params.fb_width * 
-         handle->params.fb_height * handle->video.pix_size);
+   AVPacket *pkt  = NULL;
+   AVFrame *frame = NULL;
    size_t audio_buf_size = handle->config.audio_enable ? 
       (handle->audio.codec->frame_size * 
        handle->params.channels * sizeof(int16_t)) : 0;
@@ -1272,12 +1570,26 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
 
    if (audio_buf_size)
       audio_buf = av_malloc(audio_buf_size);
+
+   /* Packets the mux stage didn't get to. */
+   while ((pkt = (AVPacket*)spsc_queue_pop(handle->video_pkts)))
+      ffmpeg_mux_packet(handle, pkt);
+   while ((pkt = (AVPacket*)spsc_queue_pop(handle->audio_pkts)))
+      ffmpeg_mux_packet(handle, pkt);
+
+   /* Frames scaled, but not yet encoded. */
+   while ((frame = (AVFrame*)spsc_queue_pop(handle->conv_queue)))
+   {
+      ffmpeg_encode_frame(handle, frame);
+      spsc_queue_push(handle->conv_free, frame);
+   }
+
    /* Try pushing data in an interleaving pattern to 
     * ease the work of the muxer a bit. */
 
    do
    {
-      struct ffemu_video_data attr_buf;
+      struct ff_video_slot *slot = NULL;
 
       did_work = false;
 
@@ -1297,13 +1609,14 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
          }
       }
 
-      if (fifo_read_avail(handle->attr_fifo) >= sizeof(attr_buf))
+      slot = (struct ff_video_slot*)spsc_queue_pop(handle->video_queue);
+      if (slot)
       {
-         fifo_read(handle->attr_fifo, &attr_buf, sizeof(attr_buf));
-         fifo_read(handle->video_fifo, video_buf, 
-               attr_buf.height * attr_buf.pitch);
-         attr_buf.data = video_buf;
-         ffmpeg_push_video_thread(handle, &attr_buf);
+         frame = (AVFrame*)spsc_queue_pop(handle->conv_free);
+         ffmpeg_convert_frame(handle, &slot->attr, frame);
+         ffmpeg_encode_frame(handle, frame);
+         spsc_queue_push(handle->conv_free, frame);
+         spsc_queue_push(handle->free_queue, slot);
 
          did_work = true;
       }
@@ -1316,7 +1629,6 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
    /* Flush out last video. */
    ffmpeg_flush_video(handle);
 
-   av_free(video_buf);
    av_free(audio_buf);
 }
 
@@ -1332,6 +1644,12 @@ static bool ffmpeg_finalize(void *data)
    /* Flush out data still in buffers (internal, and FFmpeg internal). */
    ffmpeg_flush_buffers(handle);
 
+   if (handle->stats.frames)
+      RARCH_LOG("[FFmpeg]: Queued %u frames, %u waited on the pipeline "
+            "(%.1f ms total), at most %u in flight.\n",
+            handle->stats.frames, handle->stats.stalls,
+            handle->stats.stall_usec / 1000.0, handle->stats.max_depth);
+
    deinit_thread_buf(handle);
 
    /* Write final data. */
@@ -1340,84 +1658,154 @@ static bool ffmpeg_finalize(void *data)
    return true;
 }
 
-static void ffmpeg_thread(void *data)
+static bool ffmpeg_thread_has_audio(ffmpeg_t *ff, size_t audio_buf_size)
+{
+   bool ret;
+
+   slock_lock(ff->lock);
+   ret = fifo_read_avail(ff->audio_fifo) >= audio_buf_size;
+   slock_unlock(ff->lock);
+
+   return ret;
+}
+
+/* Scale stage: packed input slots -> encoder-format frames. */
+static void ffmpeg_scale_thread(void *data)
 {
-   size_t audio_buf_size;
-   void *audio_buf;
    ffmpeg_t *ff = (ffmpeg_t*)data;
 
-   /* For some reason, FFmpeg has a tendency to crash 
-    * if we don't overallocate a bit. */
-   void *video_buf = av_malloc(2 * ff->params.fb_width *
-         ff->params.fb_height * ff->video.pix_size);
-   assert(video_buf);
+   for (;;)
+   {
+      bool alive;
+      struct ff_video_slot *slot = NULL;
+      AVFrame *frame             = NULL;
+
+      slock_lock(ff->cond_lock);
+      while (ff->scale.alive && (!spsc_queue_size(ff->video_queue)
+               || !spsc_queue_size(ff->conv_free)))
+         scond_wait(ff->scale.cond, ff->cond_lock);
+      alive = ff->scale.alive;
+      slock_unlock(ff->cond_lock);
+
+      if (!alive)
+         break;
+
+      slot  = (struct ff_video_slot*)spsc_queue_pop(ff->video_queue);
+      frame = (AVFrame*)spsc_queue_pop(ff->conv_free);
+
+      ffmpeg_convert_frame(ff, &slot->attr, frame);
+
+      spsc_queue_push(ff->free_queue, slot);
+      slock_lock(ff->cond_lock);
+      scond_signal(ff->space_cond);
+      slock_unlock(ff->cond_lock);
+
+      spsc_queue_push(ff->conv_queue, frame);
+      ffmpeg_stage_wake(&ff->venc, ff);
+   }
+}
 
-   audio_buf_size = ff->config.audio_enable ? 
-      (ff->audio.codec->frame_size * ff->params.channels * sizeof(int16_t)) : 0;
-   audio_buf      = audio_buf_size ? av_malloc(audio_buf_size) : NULL;
+/* Video encode stage: scaled frames -> packets for the muxer. */
+static void ffmpeg_video_thread(void *data)
+{
+   ffmpeg_t *ff = (ffmpeg_t*)data;
 
-   while (ff->alive)
+   for (;;)
    {
-      struct ffemu_video_data attr_buf;
+      bool alive;
+      AVFrame *frame = NULL;
 
-      bool avail_video = false;
-      bool avail_audio = false;
+      slock_lock(ff->cond_lock);
+      while (ff->venc.alive && !spsc_queue_size(ff->conv_queue))
+         scond_wait(ff->venc.cond, ff->cond_lock);
+      alive = ff->venc.alive;
+      slock_unlock(ff->cond_lock);
 
-      slock_lock(ff->lock);
-      if (fifo_read_avail(ff->attr_fifo) >= sizeof(attr_buf))
-         avail_video = true;
+      if (!alive)
+         break;
+
+      frame = (AVFrame*)spsc_queue_pop(ff->conv_queue);
+      ffmpeg_encode_frame(ff, frame);
+
+      spsc_queue_push(ff->conv_free, frame);
+      ffmpeg_stage_wake(&ff->scale, ff);
+   }
+}
+
+/* Audio stage: resamples and encodes whole codec frames of audio. */
+static void ffmpeg_audio_thread(void *data)
+{
+   ffmpeg_t *ff          = (ffmpeg_t*)data;
+   size_t audio_buf_size = ff->audio.codec->frame_size *
+      ff->params.channels * sizeof(int16_t);
+   void *audio_buf       = ff->aenc_buf;
 
-      if (ff->config.audio_enable)
-         if (fifo_read_avail(ff->audio_fifo) >= audio_buf_size)
-            avail_audio = true;
+   for (;;)
+   {
+      bool alive;
+      struct ffemu_audio_data aud = {0};
+
+      slock_lock(ff->cond_lock);
+      while (ff->aenc.alive && !ffmpeg_thread_has_audio(ff, audio_buf_size))
+         scond_wait(ff->aenc.cond, ff->cond_lock);
+      alive = ff->aenc.alive;
+      slock_unlock(ff->cond_lock);
+
+      if (!alive)
+         break;
+
+      slock_lock(ff->lock);
+      fifo_read(ff->audio_fifo, audio_buf, audio_buf_size);
       slock_unlock(ff->lock);
 
-      if (!avail_video && !avail_audio)
-      {
-         slock_lock(ff->cond_lock);
-         if (ff->can_sleep)
-         {
-            ff->can_sleep = false;
-            scond_wait(ff->cond, ff->cond_lock);
-            ff->can_sleep = true;
-         }
-         else
-            scond_signal(ff->cond);
+      slock_lock(ff->cond_lock);
+      scond_signal(ff->space_cond);
+      slock_unlock(ff->cond_lock);
 
-         slock_unlock(ff->cond_lock);
-      }
+      aud.frames = ff->audio.codec->frame_size;
+      aud.data = audio_buf;
 
-      if (avail_video)
-      {
-         slock_lock(ff->lock);
-         fifo_read(ff->attr_fifo, &attr_buf, sizeof(attr_buf));
-         fifo_read(ff->video_fifo, video_buf,
-               attr_buf.height * attr_buf.pitch);
-         slock_unlock(ff->lock);
-         scond_signal(ff->cond);
-
-         attr_buf.data = video_buf;
-         ffmpeg_push_video_thread(ff, &attr_buf);
-      }
+      ffmpeg_push_audio_thread(ff, &aud, true);
+   }
+}
 
-      if (avail_audio)
-      {
-         struct ffemu_audio_data aud = {0};
+/* Mux stage: the only thread that touches the output file. */
+static void ffmpeg_mux_thread(void *data)
+{
+   ffmpeg_t *ff = (ffmpeg_t*)data;
 
-         slock_lock(ff->lock);
-         fifo_read(ff->audio_fifo, audio_buf, audio_buf_size);
-         slock_unlock(ff->lock);
-         scond_signal(ff->cond);
+   for (;;)
+   {
+      bool alive;
+      AVPacket *vpkt = NULL;
+      AVPacket *apkt = NULL;
+
+      slock_lock(ff->cond_lock);
+      while (ff->mux.alive && !spsc_queue_size(ff->video_pkts)
+            && !spsc_queue_size(ff->audio_pkts))
+         scond_wait(ff->mux.cond, ff->cond_lock);
+      alive = ff->mux.alive;
+      slock_unlock(ff->cond_lock);
+
+      if (!alive)
+         break;
 
-         aud.frames = ff->audio.codec->frame_size;
-         aud.data = audio_buf;
+      /* Take one of each to keep the interleaving queue short. */
+      vpkt = (AVPacket*)spsc_queue_pop(ff->video_pkts);
+      apkt = (AVPacket*)spsc_queue_pop(ff->audio_pkts);
 
-         ffmpeg_push_audio_thread(ff, &aud, true);
+      if (vpkt)
+      {
+         ffmpeg_mux_packet(ff, vpkt);
+         ffmpeg_stage_wake(&ff->venc, ff);
       }
-   }
 
-   av_free(video_buf);
-   av_free(audio_buf);
+      if (apkt)
+      {
+         ffmpeg_mux_packet(ff, apkt);
+         ffmpeg_stage_wake(&ff->aenc, ff);
+      }
+   }
 }
 
 const record_driver_t ffemu_ffmpeg = {
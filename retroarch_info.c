@@ -48,6 +48,8 @@ int rarch_info_get_capabilities(enum rarch_capabilities type, char *s, size_t le
                strlcat(s, "AVX ", len);
             if (cpu & RETRO_SIMD_AVX2)
                strlcat(s, "AVX2 ", len);
+            if (cpu & RETRO_SIMD_FMA)
+               strlcat(s, "FMA ", len);
             if (cpu & RETRO_SIMD_VFPU)
                strlcat(s, "VFPU ", len);
             if (cpu & RETRO_SIMD_NEON)
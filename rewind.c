@@ -21,6 +21,14 @@
 
 #include <retro_inline.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#ifdef HAVE_ZLIB_DEFLATE
+#include <file/file_extract.h>
+#endif
+
 #include "general.h"
 #include "msg_hash.h"
 #include "rewind.h"
@@ -44,6 +52,31 @@
 #define NO_UNALIGNED_MEM
 #endif
 
+struct state_manager_keyframe
+{
+   /* Offset of the keyframe entry in state_manager::data. */
+   size_t offset;
+   uint64_t frame;
+};
+
+enum state_manager_entry_type
+{
+   /* Raw state_manager_raw_compress() output. */
+   REWIND_ENTRY_DELTA = 0,
+   /* The same, deflated. */
+   REWIND_ENTRY_DELTA_Z,
+   /* Full state. */
+   REWIND_ENTRY_KEYFRAME,
+   /* Full state, deflated. */
+   REWIND_ENTRY_KEYFRAME_Z
+};
+
+/* Each entry starts with a u32 type and a u32 payload size. */
+#define REWIND_ENTRY_HEADER_SIZE (sizeof(uint32_t) * 2)
+
+/* Entries are padded so the next one is size_t aligned. */
+#define REWIND_ENTRY_ALIGN(x) (((x) + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1))
+
 struct state_manager
 {
    uint8_t *data;
@@ -66,6 +99,36 @@ struct state_manager
 
    unsigned entries;
    bool thisblock_valid;
+
+   /* Frame number of the state in thisblock. */
+   uint64_t frame;
+
+   /* Every keyframe_interval frames, a full copy of the state is
+    * stored in the ring as well, so state_manager_seek() doesn't have
+    * to walk all deltas back one by one. 0 disables keyframes. */
+   unsigned keyframe_interval;
+   struct state_manager_keyframe *keyframes;
+   size_t keyframes_first;
+   size_t keyframes_count;
+   size_t keyframes_size;
+
+   /* Scratch buffer for the second compression stage. */
+   uint8_t *deltabuf;
+   void *zstream;
+
+#ifdef HAVE_THREADS
+   /* Delta compression is done on a worker thread.
+    * The main thread serializes into nextblock, then hands it over
+    * as pendingblock; the worker compresses it against thisblock,
+    * appends the delta to the ring and recycles the old thisblock
+    * as spareblock, which becomes the next staging buffer. */
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   uint8_t *pendingblock;
+   uint8_t *spareblock;
+   bool quit;
+#endif
 };
 
 /* Format per frame (pseudocode): */
@@ -95,7 +158,7 @@ size_t state_manager_raw_maxsize(size_t uncomp)
    /* bytes covered by a compressed block */
    const int maxcblkcover = UINT16_MAX * sizeof(uint16_t);
    /* uncompressed size, rounded to 16 bits */
-   size_t uncomp16        = (uncomp + sizeof(uint16_t) - 1) & ~sizeof(uint16_t);
+   size_t uncomp16        = (uncomp + sizeof(uint16_t) - 1) & ~(sizeof(uint16_t) - 1);
    /* number of blocks */
    size_t maxcblks        = (uncomp + maxcblkcover - 1) / maxcblkcover;
    return uncomp16 + maxcblks * sizeof(uint16_t) * 2 /* two u16 overhead per block */ + sizeof(uint16_t) *
@@ -104,9 +167,9 @@ size_t state_manager_raw_maxsize(size_t uncomp)
 
 void *state_manager_raw_alloc(size_t len, uint16_t uniq)
 {
-   size_t  len16 = (len + sizeof(uint16_t) - 1) & ~sizeof(uint16_t);
+   size_t  len16 = (len + sizeof(uint16_t) - 1) & ~(sizeof(uint16_t) - 1);
 
-   uint16_t *ret = (uint16_t*)calloc(len16 + sizeof(uint16_t) * 4 + 16, 1);
+   uint16_t *ret = (uint16_t*)calloc(len16 + sizeof(uint16_t) * 4 + 32, 1);
 
    /* Force in a different byte at the end, so we don't need to check 
     * bounds in the innermost loop (it's expensive).
@@ -117,14 +180,31 @@ void *state_manager_raw_alloc(size_t len, uint16_t uniq)
     * There is also some padding at the end. This is so we don't 
     * read outside the buffer end if we're reading in large blocks;
     *
-    * It doesn't make any difference to us, but sacrificing 16 bytes to get 
-    * Valgrind happy is worth it. */
+    * It doesn't make any difference to us, but sacrificing 32 bytes
+    * (one AVX2 load) to get Valgrind happy is worth it. */
    ret[len16/sizeof(uint16_t) + 3] = uniq;
 
    return ret;
 }
 
-#if __SSE2__
+#if defined(__AVX2__) || ((defined(__x86_64__) || defined(__i386__)) && \
+      defined(__GNUC__) && !defined(__clang__) && \
+      (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+/* GCC can build the AVX2 kernels for a generic target,
+ * they are only used if the CPU reports AVX2 at runtime. */
+#define HAVE_REWIND_AVX2
+#ifdef __AVX2__
+#define REWIND_AVX2_TARGET
+#else
+#define REWIND_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define HAVE_REWIND_NEON
+#endif
+
+#if defined(__SSE2__) || defined(HAVE_REWIND_AVX2) || defined(HAVE_REWIND_NEON)
 #if defined(__GNUC__)
 static INLINE int compat_ctz(unsigned x)
 {
@@ -148,36 +228,16 @@ static INLINE int compat_ctz(unsigned x)
    return 16;
 }
 #endif
+#endif
 
-#include <emmintrin.h>
-/* There's no equivalent in libc, you'd think so ...
- * std::mismatch exists, but it's not optimized at all. */
-
-static INLINE size_t find_change(const uint16_t *a, const uint16_t *b)
-{
-   const __m128i *a128 = (const __m128i*)a;
-   const __m128i *b128 = (const __m128i*)b;
-   
-   for (;;)
-   {
-      __m128i v0    = _mm_loadu_si128(a128);
-      __m128i v1    = _mm_loadu_si128(b128);
-      __m128i c     = _mm_cmpeq_epi32(v0, v1);
-      uint32_t mask = _mm_movemask_epi8(c);
-
-      if (mask != 0xffff) /* Something has changed, figure out where. */
-      {
-         size_t ret = (((uint8_t*)a128 - (uint8_t*)a) |
-               (compat_ctz(~mask))) >> 1;
-         return ret | (a[ret] == b[ret]);
-      }
+/* find_change() returns the number of leading uint16s which are equal
+ * in both buffers, find_same() the number of leading uint16s before
+ * the buffers agree again (see find_same_C for the exact rules).
+ *
+ * Neither checks bounds; state_manager_raw_alloc() guarantees both
+ * scans stop within the allocation. */
 
-      a128++;
-      b128++;
-   }
-}
-#else
-static INLINE size_t find_change(const uint16_t *a, const uint16_t *b)
+static size_t find_change_C(const uint16_t *a, const uint16_t *b)
 {
    const uint16_t *a_org = a;
 #ifdef NO_UNALIGNED_MEM
@@ -208,9 +268,8 @@ static INLINE size_t find_change(const uint16_t *a, const uint16_t *b)
    }
    return a - a_org;
 }
-#endif
 
-static INLINE size_t find_same(const uint16_t *a, const uint16_t *b)
+static size_t find_same_C(const uint16_t *a, const uint16_t *b)
 {
    const uint16_t *a_org = a;
 #ifdef NO_UNALIGNED_MEM
@@ -250,6 +309,231 @@ static INLINE size_t find_same(const uint16_t *a, const uint16_t *b)
    return a - a_org;
 }
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+/* There's no equivalent in libc, you'd think so ...
+ * std::mismatch exists, but it's not optimized at all. */
+
+static size_t find_change_SSE2(const uint16_t *a, const uint16_t *b)
+{
+   const __m128i *a128 = (const __m128i*)a;
+   const __m128i *b128 = (const __m128i*)b;
+   
+   for (;;)
+   {
+      __m128i v0    = _mm_loadu_si128(a128);
+      __m128i v1    = _mm_loadu_si128(b128);
+      __m128i c     = _mm_cmpeq_epi32(v0, v1);
+      uint32_t mask = _mm_movemask_epi8(c);
+
+      if (mask != 0xffff) /* Something has changed, figure out where. */
+      {
+         size_t ret = (((uint8_t*)a128 - (uint8_t*)a) |
+               (compat_ctz(~mask))) >> 1;
+         return ret | (a[ret] == b[ret]);
+      }
+
+      a128++;
+      b128++;
+   }
+}
+
+static size_t find_same_SSE2(const uint16_t *a, const uint16_t *b)
+{
+   const __m128i *a128 = (const __m128i*)a;
+   const __m128i *b128 = (const __m128i*)b;
+   
+   for (;;)
+   {
+      __m128i v0    = _mm_loadu_si128(a128);
+      __m128i v1    = _mm_loadu_si128(b128);
+      __m128i c     = _mm_cmpeq_epi32(v0, v1);
+      uint32_t mask = _mm_movemask_epi8(c);
+
+      if (mask) /* Found an identical uint32. */
+      {
+         size_t ret = (((uint8_t*)a128 - (uint8_t*)a) |
+               (compat_ctz(mask))) >> 1;
+         if (ret && a[ret - 1] == b[ret - 1])
+            ret--;
+         return ret;
+      }
+
+      a128++;
+      b128++;
+   }
+}
+#endif
+
+#ifdef HAVE_REWIND_AVX2
+#include <immintrin.h>
+
+static REWIND_AVX2_TARGET size_t find_change_AVX2(
+      const uint16_t *a, const uint16_t *b)
+{
+   const __m256i *a256 = (const __m256i*)a;
+   const __m256i *b256 = (const __m256i*)b;
+   
+   for (;;)
+   {
+      __m256i v0    = _mm256_loadu_si256(a256);
+      __m256i v1    = _mm256_loadu_si256(b256);
+      __m256i c     = _mm256_cmpeq_epi32(v0, v1);
+      uint32_t mask = (uint32_t)_mm256_movemask_epi8(c);
+
+      if (mask != 0xffffffffu)
+      {
+         size_t ret = (((uint8_t*)a256 - (uint8_t*)a) |
+               (compat_ctz(~mask))) >> 1;
+         return ret | (a[ret] == b[ret]);
+      }
+
+      a256++;
+      b256++;
+   }
+}
+
+static REWIND_AVX2_TARGET size_t find_same_AVX2(
+      const uint16_t *a, const uint16_t *b)
+{
+   const __m256i *a256 = (const __m256i*)a;
+   const __m256i *b256 = (const __m256i*)b;
+   
+   for (;;)
+   {
+      __m256i v0    = _mm256_loadu_si256(a256);
+      __m256i v1    = _mm256_loadu_si256(b256);
+      __m256i c     = _mm256_cmpeq_epi32(v0, v1);
+      uint32_t mask = (uint32_t)_mm256_movemask_epi8(c);
+
+      if (mask)
+      {
+         size_t ret = (((uint8_t*)a256 - (uint8_t*)a) |
+               (compat_ctz(mask))) >> 1;
+         if (ret && a[ret - 1] == b[ret - 1])
+            ret--;
+         return ret;
+      }
+
+      a256++;
+      b256++;
+   }
+}
+#endif
+
+#ifdef HAVE_REWIND_NEON
+#include <arm_neon.h>
+
+static INLINE int compat_ctz64(uint64_t x)
+{
+#if defined(__GNUC__)
+   return __builtin_ctzll(x);
+#else
+   int ret = 0;
+   while (!(x & 1))
+   {
+      x >>= 1;
+      ret++;
+   }
+   return ret;
+#endif
+}
+
+static size_t find_change_NEON(const uint16_t *a, const uint16_t *b)
+{
+   size_t i = 0;
+
+   for (;; i += 8)
+   {
+      uint64x2_t x = vreinterpretq_u64_u16(
+            veorq_u16(vld1q_u16(a + i), vld1q_u16(b + i)));
+      uint64_t lo  = vgetq_lane_u64(x, 0);
+      uint64_t hi  = vgetq_lane_u64(x, 1);
+
+      if (lo)
+         return i + (compat_ctz64(lo) >> 4);
+      if (hi)
+         return i + 4 + (compat_ctz64(hi) >> 4);
+   }
+}
+
+static size_t find_same_NEON(const uint16_t *a, const uint16_t *b)
+{
+   size_t i = 0;
+
+   for (;; i += 8)
+   {
+      uint32x4_t c = vceqq_u32(
+            vreinterpretq_u32_u16(vld1q_u16(a + i)),
+            vreinterpretq_u32_u16(vld1q_u16(b + i)));
+      uint64x2_t m = vreinterpretq_u64_u32(c);
+      uint64_t lo  = vgetq_lane_u64(m, 0);
+      uint64_t hi  = vgetq_lane_u64(m, 1);
+
+      if (lo || hi)
+      {
+         size_t ret = i + (lo ? (compat_ctz64(lo) >> 4)
+               : 4 + (compat_ctz64(hi) >> 4));
+         if (ret && a[ret - 1] == b[ret - 1])
+            ret--;
+         return ret;
+      }
+   }
+}
+#endif
+
+typedef size_t (*rewind_scan_t)(const uint16_t *a, const uint16_t *b);
+
+/* Until state_manager_raw_init_simd() is called, use whatever
+ * the compiler guarantees us. */
+#if defined(__AVX2__)
+static rewind_scan_t find_change = find_change_AVX2;
+static rewind_scan_t find_same   = find_same_AVX2;
+#elif defined(__SSE2__)
+static rewind_scan_t find_change = find_change_SSE2;
+static rewind_scan_t find_same   = find_same_SSE2;
+#else
+static rewind_scan_t find_change = find_change_C;
+static rewind_scan_t find_same   = find_same_C;
+#endif
+
+/**
+ * state_manager_raw_init_simd:
+ *
+ * Selects the fastest delta scan kernels the CPU supports.
+ **/
+void state_manager_raw_init_simd(void)
+{
+   uint64_t cpu = retro_get_cpu_features();
+
+   (void)cpu;
+
+   find_change = find_change_C;
+   find_same   = find_same_C;
+
+#if defined(__SSE2__)
+   if (cpu & RETRO_SIMD_SSE2)
+   {
+      find_change = find_change_SSE2;
+      find_same   = find_same_SSE2;
+   }
+#endif
+#ifdef HAVE_REWIND_AVX2
+   if ((cpu & RETRO_SIMD_AVX) && (cpu & RETRO_SIMD_AVX2))
+   {
+      find_change = find_change_AVX2;
+      find_same   = find_same_AVX2;
+   }
+#endif
+#ifdef HAVE_REWIND_NEON
+   if (cpu & RETRO_SIMD_NEON)
+   {
+      find_change = find_change_NEON;
+      find_same   = find_same_NEON;
+   }
+#endif
+}
+
 size_t state_manager_raw_compress(const void *src,
       const void *dst, size_t len, void *patch)
 {
@@ -389,16 +673,451 @@ static INLINE size_t read_size_t(const void *ptr)
 }
 
 
-state_manager_t *state_manager_new(size_t state_size, size_t buffer_size)
+static INLINE void write_entry_header(uint8_t *ptr,
+      uint32_t type, uint32_t size)
+{
+   memcpy(ptr, &type, sizeof(type));
+   memcpy(ptr + sizeof(type), &size, sizeof(size));
+}
+
+static INLINE uint32_t read_entry_type(const uint8_t *entry)
+{
+   uint32_t ret;
+
+   memcpy(&ret, entry + sizeof(size_t), sizeof(ret));
+   return ret;
+}
+
+static INLINE uint32_t read_entry_size(const uint8_t *entry)
+{
+   uint32_t ret;
+
+   memcpy(&ret, entry + sizeof(size_t) + sizeof(uint32_t), sizeof(ret));
+   return ret;
+}
+
+static INLINE const uint8_t *entry_payload(const uint8_t *entry)
+{
+   return entry + sizeof(size_t) + REWIND_ENTRY_HEADER_SIZE;
+}
+
+static struct state_manager_keyframe *state_manager_keyframe_at(
+      state_manager_t *state, size_t idx)
+{
+   return &state->keyframes[(state->keyframes_first + idx)
+      % state->keyframes_size];
+}
+
+static bool state_manager_keyframe_push(state_manager_t *state,
+      size_t offset, uint64_t frame)
+{
+   struct state_manager_keyframe *keyframe = NULL;
+
+   if (state->keyframes_count == state->keyframes_size)
+   {
+      size_t i;
+      size_t new_size = state->keyframes_size ?
+         state->keyframes_size * 2 : 16;
+      struct state_manager_keyframe *keyframes =
+         (struct state_manager_keyframe*)
+         malloc(new_size * sizeof(*keyframes));
+
+      if (!keyframes)
+         return false;
+
+      for (i = 0; i < state->keyframes_count; i++)
+         keyframes[i] = *state_manager_keyframe_at(state, i);
+
+      free(state->keyframes);
+      state->keyframes       = keyframes;
+      state->keyframes_size  = new_size;
+      state->keyframes_first = 0;
+   }
+
+   keyframe = state_manager_keyframe_at(state, state->keyframes_count++);
+   keyframe->offset = offset;
+   keyframe->frame  = frame;
+   return true;
+}
+
+/**
+ * state_manager_drop_tail:
+ * @state              : pointer to state manager
+ *
+ * Discards the oldest entry in the ring buffer.
+ **/
+static void state_manager_drop_tail(state_manager_t *state)
+{
+   if (read_entry_type(state->tail) >= REWIND_ENTRY_KEYFRAME)
+   {
+      if (state->keyframes_count)
+      {
+         state->keyframes_first = (state->keyframes_first + 1)
+            % state->keyframes_size;
+         state->keyframes_count--;
+      }
+   }
+   else
+      state->entries--;
+
+   state->tail = state->data + read_size_t(state->tail);
+}
+
+/**
+ * state_manager_entry_begin:
+ * @state              : pointer to state manager
+ *
+ * Makes room for a new entry at the head of the ring buffer.
+ *
+ * Returns: where the payload of the new entry should be written.
+ **/
+static uint8_t *state_manager_entry_begin(state_manager_t *state)
+{
+   for (;;)
+   {
+      size_t headpos   = state->head - state->data;
+      size_t tailpos   = state->tail - state->data;
+      size_t remaining = (tailpos + state->capacity -
+            sizeof(size_t) - headpos - 1) % state->capacity + 1;
+
+      if (remaining > state->maxcompsize)
+         break;
+
+      state_manager_drop_tail(state);
+   }
+
+   return state->head + sizeof(size_t) + REWIND_ENTRY_HEADER_SIZE;
+}
+
+/**
+ * state_manager_entry_end:
+ * @state              : pointer to state manager
+ * @type               : type of the entry
+ * @size               : size of the payload
+ *
+ * Commits the entry started by state_manager_entry_begin().
+ **/
+static void state_manager_entry_end(state_manager_t *state,
+      uint32_t type, size_t size)
+{
+   uint8_t *compressed = state->head + sizeof(size_t);
+
+   write_entry_header(compressed, type, size);
+   compressed += REWIND_ENTRY_HEADER_SIZE + REWIND_ENTRY_ALIGN(size);
+
+   if (compressed - state->data + state->maxcompsize > state->capacity)
+   {
+      compressed = state->data;
+      if (state->tail == state->data + sizeof(size_t))
+         state_manager_drop_tail(state);
+   }
+   write_size_t(compressed, state->head-state->data);
+   compressed += sizeof(size_t);
+   write_size_t(state->head, compressed-state->data);
+   state->head = compressed;
+}
+
+#ifdef HAVE_ZLIB_DEFLATE
+/* Deflates @in into @out, which must hold @in_size bytes.
+ * Fails if the result isn't smaller than the input. */
+static bool state_manager_deflate(state_manager_t *state,
+      const uint8_t *in, size_t in_size, uint8_t *out, size_t *out_size)
+{
+   bool ret;
+
+   zlib_set_stream(state->zstream, in_size, in_size, in, out);
+   zlib_deflate_init(state->zstream, 1);
+
+   ret       = zlib_deflate_data_to_file(state->zstream) == 1;
+   *out_size = zlib_stream_get_total_out(state->zstream);
+
+   zlib_stream_deflate_free(state->zstream);
+   return ret && *out_size < in_size;
+}
+
+static bool state_manager_inflate(state_manager_t *state,
+      const uint8_t *in, size_t in_size, uint8_t *out, size_t out_size)
+{
+   int ret = -1;
+
+   zlib_set_stream(state->zstream, in_size, out_size, in, out);
+   if (!zlib_inflate_init(state->zstream))
+      return false;
+
+   do
+   {
+      ret = zlib_inflate_data_to_file_iterate(state->zstream);
+   } while (ret == 0 && zlib_stream_get_avail_in(state->zstream)
+         && zlib_stream_get_avail_out(state->zstream));
+
+   zlib_stream_free(state->zstream);
+   return ret == 1;
+}
+#endif
+
+/**
+ * state_manager_append:
+ * @state              : pointer to state manager
+ * @newb               : newly serialized state
+ * @frame              : frame number of @newb
+ *
+ * Compresses the delta between @newb and the last pushed state
+ * and appends it to the ring buffer, discarding the oldest entries
+ * if necessary. Also stores @newb as keyframe if one is due.
+ **/
+static void state_manager_append(state_manager_t *state,
+      const uint8_t *newb, uint64_t frame)
+{
+   static struct retro_perf_counter gen_deltas = {0};
+   uint32_t type    = REWIND_ENTRY_DELTA;
+   size_t size      = 0;
+   uint8_t *payload = state_manager_entry_begin(state);
+
+   rarch_perf_init(&gen_deltas, "gen_deltas");
+   retro_perf_start(&gen_deltas);
+
+#ifdef HAVE_ZLIB_DEFLATE
+   if (state->deltabuf)
+   {
+      size_t len = state_manager_raw_compress(state->thisblock,
+            newb, state->blocksize, state->deltabuf);
+
+      if (state_manager_deflate(state, state->deltabuf, len,
+               payload, &size))
+         type = REWIND_ENTRY_DELTA_Z;
+      else
+      {
+         memcpy(payload, state->deltabuf, len);
+         size = len;
+      }
+   }
+   else
+#endif
+      size = state_manager_raw_compress(state->thisblock,
+            newb, state->blocksize, payload);
+
+   state_manager_entry_end(state, type, size);
+
+   retro_perf_stop(&gen_deltas);
+
+   if (state->keyframe_interval && !(frame % state->keyframe_interval))
+   {
+      static struct retro_perf_counter gen_keyframes = {0};
+      size_t offset;
+
+      rarch_perf_init(&gen_keyframes, "gen_keyframes");
+      retro_perf_start(&gen_keyframes);
+
+      type    = REWIND_ENTRY_KEYFRAME;
+      payload = state_manager_entry_begin(state);
+      offset  = state->head - state->data;
+
+#ifdef HAVE_ZLIB_DEFLATE
+      if (state->zstream && state_manager_deflate(state, newb,
+               state->blocksize, payload, &size))
+         type = REWIND_ENTRY_KEYFRAME_Z;
+      else
+#endif
+      {
+         memcpy(payload, newb, state->blocksize);
+         size = state->blocksize;
+      }
+
+      state_manager_entry_end(state, type, size);
+      state_manager_keyframe_push(state, offset, frame);
+
+      retro_perf_stop(&gen_keyframes);
+   }
+}
+
+/**
+ * state_manager_unwind:
+ * @state              : pointer to state manager
+ *
+ * Applies the newest delta in the ring buffer to thisblock,
+ * skipping over keyframes.
+ *
+ * Returns: true if there was a delta to apply, otherwise false.
+ **/
+static bool state_manager_unwind(state_manager_t *state)
+{
+   for (;;)
+   {
+      const uint8_t *entry, *payload;
+      uint32_t type;
+
+      if (state->head == state->tail)
+         return false;
+
+      entry   = state->data + read_size_t(state->head - sizeof(size_t));
+      type    = read_entry_type(entry);
+      payload = entry_payload(entry);
+
+      state->head = (uint8_t*)entry;
+
+      if (type >= REWIND_ENTRY_KEYFRAME)
+      {
+         /* Not needed, we already have this state in thisblock. */
+         if (state->keyframes_count)
+            state->keyframes_count--;
+         continue;
+      }
+
+#ifdef HAVE_ZLIB_DEFLATE
+      if (type == REWIND_ENTRY_DELTA_Z)
+      {
+         if (!state_manager_inflate(state, payload,
+                  read_entry_size(entry), state->deltabuf,
+                  state_manager_raw_maxsize(state->blocksize)))
+            return false;
+         payload = state->deltabuf;
+      }
+#endif
+
+      state_manager_raw_decompress(payload, state->maxcompsize,
+            state->thisblock, state->blocksize);
+
+      state->entries--;
+      state->frame--;
+      return true;
+   }
+}
+
+#ifdef HAVE_THREADS
+/**
+ * state_manager_thread:
+ * @data               : pointer to state manager
+ *
+ * Worker loop; compresses each state handed over by
+ * state_manager_push_do() against the previous one.
+ **/
+static void state_manager_thread(void *data)
+{
+   state_manager_t *state = (state_manager_t*)data;
+
+   slock_lock(state->lock);
+
+   for (;;)
+   {
+      uint8_t *newb = NULL;
+
+      while (!state->pendingblock && !state->quit)
+         scond_wait(state->cond, state->lock);
+
+      if (!state->pendingblock)
+         break;
+
+      newb = state->pendingblock;
+      slock_unlock(state->lock);
+
+      state_manager_append(state, newb, state->frame + 1);
+
+      slock_lock(state->lock);
+      state->spareblock   = state->thisblock;
+      state->thisblock    = newb;
+      state->pendingblock = NULL;
+      state->entries++;
+      state->frame++;
+      scond_signal(state->cond);
+   }
+
+   slock_unlock(state->lock);
+}
+
+/**
+ * state_manager_wait_idle:
+ * @state              : pointer to state manager
+ *
+ * Blocks until the worker has finished with the last
+ * pushed state, so the ring buffer can be safely accessed.
+ *
+ * Returns: number of states that were still queued for the worker.
+ **/
+static unsigned state_manager_wait_idle(state_manager_t *state)
+{
+   static struct retro_perf_counter rewind_queue_full = {0};
+   unsigned depth = 0;
+
+   if (!state->thread)
+      return 0;
+
+   slock_lock(state->lock);
+   if (state->pendingblock)
+   {
+      depth = 1;
+
+      /* Calls of this counter are the number of times the queue was
+       * still occupied, its time is how long we stalled on it. */
+      rarch_perf_init(&rewind_queue_full, "rewind_queue_full");
+      retro_perf_start(&rewind_queue_full);
+
+      while (state->pendingblock)
+         scond_wait(state->cond, state->lock);
+
+      retro_perf_stop(&rewind_queue_full);
+   }
+   slock_unlock(state->lock);
+
+   return depth;
+}
+
+static void state_manager_thread_init(state_manager_t *state,
+      size_t state_size)
+{
+   state->spareblock = (uint8_t*)state_manager_raw_alloc(state_size, 2);
+   state->lock       = slock_new();
+   state->cond       = scond_new();
+
+   if (state->spareblock && state->lock && state->cond)
+      state->thread  = sthread_create(state_manager_thread, state);
+
+   if (state->thread)
+      return;
+
+   /* Fall back to compressing on the main thread. */
+   RARCH_WARN("Failed to start rewind thread, compressing synchronously.\n");
+
+   if (state->lock)
+      slock_free(state->lock);
+   if (state->cond)
+      scond_free(state->cond);
+   free(state->spareblock);
+   state->lock       = NULL;
+   state->cond       = NULL;
+   state->spareblock = NULL;
+}
+
+static void state_manager_thread_deinit(state_manager_t *state)
+{
+   if (state->thread)
+   {
+      slock_lock(state->lock);
+      state->quit = true;
+      scond_signal(state->cond);
+      slock_unlock(state->lock);
+
+      sthread_join(state->thread);
+      slock_free(state->lock);
+      scond_free(state->cond);
+   }
+
+   free(state->spareblock);
+}
+#endif
+
+state_manager_t *state_manager_new(size_t state_size, size_t buffer_size,
+      unsigned keyframe_interval)
 {
    state_manager_t *state = (state_manager_t*)calloc(1, sizeof(*state));
 
    if (!state)
       return NULL;
 
-   state->blocksize   = (state_size + sizeof(uint16_t) - 1) & ~sizeof(uint16_t);
-   /* the compressed data is surrounded by pointers to the other side */
-   state->maxcompsize = state_manager_raw_maxsize(state_size) + sizeof(size_t) * 2;
+   state->blocksize   = (state_size + sizeof(uint16_t) - 1) & ~(sizeof(uint16_t) - 1);
+   /* the compressed data is surrounded by pointers to the other side,
+    * and preceded by an entry header */
+   state->maxcompsize = state_manager_raw_maxsize(state_size) + sizeof(size_t) * 3
+      + REWIND_ENTRY_HEADER_SIZE;
    state->data        = (uint8_t*)malloc(buffer_size);
 
    state->thisblock   = (uint8_t*)state_manager_raw_alloc(state_size, 0);
@@ -411,6 +1130,27 @@ state_manager_t *state_manager_new(size_t state_size, size_t buffer_size)
    state->head = state->data + sizeof(size_t);
    state->tail = state->data + sizeof(size_t);
 
+   state->keyframe_interval = keyframe_interval;
+
+#ifdef HAVE_ZLIB_DEFLATE
+   /* Keyframes make rewinding far back cheap, so spend the saved
+    * time on packing the deltas tighter. */
+   if (keyframe_interval)
+   {
+      state->zstream  = zlib_stream_new();
+      state->deltabuf = (uint8_t*)malloc(
+            state_manager_raw_maxsize(state_size));
+      if (!state->zstream || !state->deltabuf)
+         goto error;
+   }
+#endif
+
+   state_manager_raw_init_simd();
+
+#ifdef HAVE_THREADS
+   state_manager_thread_init(state, state_size);
+#endif
+
    return state;
 
 error:
@@ -423,20 +1163,27 @@ void state_manager_free(state_manager_t *state)
    if (!state)
       return;
 
+#ifdef HAVE_THREADS
+   state_manager_thread_deinit(state);
+#endif
+
    free(state->data);
    free(state->thisblock);
    free(state->nextblock);
+   free(state->keyframes);
+   free(state->deltabuf);
+   free(state->zstream);
    free(state);
 }
 
 bool state_manager_pop(state_manager_t *state, const void **data)
 {
-   size_t start;
-   uint8_t *out                 = NULL;
-   const uint8_t *compressed    = NULL;
-
    *data = NULL;
 
+#ifdef HAVE_THREADS
+   state_manager_wait_idle(state);
+#endif
+
    if (state->thisblock_valid)
    {
       state->thisblock_valid = false;
@@ -445,18 +1192,90 @@ bool state_manager_pop(state_manager_t *state, const void **data)
       return true;
    }
 
-   if (state->head == state->tail)
+   if (!state_manager_unwind(state))
       return false;
 
-   start = read_size_t(state->head - sizeof(size_t));
-   state->head = state->data + start;
+   *data = state->thisblock;
+   return true;
+}
 
-   compressed = state->data + start + sizeof(size_t);
-   out = state->thisblock;
+bool state_manager_seek(state_manager_t *state, unsigned count,
+      const void **data)
+{
+   size_t i;
+   uint64_t target;
+   bool moved                             = false;
+   const struct state_manager_keyframe *keyframe = NULL;
+
+   *data = NULL;
+
+   if (!count)
+      return false;
+
+#ifdef HAVE_THREADS
+   state_manager_wait_idle(state);
+#endif
+
+   if (state->thisblock_valid)
+   {
+      state->thisblock_valid = false;
+      state->entries--;
+      moved = true;
+      count--;
+   }
+
+   target = (count < state->frame) ? state->frame - count : 0;
+
+   /* Find the oldest keyframe that is not older than the target. */
+   for (i = state->keyframes_count; i-- > 0; )
+   {
+      const struct state_manager_keyframe *cur =
+         state_manager_keyframe_at(state, i);
+
+      if (cur->frame < target)
+         break;
+      if (cur->frame < state->frame)
+         keyframe = cur;
+   }
+
+   if (keyframe)
+   {
+      uint8_t *entry = state->data + keyframe->offset;
+      uint32_t type  = read_entry_type(entry);
+      uint64_t frame = keyframe->frame;
+
+      (void)type;
+
+#ifdef HAVE_ZLIB_DEFLATE
+      if (type == REWIND_ENTRY_KEYFRAME_Z)
+      {
+         if (!state_manager_inflate(state, entry_payload(entry),
+                  read_entry_size(entry), state->thisblock,
+                  state->blocksize))
+            return false;
+      }
+      else
+#endif
+         memcpy(state->thisblock, entry_payload(entry), state->blocksize);
+
+      /* Everything newer than the keyframe is gone now. */
+      while (state->keyframes_count &&
+            state_manager_keyframe_at(state,
+               state->keyframes_count - 1)->frame >= frame)
+         state->keyframes_count--;
+
+      state->head     = entry;
+      state->entries -= (unsigned)(state->frame - frame);
+      state->frame    = frame;
+      moved           = true;
+   }
 
-   state_manager_raw_decompress(compressed, state->maxcompsize, out, state->blocksize);
+   while (state->frame > target && state_manager_unwind(state))
+      moved = true;
+
+   if (!moved)
+      return false;
 
-   state->entries--;
    *data = state->thisblock;
    return true;
 }
@@ -482,55 +1301,53 @@ void state_manager_push_where(state_manager_t *state, void **data)
 
 void state_manager_push_do(state_manager_t *state)
 {
-   static struct retro_perf_counter gen_deltas = {0};
+#ifdef HAVE_THREADS
+   static struct retro_perf_counter rewind_queue_depth = {0};
+#endif
    uint8_t *swap = NULL;
 
    if (state->thisblock_valid)
    {
-      const uint8_t *oldb, *newb;
-      uint8_t *compressed;
-      size_t headpos, tailpos, remaining;
       if (state->capacity < sizeof(size_t) + state->maxcompsize)
          return;
 
-recheckcapacity:;
-
-      headpos = state->head - state->data;
-      tailpos = state->tail - state->data;
-      remaining = (tailpos + state->capacity -
-            sizeof(size_t) - headpos - 1) % state->capacity + 1;
-
-      if (remaining <= state->maxcompsize)
+#ifdef HAVE_THREADS
+      if (state->thread)
       {
-         state->tail = state->data + read_size_t(state->tail);
-         state->entries--;
-         goto recheckcapacity;
-      }
-
-      rarch_perf_init(&gen_deltas, "gen_deltas");
-      retro_perf_start(&gen_deltas);
-
-      oldb = state->thisblock;
-      newb = state->nextblock;
-      compressed = state->head + sizeof(size_t);
-
-      compressed += state_manager_raw_compress(oldb, newb, state->blocksize, compressed);
+         /* Staging buffers are double-buffered; we only have to wait
+          * here if the worker is still busy with the previous state. */
+         unsigned depth = state_manager_wait_idle(state);
+
+         /* One run per hand-off, sampling how many states were still
+          * queued; the depth is counted in hundredths of a state so
+          * that ticks per run reads as the average depth in percent. */
+         rarch_perf_init(&rewind_queue_depth, "rewind_queue_depth");
+         if (rewind_queue_depth.registered)
+         {
+            rewind_queue_depth.total += depth * 100;
+            rewind_queue_depth.call_cnt++;
+         }
 
-      if (compressed - state->data + state->maxcompsize > state->capacity)
-      {
-         compressed = state->data;
-         if (state->tail == state->data + sizeof(size_t))
-            state->tail = state->data + read_size_t(state->tail);
+         slock_lock(state->lock);
+         state->pendingblock = state->nextblock;
+         state->nextblock    = state->spareblock;
+         state->spareblock   = NULL;
+         scond_signal(state->cond);
+         slock_unlock(state->lock);
+         return;
       }
-      write_size_t(compressed, state->head-state->data);
-      compressed += sizeof(size_t);
-      write_size_t(state->head, compressed-state->data);
-      state->head = compressed;
+#endif
 
-      retro_perf_stop(&gen_deltas);
+      state_manager_append(state, state->nextblock, state->frame + 1);
+      state->frame++;
    }
    else
+   {
+#ifdef HAVE_THREADS
+      state_manager_wait_idle(state);
+#endif
       state->thisblock_valid = true;
+   }
 
    swap             = state->thisblock;
    state->thisblock = state->nextblock;
@@ -542,9 +1359,15 @@ recheckcapacity:;
 void state_manager_capacity(state_manager_t *state,
       unsigned *entries, size_t *bytes, bool *full)
 {
-   size_t headpos   = state->head - state->data;
-   size_t tailpos   = state->tail - state->data;
-   size_t remaining = (tailpos + state->capacity -
+   size_t headpos, tailpos, remaining;
+
+#ifdef HAVE_THREADS
+   state_manager_wait_idle(state);
+#endif
+
+   headpos   = state->head - state->data;
+   tailpos   = state->tail - state->data;
+   remaining = (tailpos + state->capacity -
          sizeof(size_t) - headpos - 1) % state->capacity + 1;
 
    if (entries)
@@ -584,7 +1407,7 @@ void init_rewind(void)
          (unsigned)(settings->rewind_buffer_size / 1000000));
 
    global->rewind.state = state_manager_new(global->rewind.size,
-         settings->rewind_buffer_size);
+         settings->rewind_buffer_size, settings->rewind_keyframe_interval);
 
    if (!global->rewind.state)
       RARCH_WARN("%s.\n", msg_hash_to_str(MSG_REWIND_INIT_FAILED));
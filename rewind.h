@@ -28,12 +28,20 @@ extern "C" {
 
 typedef struct state_manager state_manager_t;
 
-state_manager_t *state_manager_new(size_t state_size, size_t buffer_size);
+/* If keyframe_interval is non-zero, a full state is stored every keyframe_interval pushes. */
+state_manager_t *state_manager_new(size_t state_size, size_t buffer_size,
+      unsigned keyframe_interval);
 
 void state_manager_free(state_manager_t *state);
 
 bool state_manager_pop(state_manager_t *state, const void **data);
 
+/*
+ * Same as calling state_manager_pop() 'count' times, returning the last state.
+ * With keyframes enabled, this takes at most keyframe_interval steps.
+ */
+bool state_manager_seek(state_manager_t *state, unsigned count, const void **data);
+
 void state_manager_push_where(state_manager_t *state, void **data);
 
 void state_manager_push_do(state_manager_t *state);
@@ -68,6 +76,12 @@ size_t state_manager_raw_compress(const void *src, const void *dst, size_t len,
  */
 void state_manager_raw_decompress(const void *patch, size_t patchlen, void *data, size_t datalen);
 
+/*
+ * Picks the delta scan kernels used by state_manager_raw_compress() based on CPU features.
+ * Called by state_manager_new(); standalone users of the raw API should call it once.
+ */
+void state_manager_raw_init_simd(void);
+
 bool state_manager_frame_is_reversed(void);
 
 void state_manager_set_frame_is_reversed(bool value);
@@ -166,6 +166,7 @@ static void check_rewind(settings_t *settings,
       global_t *global, bool pressed)
 {
    static bool first = true;
+   static unsigned held = 0;
 
    if (state_manager_frame_is_reversed())
    {
@@ -185,8 +186,30 @@ static void check_rewind(settings_t *settings,
    if (pressed)
    {
       const void *buf    = NULL;
+      unsigned steps     = 1;
+
+      /* Every second rewind is held adds real time to its speed,
+       * that is one state per fps * granularity frames held. A seek
+       * never walks more than one keyframe interval of deltas, so
+       * cap the step there. Movies rewind frame by frame. */
+      if (settings->rewind_acceleration &&
+            settings->rewind_keyframe_interval && !global->bsv.movie)
+      {
+         const struct retro_system_av_info *av_info =
+            video_viewport_get_system_av_info();
+         double fps              = av_info->timing.fps > 0.0 ?
+            av_info->timing.fps : 60.0;
+         unsigned frames_per_step = (unsigned)(fps *
+               (settings->rewind_granularity ?
+                settings->rewind_granularity : 1) + 0.5);
+
+         steps = 1 + held / (frames_per_step ? frames_per_step : 1);
+         if (steps > settings->rewind_keyframe_interval)
+            steps = settings->rewind_keyframe_interval;
+      }
+      held++;
 
-      if (state_manager_pop(global->rewind.state, &buf))
+      if (state_manager_seek(global->rewind.state, steps, &buf))
       {
          state_manager_set_frame_is_reversed(true);
          audio_driver_setup_rewind();
@@ -206,6 +229,8 @@ static void check_rewind(settings_t *settings,
    {
       static unsigned cnt      = 0;
 
+      held = 0;
+
       cnt = (cnt + 1) % (settings->rewind_granularity ?
             settings->rewind_granularity : 1); /* Avoid possible SIGFPE. */
 
@@ -0,0 +1,550 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_WIN32) && !defined(_XBOX)
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+#include <boolean.h>
+#include <compat/strl.h>
+#include <retro_file.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#ifdef HAVE_ZLIB
+#include <file/file_extract.h>
+#endif
+
+#include "save_writer.h"
+#include "general.h"
+#include "msg_hash.h"
+#include "runloop.h"
+
+/* Compressed states start with this magic, followed by the
+ * uncompressed size as a little-endian 64-bit integer and
+ * a zlib stream. */
+#define SAVE_WRITER_MAGIC        "RZSTATE1"
+#define SAVE_WRITER_HEADER_SIZE  16
+#define SAVE_WRITER_DEFLATE_LEVEL 6
+
+typedef struct save_writer_job
+{
+   struct save_writer_job *next;
+   void *data;
+   size_t size;
+   unsigned flags;
+   unsigned type;
+   char path[PATH_MAX_LENGTH];
+   char msg[PATH_MAX_LENGTH];
+} save_writer_job_t;
+
+#ifdef HAVE_THREADS
+typedef struct save_writer
+{
+   sthread_t *thread;
+   slock_t *lock;
+   /* Signalled when a job is queued or the writer should quit. */
+   scond_t *cond;
+   /* Signalled when the queue has drained. */
+   scond_t *idle_cond;
+
+   save_writer_job_t *head;
+   save_writer_job_t *tail;
+   bool busy;
+   bool quit;
+} save_writer_t;
+
+static save_writer_t *save_writer_st;
+#endif
+
+/**
+ * dump_to_file_desperate:
+ * @data         : pointer to data buffer.
+ * @size         : size of @data.
+ * @type         : type of file to be saved.
+ *
+ * Attempt to save valuable RAM data somewhere.
+ **/
+static void dump_to_file_desperate(const void *data,
+      size_t size, unsigned type)
+{
+   time_t time_;
+   char path[PATH_MAX_LENGTH]    = {0};
+   char timebuf[PATH_MAX_LENGTH] = {0};
+#if defined(_WIN32) && !defined(_XBOX)
+   const char *base = getenv("APPDATA");
+#elif defined(__CELLOS_LV2__) || defined(_XBOX)
+   const char *base = NULL;
+#else
+   const char *base = getenv("HOME");
+#endif
+
+   if (!base)
+      goto error;
+
+   snprintf(path, sizeof(path), "%s/RetroArch-recovery-%u", base, type);
+
+   time(&time_);
+
+   strftime(timebuf, sizeof(timebuf), "%Y-%m-%d-%H-%M-%S", localtime(&time_));
+   strlcat(path, timebuf, sizeof(path));
+
+   if (retro_write_file(path, data, size))
+      RARCH_WARN("Succeeded in saving RAM data to \"%s\".\n", path);
+   else
+      goto error;
+
+   return;
+
+error:
+   RARCH_WARN("Failed ... Cannot recover save file.\n");
+}
+
+#ifdef HAVE_ZLIB_DEFLATE
+/**
+ * save_writer_deflate:
+ * @data             : buffer to compress.
+ * @size             : size of @data.
+ * @out_size         : size of the returned buffer.
+ *
+ * Returns: @data with a header, deflated, or NULL if that
+ * wouldn't make it any smaller.
+ **/
+static uint8_t *save_writer_deflate(const void *data, size_t size,
+      size_t *out_size)
+{
+   unsigned i;
+   bool ret      = false;
+   uint8_t *out  = NULL;
+   void *stream  = NULL;
+
+   if (size <= SAVE_WRITER_HEADER_SIZE || size > UINT32_MAX)
+      return NULL;
+
+   out    = (uint8_t*)malloc(size);
+   stream = zlib_stream_new();
+
+   if (!out || !stream)
+      goto end;
+
+   memcpy(out, SAVE_WRITER_MAGIC, 8);
+   for (i = 0; i < 8; i++)
+      out[8 + i] = (uint8_t)((uint64_t)size >> (i * 8));
+
+   /* The output buffer is one header short of @size, so deflate
+    * only finishes if the compressed state is smaller. */
+   zlib_set_stream(stream, size, size - SAVE_WRITER_HEADER_SIZE,
+         (const uint8_t*)data, out + SAVE_WRITER_HEADER_SIZE);
+   zlib_deflate_init(stream, SAVE_WRITER_DEFLATE_LEVEL);
+
+   ret       = zlib_deflate_data_to_file(stream) == 1;
+   *out_size = SAVE_WRITER_HEADER_SIZE + zlib_stream_get_total_out(stream);
+
+   zlib_stream_deflate_free(stream);
+
+end:
+   free(stream);
+   if (!ret)
+   {
+      free(out);
+      return NULL;
+   }
+   return out;
+}
+#endif
+
+/**
+ * save_writer_rename:
+ * @src              : temporary file.
+ * @dst              : final path.
+ *
+ * Replaces @dst with @src.
+ **/
+static bool save_writer_rename(const char *src, const char *dst)
+{
+#if defined(_WIN32) && !defined(_XBOX)
+   return MoveFileExA(src, dst,
+         MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+#if defined(_WIN32)
+   /* rename() refuses to overwrite here. */
+   remove(dst);
+#endif
+   return rename(src, dst) == 0;
+#endif
+}
+
+bool save_writer_write_file(const char *path,
+      const void *data, size_t size)
+{
+   bool failed                   = false;
+   FILE *file                    = NULL;
+   char tmp_path[PATH_MAX_LENGTH] = {0};
+
+   strlcpy(tmp_path, path, sizeof(tmp_path));
+   if (strlcat(tmp_path, ".tmp", sizeof(tmp_path)) >= sizeof(tmp_path))
+      return false;
+
+   file = fopen(tmp_path, "wb");
+   if (!file)
+      return false;
+
+   failed |= fwrite(data, 1, size, file) != size;
+   failed |= fflush(file) != 0;
+#if defined(__unix__) || defined(__APPLE__)
+   failed |= fsync(fileno(file)) != 0;
+#endif
+   failed |= fclose(file) != 0;
+
+   if (!failed)
+      failed = !save_writer_rename(tmp_path, path);
+
+   if (failed)
+      remove(tmp_path);
+
+   return !failed;
+}
+
+/**
+ * save_writer_process:
+ * @job              : job to write out.
+ *
+ * Writes @job and reports the outcome.
+ *
+ * Returns: true if successful, otherwise false.
+ **/
+static bool save_writer_process(const save_writer_job_t *job)
+{
+   bool ret         = false;
+   uint8_t *packed  = NULL;
+   size_t size      = job->size;
+   const void *data = job->data;
+
+#ifdef HAVE_ZLIB_DEFLATE
+   if (job->flags & SAVE_WRITER_COMPRESS)
+   {
+      packed = save_writer_deflate(job->data, job->size, &size);
+      if (packed)
+         data = packed;
+      else
+         size = job->size;
+   }
+#endif
+
+   ret = save_writer_write_file(job->path, data, size);
+   free(packed);
+
+   if (ret)
+   {
+      RARCH_LOG("%s \"%s\" (%u %s).\n",
+            msg_hash_to_str(MSG_SAVED_SUCCESSFULLY_TO),
+            job->path,
+            (unsigned)size,
+            msg_hash_to_str(MSG_BYTES));
+      if (*job->msg)
+         rarch_main_msg_queue_push(job->msg, 2, 180, true);
+   }
+   else if (job->flags & SAVE_WRITER_SRAM)
+   {
+      RARCH_ERR("%s.\n",
+            msg_hash_to_str(MSG_FAILED_TO_SAVE_SRAM));
+      RARCH_WARN("Attempting to recover ...\n");
+      dump_to_file_desperate(job->data, job->size, job->type);
+   }
+   else
+   {
+      /* Room for the message itself as well as a full path. */
+      char msg[PATH_MAX_LENGTH + 128] = {0};
+
+      snprintf(msg, sizeof(msg), "%s \"%s\".",
+            msg_hash_to_str(MSG_FAILED_TO_SAVE_STATE_TO),
+            job->path);
+      RARCH_ERR("%s\n", msg);
+      rarch_main_msg_queue_push(msg, 2, 180, true);
+   }
+
+   return ret;
+}
+
+static void save_writer_job_free(save_writer_job_t *job)
+{
+   if (!job)
+      return;
+   if (!(job->flags & SAVE_WRITER_SYNC))
+      free(job->data);
+   free(job);
+}
+
+#ifdef HAVE_THREADS
+/**
+ * save_writer_thread:
+ * @data             : pointer to save writer object.
+ *
+ * Writes queued jobs until asked to quit with an empty queue.
+ **/
+static void save_writer_thread(void *data)
+{
+   save_writer_t *writer = (save_writer_t*)data;
+
+   slock_lock(writer->lock);
+
+   for (;;)
+   {
+      save_writer_job_t *job = NULL;
+
+      while (!writer->head && !writer->quit)
+         scond_wait(writer->cond, writer->lock);
+
+      job = writer->head;
+      if (!job)
+         break;
+
+      writer->head = job->next;
+      if (!writer->head)
+         writer->tail = NULL;
+      writer->busy = true;
+      slock_unlock(writer->lock);
+
+      save_writer_process(job);
+      save_writer_job_free(job);
+
+      slock_lock(writer->lock);
+      writer->busy = false;
+      if (!writer->head)
+         scond_broadcast(writer->idle_cond);
+   }
+
+   slock_unlock(writer->lock);
+}
+
+static void save_writer_free(save_writer_t *writer)
+{
+   if (!writer)
+      return;
+
+   if (writer->lock)
+      slock_free(writer->lock);
+   if (writer->cond)
+      scond_free(writer->cond);
+   if (writer->idle_cond)
+      scond_free(writer->idle_cond);
+   free(writer);
+}
+
+static save_writer_t *save_writer_new(void)
+{
+   save_writer_t *writer = (save_writer_t*)calloc(1, sizeof(*writer));
+
+   if (!writer)
+      return NULL;
+
+   writer->lock      = slock_new();
+   writer->cond      = scond_new();
+   writer->idle_cond = scond_new();
+
+   if (!writer->lock || !writer->cond || !writer->idle_cond)
+      goto error;
+
+   writer->thread    = sthread_create(save_writer_thread, writer);
+   if (!writer->thread)
+      goto error;
+
+   return writer;
+
+error:
+   save_writer_free(writer);
+   return NULL;
+}
+#endif
+
+bool save_writer_push(const char *path, void *data, size_t size,
+      unsigned flags, unsigned type, const char *msg)
+{
+   bool ret               = false;
+   save_writer_job_t *job = NULL;
+#ifdef HAVE_THREADS
+   save_writer_job_t *cur = NULL;
+#endif
+
+   if (!path || !data)
+      return false;
+
+   job = (save_writer_job_t*)calloc(1, sizeof(*job));
+   if (!job)
+   {
+      if (!(flags & SAVE_WRITER_SYNC))
+         free(data);
+      return false;
+   }
+
+   job->data  = data;
+   job->size  = size;
+   job->flags = flags;
+   job->type  = type;
+   strlcpy(job->path, path, sizeof(job->path));
+   if (msg)
+      strlcpy(job->msg, msg, sizeof(job->msg));
+
+#ifdef HAVE_THREADS
+   if (!(flags & SAVE_WRITER_SYNC))
+   {
+      if (!save_writer_st)
+         save_writer_st = save_writer_new();
+      if (!save_writer_st)
+         goto sync;
+
+      slock_lock(save_writer_st->lock);
+
+      /* Anything still in the queue hasn't been started yet,
+       * so a newer save to the same file simply takes its place. */
+      for (cur = save_writer_st->head; cur; cur = cur->next)
+      {
+         if (strcmp(cur->path, job->path) != 0)
+            continue;
+
+         free(cur->data);
+         cur->data  = job->data;
+         cur->size  = job->size;
+         cur->flags = job->flags;
+         cur->type  = job->type;
+         strlcpy(cur->msg, job->msg, sizeof(cur->msg));
+         free(job);
+         job = NULL;
+         break;
+      }
+
+      if (job)
+      {
+         if (save_writer_st->tail)
+            save_writer_st->tail->next = job;
+         else
+            save_writer_st->head       = job;
+         save_writer_st->tail          = job;
+      }
+
+      scond_signal(save_writer_st->cond);
+      slock_unlock(save_writer_st->lock);
+      return true;
+   }
+
+sync:
+   /* Keep writes to the same file in order. */
+   save_writer_flush();
+#endif
+
+   ret = save_writer_process(job);
+   save_writer_job_free(job);
+   return ret;
+}
+
+void save_writer_flush(void)
+{
+#ifdef HAVE_THREADS
+   if (!save_writer_st)
+      return;
+
+   slock_lock(save_writer_st->lock);
+   while (save_writer_st->head || save_writer_st->busy)
+      scond_wait(save_writer_st->idle_cond, save_writer_st->lock);
+   slock_unlock(save_writer_st->lock);
+#endif
+}
+
+void save_writer_deinit(void)
+{
+#ifdef HAVE_THREADS
+   if (!save_writer_st)
+      return;
+
+   slock_lock(save_writer_st->lock);
+   save_writer_st->quit = true;
+   scond_signal(save_writer_st->cond);
+   slock_unlock(save_writer_st->lock);
+
+   sthread_join(save_writer_st->thread);
+   save_writer_free(save_writer_st);
+   save_writer_st = NULL;
+#endif
+}
+
+bool save_writer_decompress(void **buf, ssize_t *size)
+{
+#ifdef HAVE_ZLIB
+   int ret          = 0;
+   unsigned i;
+   uint64_t out_size = 0;
+   uint8_t *out     = NULL;
+   void *stream     = NULL;
+#endif
+   const uint8_t *in = (const uint8_t*)*buf;
+
+   if (!in || *size < SAVE_WRITER_HEADER_SIZE
+         || memcmp(in, SAVE_WRITER_MAGIC, 8) != 0)
+      return true;
+
+#ifdef HAVE_ZLIB
+   for (i = 0; i < 8; i++)
+      out_size |= (uint64_t)in[8 + i] << (i * 8);
+
+   if (!out_size || out_size > UINT32_MAX
+         || *size - SAVE_WRITER_HEADER_SIZE > UINT32_MAX)
+      goto error;
+
+   out    = (uint8_t*)malloc((size_t)out_size);
+   stream = zlib_stream_new();
+
+   if (!out || !stream)
+      goto error;
+
+   zlib_set_stream(stream, *size - SAVE_WRITER_HEADER_SIZE,
+         (uint32_t)out_size, in + SAVE_WRITER_HEADER_SIZE, out);
+   if (!zlib_inflate_init(stream))
+      goto error;
+
+   do
+   {
+      ret = zlib_inflate_data_to_file_iterate(stream);
+   } while (ret == 0 && zlib_stream_get_avail_in(stream)
+         && zlib_stream_get_avail_out(stream));
+
+   zlib_stream_free(stream);
+
+   if (ret != 1 || zlib_stream_get_total_out(stream) != out_size)
+      goto error;
+
+   free(stream);
+   free(*buf);
+   *buf  = out;
+   *size = (ssize_t)out_size;
+   return true;
+
+error:
+   free(stream);
+   free(out);
+#endif
+   RARCH_ERR("Failed to decompress savestate.\n");
+   return false;
+}
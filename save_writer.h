@@ -0,0 +1,107 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __RARCH_SAVE_WRITER_H
+#define __RARCH_SAVE_WRITER_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#include <boolean.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum save_writer_flags
+{
+   /* @data is a savestate; failures are reported as such. */
+   SAVE_WRITER_STATE    = (1 << 0),
+   /* @data is SRAM; failures fall back to a recovery dump. */
+   SAVE_WRITER_SRAM     = (1 << 1),
+   /* Deflate @data before writing it, if that makes it smaller. */
+   SAVE_WRITER_COMPRESS = (1 << 2),
+   /* Write on the calling thread. @data stays owned by the caller. */
+   SAVE_WRITER_SYNC     = (1 << 3)
+};
+
+/**
+ * save_writer_push:
+ * @path             : path that @data shall be written to.
+ * @data             : buffer to write, allocated with malloc().
+ * @size             : size of @data.
+ * @flags            : bitmask of enum save_writer_flags.
+ * @type             : memory type of @data, for SRAM recovery dumps.
+ * @msg              : message to queue once written, or NULL.
+ *
+ * Hands @data over to the background writer, which owns and
+ * frees it from now on. The file is written to a temporary
+ * file next to @path first and renamed over @path once complete,
+ * so a crash mid-write never leaves a truncated save behind.
+ * If a write to @path is still waiting in the queue, its data
+ * is replaced by @data.
+ *
+ * Returns: true if @data was queued (or written, when there is
+ * no writer thread), otherwise false.
+ **/
+bool save_writer_push(const char *path, void *data, size_t size,
+      unsigned flags, unsigned type, const char *msg);
+
+/**
+ * save_writer_write_file:
+ * @path             : path to write to.
+ * @data             : buffer to write.
+ * @size             : size of @data.
+ *
+ * Writes @data to a temporary file on the calling thread, syncs
+ * it and renames it over @path.
+ *
+ * Returns: true if successful, otherwise false.
+ **/
+bool save_writer_write_file(const char *path,
+      const void *data, size_t size);
+
+/**
+ * save_writer_flush:
+ *
+ * Blocks until all queued writes have hit the disk.
+ **/
+void save_writer_flush(void);
+
+/**
+ * save_writer_deinit:
+ *
+ * Finishes all queued writes and stops the writer thread.
+ **/
+void save_writer_deinit(void);
+
+/**
+ * save_writer_decompress:
+ * @buf              : buffer read from a file written by the writer.
+ * @size             : size of @buf.
+ *
+ * If @buf holds a compressed savestate, replaces it with the
+ * inflated state and updates @size. Other buffers are left alone.
+ *
+ * Returns: false if @buf is compressed but could not be inflated.
+ **/
+bool save_writer_decompress(void **buf, ssize_t *size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -36,14 +36,23 @@
 #if defined(HAVE_ZLIB_DEFLATE) && defined(HAVE_RPNG)
 #include <formats/rpng.h>
 #define IMG_EXT "png"
+#define HAVE_SCREENSHOT_PNG
 #else
 #define IMG_EXT "bmp"
 #endif
 
+#if defined(HAVE_SCREENSHOT_PNG) && defined(HAVE_THREADS)
+#include <rthreads/rthreads.h>
+#include <rthreads/thread_pool.h>
+#endif
+
 #include "general.h"
 #include "msg_hash.h"
 #include "gfx/scaler/scaler.h"
+#include "performance.h"
 #include "retroarch.h"
+#include "runloop.h"
+#include "save_writer.h"
 #include "screenshot.h"
 #include "gfx/video_driver.h"
 #include "gfx/video_viewport.h"
@@ -52,6 +61,226 @@
 #include "config.h"
 #endif
 
+#ifdef HAVE_SCREENSHOT_PNG
+/* Maximum number of screenshots waiting for the encoder. Taking
+ * another one blocks until one is written, so bulk captures
+ * can't pile up in memory. */
+#define SCREENSHOT_WRITER_MAX_PENDING 4
+
+typedef struct screenshot_job
+{
+   struct screenshot_job *next;
+   /* BGR24, top-down, tightly packed. */
+   uint8_t *data;
+   unsigned width;
+   unsigned height;
+   char path[PATH_MAX_LENGTH];
+} screenshot_job_t;
+
+#ifdef HAVE_THREADS
+typedef struct screenshot_writer
+{
+   sthread_t *thread;
+   slock_t *lock;
+   /* Signalled when a job is queued or the writer should quit. */
+   scond_t *cond;
+   /* Signalled when a job is done. */
+   scond_t *done_cond;
+   /* Spreads the encoding of each screenshot over all cores. */
+   thread_pool_t *pool;
+
+   screenshot_job_t *head;
+   screenshot_job_t *tail;
+   unsigned pending;
+   bool quit;
+} screenshot_writer_t;
+
+static screenshot_writer_t *screenshot_writer_st;
+#endif
+
+static void screenshot_job_free(screenshot_job_t *job)
+{
+   if (!job)
+      return;
+   free(job->data);
+   free(job);
+}
+
+/**
+ * screenshot_job_process:
+ * @job              : screenshot to write out.
+ * @pool             : thread pool to encode on, or NULL.
+ *
+ * Encodes @job to PNG and writes it to its path. The file only
+ * appears once it is complete.
+ *
+ * Returns: true if successful, otherwise false.
+ **/
+static bool screenshot_job_process(const screenshot_job_t *job,
+      thread_pool_t *pool)
+{
+   size_t size  = 0;
+   bool ret     = false;
+   uint8_t *png = rpng_encode_image_bgr24(job->data,
+         job->width, job->height, job->width * 3, pool, &size);
+
+   if (png)
+      ret = save_writer_write_file(job->path, png, size);
+
+   free(png);
+   return ret;
+}
+
+#ifdef HAVE_THREADS
+/**
+ * screenshot_writer_thread:
+ * @data             : pointer to screenshot writer object.
+ *
+ * Encodes and writes queued screenshots until asked to quit
+ * with an empty queue.
+ **/
+static void screenshot_writer_thread(void *data)
+{
+   screenshot_writer_t *writer = (screenshot_writer_t*)data;
+
+   slock_lock(writer->lock);
+
+   for (;;)
+   {
+      screenshot_job_t *job = NULL;
+
+      while (!writer->head && !writer->quit)
+         scond_wait(writer->cond, writer->lock);
+
+      job = writer->head;
+      if (!job)
+         break;
+
+      writer->head = job->next;
+      if (!writer->head)
+         writer->tail = NULL;
+      slock_unlock(writer->lock);
+
+      if (!screenshot_job_process(job, writer->pool))
+      {
+         RARCH_ERR("Failed to take screenshot.\n");
+         rarch_main_msg_queue_push(
+               msg_hash_to_str(MSG_FAILED_TO_TAKE_SCREENSHOT),
+               1, 180, true);
+      }
+      screenshot_job_free(job);
+
+      slock_lock(writer->lock);
+      writer->pending--;
+      scond_broadcast(writer->done_cond);
+   }
+
+   slock_unlock(writer->lock);
+}
+
+static void screenshot_writer_free(screenshot_writer_t *writer)
+{
+   if (!writer)
+      return;
+
+   if (writer->pool)
+      thread_pool_free(writer->pool);
+   if (writer->lock)
+      slock_free(writer->lock);
+   if (writer->cond)
+      scond_free(writer->cond);
+   if (writer->done_cond)
+      scond_free(writer->done_cond);
+   free(writer);
+}
+
+static screenshot_writer_t *screenshot_writer_new(void)
+{
+   screenshot_writer_t *writer = (screenshot_writer_t*)
+      calloc(1, sizeof(*writer));
+
+   if (!writer)
+      return NULL;
+
+   writer->lock      = slock_new();
+   writer->cond      = scond_new();
+   writer->done_cond = scond_new();
+
+   if (!writer->lock || !writer->cond || !writer->done_cond)
+      goto error;
+
+   /* A pool of its own, the video driver's pool runs per-frame
+    * work that must never queue behind a screenshot.
+    * Without it, screenshots are still encoded off the main
+    * thread, just not in parallel. */
+   writer->pool      = thread_pool_new(retro_get_cpu_cores());
+
+   writer->thread    = sthread_create(screenshot_writer_thread, writer);
+   if (!writer->thread)
+      goto error;
+
+   return writer;
+
+error:
+   screenshot_writer_free(writer);
+   return NULL;
+}
+
+/**
+ * screenshot_writer_push:
+ * @job              : screenshot to queue.
+ *
+ * Hands @job over to the screenshot writer, which owns and
+ * frees it from now on. Blocks while the writer is
+ * SCREENSHOT_WRITER_MAX_PENDING screenshots behind.
+ *
+ * Returns: true if @job was queued, false if there is no
+ * writer thread.
+ **/
+static bool screenshot_writer_push(screenshot_job_t *job)
+{
+   if (!screenshot_writer_st)
+      screenshot_writer_st = screenshot_writer_new();
+   if (!screenshot_writer_st)
+      return false;
+
+   slock_lock(screenshot_writer_st->lock);
+
+   while (screenshot_writer_st->pending >= SCREENSHOT_WRITER_MAX_PENDING)
+      scond_wait(screenshot_writer_st->done_cond,
+            screenshot_writer_st->lock);
+
+   if (screenshot_writer_st->tail)
+      screenshot_writer_st->tail->next = job;
+   else
+      screenshot_writer_st->head       = job;
+   screenshot_writer_st->tail          = job;
+   screenshot_writer_st->pending++;
+
+   scond_signal(screenshot_writer_st->cond);
+   slock_unlock(screenshot_writer_st->lock);
+   return true;
+}
+#endif
+#endif
+
+void screenshot_writer_deinit(void)
+{
+#if defined(HAVE_SCREENSHOT_PNG) && defined(HAVE_THREADS)
+   if (!screenshot_writer_st)
+      return;
+
+   slock_lock(screenshot_writer_st->lock);
+   screenshot_writer_st->quit = true;
+   scond_signal(screenshot_writer_st->cond);
+   slock_unlock(screenshot_writer_st->lock);
+
+   sthread_join(screenshot_writer_st->thread);
+   screenshot_writer_free(screenshot_writer_st);
+   screenshot_writer_st = NULL;
+#endif
+}
+
 /* Take frame bottom-up. */
 static bool screenshot_dump(const char *folder, const void *frame,
       unsigned width, unsigned height, int pitch, bool bgr24)
@@ -61,11 +290,12 @@ static bool screenshot_dump(const char *folder, const void *frame,
    char shotname[PATH_MAX_LENGTH] = {0};
    struct scaler_ctx scaler       = {0};
    RFILE *file                    = NULL;
-   uint8_t *out_buffer            = NULL;
+#ifdef HAVE_SCREENSHOT_PNG
+   screenshot_job_t *job          = NULL;
+#endif
    driver_t *driver               = driver_get_ptr();
 
    (void)file;
-   (void)out_buffer;
    (void)scaler;
    (void)driver;
 
@@ -85,11 +315,22 @@ static bool screenshot_dump(const char *folder, const void *frame,
       ret = true;
    else
       ret = false;
-#elif defined(HAVE_ZLIB_DEFLATE) && defined(HAVE_RPNG)
-   out_buffer = (uint8_t*)malloc(width * height * 3);
-   if (!out_buffer)
+#elif defined(HAVE_SCREENSHOT_PNG)
+   job = (screenshot_job_t*)calloc(1, sizeof(*job));
+   if (!job)
       return false;
 
+   job->data   = (uint8_t*)malloc(width * height * 3);
+   job->width  = width;
+   job->height = height;
+   strlcpy(job->path, filename, sizeof(job->path));
+
+   if (!job->data)
+   {
+      screenshot_job_free(job);
+      return false;
+   }
+
    scaler.in_width    = width;
    scaler.in_height   = height;
    scaler.out_width   = width;
@@ -98,6 +339,7 @@ static bool screenshot_dump(const char *folder, const void *frame,
    scaler.out_stride  = width * 3;
    scaler.out_fmt     = SCALER_FMT_BGR24;
    scaler.scaler_type = SCALER_TYPE_POINT;
+   scaler.pool        = video_driver_get_thread_pool();
 
    if (bgr24)
       scaler.in_fmt = SCALER_FMT_BGR24;
@@ -107,14 +349,21 @@ static bool screenshot_dump(const char *folder, const void *frame,
       scaler.in_fmt = SCALER_FMT_RGB565;
 
    scaler_ctx_gen_filter(&scaler);
-   scaler_ctx_scale(&scaler, out_buffer,
+   scaler_ctx_scale(&scaler, job->data,
          (const uint8_t*)frame + ((int)height - 1) * pitch);
    scaler_ctx_gen_reset(&scaler);
 
    RARCH_LOG("Using RPNG for PNG screenshots.\n");
-   ret = rpng_save_image_bgr24(filename,
-         out_buffer, width, height, width * 3);
-   free(out_buffer);
+
+#ifdef HAVE_THREADS
+   /* Encoding is left to the screenshot writer,
+    * so the frame doesn't have to wait for it. */
+   if (screenshot_writer_push(job))
+      return true;
+#endif
+
+   ret = screenshot_job_process(job, NULL);
+   screenshot_job_free(job);
 #else
    ret = rbmp_save_image(filename, frame, width, height, pitch, bgr24,
         (video_driver_get_pixel_format() == RETRO_PIXEL_FORMAT_XRGB8888) );
@@ -27,6 +27,14 @@ extern "C" {
 
 bool take_screenshot(void);
 
+/**
+ * screenshot_writer_deinit:
+ *
+ * Finishes all screenshots still being encoded and stops
+ * the screenshot writer thread.
+ **/
+void screenshot_writer_deinit(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -15,18 +15,25 @@
 
 #include <compat/strcasestr.h>
 #include <compat/strl.h>
+#include <retro_dirent.h>
 #include <retro_endianness.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "tasks.h"
 
 #ifdef HAVE_LIBRETRODB
 #include "../database_info.h"
 #endif
 
+#include "../core_info.h"
 #include "../dir_list_special.h"
 #include "../file_ops.h"
 #include "../msg_hash.h"
 #include "../general.h"
+#include "../performance.h"
 
 #define CB_DB_SCAN_FILE                0x70ce56d2U
 #define CB_DB_SCAN_FOLDER              0xde2bef8eU
@@ -41,24 +48,74 @@
 #define COLLECTION_SIZE                99999
 #endif
 
-typedef struct database_state_handle
+/* Upper bound on hashing workers; content scanning is
+ * mostly I/O bound past this point. */
+#define DATABASE_SCAN_MAX_THREADS      8
+
+/* Most files the matcher consumes per data runloop tick. */
+#define DATABASE_SCAN_MATCH_BATCH      64
+
+/* Most database entries added to the playlists per file. */
+#define DATABASE_SCAN_MAX_MATCHES      16
+
+#ifdef HAVE_LIBRETRODB
+
+typedef struct database_scan_item
 {
-   database_info_list_t *info;
-   struct string_list *list;
-   size_t list_index;
-   size_t entry_index;
+   char *path;
+   char *zip_name;
    uint32_t crc;
-   uint8_t *buf;
-   char zip_name[PATH_MAX_LENGTH];
-   char serial[4096];
-} database_state_handle_t;
+   char serial[32];
+   bool hashed;
+} database_scan_item_t;
+
+typedef struct database_scan_db
+{
+   content_playlist_t *playlist;
+   char playlist_base[PATH_MAX_LENGTH];
+} database_scan_db_t;
+
+typedef struct database_scan
+{
+   char root[PATH_MAX_LENGTH];
+   bool is_dir;
+   struct string_list *ext_list;
+   struct string_list *databases;
+
+   /* Filled in by the walker, hashed by the workers and
+    * consumed in order by the matcher. */
+   database_scan_item_t **items;
+   size_t count;
+   size_t cap;
+   size_t next_hash;
+   size_t next_match;
+
+   database_info_index_t *index;
+   database_scan_db_t *dbs;
+   unsigned num_dbs;
+
+   bool walk_done;
+   bool index_ready;
+   bool quit;
+
+   size_t matches;
+   retro_time_t start_time;
+
+   bool threaded;
+#ifdef HAVE_THREADS
+   slock_t *lock;
+   scond_t *cond;
+   sthread_t *walker;
+   sthread_t *indexer;
+   sthread_t *workers[DATABASE_SCAN_MAX_THREADS];
+   unsigned num_workers;
+#endif
+} database_scan_t;
 
 typedef struct db_handle
 {
-   database_state_handle_t state;
-   database_info_handle_t *handle;
+   database_scan_t *scan;
    msg_queue_t *msg_queue;
-   unsigned status;
 } db_handle_t;
 
 static db_handle_t *db_ptr;
@@ -74,58 +131,64 @@ bool rarch_main_data_db_pending_scan_finished(void)
    return true;
 }
 
-#ifdef HAVE_LIBRETRODB
-
-#ifdef HAVE_ZLIB
-static int zlib_compare_crc32(const char *name, const char *valid_exts,
-      const uint8_t *cdata, unsigned cmode, uint32_t csize, uint32_t size,
-      uint32_t crc32, void *userdata)
+static void database_scan_lock(database_scan_t *scan)
 {
-   database_state_handle_t *db_state = (database_state_handle_t*)userdata;
-    
-   db_state->crc = crc32;
+#ifdef HAVE_THREADS
+   if (scan->threaded)
+      slock_lock(scan->lock);
+#endif
+}
 
-   strlcpy(db_state->zip_name, name, sizeof(db_state->zip_name));
+static void database_scan_unlock(database_scan_t *scan)
+{
+#ifdef HAVE_THREADS
+   if (scan->threaded)
+      slock_unlock(scan->lock);
+#endif
+}
 
-#if 0
-   RARCH_LOG("Going to compare CRC 0x%x for %s\n", crc32, name);
+static void database_scan_wake(database_scan_t *scan)
+{
+#ifdef HAVE_THREADS
+   if (scan->threaded)
+      scond_broadcast(scan->cond);
 #endif
+}
+
+static bool database_scan_cancelled(database_scan_t *scan)
+{
+   bool quit;
+
+   database_scan_lock(scan);
+   quit = scan->quit;
+   database_scan_unlock(scan);
 
-   return 1;
+   return quit;
 }
-#endif
 
-static int database_info_iterate_start
-(database_info_handle_t *db, const char *name)
+#ifdef HAVE_ZLIB
+static int zlib_compare_crc32(const char *name, const char *valid_exts,
+      const uint8_t *cdata, unsigned cmode, uint32_t csize, uint32_t size,
+      uint32_t crc32, void *userdata)
 {
-   char msg[PATH_MAX_LENGTH] = {0};
+   database_scan_item_t *item = (database_scan_item_t*)userdata;
 
-   snprintf(msg, sizeof(msg),
-#ifdef _WIN32
-         "%Iu/%Iu: %s %s...\n",
-#else
-         "%zu/%zu: %s %s...\n",
-#endif
-         db->list_ptr,
-         db->list->size,
-         msg_hash_to_str(MSG_SCANNING),
-         name);
+   if (!crc32)
+      return 1;
 
-   if (msg[0] != '\0')
-      rarch_main_msg_queue_push(msg, 1, 180, true);
+   item->crc      = crc32;
+   item->zip_name = strdup(name);
 
 #if 0
-   RARCH_LOG("msg: %s\n", msg);
+   RARCH_LOG("Going to compare CRC 0x%x for %s\n", crc32, name);
 #endif
 
-
-   db->status = DATABASE_STATUS_ITERATE;
-
+   /* Only the first entry of the archive is matched. */
    return 0;
 }
+#endif
 
-static int iso_get_serial(database_state_handle_t *db_state,
-      database_info_handle_t *db, const char *name, char* serial)
+static int iso_get_serial(const char *name, char* serial)
 {
    int rv;
    int32_t offset = 0;
@@ -150,13 +213,12 @@ static int iso_get_serial(database_state_handle_t *db_state,
    return 0;
 }
 
-static int cue_get_serial(database_state_handle_t *db_state,
-      database_info_handle_t *db, const char *name, char* serial)
+static int cue_get_serial(const char *name, char* serial)
 {
    char track_path[PATH_MAX_LENGTH];
    int32_t offset = 0;
    int rv = find_first_data_track(name, &offset, track_path, PATH_MAX_LENGTH);
-    
+
    if (rv < 0)
    {
       RARCH_LOG("Could not find valid data track: %s\n", strerror(-rv));
@@ -165,317 +227,557 @@ static int cue_get_serial(database_state_handle_t *db_state,
 
    RARCH_LOG("Reading 1st data track...\n");
 
-   return iso_get_serial(db_state, db, track_path, serial);
+   return iso_get_serial(track_path, serial);
 }
 
-static int database_info_iterate_playlist(
-      database_state_handle_t *db_state,
-      database_info_handle_t *db, const char *name)
+/**
+ * database_scan_hash_item:
+ * @item                : File to hash.
+ *
+ * Computes what the matcher needs to know about @item: the CRC32
+ * of plain files and of the first entry of ZIP archives, or the
+ * disc serial of CUE sheets and ISO images. Touches nothing but
+ * @item, so it is safe to run from any worker.
+ **/
+static void database_scan_hash_item(database_scan_item_t *item)
 {
-   uint32_t extension_hash          = 0;
-   char parent_dir[PATH_MAX_LENGTH] = {0};
-
-   path_parent_dir(parent_dir);
-
-   extension_hash = msg_hash_calculate(path_get_extension(name));
-
-   switch (extension_hash)
+   switch (msg_hash_calculate(path_get_extension(item->path)))
    {
       case HASH_EXTENSION_ZIP:
 #ifdef HAVE_ZLIB
-         db->type = DATABASE_TYPE_ITERATE_ZIP;
-         memset(&db->state, 0, sizeof(zlib_transfer_t));
-         db_state->zip_name[0] = '\0';
-         db->state.type = ZLIB_TRANSFER_INIT;
-
-         return 1;
+         zlib_parse_file(item->path, NULL, zlib_compare_crc32, item);
+         break;
 #endif
       case HASH_EXTENSION_CUE:
       case HASH_EXTENSION_CUE_UPPERCASE:
-         db_state->serial[0] = '\0';
-         cue_get_serial(db_state, db, name, db_state->serial);
-         db->type = DATABASE_TYPE_SERIAL_LOOKUP;
-         return 1;
+         cue_get_serial(item->path, item->serial);
+         break;
       case HASH_EXTENSION_ISO:
       case HASH_EXTENSION_ISO_UPPERCASE:
-         db_state->serial[0] = '\0';
-         iso_get_serial(db_state, db, name, db_state->serial);
-         db->type = DATABASE_TYPE_SERIAL_LOOKUP;
-         return 1;
+         iso_get_serial(item->path, item->serial);
+         break;
       default:
          {
             ssize_t ret;
-            int read_from            = read_file(name, (void**)&db_state->buf, &ret);
-
-            if (read_from != 1 || ret <= 0)
-               return 0;
-
+            void *buf    = NULL;
+            int read_from = read_file(item->path, &buf, &ret);
 
+            if (read_from == 1 && ret > 0)
+            {
 #ifdef HAVE_ZLIB
-            db_state->crc = zlib_crc32_calculate(db_state->buf, ret);
+               item->crc = zlib_crc32_calculate((const uint8_t*)buf, ret);
 #endif
-            db->type = DATABASE_TYPE_CRC_LOOKUP;
+            }
+
+            free(buf);
          }
          break;
    }
-
-   return 1;
 }
 
-static int database_info_list_iterate_end_no_match(database_state_handle_t *db_state)
+static bool database_scan_push_item(database_scan_t *scan, const char *path)
 {
-   /* Reached end of database list, CRC match probably didn't succeed. */
-   db_state->list_index  = 0;
-   db_state->entry_index = 0;
+   database_scan_item_t *item = (database_scan_item_t*)
+      calloc(1, sizeof(*item));
 
-   if (db_state->crc != 0)
-      db_state->crc = 0;
-   return 0;
+   if (!item)
+      return false;
+
+   item->path = strdup(path);
+
+   database_scan_lock(scan);
+
+   if (scan->count == scan->cap)
+   {
+      size_t new_cap                  = scan->cap ? scan->cap * 2 : 256;
+      database_scan_item_t **new_items = (database_scan_item_t**)
+         realloc(scan->items, new_cap * sizeof(*new_items));
+
+      if (!new_items)
+      {
+         database_scan_unlock(scan);
+         free(item->path);
+         free(item);
+         return false;
+      }
+
+      scan->items = new_items;
+      scan->cap   = new_cap;
+   }
+
+   scan->items[scan->count++] = item;
+
+   database_scan_wake(scan);
+   database_scan_unlock(scan);
+
+   return true;
 }
 
-static int database_info_iterate_next(database_info_handle_t *db)
+/**
+ * database_scan_walk:
+ * @scan                : Scan handle.
+ *
+ * Directory walker stage. Feeds every file of the scanned
+ * directory with an extension supported by one of the installed
+ * cores to the hashing workers as soon as it is found.
+ **/
+static void database_scan_walk(database_scan_t *scan)
 {
-   db->list_ptr++;
+   struct RDIR *entry = NULL;
 
-   if (db->list_ptr < db->list->size)
-      return 0;
-   return -1;
+   if (!scan->is_dir)
+   {
+      database_scan_push_item(scan, scan->root);
+      goto end;
+   }
+
+   entry = retro_opendir(scan->root);
+
+   if (!entry || retro_dirent_error(entry))
+      goto end;
+
+   while (!database_scan_cancelled(scan) && retro_readdir(entry))
+   {
+      char file_path[PATH_MAX_LENGTH] = {0};
+      const char *name                = retro_dirent_get_name(entry);
+
+      if (!strcmp(name, ".") || !strcmp(name, ".."))
+         continue;
+
+      fill_pathname_join(file_path, scan->root, name, sizeof(file_path));
+
+      if (retro_dirent_is_dir(entry, file_path))
+         continue;
+
+      if (!scan->ext_list || !string_list_find_elem_prefix(
+               scan->ext_list, ".", path_get_extension(name)))
+         continue;
+
+      if (!database_scan_push_item(scan, file_path))
+         break;
+   }
+
+end:
+   if (entry)
+      retro_closedir(entry);
+
+   database_scan_lock(scan);
+   scan->walk_done = true;
+   database_scan_wake(scan);
+   database_scan_unlock(scan);
 }
 
-static int database_info_list_iterate_new(database_state_handle_t *db_state, const char *query)
+/**
+ * database_scan_load_index:
+ * @scan                : Scan handle.
+ *
+ * Indexes the crc and serial fields of every database once, so that
+ * matching a scanned file costs one probe instead of a query over
+ * every database.
+ **/
+static void database_scan_load_index(database_scan_t *scan)
 {
-   const char *new_database = db_state->list->elems[db_state->list_index].data;
-#if 0
-   RARCH_LOG("Check database [%d/%d] : %s\n", (unsigned)db_state->list_index, 
-         (unsigned)db_state->list->size, new_database);
-#endif
-   if (db_state->info)
-      database_info_list_free(db_state->info);
-   db_state->info = database_info_list_new(new_database, query);
-   return 0;
+   unsigned i;
+   database_scan_db_t *dbs      = NULL;
+   database_info_index_t *index = NULL;
+
+   if (!scan->databases || !scan->databases->size)
+      goto end;
+
+   index = database_info_index_new();
+   dbs   = (database_scan_db_t*)calloc(scan->databases->size, sizeof(*dbs));
+
+   if (!index || !dbs)
+   {
+      database_info_index_free(index);
+      free(dbs);
+      index = NULL;
+      dbs   = NULL;
+      goto end;
+   }
+
+   for (i = 0; i < scan->databases->size
+         && !database_scan_cancelled(scan); i++)
+   {
+      const char *db_path = scan->databases->elems[i].data;
+
+      fill_short_pathname_representation(dbs[i].playlist_base,
+            db_path, sizeof(dbs[i].playlist_base));
+      path_remove_extension(dbs[i].playlist_base);
+      strlcat(dbs[i].playlist_base, ".lpl", sizeof(dbs[i].playlist_base));
+
+      database_info_index_add(index, db_path);
+   }
+
+end:
+   database_scan_lock(scan);
+   scan->index       = index;
+   scan->dbs         = dbs;
+   scan->num_dbs     = dbs ? scan->databases->size : 0;
+   scan->index_ready = true;
+   database_scan_unlock(scan);
 }
 
-static int database_info_list_iterate_found_match(
-      database_state_handle_t *db_state,
-      database_info_handle_t *db,
-      const char *zip_name
-      )
+static void database_scan_found_match(database_scan_t *scan,
+      const database_scan_item_t *item, unsigned db_index,
+      const database_info_t *db_info_entry)
 {
-   char db_crc[PATH_MAX_LENGTH]                = {0};
-   char db_playlist_path[PATH_MAX_LENGTH]      = {0};
-   char  db_playlist_base_str[PATH_MAX_LENGTH] = {0};
-   char entry_path_str[PATH_MAX_LENGTH]        = {0};
-   content_playlist_t   *playlist = NULL;
-   settings_t           *settings = config_get_ptr();
-   const char            *db_path = db_state->list->elems[db_state->list_index].data;
-   const char         *entry_path = db ? db->list->elems[db->list_ptr].data : NULL;
-   database_info_t *db_info_entry = &db_state->info->list[db_state->entry_index];
-
-   fill_short_pathname_representation(db_playlist_base_str,
-         db_path, sizeof(db_playlist_base_str));
+   char db_crc[PATH_MAX_LENGTH]         = {0};
+   char entry_path_str[PATH_MAX_LENGTH] = {0};
+   database_scan_db_t *db               = &scan->dbs[db_index];
 
-   path_remove_extension(db_playlist_base_str);
+   if (!db->playlist)
+   {
+      char db_playlist_path[PATH_MAX_LENGTH] = {0};
+      settings_t *settings                   = config_get_ptr();
 
-   strlcat(db_playlist_base_str, ".lpl", sizeof(db_playlist_base_str));
-   fill_pathname_join(db_playlist_path, settings->playlist_directory,
-         db_playlist_base_str, sizeof(db_playlist_path));
+      fill_pathname_join(db_playlist_path, settings->playlist_directory,
+            db->playlist_base, sizeof(db_playlist_path));
 
-   playlist = content_playlist_init(db_playlist_path, COLLECTION_SIZE);
+      db->playlist = content_playlist_init(db_playlist_path, COLLECTION_SIZE);
 
+      if (!db->playlist)
+         return;
+   }
 
    snprintf(db_crc, sizeof(db_crc), "%08X|crc", db_info_entry->crc32);
 
-   strlcpy(entry_path_str, entry_path, sizeof(entry_path_str));
+   strlcpy(entry_path_str, item->path, sizeof(entry_path_str));
 
-   if (zip_name && zip_name[0] != '\0')
-      fill_pathname_join_delim(entry_path_str, entry_path_str, zip_name,
+   if (item->zip_name && item->zip_name[0] != '\0')
+      fill_pathname_join_delim(entry_path_str, entry_path_str, item->zip_name,
             '#', sizeof(entry_path_str));
 
-#if 0
-   RARCH_LOG("Found match in database !\n");
-
-   RARCH_LOG("Path: %s\n", db_path);
-   RARCH_LOG("CRC : %s\n", db_crc);
-   RARCH_LOG("Playlist Path: %s\n", db_playlist_path);
-   RARCH_LOG("Entry Path: %s\n", entry_path);
-   RARCH_LOG("Playlist not NULL: %d\n", playlist != NULL);
-   RARCH_LOG("ZIP entry: %s\n", zip_name);
-   RARCH_LOG("entry path str: %s\n", entry_path_str);
-#endif
+   content_playlist_push(db->playlist, entry_path_str,
+         db_info_entry->name, "DETECT", "DETECT", db_crc, db->playlist_base);
 
-   content_playlist_push(playlist, entry_path_str,
-         db_info_entry->name, "DETECT", "DETECT", db_crc, db_playlist_base_str);
-
-   content_playlist_write_file(playlist);
-   content_playlist_free(playlist);
-   return 0;
+   scan->matches++;
 }
 
-/* End of entries in database info list and didn't find a 
- * match, go to the next database. */
-static int database_info_list_iterate_next(
-      database_state_handle_t *db_state
-      )
+static void database_scan_match_item(database_scan_t *scan,
+      const database_scan_item_t *item)
 {
-   db_state->list_index++;
-   db_state->entry_index = 0;
+   size_t i;
+   database_info_index_match_t matches[DATABASE_SCAN_MAX_MATCHES];
+   database_info_list_t *list = NULL;
+   size_t num_matches         = 0;
+
+   if (!scan->index)
+      return;
+
+   if (item->serial[0] != '\0')
+      num_matches = database_info_index_find_serial(scan->index,
+            item->serial, matches, DATABASE_SCAN_MAX_MATCHES);
+   else if (item->crc)
+      num_matches = database_info_index_find_crc(scan->index,
+            item->crc, matches, DATABASE_SCAN_MAX_MATCHES);
+
+   if (!num_matches)
+      return;
+
+   list = database_info_index_read(scan->index, matches, num_matches);
+
+   if (!list)
+      return;
+
+   for (i = 0; i < list->count; i++)
+   {
+      if (list->list[i].name)
+         database_scan_found_match(scan, item, matches[i].db,
+               &list->list[i]);
+   }
 
-   database_info_list_free(db_state->info);
-   db_state->info        = NULL;
+   database_info_list_free(list);
+}
 
-   return 1;
+#ifdef HAVE_THREADS
+static void database_scan_walker_thread(void *data)
+{
+   database_scan_walk((database_scan_t*)data);
 }
 
-static int database_info_iterate_crc_lookup(
-      database_state_handle_t *db_state,
-      database_info_handle_t *db,
-      const char *zip_entry)
+static void database_scan_indexer_thread(void *data)
 {
+   database_scan_load_index((database_scan_t*)data);
+}
 
-   if (!db_state->list || (unsigned)db_state->list_index == (unsigned)db_state->list->size)
-      return database_info_list_iterate_end_no_match(db_state);
+static void database_scan_worker_thread(void *data)
+{
+   database_scan_t *scan = (database_scan_t*)data;
 
-   if (db_state->entry_index == 0)
+   for (;;)
    {
-      char query[50] = {0};
-      snprintf(query, sizeof(query), "{crc: b\"%08X\"}", swap_if_big32(db_state->crc));
+      database_scan_item_t *item = NULL;
 
-      database_info_list_iterate_new(db_state, query);
+      slock_lock(scan->lock);
+      while (!scan->quit && !scan->walk_done
+            && scan->next_hash == scan->count)
+         scond_wait(scan->cond, scan->lock);
+
+      if (!scan->quit && scan->next_hash < scan->count)
+         item = scan->items[scan->next_hash++];
+      slock_unlock(scan->lock);
+
+      if (!item)
+         break;
+
+      database_scan_hash_item(item);
+
+      slock_lock(scan->lock);
+      item->hashed = true;
+      slock_unlock(scan->lock);
    }
+}
 
-   if (db_state->info)
-   {
-      database_info_t *db_info_entry = &db_state->info->list[db_state->entry_index];
+static void database_scan_start_threads(database_scan_t *scan)
+{
+   unsigned i;
+   unsigned num_workers = retro_get_cpu_cores();
 
-      if (db_info_entry && db_info_entry->crc32)
-      {
-#if 0
-         RARCH_LOG("CRC32: 0x%08X , entry CRC32: 0x%08X (%s).\n",
-                   db_state->crc, db_info_entry->crc32, db_info_entry->name);
-#endif
-         if (db_state->crc == db_info_entry->crc32)
-            database_info_list_iterate_found_match(db_state, db, zip_entry);
-      }
+   if (num_workers < 1)
+      num_workers = 1;
+   if (num_workers > DATABASE_SCAN_MAX_THREADS)
+      num_workers = DATABASE_SCAN_MAX_THREADS;
+
+   scan->lock = slock_new();
+   scan->cond = scond_new();
+
+   if (!scan->lock || !scan->cond)
+      return;
+
+   scan->threaded = true;
+
+   /* Any stage whose thread fails to start runs on the
+    * data runloop instead. */
+   for (i = 0; i < num_workers; i++)
+   {
+      scan->workers[i] = sthread_create(database_scan_worker_thread, scan);
+      if (!scan->workers[i])
+         break;
+      scan->num_workers++;
    }
 
-   db_state->entry_index++;
+   scan->walker  = sthread_create(database_scan_walker_thread, scan);
+   scan->indexer = sthread_create(database_scan_indexer_thread, scan);
 
-   if (db_state->entry_index >= db_state->info->count)
-      return database_info_list_iterate_next(db_state);
+   RARCH_LOG("Scanning %s with %u hashing threads.\n",
+         scan->root, scan->num_workers);
+}
+
+static void database_scan_stop_threads(database_scan_t *scan)
+{
+   unsigned i;
 
-   if (db_state->list_index < db_state->list->size)
+   if (scan->threaded)
    {
-      /* Didn't reach the end of the database list yet,
-       * continue iterating. */
-      return 1;
+      slock_lock(scan->lock);
+      scan->quit = true;
+      scond_broadcast(scan->cond);
+      slock_unlock(scan->lock);
    }
 
-   if (db_state->info)
-      database_info_list_free(db_state->info);
-   return 0;
+   if (scan->walker)
+      sthread_join(scan->walker);
+   if (scan->indexer)
+      sthread_join(scan->indexer);
+   for (i = 0; i < scan->num_workers; i++)
+      sthread_join(scan->workers[i]);
+
+   if (scan->cond)
+      scond_free(scan->cond);
+   if (scan->lock)
+      slock_free(scan->lock);
 }
+#endif
 
-static int database_info_iterate_playlist_zip(
-      database_state_handle_t *db_state,
-      database_info_handle_t *db, const char *name)
+static database_scan_t *database_scan_new(const char *path, bool is_dir)
 {
-   bool returnerr = true;
-#ifdef HAVE_ZLIB
-   if (db_state->crc != 0)
-      return database_info_iterate_crc_lookup(db_state, db, db_state->zip_name);
-   else
+   database_scan_t *scan = (database_scan_t*)calloc(1, sizeof(*scan));
+
+   if (!scan)
+      return NULL;
+
+   strlcpy(scan->root, path, sizeof(scan->root));
+   scan->is_dir     = is_dir;
+   scan->databases  = dir_list_new_special(NULL, DIR_LIST_DATABASES);
+   scan->start_time = retro_get_time_usec();
+
+   if (is_dir)
    {
-      if (zlib_parse_file_iterate(&db->state,
-               &returnerr, name, NULL, zlib_compare_crc32,
-               (void*)db_state) != 0)
-         return 0;
+      const char *exts = core_info_list_get_all_extensions();
 
-      if (db_state->crc)
-         zlib_parse_file_iterate_stop(&db->state);
+      if (exts)
+         scan->ext_list = string_split(exts, "|");
    }
+
+#ifdef HAVE_THREADS
+   database_scan_start_threads(scan);
 #endif
 
-   return 1;
+   return scan;
 }
 
-static int database_info_iterate_serial_lookup(
-      database_state_handle_t *db_state,
-      database_info_handle_t *db, const char *name)
+static void database_scan_free(database_scan_t *scan)
 {
-   if (!db_state->list || (unsigned)db_state->list_index == (unsigned)db_state->list->size)
-      return database_info_list_iterate_end_no_match(db_state);
+   size_t i;
 
-   if (db_state->entry_index == 0)
-   {
-      char query[50];
-      char *serial_buf = bin_to_hex_alloc((uint8_t*)db_state->serial, 10 * sizeof(uint8_t));
+   if (!scan)
+      return;
 
-      if (!serial_buf)
-         return 1;
+#ifdef HAVE_THREADS
+   database_scan_stop_threads(scan);
+#endif
 
-      snprintf(query, sizeof(query), "{'serial': b'%s'}", serial_buf);
-      database_info_list_iterate_new(db_state, query);
+   for (i = 0; i < scan->num_dbs; i++)
+   {
+      database_scan_db_t *db = &scan->dbs[i];
 
-      free(serial_buf);
+      if (db->playlist)
+      {
+         content_playlist_write_file(db->playlist);
+         content_playlist_free(db->playlist);
+      }
    }
 
-   if (db_state->info)
+   for (i = 0; i < scan->count; i++)
    {
-      database_info_t *db_info_entry = &db_state->info->list[db_state->entry_index];
+      free(scan->items[i]->path);
+      free(scan->items[i]->zip_name);
+      free(scan->items[i]);
+   }
 
-      if (db_info_entry && db_info_entry->serial)
-      {
-#if 0
-         RARCH_LOG("serial: %s , entry serial: %s (%s).\n",
-                   db_state->serial, db_info_entry->serial, db_info_entry->name);
+   free(scan->items);
+   free(scan->dbs);
+   database_info_index_free(scan->index);
+
+   if (scan->ext_list)
+      string_list_free(scan->ext_list);
+   if (scan->databases)
+      dir_list_free(scan->databases);
+
+   free(scan);
+}
+
+static void database_scan_report(database_scan_t *scan,
+      const database_scan_item_t *item)
+{
+   size_t count;
+   char msg[PATH_MAX_LENGTH] = {0};
+   retro_time_t elapsed      = retro_get_time_usec() - scan->start_time;
+   unsigned files_per_sec    = elapsed > 0 ?
+      (unsigned)(scan->next_match * 1000000 / elapsed) : 0;
+
+   /* The walker may still be appending. */
+   database_scan_lock(scan);
+   count = scan->count;
+   database_scan_unlock(scan);
+
+   snprintf(msg, sizeof(msg),
+#ifdef _WIN32
+         "%Iu/%Iu: %s %s (%u files/s)...\n",
+#else
+         "%zu/%zu: %s %s (%u files/s)...\n",
 #endif
-         if (!strcmp(db_state->serial, db_info_entry->serial))
-            database_info_list_iterate_found_match(db_state, db, NULL);
-      }
-   }
+         scan->next_match,
+         count,
+         msg_hash_to_str(MSG_SCANNING),
+         path_basename(item->path),
+         files_per_sec);
 
-   db_state->entry_index++;
+   rarch_main_msg_queue_push(msg, 1, 180, true);
+}
 
-   if (db_state->entry_index >= db_state->info->count)
-      return database_info_list_iterate_next(db_state);
+/**
+ * database_scan_iterate:
+ * @scan                : Scan handle.
+ *
+ * Matcher stage, run once per data runloop tick. Looks up the
+ * files hashed since the last tick, in directory order, and
+ * collects the matches into the per-database playlists. Without
+ * threads, the walker, the index and the hashing also run here.
+ *
+ * Returns: true (1) once every file has been matched.
+ **/
+static bool database_scan_iterate(database_scan_t *scan)
+{
+   unsigned i;
+   bool done                  = false;
+   bool inline_walk           = true;
+   bool inline_index          = true;
+   bool inline_hash           = true;
+   database_scan_item_t *last = NULL;
+
+#ifdef HAVE_THREADS
+   inline_walk  = !scan->walker;
+   inline_index = !scan->indexer;
+   inline_hash  = !scan->num_workers;
+#endif
 
-   if (db_state->list_index < db_state->list->size)
+   if (inline_walk && !scan->walk_done)
    {
-      /* Didn't reach the end of the database list yet,
-       * continue iterating. */
-      return 1;
+      database_scan_walk(scan);
+      return false;
    }
 
-   if (db_state->info)
-      database_info_list_free(db_state->info);
-   return 0;
-}
+   if (inline_index && !scan->index_ready)
+   {
+      database_scan_load_index(scan);
+      return false;
+   }
 
-static int database_info_iterate(database_state_handle_t *db_state, database_info_handle_t *db)
-{
-   const char *name = db ? db->list->elems[db->list_ptr].data : NULL;
+   if (inline_hash)
+   {
+      database_scan_item_t *item = NULL;
 
-   if (!db || !db->list)
-      return -1;
+      database_scan_lock(scan);
+      if (scan->next_hash < scan->count)
+         item = scan->items[scan->next_hash++];
+      database_scan_unlock(scan);
 
-   if (!name)
-      return 0;
+      if (item)
+      {
+         database_scan_hash_item(item);
+         item->hashed = true;
+      }
+   }
 
-   switch (db->type)
+   for (i = 0; i < DATABASE_SCAN_MATCH_BATCH; i++)
    {
-      case DATABASE_TYPE_NONE:
+      database_scan_item_t *item = NULL;
+
+      database_scan_lock(scan);
+      if (scan->index_ready && scan->next_match < scan->count
+            && scan->items[scan->next_match]->hashed)
+         item = scan->items[scan->next_match];
+      database_scan_unlock(scan);
+
+      if (!item)
          break;
-      case DATABASE_TYPE_ITERATE:
-         return database_info_iterate_playlist(db_state, db, name);
-      case DATABASE_TYPE_ITERATE_ZIP:
-         return database_info_iterate_playlist_zip(db_state, db, name);
-      case DATABASE_TYPE_SERIAL_LOOKUP:
-         return database_info_iterate_serial_lookup(db_state, db, name);
-      case DATABASE_TYPE_CRC_LOOKUP:
-         return database_info_iterate_crc_lookup(db_state, db, NULL);
+
+      database_scan_match_item(scan, item);
+      scan->next_match++;
+      last = item;
    }
 
-   return 0;
+   if (last)
+      database_scan_report(scan, last);
+
+   database_scan_lock(scan);
+   done = scan->walk_done && scan->index_ready
+      && scan->next_match == scan->count;
+   database_scan_unlock(scan);
+
+   if (done)
+   {
+      retro_time_t elapsed = retro_get_time_usec() - scan->start_time;
+
+      RARCH_LOG("Scanned %u files in %.2f s (%.1f files/s), %u matches.\n",
+            (unsigned)scan->count, elapsed / 1000000.0,
+            elapsed > 0 ? scan->count * 1000000.0 / elapsed : 0.0,
+            (unsigned)scan->matches);
+   }
+
+   return done;
 }
 
 static int database_info_poll(db_handle_t *db)
@@ -488,7 +790,7 @@ static int database_info_poll(db_handle_t *db)
    if (!path)
       return -1;
 
-   str_list                     = string_split(path, "|"); 
+   str_list                     = string_split(path, "|");
 
    if (!str_list)
       goto error;
@@ -502,10 +804,10 @@ static int database_info_poll(db_handle_t *db)
    switch (cb_type_hash)
    {
       case CB_DB_SCAN_FILE:
-         db->handle = database_info_file_init(elem0, DATABASE_TYPE_ITERATE);
+         db->scan = database_scan_new(elem0, false);
          break;
       case CB_DB_SCAN_FOLDER:
-         db->handle = database_info_dir_init(elem0, DATABASE_TYPE_ITERATE);
+         db->scan = database_scan_new(elem0, true);
          break;
    }
 
@@ -520,81 +822,25 @@ error:
    return -1;
 }
 
-static void rarch_main_data_db_cleanup_state(database_state_handle_t *db_state)
-{
-   if (!db_state)
-      return;
-
-   if (db_state->buf)
-      free(db_state->buf);
-   db_state->buf = NULL;
-}
-
 void rarch_main_data_db_iterate(bool is_thread)
 {
-   database_info_handle_t      *db   = (db_ptr) ? db_ptr->handle : NULL;
-   database_state_handle_t *db_state = (db_ptr) ? &db_ptr->state : NULL;
-   const char *name = db ? db->list->elems[db->list_ptr].data    : NULL;
-
-   if (!db)
-      goto do_poll;
+   if (!db_ptr)
+      return;
 
-   switch (db->status)
+   if (!db_ptr->scan)
    {
-      case DATABASE_STATUS_ITERATE_BEGIN:
-         if (db_state && !db_state->list)
-            db_state->list = dir_list_new_special(NULL, DIR_LIST_DATABASES);
-         db->status = DATABASE_STATUS_ITERATE_START;
-         break;
-      case DATABASE_STATUS_ITERATE_START:
-         rarch_main_data_db_cleanup_state(db_state);
-         db_state->list_index  = 0;
-         db_state->entry_index = 0;
-         database_info_iterate_start(db, name);
-         break;
-      case DATABASE_STATUS_ITERATE:
-         if (database_info_iterate(&db_ptr->state, db) == 0)
-         {
-            db->status = DATABASE_STATUS_ITERATE_NEXT;
-            db->type   = DATABASE_TYPE_ITERATE;
-         }
-         break;
-      case DATABASE_STATUS_ITERATE_NEXT:
-         if (database_info_iterate_next(db) == 0)
-         {
-            db->status = DATABASE_STATUS_ITERATE_START;
-            db->type   = DATABASE_TYPE_ITERATE;
-         }
-         else
-         {
-            rarch_main_msg_queue_push_new(MSG_SCANNING_OF_DIRECTORY_FINISHED, 0, 180, true);
-            pending_scan_finished = true;
-            db->status = DATABASE_STATUS_FREE;
-         }
-         break;
-      case DATABASE_STATUS_FREE:
-         if (db_state->list)
-            dir_list_free(db_state->list);
-         db_state->list = NULL;
-         rarch_main_data_db_cleanup_state(db_state);
-         database_info_free(db);
-         if (db_ptr->handle)
-            free(db_ptr->handle);
-         db_ptr->handle = NULL;
-         break;
-      default:
-      case DATABASE_STATUS_NONE:
-         goto do_poll;
+      database_info_poll(db_ptr);
+      return;
    }
 
-   return;
+   if (!database_scan_iterate(db_ptr->scan))
+      return;
 
-do_poll:
-   if (database_info_poll(db_ptr) != -1)
-   {
-      if (db_ptr->handle)
-         db_ptr->handle->status = DATABASE_STATUS_ITERATE_BEGIN;
-   }
+   database_scan_free(db_ptr->scan);
+   db_ptr->scan = NULL;
+
+   rarch_main_msg_queue_push_new(MSG_SCANNING_OF_DIRECTORY_FINISHED, 0, 180, true);
+   pending_scan_finished = true;
 }
 
 
@@ -604,7 +850,7 @@ void rarch_main_data_db_init_msg_queue(void)
 
    if (!db)
       return;
-   
+
    if (!db->msg_queue)
       rarch_assert(db->msg_queue         = msg_queue_new(8));
 }
@@ -620,7 +866,10 @@ msg_queue_t *rarch_main_data_db_get_msg_queue_ptr(void)
 void rarch_main_data_db_uninit(void)
 {
    if (db_ptr)
+   {
+      database_scan_free(db_ptr->scan);
       free(db_ptr);
+   }
    db_ptr = NULL;
    pending_scan_finished = false;
 }
@@ -634,11 +883,9 @@ void rarch_main_data_db_init(void)
 bool rarch_main_data_db_is_active(void)
 {
    db_handle_t              *db   = (db_handle_t*)db_ptr;
-   database_info_handle_t   *dbi  = db ? db->handle : NULL;
-   if (dbi && dbi->status != DATABASE_STATUS_NONE)
+   if (db && db->scan)
       return true;
 
    return false;
 }
 #endif
-
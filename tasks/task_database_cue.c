@@ -170,7 +170,7 @@ static int detect_ps1_game_sub(const char *track_path, char *game_id, int sub_ch
    while (tmp < (buffer + 2048 * 2))
    {
       if (!*tmp)
-         return 0;
+         goto error;
 
       if (!strncasecmp((const char*)(tmp + 33), "SYSTEM.CNF;1", 12))
          break;
@@ -178,7 +178,7 @@ static int detect_ps1_game_sub(const char *track_path, char *game_id, int sub_ch
       tmp += *tmp;
    }
    if(tmp >= (buffer + 2048 * 2))
-      return 0;
+      goto error;
 
    cd_sector = tmp[2] | (tmp[3] << 8) | (tmp[4] << 16);
    retro_fseek(fp, 13 + skip + cd_sector * frame_size, SEEK_SET);
@@ -206,6 +206,10 @@ static int detect_ps1_game_sub(const char *track_path, char *game_id, int sub_ch
 
    retro_fclose(fp);
    return 1;
+
+error:
+   retro_fclose(fp);
+   return 0;
 }
 
 int detect_ps1_game(const char *track_path, char *game_id)
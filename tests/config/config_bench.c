@@ -0,0 +1,223 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Times config_file_new() on a config file, and on every .info
+ * file of a directory the way core_info.c reads them:
+ *    config_bench <config> [info directory]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <file/config_file.h>
+#include <file/dir_list.h>
+#include <string/string_list.h>
+
+/* Repeats every measurement for at least this long. */
+#define BENCH_MIN_USEC 500000
+
+static const char *info_keys[] = {
+   "display_name",
+   "corename",
+   "systemname",
+   "manufacturer",
+   "supported_extensions",
+   "authors",
+   "permissions",
+   "license",
+   "categories",
+   "database",
+   "notes",
+};
+
+/* The logging of libretro-common refers to it. */
+bool rarch_main_verbosity(void)
+{
+   return false;
+}
+
+static int64_t bench_time_usec(void)
+{
+   struct timespec tv;
+   clock_gettime(CLOCK_MONOTONIC, &tv);
+   return (int64_t)tv.tv_sec * 1000000 + tv.tv_nsec / 1000;
+}
+
+/* Looks up every key of @conf once, the way configuration.c
+ * reads all of its settings. */
+static unsigned read_all_keys(config_file_t *conf)
+{
+   struct config_file_entry entry = {0};
+   unsigned keys                  = 0;
+   bool more                      = config_get_entry_list_head(conf, &entry);
+
+   while (more)
+   {
+      char buf[1024];
+
+      if (config_get_array(conf, entry.key, buf, sizeof(buf)))
+         keys++;
+      more = config_get_entry_list_next(&entry);
+   }
+
+   return keys;
+}
+
+/* Mirrors core_info_parse_file(). */
+static bool read_info(const char *path)
+{
+   unsigned i;
+   unsigned count      = 0;
+   bool supports       = false;
+   config_file_t *conf = config_file_new(path);
+
+   if (!conf)
+      return false;
+
+   for (i = 0; i < sizeof(info_keys) / sizeof(info_keys[0]); i++)
+   {
+      char *str = NULL;
+      if (config_get_string(conf, info_keys[i], &str))
+         free(str);
+   }
+   config_get_bool(conf, "supports_no_game", &supports);
+
+   if (config_get_uint(conf, "firmware_count", &count))
+   {
+      for (i = 0; i < count; i++)
+      {
+         char key[64] = {0};
+         char *str    = NULL;
+
+         snprintf(key, sizeof(key), "firmware%u_path", i);
+         if (config_get_string(conf, key, &str))
+            free(str);
+         str = NULL;
+         snprintf(key, sizeof(key), "firmware%u_desc", i);
+         if (config_get_string(conf, key, &str))
+            free(str);
+         snprintf(key, sizeof(key), "firmware%u_opt", i);
+         config_get_bool(conf, key, &supports);
+      }
+   }
+
+   config_file_free(conf);
+   return true;
+}
+
+static bool bench_config(const char *path)
+{
+   unsigned keys    = 0;
+   unsigned loads   = 0;
+   int64_t start, elapsed;
+   double load_time;
+   config_file_t *conf = config_file_new(path);
+
+   if (!conf)
+   {
+      fprintf(stderr, "Could not load %s.\n", path);
+      return false;
+   }
+   keys = read_all_keys(conf);
+   config_file_free(conf);
+
+   start = bench_time_usec();
+   do
+   {
+      config_file_free(config_file_new(path));
+      loads++;
+      elapsed = bench_time_usec() - start;
+   } while (elapsed < BENCH_MIN_USEC);
+   load_time = (double)elapsed / loads;
+
+   loads = 0;
+   start = bench_time_usec();
+   do
+   {
+      conf = config_file_new(path);
+      read_all_keys(conf);
+      config_file_free(conf);
+      loads++;
+      elapsed = bench_time_usec() - start;
+   } while (elapsed < BENCH_MIN_USEC);
+
+   printf("%s: %u keys\n", path, keys);
+   printf("   load:              %10.1f us\n", load_time);
+   printf("   load + every key:  %10.1f us\n", (double)elapsed / loads);
+   return true;
+}
+
+static bool bench_info_dir(const char *dir)
+{
+   unsigned i;
+   unsigned passes           = 0;
+   int64_t start, elapsed;
+   struct string_list *infos = dir_list_new(dir, "info", false, false);
+
+   if (!infos || !infos->size)
+   {
+      fprintf(stderr, "No .info files in %s.\n", dir);
+      string_list_free(infos);
+      return false;
+   }
+
+   for (i = 0; i < infos->size; i++)
+   {
+      if (!read_info(infos->elems[i].data))
+      {
+         fprintf(stderr, "Could not load %s.\n", infos->elems[i].data);
+         string_list_free(infos);
+         return false;
+      }
+   }
+
+   start = bench_time_usec();
+   do
+   {
+      for (i = 0; i < infos->size; i++)
+         read_info(infos->elems[i].data);
+      passes++;
+      elapsed = bench_time_usec() - start;
+   } while (elapsed < BENCH_MIN_USEC);
+
+   printf("%s: %u .info files\n", dir, (unsigned)infos->size);
+   printf("   all files:         %10.1f us\n", (double)elapsed / passes);
+   printf("   per file:          %10.1f us\n",
+         (double)elapsed / passes / infos->size);
+
+   string_list_free(infos);
+   return true;
+}
+
+int main(int argc, char *argv[])
+{
+   if (argc < 2 || argc > 3)
+   {
+      fprintf(stderr, "Usage: %s <config> [info directory]\n", argv[0]);
+      return 1;
+   }
+
+   if (!bench_config(argv[1]))
+      return 1;
+
+   if (argc == 3 && !bench_info_dir(argv[2]))
+      return 1;
+
+   return 0;
+}
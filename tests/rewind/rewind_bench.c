@@ -0,0 +1,348 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Benchmark for the rewind delta codec.
+ * Feeds a sequence of savestates through state_manager_raw_compress()
+ * and state_manager_raw_decompress() with each delta scan kernel the
+ * CPU supports, checks that the patches rewind the sequence back to
+ * its first state, and reports GB/s of savestate data.
+ *
+ * A recording is the states of consecutive frames, concatenated:
+ *    rewind_bench <state size> <recording>
+ * Without arguments, a synthetic recording is used.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../../general.h"
+#include "../../msg_hash.h"
+#include "../../performance.h"
+#include "../../rewind.h"
+#include "../../audio/audio_driver.h"
+
+/* Runs every kernel at least this long. */
+#define BENCH_MIN_USEC 500000
+
+#define SYNTH_STATE_SIZE (256 * 1024)
+#define SYNTH_STATES     240
+
+/* Built from performance.c under this name, see the Makefile. */
+uint64_t rewind_bench_cpu_features(void);
+
+/* Frontend symbols init_rewind() refers to. The benchmark
+ * only uses the raw codec, so none of them are called. */
+static settings_t g_settings;
+static global_t g_global;
+
+settings_t *config_get_ptr(void)
+{
+   return &g_settings;
+}
+
+global_t *global_get_ptr(void)
+{
+   return &g_global;
+}
+
+bool rarch_main_verbosity(void)
+{
+   return false;
+}
+
+const char *msg_hash_to_str(uint32_t hash)
+{
+   (void)hash;
+   return "";
+}
+
+bool audio_driver_has_callback(void)
+{
+   return false;
+}
+
+size_t (*pretro_serialize_size)(void);
+bool (*pretro_serialize)(void*, size_t);
+
+static uint64_t bench_cpu_mask;
+
+/* state_manager_raw_init_simd() picks its kernels from this. */
+uint64_t retro_get_cpu_features(void)
+{
+   return bench_cpu_mask;
+}
+
+static const struct
+{
+   const char *name;
+   uint64_t mask;
+} kernels[] = {
+   { "C",    0 },
+   { "SSE2", RETRO_SIMD_SSE2 },
+   { "AVX2", RETRO_SIMD_SSE2 | RETRO_SIMD_AVX | RETRO_SIMD_AVX2 },
+   { "NEON", RETRO_SIMD_NEON },
+};
+
+struct bench_recording
+{
+   size_t state_size;
+   unsigned num_states;
+   uint8_t **states;
+   uint8_t **patches;
+   size_t *patch_sizes;
+};
+
+static void bench_recording_free(struct bench_recording *rec)
+{
+   unsigned i;
+
+   for (i = 0; i < rec->num_states; i++)
+   {
+      if (rec->states)
+         free(rec->states[i]);
+      if (rec->patches)
+         free(rec->patches[i]);
+   }
+
+   free(rec->states);
+   free(rec->patches);
+   free(rec->patch_sizes);
+}
+
+static bool bench_recording_alloc(struct bench_recording *rec,
+      size_t state_size, unsigned num_states)
+{
+   unsigned i;
+
+   rec->state_size  = state_size;
+   rec->num_states  = num_states;
+   rec->states      = (uint8_t**)calloc(num_states, sizeof(*rec->states));
+   rec->patches     = (uint8_t**)calloc(num_states, sizeof(*rec->patches));
+   rec->patch_sizes = (size_t*)calloc(num_states, sizeof(*rec->patch_sizes));
+
+   if (!rec->states || !rec->patches || !rec->patch_sizes)
+      return false;
+
+   for (i = 0; i < num_states; i++)
+   {
+      /* Neighbouring states need different sentinels. */
+      rec->states[i]  = (uint8_t*)state_manager_raw_alloc(state_size, i & 1);
+      rec->patches[i] = (uint8_t*)malloc(
+            state_manager_raw_maxsize(state_size));
+      if (!rec->states[i] || !rec->patches[i])
+         return false;
+   }
+
+   return true;
+}
+
+static bool bench_recording_load(struct bench_recording *rec,
+      size_t state_size, const char *path)
+{
+   unsigned i;
+   long file_size;
+   FILE *file = fopen(path, "rb");
+
+   if (!file)
+   {
+      fprintf(stderr, "Could not open %s.\n", path);
+      return false;
+   }
+
+   fseek(file, 0, SEEK_END);
+   file_size = ftell(file);
+   fseek(file, 0, SEEK_SET);
+
+   if (file_size < 0 || (size_t)file_size < 2 * state_size)
+   {
+      fprintf(stderr, "%s holds less than two states.\n", path);
+      fclose(file);
+      return false;
+   }
+
+   if (!bench_recording_alloc(rec, state_size, file_size / state_size))
+   {
+      fclose(file);
+      return false;
+   }
+
+   for (i = 0; i < rec->num_states; i++)
+   {
+      if (fread(rec->states[i], 1, state_size, file) != state_size)
+      {
+         fclose(file);
+         return false;
+      }
+   }
+
+   fclose(file);
+   return true;
+}
+
+/* Somewhat like a game: a few counters, some sprites moving,
+ * and now and then a larger block of RAM rewritten. */
+static bool bench_recording_synthesize(struct bench_recording *rec)
+{
+   unsigned i, j;
+
+   if (!bench_recording_alloc(rec, SYNTH_STATE_SIZE, SYNTH_STATES))
+      return false;
+
+   srand(1);
+   for (j = 0; j < SYNTH_STATE_SIZE; j++)
+      rec->states[0][j] = (j & 0xf000) ? rand() : 0;
+
+   for (i = 1; i < SYNTH_STATES; i++)
+   {
+      uint8_t *state = rec->states[i];
+
+      memcpy(state, rec->states[i - 1], SYNTH_STATE_SIZE);
+
+      for (j = 0; j < 64; j++)
+         state[rand() % SYNTH_STATE_SIZE]++;
+      for (j = 0; j < 16; j++)
+      {
+         unsigned offset = rand() % (SYNTH_STATE_SIZE - 64);
+         memset(state + offset, rand(), 4 + rand() % 60);
+      }
+      if (i % 30 == 0)
+      {
+         unsigned offset = rand() % (SYNTH_STATE_SIZE - 8192);
+         for (j = 0; j < 8192; j++)
+            state[offset + j] = rand();
+      }
+   }
+
+   return true;
+}
+
+/**
+ * bench_kernel:
+ *
+ * Compresses every pair of neighbouring states, then rewinds
+ * the last state back to the first with the patches.
+ *
+ * Returns: true (1) if the rewound state matches, otherwise false (0).
+ **/
+static bool bench_kernel(struct bench_recording *rec, unsigned kernel,
+      uint8_t *scratch)
+{
+   unsigned i;
+   unsigned passes;
+   retro_time_t start, comp_time, decomp_time;
+   size_t patch_bytes = 0;
+   double bytes       = (double)rec->state_size * (rec->num_states - 1);
+
+   bench_cpu_mask = kernels[kernel].mask;
+   state_manager_raw_init_simd();
+
+   start  = retro_get_time_usec();
+   passes = 0;
+   do
+   {
+      for (i = 0; i + 1 < rec->num_states; i++)
+         rec->patch_sizes[i] = state_manager_raw_compress(
+               rec->states[i], rec->states[i + 1],
+               rec->state_size, rec->patches[i]);
+      passes++;
+      comp_time = retro_get_time_usec() - start;
+   } while (comp_time < BENCH_MIN_USEC);
+   comp_time /= passes;
+
+   for (i = 0; i + 1 < rec->num_states; i++)
+      patch_bytes += rec->patch_sizes[i];
+
+   start  = retro_get_time_usec();
+   passes = 0;
+   do
+   {
+      memcpy(scratch, rec->states[rec->num_states - 1], rec->state_size);
+      for (i = rec->num_states - 1; i-- > 0; )
+         state_manager_raw_decompress(rec->patches[i],
+               rec->patch_sizes[i], scratch, rec->state_size);
+      passes++;
+      decomp_time = retro_get_time_usec() - start;
+   } while (decomp_time < BENCH_MIN_USEC);
+   decomp_time /= passes;
+
+   printf("%-6s  %12.2f  %12.2f  %10.2f%%\n", kernels[kernel].name,
+         bytes / (comp_time * 1000.0), bytes / (decomp_time * 1000.0),
+         100.0 * patch_bytes / bytes);
+
+   return !memcmp(scratch, rec->states[0], rec->state_size);
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i;
+   int ret                    = 0;
+   uint64_t cpu_mask          = rewind_bench_cpu_features();
+   uint8_t *scratch           = NULL;
+   struct bench_recording rec = {0};
+
+   if (argc == 3)
+   {
+      if (!bench_recording_load(&rec, strtoul(argv[1], NULL, 0), argv[2]))
+      {
+         bench_recording_free(&rec);
+         return 1;
+      }
+   }
+   else if (argc == 1)
+   {
+      if (!bench_recording_synthesize(&rec))
+      {
+         bench_recording_free(&rec);
+         return 1;
+      }
+   }
+   else
+   {
+      fprintf(stderr, "Usage: %s [<state size> <recording>]\n", argv[0]);
+      return 1;
+   }
+
+   scratch = (uint8_t*)state_manager_raw_alloc(rec.state_size, 2);
+   if (!scratch)
+   {
+      bench_recording_free(&rec);
+      return 1;
+   }
+
+   printf("%u states of %u bytes.\n", rec.num_states,
+         (unsigned)rec.state_size);
+   printf("%-6s  %12s  %12s  %11s\n", "kernel",
+         "comp GB/s", "decomp GB/s", "patch size");
+
+   for (i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++)
+   {
+      if ((cpu_mask & kernels[i].mask) != kernels[i].mask)
+         continue;
+
+      if (!bench_kernel(&rec, i, scratch))
+      {
+         fprintf(stderr, "%s: rewinding did not give back the first state.\n",
+               kernels[i].name);
+         ret = 1;
+      }
+   }
+
+   free(scratch);
+   bench_recording_free(&rec);
+   return ret;
+}